@@ -0,0 +1,803 @@
+/**
+ * @file Auto-generated message definitions for motor_control
+ *
+ * Generated from: Capybarish/schemas/motor_control.cpy
+ * Generated at: 2026-10-17T11:40:21.849894
+ *
+ * DO NOT EDIT - This file is auto-generated by capybarish-gen.
+ *
+ * @copyright 2025 Chen Yu
+ * @license Apache-2.0
+ */
+
+#ifndef MOTOR_CONTROL_MESSAGES_HPP
+#define MOTOR_CONTROL_MESSAGES_HPP
+
+#include <cstdint>
+#include <cstring>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+namespace motor_control {
+
+// Forward declarations
+struct MotorCommand;
+struct TrajectoryChunk;
+struct IMUOrientation;
+struct IMUQuaternion;
+struct IMUOmega;
+struct IMUAcceleration;
+struct IMUData;
+struct MotorData;
+struct ErrorData;
+struct UWBDistances;
+struct PolicyDebugData;
+struct SensorData;
+
+/** One primitive field in a message's flattened wire layout */
+struct FieldLayout {
+    const char* name;  ///< Dotted path for nested fields, e.g. "pose.position.x"
+    const char* type;  ///< Wire type: int8..uint64, float32, float64, bool
+    uint16_t offset;   ///< Byte offset in the serialized message
+    uint16_t count;    ///< Array length (1 for scalars)
+};
+
+/** Motor command sent from server to robot module */
+#pragma pack(push, 1)
+struct MotorCommand {
+    float target = 0.0f;  ///< Target position (radians)
+    float target_vel = 0.0f;  ///< Target velocity (rad/s)
+    float kp = 0.0f;  ///< Proportional gain
+    float kd = 0.0f;  ///< Derivative gain
+    int32_t enable_filter = 0;  ///< Enable low-pass filter (0 or 1)
+    int32_t switch_ = 0;  ///< Motor switch state (0=off, 1=on)
+    int32_t calibrate = 0;  ///< Trigger calibration (0 or 1)
+    int32_t restart = 0;  ///< Trigger restart (0 or 1)
+    float timestamp = 0.0f;  ///< Command timestamp (seconds)
+    int32_t control_mode = 0;  ///< Control mode: 0=direct PD target from PC, 1=ESP32 onboard model
+    float joint_offset = 0.0f;  ///< Per-joint default offset (radians), sent explicitly by PC
+    int32_t policy_hash = 0;  ///< Positive int32 FNV-1a hash of the deployed onboard model weights
+    int32_t joint_id = 0;  ///< Index of the joint/action this command targets (0-based); -1 = broadcast/all
+    float command_context[8];  ///< Auxiliary command context (8-dim); zeros when unused
+
+    static constexpr size_t SIZE = 84;
+
+    static constexpr const char* NAME = "MotorCommand";
+    static constexpr size_t FIELD_COUNT = 14;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"target", "float32", 0, 1},
+        {"target_vel", "float32", 4, 1},
+        {"kp", "float32", 8, 1},
+        {"kd", "float32", 12, 1},
+        {"enable_filter", "int32", 16, 1},
+        {"switch_", "int32", 20, 1},
+        {"calibrate", "int32", 24, 1},
+        {"restart", "int32", 28, 1},
+        {"timestamp", "float32", 32, 1},
+        {"control_mode", "int32", 36, 1},
+        {"joint_offset", "float32", 40, 1},
+        {"policy_hash", "int32", 44, 1},
+        {"joint_id", "int32", 48, 1},
+        {"command_context", "float32", 52, 8},
+    };
+
+    /**
+     * @brief Serialize struct to byte buffer
+     * @param buffer Output buffer (must be at least SIZE bytes)
+     */
+    void serialize(uint8_t* buffer) const {
+        memcpy(buffer, this, SIZE);
+    }
+
+    /**
+     * @brief Deserialize from byte buffer
+     * @param buffer Input buffer (must be at least SIZE bytes)
+     * @param len Buffer length
+     * @return true if successful
+     */
+    bool deserialize(const uint8_t* buffer, size_t len) {
+        if (len < SIZE) return false;
+        memcpy(this, buffer, SIZE);
+        return true;
+    }
+
+    /**
+     * @brief Static factory: create from byte buffer
+     * @param buffer Input buffer
+     * @param len Buffer length
+     * @return MotorCommand object
+     */
+    static MotorCommand fromBytes(const uint8_t* buffer, size_t len) {
+        MotorCommand obj;
+        obj.deserialize(buffer, len);
+        return obj;
+    }
+};
+#pragma pack(pop)
+static_assert(sizeof(MotorCommand) == 84, "Size mismatch for MotorCommand");
+
+/** Short horizon of timestamped setpoints, interpolated on the module (cpy::TrajectoryBuffer) */
+#pragma pack(push, 1)
+struct TrajectoryChunk {
+    int32_t joint_id = 0;  ///< Target joint (0-based); -1 = broadcast/all
+    int32_t seq = 0;  ///< Chunk sequence number
+    float timestamp = 0.0f;  ///< Sender time of the chunk (seconds, same clock as MotorCommand)
+    int32_t count = 0;  ///< Number of valid points (0-8)
+    float t[8];  ///< Point times relative to timestamp (seconds, increasing)
+    float target[8];  ///< Target position at each point (radians)
+    float target_vel[8];  ///< Target velocity at each point (rad/s)
+    float kp = 0.0f;  ///< Proportional gain
+    float kd = 0.0f;  ///< Derivative gain
+
+    static constexpr size_t SIZE = 120;
+
+    static constexpr const char* NAME = "TrajectoryChunk";
+    static constexpr size_t FIELD_COUNT = 9;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"joint_id", "int32", 0, 1},
+        {"seq", "int32", 4, 1},
+        {"timestamp", "float32", 8, 1},
+        {"count", "int32", 12, 1},
+        {"t", "float32", 16, 8},
+        {"target", "float32", 48, 8},
+        {"target_vel", "float32", 80, 8},
+        {"kp", "float32", 112, 1},
+        {"kd", "float32", 116, 1},
+    };
+
+    /**
+     * @brief Serialize struct to byte buffer
+     * @param buffer Output buffer (must be at least SIZE bytes)
+     */
+    void serialize(uint8_t* buffer) const {
+        memcpy(buffer, this, SIZE);
+    }
+
+    /**
+     * @brief Deserialize from byte buffer
+     * @param buffer Input buffer (must be at least SIZE bytes)
+     * @param len Buffer length
+     * @return true if successful
+     */
+    bool deserialize(const uint8_t* buffer, size_t len) {
+        if (len < SIZE) return false;
+        memcpy(this, buffer, SIZE);
+        return true;
+    }
+
+    /**
+     * @brief Static factory: create from byte buffer
+     * @param buffer Input buffer
+     * @param len Buffer length
+     * @return TrajectoryChunk object
+     */
+    static TrajectoryChunk fromBytes(const uint8_t* buffer, size_t len) {
+        TrajectoryChunk obj;
+        obj.deserialize(buffer, len);
+        return obj;
+    }
+};
+#pragma pack(pop)
+static_assert(sizeof(TrajectoryChunk) == 120, "Size mismatch for TrajectoryChunk");
+
+/** IMU orientation (Euler angles in radians) */
+#pragma pack(push, 1)
+struct IMUOrientation {
+    float x = 0.0f;  ///< Roll
+    float y = 0.0f;  ///< Pitch
+    float z = 0.0f;  ///< Yaw
+
+    static constexpr size_t SIZE = 12;
+
+    static constexpr const char* NAME = "IMUOrientation";
+    static constexpr size_t FIELD_COUNT = 3;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"x", "float32", 0, 1},
+        {"y", "float32", 4, 1},
+        {"z", "float32", 8, 1},
+    };
+
+    /**
+     * @brief Serialize struct to byte buffer
+     * @param buffer Output buffer (must be at least SIZE bytes)
+     */
+    void serialize(uint8_t* buffer) const {
+        memcpy(buffer, this, SIZE);
+    }
+
+    /**
+     * @brief Deserialize from byte buffer
+     * @param buffer Input buffer (must be at least SIZE bytes)
+     * @param len Buffer length
+     * @return true if successful
+     */
+    bool deserialize(const uint8_t* buffer, size_t len) {
+        if (len < SIZE) return false;
+        memcpy(this, buffer, SIZE);
+        return true;
+    }
+
+    /**
+     * @brief Static factory: create from byte buffer
+     * @param buffer Input buffer
+     * @param len Buffer length
+     * @return IMUOrientation object
+     */
+    static IMUOrientation fromBytes(const uint8_t* buffer, size_t len) {
+        IMUOrientation obj;
+        obj.deserialize(buffer, len);
+        return obj;
+    }
+};
+#pragma pack(pop)
+static_assert(sizeof(IMUOrientation) == 12, "Size mismatch for IMUOrientation");
+
+/** IMU quaternion representation */
+#pragma pack(push, 1)
+struct IMUQuaternion {
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+    float w = 0.0f;
+
+    static constexpr size_t SIZE = 16;
+
+    static constexpr const char* NAME = "IMUQuaternion";
+    static constexpr size_t FIELD_COUNT = 4;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"x", "float32", 0, 1},
+        {"y", "float32", 4, 1},
+        {"z", "float32", 8, 1},
+        {"w", "float32", 12, 1},
+    };
+
+    /**
+     * @brief Serialize struct to byte buffer
+     * @param buffer Output buffer (must be at least SIZE bytes)
+     */
+    void serialize(uint8_t* buffer) const {
+        memcpy(buffer, this, SIZE);
+    }
+
+    /**
+     * @brief Deserialize from byte buffer
+     * @param buffer Input buffer (must be at least SIZE bytes)
+     * @param len Buffer length
+     * @return true if successful
+     */
+    bool deserialize(const uint8_t* buffer, size_t len) {
+        if (len < SIZE) return false;
+        memcpy(this, buffer, SIZE);
+        return true;
+    }
+
+    /**
+     * @brief Static factory: create from byte buffer
+     * @param buffer Input buffer
+     * @param len Buffer length
+     * @return IMUQuaternion object
+     */
+    static IMUQuaternion fromBytes(const uint8_t* buffer, size_t len) {
+        IMUQuaternion obj;
+        obj.deserialize(buffer, len);
+        return obj;
+    }
+};
+#pragma pack(pop)
+static_assert(sizeof(IMUQuaternion) == 16, "Size mismatch for IMUQuaternion");
+
+/** IMU angular velocity (rad/s) */
+#pragma pack(push, 1)
+struct IMUOmega {
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+
+    static constexpr size_t SIZE = 12;
+
+    static constexpr const char* NAME = "IMUOmega";
+    static constexpr size_t FIELD_COUNT = 3;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"x", "float32", 0, 1},
+        {"y", "float32", 4, 1},
+        {"z", "float32", 8, 1},
+    };
+
+    /**
+     * @brief Serialize struct to byte buffer
+     * @param buffer Output buffer (must be at least SIZE bytes)
+     */
+    void serialize(uint8_t* buffer) const {
+        memcpy(buffer, this, SIZE);
+    }
+
+    /**
+     * @brief Deserialize from byte buffer
+     * @param buffer Input buffer (must be at least SIZE bytes)
+     * @param len Buffer length
+     * @return true if successful
+     */
+    bool deserialize(const uint8_t* buffer, size_t len) {
+        if (len < SIZE) return false;
+        memcpy(this, buffer, SIZE);
+        return true;
+    }
+
+    /**
+     * @brief Static factory: create from byte buffer
+     * @param buffer Input buffer
+     * @param len Buffer length
+     * @return IMUOmega object
+     */
+    static IMUOmega fromBytes(const uint8_t* buffer, size_t len) {
+        IMUOmega obj;
+        obj.deserialize(buffer, len);
+        return obj;
+    }
+};
+#pragma pack(pop)
+static_assert(sizeof(IMUOmega) == 12, "Size mismatch for IMUOmega");
+
+/** IMU linear acceleration (m/s²) */
+#pragma pack(push, 1)
+struct IMUAcceleration {
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+
+    static constexpr size_t SIZE = 12;
+
+    static constexpr const char* NAME = "IMUAcceleration";
+    static constexpr size_t FIELD_COUNT = 3;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"x", "float32", 0, 1},
+        {"y", "float32", 4, 1},
+        {"z", "float32", 8, 1},
+    };
+
+    /**
+     * @brief Serialize struct to byte buffer
+     * @param buffer Output buffer (must be at least SIZE bytes)
+     */
+    void serialize(uint8_t* buffer) const {
+        memcpy(buffer, this, SIZE);
+    }
+
+    /**
+     * @brief Deserialize from byte buffer
+     * @param buffer Input buffer (must be at least SIZE bytes)
+     * @param len Buffer length
+     * @return true if successful
+     */
+    bool deserialize(const uint8_t* buffer, size_t len) {
+        if (len < SIZE) return false;
+        memcpy(this, buffer, SIZE);
+        return true;
+    }
+
+    /**
+     * @brief Static factory: create from byte buffer
+     * @param buffer Input buffer
+     * @param len Buffer length
+     * @return IMUAcceleration object
+     */
+    static IMUAcceleration fromBytes(const uint8_t* buffer, size_t len) {
+        IMUAcceleration obj;
+        obj.deserialize(buffer, len);
+        return obj;
+    }
+};
+#pragma pack(pop)
+static_assert(sizeof(IMUAcceleration) == 12, "Size mismatch for IMUAcceleration");
+
+/** Complete IMU data package */
+#pragma pack(push, 1)
+struct IMUData {
+    IMUOrientation orientation;
+    IMUQuaternion quaternion;
+    IMUOmega omega;
+    IMUAcceleration acceleration;
+
+    static constexpr size_t SIZE = 52;
+
+    static constexpr const char* NAME = "IMUData";
+    static constexpr size_t FIELD_COUNT = 13;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"orientation.x", "float32", 0, 1},
+        {"orientation.y", "float32", 4, 1},
+        {"orientation.z", "float32", 8, 1},
+        {"quaternion.x", "float32", 12, 1},
+        {"quaternion.y", "float32", 16, 1},
+        {"quaternion.z", "float32", 20, 1},
+        {"quaternion.w", "float32", 24, 1},
+        {"omega.x", "float32", 28, 1},
+        {"omega.y", "float32", 32, 1},
+        {"omega.z", "float32", 36, 1},
+        {"acceleration.x", "float32", 40, 1},
+        {"acceleration.y", "float32", 44, 1},
+        {"acceleration.z", "float32", 48, 1},
+    };
+
+    /**
+     * @brief Serialize struct to byte buffer
+     * @param buffer Output buffer (must be at least SIZE bytes)
+     */
+    void serialize(uint8_t* buffer) const {
+        memcpy(buffer, this, SIZE);
+    }
+
+    /**
+     * @brief Deserialize from byte buffer
+     * @param buffer Input buffer (must be at least SIZE bytes)
+     * @param len Buffer length
+     * @return true if successful
+     */
+    bool deserialize(const uint8_t* buffer, size_t len) {
+        if (len < SIZE) return false;
+        memcpy(this, buffer, SIZE);
+        return true;
+    }
+
+    /**
+     * @brief Static factory: create from byte buffer
+     * @param buffer Input buffer
+     * @param len Buffer length
+     * @return IMUData object
+     */
+    static IMUData fromBytes(const uint8_t* buffer, size_t len) {
+        IMUData obj;
+        obj.deserialize(buffer, len);
+        return obj;
+    }
+};
+#pragma pack(pop)
+static_assert(sizeof(IMUData) == 52, "Size mismatch for IMUData");
+
+/** Motor sensor data */
+#pragma pack(push, 1)
+struct MotorData {
+    float pos = 0.0f;  ///< Current position (radians)
+    float large_pos = 0.0f;  ///< Unwrapped position (radians)
+    float vel = 0.0f;  ///< Current velocity (rad/s)
+    float torque = 0.0f;  ///< Current torque (Nm)
+    float voltage = 0.0f;  ///< Motor voltage (V)
+    float current = 0.0f;  ///< Motor current (A)
+    int32_t temperature = 0;  ///< Temperature (°C)
+    int32_t motor_error = 0;  ///< Motor error flags (6 bits: undervoltage, overcurrent, etc.)
+    int32_t motor_mode = 0;  ///< Motor mode (0=Reset/Off, 1=Calibration, 2=Active/On)
+    int32_t driver_error = 0;  ///< Driver chip error/fault state (packed bits)
+
+    static constexpr size_t SIZE = 40;
+
+    static constexpr const char* NAME = "MotorData";
+    static constexpr size_t FIELD_COUNT = 10;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"pos", "float32", 0, 1},
+        {"large_pos", "float32", 4, 1},
+        {"vel", "float32", 8, 1},
+        {"torque", "float32", 12, 1},
+        {"voltage", "float32", 16, 1},
+        {"current", "float32", 20, 1},
+        {"temperature", "int32", 24, 1},
+        {"motor_error", "int32", 28, 1},
+        {"motor_mode", "int32", 32, 1},
+        {"driver_error", "int32", 36, 1},
+    };
+
+    /**
+     * @brief Serialize struct to byte buffer
+     * @param buffer Output buffer (must be at least SIZE bytes)
+     */
+    void serialize(uint8_t* buffer) const {
+        memcpy(buffer, this, SIZE);
+    }
+
+    /**
+     * @brief Deserialize from byte buffer
+     * @param buffer Input buffer (must be at least SIZE bytes)
+     * @param len Buffer length
+     * @return true if successful
+     */
+    bool deserialize(const uint8_t* buffer, size_t len) {
+        if (len < SIZE) return false;
+        memcpy(this, buffer, SIZE);
+        return true;
+    }
+
+    /**
+     * @brief Static factory: create from byte buffer
+     * @param buffer Input buffer
+     * @param len Buffer length
+     * @return MotorData object
+     */
+    static MotorData fromBytes(const uint8_t* buffer, size_t len) {
+        MotorData obj;
+        obj.deserialize(buffer, len);
+        return obj;
+    }
+};
+#pragma pack(pop)
+static_assert(sizeof(MotorData) == 40, "Size mismatch for MotorData");
+
+/** System error data */
+#pragma pack(push, 1)
+struct ErrorData {
+    int32_t reset_reason0 = 0;  ///< CPU0 reset reason
+    int32_t reset_reason1 = 0;  ///< CPU1 reset reason
+
+    static constexpr size_t SIZE = 8;
+
+    static constexpr const char* NAME = "ErrorData";
+    static constexpr size_t FIELD_COUNT = 2;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"reset_reason0", "int32", 0, 1},
+        {"reset_reason1", "int32", 4, 1},
+    };
+
+    /**
+     * @brief Serialize struct to byte buffer
+     * @param buffer Output buffer (must be at least SIZE bytes)
+     */
+    void serialize(uint8_t* buffer) const {
+        memcpy(buffer, this, SIZE);
+    }
+
+    /**
+     * @brief Deserialize from byte buffer
+     * @param buffer Input buffer (must be at least SIZE bytes)
+     * @param len Buffer length
+     * @return true if successful
+     */
+    bool deserialize(const uint8_t* buffer, size_t len) {
+        if (len < SIZE) return false;
+        memcpy(this, buffer, SIZE);
+        return true;
+    }
+
+    /**
+     * @brief Static factory: create from byte buffer
+     * @param buffer Input buffer
+     * @param len Buffer length
+     * @return ErrorData object
+     */
+    static ErrorData fromBytes(const uint8_t* buffer, size_t len) {
+        ErrorData obj;
+        obj.deserialize(buffer, len);
+        return obj;
+    }
+};
+#pragma pack(pop)
+static_assert(sizeof(ErrorData) == 8, "Size mismatch for ErrorData");
+
+/** UWB distance measurements (4 anchors) */
+#pragma pack(push, 1)
+struct UWBDistances {
+    float d0 = 0.0f;  ///< Distance to anchor 0 (meters)
+    float d1 = 0.0f;  ///< Distance to anchor 1 (meters)
+    float d2 = 0.0f;  ///< Distance to anchor 2 (meters)
+    float d3 = 0.0f;  ///< Distance to anchor 3 (meters)
+
+    static constexpr size_t SIZE = 16;
+
+    static constexpr const char* NAME = "UWBDistances";
+    static constexpr size_t FIELD_COUNT = 4;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"d0", "float32", 0, 1},
+        {"d1", "float32", 4, 1},
+        {"d2", "float32", 8, 1},
+        {"d3", "float32", 12, 1},
+    };
+
+    /**
+     * @brief Serialize struct to byte buffer
+     * @param buffer Output buffer (must be at least SIZE bytes)
+     */
+    void serialize(uint8_t* buffer) const {
+        memcpy(buffer, this, SIZE);
+    }
+
+    /**
+     * @brief Deserialize from byte buffer
+     * @param buffer Input buffer (must be at least SIZE bytes)
+     * @param len Buffer length
+     * @return true if successful
+     */
+    bool deserialize(const uint8_t* buffer, size_t len) {
+        if (len < SIZE) return false;
+        memcpy(this, buffer, SIZE);
+        return true;
+    }
+
+    /**
+     * @brief Static factory: create from byte buffer
+     * @param buffer Input buffer
+     * @param len Buffer length
+     * @return UWBDistances object
+     */
+    static UWBDistances fromBytes(const uint8_t* buffer, size_t len) {
+        UWBDistances obj;
+        obj.deserialize(buffer, len);
+        return obj;
+    }
+};
+#pragma pack(pop)
+static_assert(sizeof(UWBDistances) == 16, "Size mismatch for UWBDistances");
+
+/** input/output used on the module. */
+#pragma pack(push, 1)
+struct PolicyDebugData {
+    int32_t valid = 0;  ///< 1 when onboard-model debug data is populated
+    int32_t seq = 0;  ///< Monotonic sequence number for model ticks
+    float nn_action = 0.0f;  ///< Raw onboard-model action in [-0.8, 0.8]
+    float motor_target = 0.0f;  ///< Final motor target after adding joint_offset
+    float joint_offset = 0.0f;  ///< Joint offset applied on the ESP32
+    float dof_pos = 0.0f;  ///< Filtered joint position used by the onboard model
+    float dof_vel = 0.0f;  ///< Filtered joint velocity used by the onboard model
+    float command_context[8];  ///< Latest command context used by the onboard model
+    float local_obs[40];  ///< Full onboard-model observation history (current deploy config)
+
+    static constexpr size_t SIZE = 220;
+
+    static constexpr const char* NAME = "PolicyDebugData";
+    static constexpr size_t FIELD_COUNT = 9;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"valid", "int32", 0, 1},
+        {"seq", "int32", 4, 1},
+        {"nn_action", "float32", 8, 1},
+        {"motor_target", "float32", 12, 1},
+        {"joint_offset", "float32", 16, 1},
+        {"dof_pos", "float32", 20, 1},
+        {"dof_vel", "float32", 24, 1},
+        {"command_context", "float32", 28, 8},
+        {"local_obs", "float32", 60, 40},
+    };
+
+    /**
+     * @brief Serialize struct to byte buffer
+     * @param buffer Output buffer (must be at least SIZE bytes)
+     */
+    void serialize(uint8_t* buffer) const {
+        memcpy(buffer, this, SIZE);
+    }
+
+    /**
+     * @brief Deserialize from byte buffer
+     * @param buffer Input buffer (must be at least SIZE bytes)
+     * @param len Buffer length
+     * @return true if successful
+     */
+    bool deserialize(const uint8_t* buffer, size_t len) {
+        if (len < SIZE) return false;
+        memcpy(this, buffer, SIZE);
+        return true;
+    }
+
+    /**
+     * @brief Static factory: create from byte buffer
+     * @param buffer Input buffer
+     * @param len Buffer length
+     * @return PolicyDebugData object
+     */
+    static PolicyDebugData fromBytes(const uint8_t* buffer, size_t len) {
+        PolicyDebugData obj;
+        obj.deserialize(buffer, len);
+        return obj;
+    }
+};
+#pragma pack(pop)
+static_assert(sizeof(PolicyDebugData) == 220, "Size mismatch for PolicyDebugData");
+
+/** Complete sensor data from robot module */
+#pragma pack(push, 1)
+struct SensorData {
+    int32_t module_id = 0;  ///< Unique module identifier
+    int32_t receive_dt = 0;  ///< Receive processing time (µs)
+    int32_t timestamp = 0;  ///< Current timestamp (µs)
+    int32_t switch_off = 0;  ///< Switch off request flag
+    float last_rcv_timestamp = 0.0f;  ///< Last received command timestamp
+    int32_t info = 0;  ///< Info/status code
+    MotorData motor;  ///< Motor sensor data
+    IMUData imu;  ///< IMU sensor data
+    ErrorData error;  ///< Error/reset data
+    int32_t policy_hash = 0;  ///< Positive int32 FNV-1a hash computed on ESP32 from loaded policy weights
+    int32_t policy_status = 0;  ///< Bitmask: loaded/sanity/hash seen/hash match/runtime check
+    int32_t policy_error = 0;  ///< Runtime policy error code (0=OK, nonzero=fault)
+    float goal_distance = 0.0f;  ///< Distance to goal (meters)
+    UWBDistances uwb;  ///< UWB distance measurements
+    PolicyDebugData policy_debug;  ///< Optional onboard-model debug snapshot
+
+    static constexpr size_t SIZE = 376;
+
+    static constexpr const char* NAME = "SensorData";
+    static constexpr size_t FIELD_COUNT = 48;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"module_id", "int32", 0, 1},
+        {"receive_dt", "int32", 4, 1},
+        {"timestamp", "int32", 8, 1},
+        {"switch_off", "int32", 12, 1},
+        {"last_rcv_timestamp", "float32", 16, 1},
+        {"info", "int32", 20, 1},
+        {"motor.pos", "float32", 24, 1},
+        {"motor.large_pos", "float32", 28, 1},
+        {"motor.vel", "float32", 32, 1},
+        {"motor.torque", "float32", 36, 1},
+        {"motor.voltage", "float32", 40, 1},
+        {"motor.current", "float32", 44, 1},
+        {"motor.temperature", "int32", 48, 1},
+        {"motor.motor_error", "int32", 52, 1},
+        {"motor.motor_mode", "int32", 56, 1},
+        {"motor.driver_error", "int32", 60, 1},
+        {"imu.orientation.x", "float32", 64, 1},
+        {"imu.orientation.y", "float32", 68, 1},
+        {"imu.orientation.z", "float32", 72, 1},
+        {"imu.quaternion.x", "float32", 76, 1},
+        {"imu.quaternion.y", "float32", 80, 1},
+        {"imu.quaternion.z", "float32", 84, 1},
+        {"imu.quaternion.w", "float32", 88, 1},
+        {"imu.omega.x", "float32", 92, 1},
+        {"imu.omega.y", "float32", 96, 1},
+        {"imu.omega.z", "float32", 100, 1},
+        {"imu.acceleration.x", "float32", 104, 1},
+        {"imu.acceleration.y", "float32", 108, 1},
+        {"imu.acceleration.z", "float32", 112, 1},
+        {"error.reset_reason0", "int32", 116, 1},
+        {"error.reset_reason1", "int32", 120, 1},
+        {"policy_hash", "int32", 124, 1},
+        {"policy_status", "int32", 128, 1},
+        {"policy_error", "int32", 132, 1},
+        {"goal_distance", "float32", 136, 1},
+        {"uwb.d0", "float32", 140, 1},
+        {"uwb.d1", "float32", 144, 1},
+        {"uwb.d2", "float32", 148, 1},
+        {"uwb.d3", "float32", 152, 1},
+        {"policy_debug.valid", "int32", 156, 1},
+        {"policy_debug.seq", "int32", 160, 1},
+        {"policy_debug.nn_action", "float32", 164, 1},
+        {"policy_debug.motor_target", "float32", 168, 1},
+        {"policy_debug.joint_offset", "float32", 172, 1},
+        {"policy_debug.dof_pos", "float32", 176, 1},
+        {"policy_debug.dof_vel", "float32", 180, 1},
+        {"policy_debug.command_context", "float32", 184, 8},
+        {"policy_debug.local_obs", "float32", 216, 40},
+    };
+
+    /**
+     * @brief Serialize struct to byte buffer
+     * @param buffer Output buffer (must be at least SIZE bytes)
+     */
+    void serialize(uint8_t* buffer) const {
+        memcpy(buffer, this, SIZE);
+    }
+
+    /**
+     * @brief Deserialize from byte buffer
+     * @param buffer Input buffer (must be at least SIZE bytes)
+     * @param len Buffer length
+     * @return true if successful
+     */
+    bool deserialize(const uint8_t* buffer, size_t len) {
+        if (len < SIZE) return false;
+        memcpy(this, buffer, SIZE);
+        return true;
+    }
+
+    /**
+     * @brief Static factory: create from byte buffer
+     * @param buffer Input buffer
+     * @param len Buffer length
+     * @return SensorData object
+     */
+    static SensorData fromBytes(const uint8_t* buffer, size_t len) {
+        SensorData obj;
+        obj.deserialize(buffer, len);
+        return obj;
+    }
+};
+#pragma pack(pop)
+static_assert(sizeof(SensorData) == 376, "Size mismatch for SensorData");
+
+} // namespace motor_control
+
+#endif // MOTOR_CONTROL_MESSAGES_HPP
\ No newline at end of file
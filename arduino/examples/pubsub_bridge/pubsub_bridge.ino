@@ -0,0 +1,140 @@
+/**
+ * ESP32 WiFi <-> USB Bridge Example
+ * 
+ * Forwards topics between the WiFi network and a host on the USB cable,
+ * without compiling in a message type per topic. Datagrams are passed on
+ * verbatim (frame headers included), so FEC and duplicate filtering still
+ * work end to end.
+ * 
+ * Topics with a schema are also checked for size, and one of them is
+ * decoded by field name for a once-a-second summary. Schemas come either
+ * from the generated FIELDS tables or from .cpy text, e.g. for a message
+ * this firmware was never built against.
+ * 
+ * Host side: capybarish.serial_transport on the same USB port.
+ */
+
+#include <WiFi.h>
+#include "capybarish_pubsub.h"
+#include "capybarish_serial.h"
+#include "motor_control_messages.hpp"
+
+// =============================================================================
+// WiFi Configuration
+// =============================================================================
+
+const char* WIFI_SSID = "Xenobot";
+const char* WIFI_PASSWORD = "your_password_here";  // Update this!
+
+const char* PEER_IP = "192.168.1.100";  // Where USB -> WiFi topics go
+
+// =============================================================================
+// Schemas
+// =============================================================================
+
+// Runtime schema for a message this firmware has no header for
+const char* EXTRA_SCHEMA = R"(
+# Battery pack status
+message BatteryStatus:
+    uint8 pack_id
+    float32 voltage
+    float32 current
+    float32[4] cell_temps
+)";
+
+cpy::SchemaSet schemas;
+
+// =============================================================================
+// Bridged Topics
+// =============================================================================
+
+struct Route {
+    const char* topic;
+    const char* schema;  // Message name, or nullptr for opaque
+    uint16_t port;
+    bool toUsb;          // WiFi -> USB (true) or USB -> WiFi (false)
+};
+
+const Route ROUTES[] = {
+    {"/motor/feedback", "SensorData",    6666, true},
+    {"/battery",        "BatteryStatus", 6670, true},
+    {"/log",            nullptr,         6671, true},
+    {"/motor/command",  "MotorCommand",  6667, false},
+};
+constexpr size_t NUM_ROUTES = sizeof(ROUTES) / sizeof(ROUTES[0]);
+
+cpy::SerialTransport<> usb(Serial);
+cpy::Node* wifiNode = nullptr;
+cpy::Node* usbNode = nullptr;
+cpy::GenericPublisher* outputs[NUM_ROUTES];
+cpy::GenericSubscription* inputs[NUM_ROUTES];
+
+// Summary of the first feedback topic, decoded by field name
+const cpy::MessageSchema* feedbackSchema = nullptr;
+double lastPos = 0.0;
+
+// =============================================================================
+// Setup
+// =============================================================================
+
+void setup() {
+    Serial.begin(921600);
+    
+    // Load schemas: generated tables first, then .cpy text
+    schemas.add<motor_control::SensorData>();
+    schemas.add<motor_control::MotorCommand>();
+    if (!schemas.parse(EXTRA_SCHEMA)) {
+        Serial.printf("[Bridge] Schema error: %s\n", schemas.lastError());
+    }
+    feedbackSchema = schemas.find("SensorData");
+    
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+    while (WiFi.status() != WL_CONNECTED) {
+        delay(500);
+    }
+    
+    wifiNode = new cpy::Node("bridge_wifi");
+    usbNode = new cpy::Node("bridge_usb", "", &usb);
+    
+    for (size_t i = 0; i < NUM_ROUTES; i++) {
+        const Route& r = ROUTES[i];
+        const cpy::MessageSchema* schema = r.schema ? schemas.find(r.schema) : nullptr;
+        cpy::Node* from = r.toUsb ? wifiNode : usbNode;
+        cpy::Node* to = r.toUsb ? usbNode : wifiNode;
+        
+        outputs[i] = to->createGenericPublisher(r.topic, schema, PEER_IP, r.port);
+        cpy::GenericPublisher* out = outputs[i];
+        
+        bool summarize = schema == feedbackSchema;
+        inputs[i] = from->createGenericSubscription(r.topic, schema,
+            [out, summarize](const uint8_t* data, size_t len) {
+                out->publish(data, len);
+                if (summarize) {
+                    cpy::MessageView view(*feedbackSchema, data, len);
+                    view.getDouble("motor.pos", lastPos);
+                }
+            }, r.port);
+    }
+}
+
+// =============================================================================
+// Main Loop
+// =============================================================================
+
+unsigned long lastStats = 0;
+
+void loop() {
+    // Both directions; the WiFi side sleeps until a datagram arrives
+    wifiNode->spinFor(1000);
+    usbNode->spinOnce();
+    
+    if (millis() - lastStats >= 1000) {
+        lastStats = millis();
+        for (size_t i = 0; i < NUM_ROUTES; i++) {
+            Serial.printf("[Bridge] %-16s rx %lu drop %lu -> tx %lu (%.0f B/s)\n",
+                          ROUTES[i].topic, inputs[i]->getReceiveCount(), inputs[i]->getDropCount(),
+                          outputs[i]->getPublishCount(), outputs[i]->getBytesPerSec());
+        }
+        Serial.printf("[Bridge] motor.pos = %.3f\n", lastPos);
+    }
+}
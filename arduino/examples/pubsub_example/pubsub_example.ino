@@ -32,7 +32,6 @@ using namespace motor_control;
 
 void printStats();
 void controlLoop();
-void onCommandReceived(const MotorCommand& cmd);
 
 // =============================================================================
 // Configuration
@@ -64,45 +63,36 @@ cpy::Subscription<MotorCommand>* commandSub = nullptr;
 // State
 MotorData motorState = {};
 IMUData imuState = {};
-MotorCommand lastCommand = {};
-bool hasNewCommand = false;
+
+// Latest command, written by the subscription. Readable from any task
+// without a mutex, so reception can move off the control loop's task.
+cpy::Seqlock<MotorCommand> latestCommand;
+uint32_t commandVersion = 0;  // Last version the control loop applied
 
 // Statistics
 uint32_t loopCount = 0;
 uint64_t lastStatsPrint = 0;
 
 // =============================================================================
-// Callback Functions
+// Control Loop
 // =============================================================================
 
-/**
- * @brief Callback when command is received from server
- */
-void onCommandReceived(const MotorCommand& cmd) {
-    lastCommand = cmd;
-    hasNewCommand = true;
-    
-    // Log received command (optional, can be noisy at high rates)
-    // node.logInfo("Cmd: target=%.2f, kp=%.1f", cmd.target, cmd.kp);
-}
-
 /**
  * @brief Simulated motor control loop
  */
 void controlLoop() {
     // Simulate motor dynamics
-    if (hasNewCommand) {
+    MotorCommand cmd;
+    if (latestCommand.readIfNewer(cmd, commandVersion)) {
         // Simple P controller simulation
-        float error = lastCommand.target - motorState.pos;
-        float torque = lastCommand.kp * error - lastCommand.kd * motorState.vel;
+        float error = cmd.target - motorState.pos;
+        float torque = cmd.kp * error - cmd.kd * motorState.vel;
         
         // Integrate (simple Euler)
         float dt = 1.0f / CONTROL_RATE_HZ;
         motorState.vel += torque * dt;
         motorState.pos += motorState.vel * dt;
         motorState.torque = torque;
-        
-        hasNewCommand = false;
     }
     
     // Simulate IMU data
@@ -150,11 +140,12 @@ void setup() {
         SERVER_PORT         // Remote port
     );
     
-    // Create subscription for commands
+    // Create subscription for commands, stored in latestCommand as they
+    // arrive (pass a callback instead to handle each one)
     // Similar to Python: sub = node.create_subscription(MotorCommand, '/motor/command', callback, ...)
     commandSub = node.createSubscription<MotorCommand>(
         "/motor/command",   // Topic name
-        onCommandReceived,  // Callback function
+        latestCommand,      // Output (cpy::Seqlock or cpy::TripleBuffer)
         LOCAL_PORT          // Local port to listen on
     );
     
@@ -175,24 +166,17 @@ void setup() {
 // =============================================================================
 
 void loop() {
-    // Process incoming messages (callbacks will be called)
-    // Similar to Python: cpy.spin_once(node)
-    if (commandSub) {
-        commandSub->spinAll();  // Process all pending messages
-    }
-    
-    // Process timers (control loop will be called at 100 Hz)
-    node.spinOnce();
+    // Run subscription callbacks and timers (control loop at 100 Hz) for up
+    // to 5 ms. The task sleeps in select() until a command arrives or the
+    // next timer is due, so there is no busy polling.
+    // Similar to Python: node.spin_for(0.005)
+    node.spinFor(5000);
     
     // Print statistics every 5 seconds
     if (millis() - lastStatsPrint >= 5000) {
         printStats();
         lastStatsPrint = millis();
     }
-    
-    // Small delay to prevent watchdog issues
-    // In a real application, use cpy::Rate for precise timing
-    delayMicroseconds(100);
 }
 
 // =============================================================================
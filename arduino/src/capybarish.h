@@ -8,6 +8,7 @@
  * Features:
  * - Template-based UDP communication (UDPComm)
  * - ROS2-like pub/sub API (Node, Publisher, Subscription, Timer)
+ * - Request/response services (Service, Client)
  * - Code generation for message types (capybarish-gen)
  * 
  * @author Chen Yu <chenyu@u.northwestern.edu>
@@ -36,6 +37,13 @@
 
 // Include pub/sub module
 #include "capybarish_pubsub.h"
+#include "capybarish_trajectory.h"
+#include "capybarish_serial.h"
+#include "capybarish_cybergear.h"
+#include "capybarish_pipeline.h"
+#include "capybarish_imu_batch.h"
+#include "capybarish_natnet.h"
+#include "capybarish_uwb.h"
 
 namespace Capybarish {
 
@@ -159,6 +167,11 @@ public:
  * 
  * Status status = {1.5f, 0};
  * comm.send(status);
+ * 
+ * // Tethered over USB-CDC: same calls, WiFi arguments are ignored
+ * cpy::SerialTransport<> usb(Serial);
+ * Capybarish::UDPComm<Command, Status> usbComm(&usb);
+ * usbComm.begin(nullptr, nullptr, nullptr, 6666);
  * @endcode
  */
 template<typename TReceive, typename TSend>
@@ -166,6 +179,15 @@ class UDPComm {
 public:
     UDPComm() : _status(ConnectionStatus::DISCONNECTED) {}
     
+    /**
+     * @brief Communicate over @p transport instead of WiFi UDP
+     * 
+     * begin() then skips WiFi; serverPort/localPort address the datagrams
+     * on the transport.
+     */
+    explicit UDPComm(cpy::Transport* transport)
+        : _status(ConnectionStatus::DISCONNECTED), _transport(transport) {}
+    
     /**
      * @brief Initialize WiFi and UDP communication
      * 
@@ -203,6 +225,22 @@ public:
      * @return true if data was received
      */
     bool receive(TReceive& data) {
+        if (_transport) {
+            uint8_t buffer[sizeof(TReceive)];
+            size_t len = _transport->receive(_config.localPort, buffer, sizeof(buffer));
+            if (len == 0) {
+                return false;
+            }
+            if (len != sizeof(TReceive)) {
+                _stats.receiveErrors++;
+                return false;
+            }
+            memcpy(&data, buffer, sizeof(TReceive));
+            _stats.packetsReceived++;
+            _stats.lastReceiveTime = micros();
+            return true;
+        }
+        
         int packetSize = _udp.parsePacket();
         if (packetSize == 0) {
             return false;
@@ -241,10 +279,17 @@ public:
         
         uint64_t startTime = micros();
         
-        _udp.beginPacket(_config.serverIP, _config.serverPort);
-        _udp.write(reinterpret_cast<const uint8_t*>(&data), sizeof(TSend));
+        bool sent;
+        if (_transport) {
+            sent = _transport->send(_config.serverPort, reinterpret_cast<const uint8_t*>(&data),
+                                    sizeof(TSend));
+        } else {
+            _udp.beginPacket(_config.serverIP, _config.serverPort);
+            _udp.write(reinterpret_cast<const uint8_t*>(&data), sizeof(TSend));
+            sent = _udp.endPacket();
+        }
         
-        if (_udp.endPacket()) {
+        if (sent) {
             _stats.packetsSent++;
             _stats.lastSendTime = startTime;
             return true;
@@ -258,6 +303,7 @@ public:
      * @brief Check if connected to WiFi
      */
     bool isConnected() const {
+        if (_transport) return _status == ConnectionStatus::CONNECTED;
         return WiFi.status() == WL_CONNECTED;
     }
     
@@ -300,6 +346,7 @@ public:
      * @brief Update connection state (call in loop for auto-reconnect)
      */
     void update() {
+        if (_transport) return;
         if (_config.autoReconnect && !isConnected()) {
             _status = ConnectionStatus::CONNECTION_LOST;
             _connectWiFi();
@@ -310,8 +357,10 @@ public:
      * @brief Close connection
      */
     void end() {
-        _udp.stop();
-        WiFi.disconnect();
+        if (!_transport) {
+            _udp.stop();
+            WiFi.disconnect();
+        }
         _status = ConnectionStatus::DISCONNECTED;
     }
     
@@ -334,8 +383,14 @@ private:
     WiFiUDP _udp;
     ConnectionStatus _status;
     Stats _stats;
+    cpy::Transport* _transport = nullptr;
     
     bool _connectWiFi() {
+        if (_transport) {
+            _status = ConnectionStatus::CONNECTED;
+            return true;
+        }
+        
         _status = ConnectionStatus::CONNECTING;
         
         Serial.println("[Capybarish] Connecting to WiFi...");
@@ -372,6 +427,11 @@ private:
     }
     
     bool _setupUDP() {
+        if (_transport) {
+            Serial.printf("[Capybarish] Using %s transport (ports %d/%d)\n",
+                          _transport->name(), _config.localPort, _config.serverPort);
+            return true;
+        }
         if (_udp.begin(_config.localPort)) {
             Serial.print("[Capybarish] UDP listening on port ");
             Serial.println(_config.localPort);
@@ -0,0 +1,518 @@
+/**
+ * @file capybarish_auth.h
+ * @brief Per-topic message authentication with SipHash and a replay window
+ *
+ * Without authentication anyone on the robot's network can send a
+ * MotorCommand. A topic with a key appends a 20-byte trailer to every
+ * datagram (plain, framed or parity):
+ *
+ *     payload | u32 sender | u64 sequence | u64 SipHash-2-4 tag   (little-endian)
+ *
+ * - The tag covers the payload, the sender ID and the sequence number,
+ *   under a key derived from the shared key and the topic name, so a
+ *   datagram cannot be moved to another topic with the same key.
+ * - Subscribers keep a 64-entry window over sequence numbers for each
+ *   sender (up to ReplayGuard::MAX_SENDERS per topic) and never move it
+ *   back: replayed datagrams (and the extra copies of a redundant
+ *   publisher) are dropped as duplicates.
+ * - SipHash is a handful of 64-bit adds, rotates and xors per 8 bytes, so
+ *   it stays cheap enough for a 1 kHz control topic.
+ *
+ * Because the window never moves back, a publisher must not reuse
+ * sequence numbers after a restart: start it at authBootSequence() on the
+ * ESP32 (a boot counter in NVS, in the upper 32 bits), or at another
+ * value that only grows, such as microseconds of wall-clock time (what
+ * capybarish.auth uses). Two publishers of one topic need different
+ * sender IDs; the default, authSenderId(), comes from the MAC address on
+ * the ESP32 and ESP8266 and is 0 elsewhere.
+ *
+ * A subscriber that reboots must not take the first authentic datagram
+ * at face value, or a recorded stream could be replayed to it. On the
+ * ESP32 it checkpoints each sender's highest sequence number in NVS
+ * (next to the boot counter) on first contact and then every
+ * ReplayGuard::CHECKPOINT_INTERVAL datagrams, and after a reboot rejects
+ * everything up to the checkpoint. What remains:
+ *
+ * - Datagrams sent after the last checkpoint (fewer than
+ *   CHECKPOINT_INTERVAL per sender) can be replayed to a rebooted
+ *   subscriber until the sender's live stream moves the window past
+ *   them.
+ * - Without NVS (other platforms) nothing is checkpointed, so a rebooted
+ *   subscriber accepts any recording until the live stream overtakes it.
+ * - A checkpoint is an NVS write in the receive path (a few ms).
+ *
+ * @example
+ * @code
+ * // 32 hex digits, provisioned per robot (e.g. in secrets.h or NVS)
+ * cpy::AuthKey key;
+ * cpy::parseAuthKey(COMMAND_KEY_HEX, key);
+ *
+ * auto* cmd = node.createSubscription<MotorCommand>("/motor/command", onCommand, 6666);
+ * cmd->setAuth(key);               // Unauthenticated commands are dropped
+ *
+ * auto* fb = node.createPublisher<SensorData>("/motor/feedback", SERVER_IP, 6667);
+ * uint64_t firstSeq;
+ * if (!cpy::authBootSequence(firstSeq)) {
+ *     Serial.println("No boot counter: subscribers will drop our datagrams as replays");
+ * }
+ * fb->setAuth(key, firstSeq);
+ * @endcode
+ *
+ * @author Chen Yu <chenyu@u.northwestern.edu>
+ * @copyright 2025 Chen Yu
+ * @license Apache-2.0
+ */
+
+#pragma once
+
+#ifndef CAPYBARISH_AUTH_H
+#define CAPYBARISH_AUTH_H
+
+#include "Arduino.h"
+
+#ifdef ESP32
+    #include <Preferences.h>
+#elif defined(ESP8266)
+    #include <ESP8266WiFi.h>
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace cpy {
+
+// =============================================================================
+// SipHash
+// =============================================================================
+
+/**
+ * @brief 128-bit key
+ */
+struct AuthKey {
+    uint8_t bytes[16] = {};
+};
+
+/**
+ * @brief Parse a key from 32 hex digits
+ * @return false (leaving @p key unchanged) if @p hex is not 32 hex digits
+ */
+inline bool parseAuthKey(const char* hex, AuthKey& key) {
+    if (!hex || strlen(hex) != 32) return false;
+    AuthKey parsed;
+    for (size_t i = 0; i < 32; i++) {
+        char c = hex[i];
+        uint8_t nibble;
+        if (c >= '0' && c <= '9') nibble = c - '0';
+        else if (c >= 'a' && c <= 'f') nibble = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') nibble = c - 'A' + 10;
+        else return false;
+        parsed.bytes[i / 2] = static_cast<uint8_t>(parsed.bytes[i / 2] << 4 | nibble);
+    }
+    key = parsed;
+    return true;
+}
+
+namespace detail {
+
+inline uint64_t load64(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));  // Little-endian targets
+    return v;
+}
+
+inline uint64_t rotl64(uint64_t x, int b) { return (x << b) | (x >> (64 - b)); }
+
+inline void sipRound(uint64_t& v0, uint64_t& v1, uint64_t& v2, uint64_t& v3) {
+    v0 += v1; v1 = rotl64(v1, 13); v1 ^= v0; v0 = rotl64(v0, 32);
+    v2 += v3; v3 = rotl64(v3, 16); v3 ^= v2;
+    v0 += v3; v3 = rotl64(v3, 21); v3 ^= v0;
+    v2 += v1; v1 = rotl64(v1, 17); v1 ^= v2; v2 = rotl64(v2, 32);
+}
+
+} // namespace detail
+
+/**
+ * @brief SipHash-2-4 of @p len bytes under the key (k0, k1)
+ */
+inline uint64_t sipHash24(uint64_t k0, uint64_t k1, const uint8_t* data, size_t len) {
+    uint64_t v0 = k0 ^ 0x736f6d6570736575ull;
+    uint64_t v1 = k1 ^ 0x646f72616e646f6dull;
+    uint64_t v2 = k0 ^ 0x6c7967656e657261ull;
+    uint64_t v3 = k1 ^ 0x7465646279746573ull;
+
+    const uint8_t* end = data + (len & ~static_cast<size_t>(7));
+    for (; data != end; data += 8) {
+        uint64_t m = detail::load64(data);
+        v3 ^= m;
+        detail::sipRound(v0, v1, v2, v3);
+        detail::sipRound(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+
+    uint64_t last = static_cast<uint64_t>(len) << 56;
+    for (size_t i = 0; i < (len & 7); i++) last |= static_cast<uint64_t>(data[i]) << (8 * i);
+    v3 ^= last;
+    detail::sipRound(v0, v1, v2, v3);
+    detail::sipRound(v0, v1, v2, v3);
+    v0 ^= last;
+
+    v2 ^= 0xff;
+    for (int i = 0; i < 4; i++) detail::sipRound(v0, v1, v2, v3);
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+inline uint64_t sipHash24(const AuthKey& key, const uint8_t* data, size_t len) {
+    return sipHash24(detail::load64(key.bytes), detail::load64(key.bytes + 8), data, len);
+}
+
+// =============================================================================
+// Sealing
+// =============================================================================
+
+constexpr size_t AUTH_TRAILER_SIZE = 20;  ///< u32 sender + u64 sequence + u64 tag
+
+/**
+ * @brief Seals and opens one topic's datagrams
+ */
+class MessageAuth {
+public:
+    /**
+     * @brief Derive the topic key from the shared @p key and @p topic
+     */
+    void begin(const AuthKey& key, const char* topic) {
+        const uint8_t* name = reinterpret_cast<const uint8_t*>(topic);
+        uint64_t k0 = detail::load64(key.bytes);
+        uint64_t k1 = detail::load64(key.bytes + 8);
+        _k0 = sipHash24(k0, k1, name, strlen(topic));
+        _k1 = sipHash24(k1, k0, name, strlen(topic));
+        _enabled = true;
+    }
+
+    void end() { _enabled = false; }
+    bool enabled() const { return _enabled; }
+
+    /**
+     * @brief Copy @p data to @p out and append the sender, sequence number and tag
+     * @return Sealed length, 0 if @p capacity is too small
+     */
+    size_t seal(const uint8_t* data, size_t len, uint8_t* out, size_t capacity,
+                uint32_t sender, uint64_t seq) const {
+        if (capacity < len + AUTH_TRAILER_SIZE) return 0;
+        if (out != data) memmove(out, data, len);
+        memcpy(out + len, &sender, sizeof(sender));
+        memcpy(out + len + sizeof(sender), &seq, sizeof(seq));
+        size_t signedLen = len + AUTH_TRAILER_SIZE - sizeof(uint64_t);
+        uint64_t tag = sipHash24(_k0, _k1, out, signedLen);
+        memcpy(out + signedLen, &tag, sizeof(tag));
+        return len + AUTH_TRAILER_SIZE;
+    }
+
+    /**
+     * @brief Check the tag of a sealed datagram
+     * @param[out] sender Its sender ID
+     * @param[out] seq Its sequence number
+     * @return Payload length, 0 if the datagram is too short or forged
+     */
+    size_t open(const uint8_t* data, size_t len, uint32_t& sender, uint64_t& seq) const {
+        if (len <= AUTH_TRAILER_SIZE) return 0;
+        size_t payload = len - AUTH_TRAILER_SIZE;
+        size_t signedLen = len - sizeof(uint64_t);
+        uint64_t expected = sipHash24(_k0, _k1, data, signedLen);
+        uint64_t tag;
+        memcpy(&tag, data + signedLen, sizeof(tag));
+        if ((tag ^ expected) != 0) return 0;
+        memcpy(&sender, data + payload, sizeof(sender));
+        memcpy(&seq, data + payload + sizeof(sender), sizeof(seq));
+        return payload;
+    }
+
+private:
+    uint64_t _k0 = 0;
+    uint64_t _k1 = 0;
+    bool _enabled = false;
+};
+
+// =============================================================================
+// Replay Window
+// =============================================================================
+
+/**
+ * @brief Anti-replay window over 64-bit sequence numbers
+ *
+ * Like SeqWindow, but a sequence number far behind the window is always
+ * rejected rather than taken as a restart.
+ */
+class ReplayWindow {
+public:
+    static constexpr uint64_t WINDOW = 64;
+
+    /**
+     * @return true the first time @p seq is seen within the window
+     */
+    bool accept(uint64_t seq) {
+        if (!_active) {
+            _active = true;
+            _top = seq;
+            _bits = 1;
+            return true;
+        }
+        if (seq > _top) {
+            uint64_t ahead = seq - _top;
+            _bits = ahead >= WINDOW ? 0 : _bits << ahead;
+            _bits |= 1;
+            _top = seq;
+            return true;
+        }
+        uint64_t behind = _top - seq;
+        if (behind >= WINDOW) return false;
+        uint64_t bit = 1ull << behind;
+        if (_bits & bit) return false;
+        _bits |= bit;
+        return true;
+    }
+
+    /**
+     * @brief Forget the window (accepts the next sequence number, whatever it is)
+     */
+    void reset() { _active = false; }
+
+private:
+    bool _active = false;
+    uint64_t _top = 0;
+    uint64_t _bits = 0;
+};
+
+enum class ReplayResult : uint8_t {
+    ACCEPTED,
+    REPLAYED,        ///< Seen before, behind the window or at or below the checkpoint
+    TOO_MANY_SENDERS ///< The sender table is full
+};
+
+/**
+ * @brief One topic's replay windows, one per sender, with checkpoints
+ *
+ * A sender's checkpoint is its highest sequence number, recorded on first
+ * contact and then every CHECKPOINT_INTERVAL sequence numbers. restore()
+ * turns saved checkpoints into floors: nothing at or below them is taken
+ * again. A full table takes a new sender only in place of a restored one
+ * that has not been heard from.
+ */
+class ReplayGuard {
+public:
+    static constexpr size_t MAX_SENDERS = 4;
+    static constexpr uint64_t CHECKPOINT_INTERVAL = 1ull << 16;
+    static constexpr size_t ENTRY_SIZE = sizeof(uint32_t) + sizeof(uint64_t);
+    static constexpr size_t BLOB_SIZE = 8 + MAX_SENDERS * ENTRY_SIZE;
+
+    ReplayResult accept(uint32_t sender, uint64_t seq) {
+        Entry* entry = _find(sender);
+        if (!entry) entry = _claim(sender);
+        if (!entry) return ReplayResult::TOO_MANY_SENDERS;
+        if (entry->hasFloor && seq <= entry->floor) return ReplayResult::REPLAYED;
+        if (!entry->window.accept(seq)) return ReplayResult::REPLAYED;
+
+        entry->heard = true;
+        if (!entry->hasCheckpoint || (seq > entry->checkpoint && seq - entry->checkpoint >= CHECKPOINT_INTERVAL)) {
+            entry->checkpoint = seq;
+            entry->hasCheckpoint = true;
+            _checkpointDue = true;
+        }
+        return ReplayResult::ACCEPTED;
+    }
+
+    /**
+     * @brief Forget every sender, floors included
+     */
+    void reset() {
+        _count = 0;
+        _checkpointDue = false;
+    }
+
+    size_t size() const { return _count; }
+
+    /**
+     * @brief Whether a checkpoint moved since the last call to checkpoint()
+     */
+    bool checkpointDue() const { return _checkpointDue; }
+
+    /**
+     * @brief Write "CPYR", version, count, then (u32 sender, u64 checkpoint)
+     *        pairs, and clear checkpointDue()
+     * @return Bytes written (at most BLOB_SIZE), 0 if @p capacity is too small
+     */
+    size_t checkpoint(uint8_t* out, size_t capacity) {
+        if (capacity < BLOB_SIZE) return 0;
+        size_t count = 0;
+        for (size_t i = 0; i < _count; i++) {
+            if (!_entries[i].hasCheckpoint) continue;
+            uint8_t* p = out + 8 + count++ * ENTRY_SIZE;
+            memcpy(p, &_entries[i].sender, sizeof(uint32_t));
+            memcpy(p + sizeof(uint32_t), &_entries[i].checkpoint, sizeof(uint64_t));
+        }
+        memcpy(out, "CPYR", 4);
+        out[4] = 1;
+        out[5] = static_cast<uint8_t>(count);
+        out[6] = out[7] = 0;
+        _checkpointDue = false;
+        return 8 + count * ENTRY_SIZE;
+    }
+
+    /**
+     * @brief Take saved checkpoints as floors (forgetting every sender first)
+     * @return false (leaving the guard empty) if @p data is not a valid blob
+     */
+    bool restore(const uint8_t* data, size_t len) {
+        reset();
+        if (len < 8 || memcmp(data, "CPYR", 4) != 0 || data[4] != 1) return false;
+        size_t count = data[5];
+        if (count > MAX_SENDERS || len < 8 + count * ENTRY_SIZE) return false;
+        for (size_t i = 0; i < count; i++) {
+            Entry& entry = _entries[_count++];
+            entry = Entry();
+            memcpy(&entry.sender, data + 8 + i * ENTRY_SIZE, sizeof(uint32_t));
+            memcpy(&entry.floor, data + 8 + i * ENTRY_SIZE + sizeof(uint32_t), sizeof(uint64_t));
+            entry.hasFloor = true;
+            entry.checkpoint = entry.floor;
+            entry.hasCheckpoint = true;
+        }
+        return true;
+    }
+
+private:
+    struct Entry {
+        uint32_t sender = 0;
+        bool heard = false;          // Accepted a datagram since restore()
+        bool hasFloor = false;
+        bool hasCheckpoint = false;
+        uint64_t floor = 0;          // Restored checkpoint
+        uint64_t checkpoint = 0;
+        ReplayWindow window;
+    };
+
+    Entry* _find(uint32_t sender) {
+        for (size_t i = 0; i < _count; i++) {
+            if (_entries[i].sender == sender) return &_entries[i];
+        }
+        return nullptr;
+    }
+
+    Entry* _claim(uint32_t sender) {
+        Entry* entry = nullptr;
+        if (_count < MAX_SENDERS) {
+            entry = &_entries[_count++];
+        } else {
+            for (size_t i = 0; i < _count && !entry; i++) {
+                if (!_entries[i].heard) entry = &_entries[i];
+            }
+            if (!entry) return nullptr;
+        }
+        *entry = Entry();
+        entry->sender = sender;
+        return entry;
+    }
+
+    Entry _entries[MAX_SENDERS];
+    size_t _count = 0;
+    bool _checkpointDue = false;
+};
+
+#ifdef ESP32
+/**
+ * @brief First sequence number for this boot: a boot counter kept in NVS,
+ *        shifted into the upper 32 bits
+ *
+ * Call once per boot and share the value between publishers (each sender
+ * has its own window).
+ *
+ * @return false (with @p seq set to 0) if NVS could not be read or
+ *         written; sequence numbers would then repeat across reboots
+ */
+inline bool authBootSequence(uint64_t& seq) {
+    seq = 0;
+    Preferences prefs;
+    if (!prefs.begin("cpy_auth", false)) {
+        Serial.println("[Auth] Cannot open NVS for the boot counter");
+        return false;
+    }
+    uint32_t boots = prefs.getUInt("boots", 0) + 1;
+    bool saved = prefs.putUInt("boots", boots) == sizeof(boots);
+    prefs.end();
+    if (!saved) {
+        Serial.println("[Auth] Cannot store the boot counter in NVS");
+        return false;
+    }
+    seq = static_cast<uint64_t>(boots) << 32;
+    return true;
+}
+
+/**
+ * @brief NVS key of @p topic's replay checkpoints (namespace "cpy_auth")
+ */
+inline void authReplayKey(const char* topic, char (&key)[12]) {
+    uint64_t hash = sipHash24(0, 0, reinterpret_cast<const uint8_t*>(topic), strlen(topic));
+    snprintf(key, sizeof(key), "r%08x", static_cast<unsigned>(hash));
+}
+
+/**
+ * @brief Restore @p topic's checkpoints from NVS (false if none are stored)
+ */
+inline bool loadReplayCheckpoints(const char* topic, ReplayGuard& guard) {
+    char key[12];
+    authReplayKey(topic, key);
+    uint8_t blob[ReplayGuard::BLOB_SIZE];
+    Preferences prefs;
+    if (!prefs.begin("cpy_auth", true)) return false;
+    size_t len = prefs.isKey(key) ? prefs.getBytes(key, blob, sizeof(blob)) : 0;
+    prefs.end();
+    return len > 0 && guard.restore(blob, len);
+}
+
+/**
+ * @brief Store @p topic's checkpoints in NVS
+ */
+inline bool saveReplayCheckpoints(const char* topic, ReplayGuard& guard) {
+    char key[12];
+    authReplayKey(topic, key);
+    uint8_t blob[ReplayGuard::BLOB_SIZE];
+    size_t len = guard.checkpoint(blob, sizeof(blob));
+    Preferences prefs;
+    if (!prefs.begin("cpy_auth", false)) return false;
+    bool ok = prefs.putBytes(key, blob, len) == len;
+    prefs.end();
+    return ok;
+}
+
+/**
+ * @brief Default sender ID: the factory MAC address, folded to 32 bits
+ */
+inline uint32_t authSenderId() {
+    uint64_t mac = ESP.getEfuseMac();
+    return static_cast<uint32_t>(mac ^ (mac >> 32));
+}
+#elif defined(ESP8266)
+/**
+ * @brief Default sender ID: the station MAC address, folded to 32 bits
+ */
+inline uint32_t authSenderId() {
+    uint8_t bytes[6];
+    WiFi.macAddress(bytes);
+    uint64_t mac = 0;
+    for (int i = 5; i >= 0; i--) mac = (mac << 8) | bytes[i];  // Same order as getEfuseMac()
+    return static_cast<uint32_t>(mac ^ (mac >> 32));
+}
+#else
+/**
+ * @brief Default sender ID: always 0, as there is no MAC address to derive
+ *        one from
+ *
+ * Every authenticating publisher of a topic on such a host needs its own
+ * sender ID, passed to setAuth() explicitly.
+ */
+inline uint32_t authSenderId() { return 0; }
+#endif
+
+} // namespace cpy
+
+#endif // CAPYBARISH_AUTH_H
@@ -0,0 +1,114 @@
+/**
+ * @file capybarish_clock.h
+ * @brief Pluggable time source for timers, rates and pub/sub bookkeeping
+ *
+ * Everything in the pub/sub layer that reads or waits on time goes through
+ * nowUs()/nowMs()/sleepUs(). By default these are micros()/millis()/delay().
+ * Installing a Clock with setClock() replaces them process-wide, e.g. a
+ * VirtualClock that only moves when a simulation advances it (see
+ * capybarish_sim.h), so timing tests run faster than real time and give the
+ * same result every run.
+ *
+ * @author Chen Yu <chenyu@u.northwestern.edu>
+ * @copyright 2025 Chen Yu
+ * @license Apache-2.0
+ */
+
+#pragma once
+
+#ifndef CAPYBARISH_CLOCK_H
+#define CAPYBARISH_CLOCK_H
+
+#include "Arduino.h"
+
+#include <cstdint>
+
+namespace cpy {
+
+/**
+ * @brief Source of microsecond time
+ */
+class Clock {
+public:
+    virtual ~Clock() = default;
+
+    /**
+     * @brief Microseconds since an arbitrary epoch (wraps like micros())
+     */
+    virtual uint32_t nowUs() = 0;
+
+    /**
+     * @brief Block the caller for @p us (a virtual clock advances instead)
+     */
+    virtual void sleepUs(uint32_t us) = 0;
+};
+
+/**
+ * @brief Clock whose time is set explicitly
+ *
+ * Holds 64-bit time so a long simulation does not wrap; nowUs() truncates
+ * to 32 bits like micros().
+ */
+class VirtualClock : public Clock {
+public:
+    explicit VirtualClock(uint64_t startUs = 0) : _now(startUs) {}
+
+    uint32_t nowUs() override { return static_cast<uint32_t>(_now); }
+    void sleepUs(uint32_t us) override { _now += us; }
+
+    uint64_t now64() const { return _now; }
+    void advance(uint64_t us) { _now += us; }
+
+    /**
+     * @brief Move to @p us; time never goes backwards
+     */
+    void advanceTo(uint64_t us) {
+        if (us > _now) _now = us;
+    }
+
+private:
+    uint64_t _now;
+};
+
+/**
+ * @brief Installed clock (nullptr = hardware timers)
+ */
+inline Clock*& activeClock() {
+    static Clock* clock = nullptr;
+    return clock;
+}
+
+/**
+ * @brief Route all pub/sub timing through @p clock (nullptr = hardware)
+ *
+ * Set it before creating nodes; timers and budgets keep timestamps from
+ * the clock they were started on.
+ */
+inline void setClock(Clock* clock) { activeClock() = clock; }
+
+inline uint32_t nowUs() {
+    Clock* clock = activeClock();
+    return clock ? clock->nowUs() : static_cast<uint32_t>(micros());
+}
+
+inline uint32_t nowMs() {
+    Clock* clock = activeClock();
+    return clock ? clock->nowUs() / 1000 : static_cast<uint32_t>(millis());
+}
+
+/**
+ * @brief Sleep @p us: delay() for whole milliseconds, then
+ *        delayMicroseconds() for the rest
+ */
+inline void sleepUs(uint32_t us) {
+    if (Clock* clock = activeClock()) {
+        clock->sleepUs(us);
+        return;
+    }
+    if (us >= 1000) delay(us / 1000);
+    if (us % 1000) delayMicroseconds(us % 1000);
+}
+
+} // namespace cpy
+
+#endif // CAPYBARISH_CLOCK_H
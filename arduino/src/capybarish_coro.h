@@ -0,0 +1,184 @@
+/**
+ * @file capybarish_coro.h
+ * @brief C++20 coroutines for sequential logic on a Node
+ *
+ * Multi-step sequences (send calibrate, wait for the mode change, time out
+ * after 2 s, ...) read as straight-line code instead of a state machine
+ * spread over callbacks:
+ *
+ * - co_await sub.next(timeoutUs)  next message of a polling subscription
+ * - co_await timer.tick()         next firing of a node's timer
+ * - co_await node.sleepFor(us)    delay
+ * - co_await client.call(req, us) response of a service call
+ *
+ * A cpy::Task starts running when called and is resumed from
+ * Node::spinOnce()/spinUntil() on the thread that spins the node, so no
+ * locking is needed. An Executor does not resume them: it refuses a node
+ * with waiting coroutines, and a co_await on a node it runs returns at
+ * once as timed out. Coroutine frames come from a fixed pool, never the
+ * heap; if the pool is exhausted or a frame is larger than a block, the
+ * task does not start and is !valid(). Raise the block size with
+ * cpy::BasicTask<FrameSize, Frames> (the log line names the size needed).
+ *
+ * Requires coroutine support in the compiler (GCC 11+ in C++20 mode).
+ *
+ * @example
+ * @code
+ * cpy::Task calibrate(cpy::Node& node, cpy::Publisher<MotorCommand>* cmd,
+ *                     cpy::Subscription<SensorData>* fb) {
+ *     MotorCommand c{};
+ *     c.calibrate = 1;
+ *     cmd->publish(c);
+ *
+ *     while (true) {
+ *         auto data = co_await fb->next(2000000);
+ *         if (!data) { Serial.println("Calibration timed out"); co_return; }
+ *         if (data->motor.motor_mode == 2) break;
+ *     }
+ *     co_await node.sleepFor(100000);  // Settle
+ *     Serial.println("Calibrated");
+ * }
+ *
+ * void setup() {
+ *     auto* fb = node.createSubscription<SensorData>("/motor/feedback", 6667);  // No callback
+ *     calibrate(node, cmdPub, fb);
+ * }
+ *
+ * void loop() { node.spinFor(5000); }
+ * @endcode
+ *
+ * @author Chen Yu <chenyu@u.northwestern.edu>
+ * @copyright 2025 Chen Yu
+ * @license Apache-2.0
+ */
+
+#pragma once
+
+#ifndef CAPYBARISH_CORO_H
+#define CAPYBARISH_CORO_H
+
+#include "capybarish_pubsub.h"
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+
+namespace cpy {
+
+// =============================================================================
+// Frame Pool
+// =============================================================================
+
+/**
+ * @brief Fixed pool of coroutine frames, one per template instantiation
+ *
+ * Blocks are claimed and released with a CAS on a 32-bit occupancy mask,
+ * so allocation is lock-free and O(1) in the number of blocks.
+ */
+template<size_t FRAME_SIZE, size_t FRAMES>
+class FramePool {
+public:
+    static_assert(FRAMES >= 1 && FRAMES <= 32, "FramePool holds 1 to 32 frames");
+    static_assert(FRAME_SIZE % alignof(std::max_align_t) == 0,
+                  "FRAME_SIZE must be a multiple of the maximum alignment");
+
+    /**
+     * @return nullptr if @p size exceeds a block or every block is in use
+     */
+    static void* allocate(size_t size) noexcept {
+        if (size > _largest.load(std::memory_order_relaxed)) {
+            _largest.store(size, std::memory_order_relaxed);
+        }
+        if (size > FRAME_SIZE) return nullptr;
+
+        uint32_t used = _used.load(std::memory_order_relaxed);
+        while (true) {
+            uint32_t free = ~used & ALL;
+            if (free == 0) return nullptr;
+            uint32_t bit = free & (~free + 1);  // Lowest free block
+            if (_used.compare_exchange_weak(used, used | bit, std::memory_order_acquire,
+                                            std::memory_order_relaxed)) {
+                return _blocks[__builtin_ctz(bit)];
+            }
+        }
+    }
+
+    static void release(void* frame) noexcept {
+        size_t index = (static_cast<uint8_t*>(frame) - &_blocks[0][0]) / FRAME_SIZE;
+        _used.fetch_and(~(1u << index), std::memory_order_release);
+    }
+
+    static size_t inUse() { return __builtin_popcount(_used.load(std::memory_order_relaxed)); }
+
+    /**
+     * @brief Largest frame requested so far, to size FRAME_SIZE
+     */
+    static size_t largestRequest() { return _largest.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint32_t ALL = FRAMES == 32 ? 0xFFFFFFFFu : (1u << FRAMES) - 1;
+
+    alignas(std::max_align_t) static inline uint8_t _blocks[FRAMES][FRAME_SIZE];
+    static inline std::atomic<uint32_t> _used{0};
+    static inline std::atomic<size_t> _largest{0};
+};
+
+// =============================================================================
+// Task
+// =============================================================================
+
+/**
+ * @brief Fire-and-forget coroutine whose frame lives in a FramePool
+ *
+ * Runs eagerly up to its first co_await and frees its frame when it
+ * returns. The Task object only reports whether it started.
+ *
+ * @tparam FRAME_SIZE Bytes per frame (locals that live across co_await,
+ *         plus awaiters and compiler bookkeeping)
+ * @tparam FRAMES Coroutines of this type alive at once
+ */
+template<size_t FRAME_SIZE = 1024, size_t FRAMES = 4>
+class BasicTask {
+public:
+    using Pool = FramePool<FRAME_SIZE, FRAMES>;
+
+    struct promise_type {
+        static void* operator new(size_t size) noexcept {
+            void* frame = Pool::allocate(size);
+            if (!frame) {
+                Serial.printf("[Task] No frame for %u bytes (%u of %u blocks of %u in use)\n",
+                              static_cast<unsigned>(size), static_cast<unsigned>(Pool::inUse()),
+                              static_cast<unsigned>(FRAMES), static_cast<unsigned>(FRAME_SIZE));
+            }
+            return frame;
+        }
+
+        static void operator delete(void* frame) noexcept { Pool::release(frame); }
+
+        static BasicTask get_return_object_on_allocation_failure() { return BasicTask(false); }
+        BasicTask get_return_object() { return BasicTask(true); }
+
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    /**
+     * @brief Whether the coroutine got a frame and started
+     */
+    bool valid() const { return _started; }
+    explicit operator bool() const { return _started; }
+
+private:
+    explicit BasicTask(bool started) : _started(started) {}
+
+    bool _started;
+};
+
+using Task = BasicTask<>;
+
+} // namespace cpy
+
+#endif // CAPYBARISH_CORO_H
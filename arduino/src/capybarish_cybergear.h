@@ -0,0 +1,358 @@
+/**
+ * @file capybarish_cybergear.h
+ * @brief Xiaomi CyberGear CAN protocol codec
+ *
+ * Packs and parses CyberGear frames (CAN 2.0B, 29-bit extended ID, 1 Mbit/s)
+ * so firmware and host tools share one implementation. The codec only turns
+ * values into CanFrame structs and back; sending them is up to a backend
+ * (ESP32 TWAI, capybarish_socketcan.h on Linux, ...).
+ *
+ * Extended ID layout:
+ *
+ *     bits 28..24  communication type
+ *     bits 23..8   data area 2 (torque, host ID, status, ...)
+ *     bits  7..0   destination ID
+ *
+ * Motion (MIT mode) values are linear 16-bit fixed point, big endian;
+ * parameters are little endian. Feedback is parsed straight into the
+ * generated MotorData struct (pos, vel, torque, temperature, motor_error,
+ * motor_mode; voltage/current from parameter reads; driver_error from
+ * fault frames), using the same bit layout as capybarish.devices.cybergear.
+ *
+ * @example
+ * @code
+ * namespace cg = cpy::cybergear;
+ *
+ * // One control tick for four motors, sent as one batch
+ * cg::MotionCommand cmds[4];
+ * const uint8_t ids[4] = {1, 2, 3, 4};
+ * cpy::CanFrame frames[4];
+ * cg::encodeMotionBatch(ids, cmds, 4, frames);
+ *
+ * // Feedback from motor N lands in motors[N - 1]
+ * MotorData motors[4];
+ * uint8_t src = cg::sourceId(rx);
+ * if (src >= 1 && src <= 4) cg::applyFeedback(rx, motors[src - 1]);
+ * @endcode
+ *
+ * @author Chen Yu <chenyu@u.northwestern.edu>
+ * @copyright 2025 Chen Yu
+ * @license Apache-2.0
+ */
+
+#pragma once
+
+#ifndef CAPYBARISH_CYBERGEAR_H
+#define CAPYBARISH_CYBERGEAR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace cpy {
+
+/**
+ * @brief Classic CAN frame (extended IDs only, as CyberGear uses)
+ */
+struct CanFrame {
+    uint32_t id = 0;       ///< 29-bit extended identifier
+    uint8_t len = 8;       ///< Data length code (0-8)
+    uint8_t data[8] = {};
+};
+
+namespace cybergear {
+
+// =============================================================================
+// Protocol Constants
+// =============================================================================
+
+/**
+ * @brief Communication types (ID bits 28..24)
+ */
+enum FrameType : uint8_t {
+    TYPE_GET_ID      = 0,
+    TYPE_MOTION      = 1,   ///< MIT-mode command (host -> motor)
+    TYPE_FEEDBACK    = 2,   ///< Motor state (motor -> host)
+    TYPE_ENABLE      = 3,
+    TYPE_STOP        = 4,
+    TYPE_SET_ZERO    = 6,
+    TYPE_SET_CAN_ID  = 7,
+    TYPE_PARAM_READ  = 17,
+    TYPE_PARAM_WRITE = 18,
+    TYPE_FAULT       = 21   ///< Fault/warning report (motor -> host)
+};
+
+/**
+ * @brief Parameter indices for TYPE_PARAM_READ / TYPE_PARAM_WRITE
+ */
+enum Param : uint16_t {
+    PARAM_RUN_MODE     = 0x7005,  ///< uint8: RunMode
+    PARAM_IQ_REF       = 0x7006,  ///< Current mode Iq command (A)
+    PARAM_SPD_REF      = 0x700A,  ///< Speed mode command (rad/s)
+    PARAM_LIMIT_TORQUE = 0x700B,  ///< Torque limit (Nm)
+    PARAM_CUR_KP       = 0x7010,
+    PARAM_CUR_KI       = 0x7011,
+    PARAM_CUR_FILT     = 0x7014,
+    PARAM_LOC_REF      = 0x7016,  ///< Position mode command (rad)
+    PARAM_LIMIT_SPD    = 0x7017,  ///< Position mode speed limit (rad/s)
+    PARAM_LIMIT_CUR    = 0x7018,  ///< Speed/position mode current limit (A)
+    PARAM_MECH_POS     = 0x7019,  ///< Load-side position (rad, read only)
+    PARAM_IQF          = 0x701A,  ///< Filtered Iq (A, read only)
+    PARAM_MECH_VEL     = 0x701B,  ///< Load-side speed (rad/s, read only)
+    PARAM_VBUS         = 0x701C,  ///< Bus voltage (V, read only)
+    PARAM_LOC_KP       = 0x701E,
+    PARAM_SPD_KP       = 0x701F,
+    PARAM_SPD_KI       = 0x7020
+};
+
+/**
+ * @brief Values of PARAM_RUN_MODE
+ */
+enum RunMode : uint8_t {
+    MODE_MOTION   = 0,  ///< MIT mode (TYPE_MOTION frames)
+    MODE_POSITION = 1,
+    MODE_SPEED    = 2,
+    MODE_CURRENT  = 3
+};
+
+constexpr uint8_t DEFAULT_HOST_ID = 0xFD;
+
+constexpr float P_MIN = -12.566371f;  // -4 pi
+constexpr float P_MAX = 12.566371f;
+constexpr float V_MIN = -30.0f;
+constexpr float V_MAX = 30.0f;
+constexpr float T_MIN = -12.0f;
+constexpr float T_MAX = 12.0f;
+constexpr float KP_MAX = 500.0f;
+constexpr float KD_MAX = 5.0f;
+
+// =============================================================================
+// Fixed Point Helpers
+// =============================================================================
+
+/**
+ * @brief Map [lo, hi] onto 0..65535 (clamped)
+ */
+inline uint16_t toUint16(float x, float lo, float hi) {
+    const float scaled = (x - lo) * (65535.0f / (hi - lo));
+    if (!(scaled > 0.0f)) return 0;  // Also catches NaN
+    if (scaled >= 65535.0f) return 65535;
+    return static_cast<uint16_t>(scaled + 0.5f);
+}
+
+/**
+ * @brief Map 0..65535 back onto [lo, hi]
+ */
+inline float fromUint16(uint16_t v, float lo, float hi) {
+    return lo + static_cast<float>(v) * ((hi - lo) / 65535.0f);
+}
+
+inline void putBE16(uint8_t* p, uint16_t v) {
+    p[0] = v >> 8;
+    p[1] = v & 0xFF;
+}
+
+inline uint16_t getBE16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+constexpr uint32_t makeId(uint8_t type, uint16_t area2, uint8_t target) {
+    return (static_cast<uint32_t>(type & 0x1F) << 24) |
+           (static_cast<uint32_t>(area2) << 8) | target;
+}
+
+constexpr uint8_t frameType(const CanFrame& f) { return (f.id >> 24) & 0x1F; }
+
+// =============================================================================
+// Encoding (host -> motor)
+// =============================================================================
+
+/**
+ * @brief MIT-mode setpoint: tau = kp (pos - q) + kd (vel - dq) + torque
+ */
+struct MotionCommand {
+    float pos = 0.0f;     ///< rad, [-4pi, 4pi]
+    float vel = 0.0f;     ///< rad/s, [-30, 30]
+    float kp = 0.0f;      ///< [0, 500]
+    float kd = 0.0f;      ///< [0, 5]
+    float torque = 0.0f;  ///< Feed-forward Nm, [-12, 12]
+};
+
+inline void encodeMotion(uint8_t motorId, const MotionCommand& cmd, CanFrame& out) {
+    out.id = makeId(TYPE_MOTION, toUint16(cmd.torque, T_MIN, T_MAX), motorId);
+    out.len = 8;
+    putBE16(out.data + 0, toUint16(cmd.pos, P_MIN, P_MAX));
+    putBE16(out.data + 2, toUint16(cmd.vel, V_MIN, V_MAX));
+    putBE16(out.data + 4, toUint16(cmd.kp, 0.0f, KP_MAX));
+    putBE16(out.data + 6, toUint16(cmd.kd, 0.0f, KD_MAX));
+}
+
+/**
+ * @brief Encode one MIT-mode frame per motor
+ *
+ * @param motorIds CAN IDs of the motors
+ * @param cmds Setpoint for each motor
+ * @param n Number of motors
+ * @param out Output frames (n entries), ready for one batched send
+ * @return n
+ */
+inline size_t encodeMotionBatch(const uint8_t* motorIds, const MotionCommand* cmds, size_t n,
+                                CanFrame* out) {
+    for (size_t i = 0; i < n; i++) {
+        encodeMotion(motorIds[i], cmds[i], out[i]);
+    }
+    return n;
+}
+
+/**
+ * @brief Frame with an empty (zeroed) 8-byte payload
+ */
+inline void encodeCommand(uint8_t type, uint8_t motorId, uint8_t hostId, CanFrame& out) {
+    out.id = makeId(type, hostId, motorId);
+    out.len = 8;
+    memset(out.data, 0, sizeof(out.data));
+}
+
+inline void encodeEnable(uint8_t motorId, CanFrame& out, uint8_t hostId = DEFAULT_HOST_ID) {
+    encodeCommand(TYPE_ENABLE, motorId, hostId, out);
+}
+
+inline void encodeStop(uint8_t motorId, CanFrame& out, bool clearFault = false,
+                       uint8_t hostId = DEFAULT_HOST_ID) {
+    encodeCommand(TYPE_STOP, motorId, hostId, out);
+    out.data[0] = clearFault ? 1 : 0;
+}
+
+inline void encodeSetZero(uint8_t motorId, CanFrame& out, uint8_t hostId = DEFAULT_HOST_ID) {
+    encodeCommand(TYPE_SET_ZERO, motorId, hostId, out);
+    out.data[0] = 1;
+}
+
+inline void encodeSetCanId(uint8_t motorId, uint8_t newId, CanFrame& out,
+                           uint8_t hostId = DEFAULT_HOST_ID) {
+    encodeCommand(TYPE_SET_CAN_ID, motorId, static_cast<uint16_t>(newId << 8 | hostId), out);
+}
+
+inline void encodeParamRead(uint8_t motorId, uint16_t index, CanFrame& out,
+                            uint8_t hostId = DEFAULT_HOST_ID) {
+    encodeCommand(TYPE_PARAM_READ, motorId, hostId, out);
+    out.data[0] = index & 0xFF;
+    out.data[1] = index >> 8;
+}
+
+inline void encodeParamWrite(uint8_t motorId, uint16_t index, float value, CanFrame& out,
+                             uint8_t hostId = DEFAULT_HOST_ID) {
+    encodeParamRead(motorId, index, out, hostId);
+    out.id = makeId(TYPE_PARAM_WRITE, hostId, motorId);
+    memcpy(out.data + 4, &value, 4);  // Little endian on every supported target
+}
+
+inline void encodeRunMode(uint8_t motorId, RunMode mode, CanFrame& out,
+                          uint8_t hostId = DEFAULT_HOST_ID) {
+    encodeParamRead(motorId, PARAM_RUN_MODE, out, hostId);
+    out.id = makeId(TYPE_PARAM_WRITE, hostId, motorId);
+    out.data[4] = mode;
+}
+
+// =============================================================================
+// Decoding (motor -> host)
+// =============================================================================
+
+/**
+ * @brief Decoded TYPE_FEEDBACK frame
+ */
+struct Feedback {
+    uint8_t motorId = 0;
+    uint8_t faults = 0;   ///< Bits: UV, OC, OT, magnetic encoder, HALL, uncalibrated
+    uint8_t mode = 0;     ///< 0 reset, 1 calibration, 2 running
+    float pos = 0.0f;
+    float vel = 0.0f;
+    float torque = 0.0f;
+    float temperature = 0.0f;  ///< Celsius
+};
+
+inline bool parseFeedback(const CanFrame& f, Feedback& fb) {
+    if (frameType(f) != TYPE_FEEDBACK || f.len < 8) return false;
+    fb.motorId = (f.id >> 8) & 0xFF;
+    fb.faults = (f.id >> 16) & 0x3F;
+    fb.mode = (f.id >> 22) & 0x03;
+    fb.pos = fromUint16(getBE16(f.data + 0), P_MIN, P_MAX);
+    fb.vel = fromUint16(getBE16(f.data + 2), V_MIN, V_MAX);
+    fb.torque = fromUint16(getBE16(f.data + 4), T_MIN, T_MAX);
+    fb.temperature = getBE16(f.data + 6) * 0.1f;
+    return true;
+}
+
+/**
+ * @brief Motor that sent a feedback, parameter or fault frame
+ */
+inline uint8_t sourceId(const CanFrame& f) {
+    return (f.id >> 8) & 0xFF;
+}
+
+/**
+ * @brief Decode a TYPE_PARAM_READ response
+ */
+inline bool parseParam(const CanFrame& f, uint16_t& index, float& value) {
+    if (frameType(f) != TYPE_PARAM_READ || f.len < 8) return false;
+    index = static_cast<uint16_t>(f.data[0] | (f.data[1] << 8));
+    memcpy(&value, f.data + 4, 4);
+    return true;
+}
+
+/**
+ * @brief Update a MotorData-like struct from any motor -> host frame
+ *
+ * Feedback frames set pos/large_pos/vel/torque/temperature/motor_error/
+ * motor_mode; PARAM_VBUS and PARAM_IQF responses set voltage/current; fault
+ * frames set driver_error (fault bits, temperature warning in bit 24).
+ *
+ * @tparam MotorDataT Generated MotorData (or any struct with those fields)
+ * @return true if the frame changed @p m
+ */
+template<typename MotorDataT>
+bool applyFeedback(const CanFrame& f, MotorDataT& m) {
+    switch (frameType(f)) {
+        case TYPE_FEEDBACK: {
+            Feedback fb;
+            if (!parseFeedback(f, fb)) return false;
+            m.pos = fb.pos;
+            m.large_pos = fb.pos;
+            m.vel = fb.vel;
+            m.torque = fb.torque;
+            m.temperature = static_cast<int32_t>(fb.temperature);
+            m.motor_error = fb.faults;
+            m.motor_mode = fb.mode;
+            return true;
+        }
+        case TYPE_PARAM_READ: {
+            uint16_t index;
+            float value;
+            if (!parseParam(f, index, value)) return false;
+            if (index == PARAM_VBUS) {
+                m.voltage = value;
+            } else if (index == PARAM_IQF) {
+                m.current = value;
+            } else {
+                return false;
+            }
+            return true;
+        }
+        case TYPE_FAULT: {
+            if (f.len < 8) return false;
+            uint32_t faults;
+            uint32_t warnings;
+            memcpy(&faults, f.data, 4);
+            memcpy(&warnings, f.data + 4, 4);
+            m.driver_error = static_cast<int32_t>((faults & 0x00FFFFFF) | ((warnings & 1) << 24));
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+} // namespace cybergear
+} // namespace cpy
+
+#endif // CAPYBARISH_CYBERGEAR_H
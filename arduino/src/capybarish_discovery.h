@@ -0,0 +1,563 @@
+/**
+ * @file capybarish_discovery.h
+ * @brief Zero-configuration peer discovery with a persistent peer cache
+ *
+ * Sketches no longer need a hard-coded server IP. A Discovery attached to
+ * a Node periodically announces the node's topics on a multicast group
+ * (in the spirit of DDS's SPDP): for each topic the name, role, port,
+ * message size and a layout fingerprint (messageFingerprint<T>()).
+ *
+ * - A node that boots sends its announcement with a reply request; every
+ *   peer answers with its own announcement straight away, so both sides
+ *   know each other after one round trip.
+ * - A publisher created with an empty remote IP is pointed at a peer
+ *   that subscribes to its topic, provided the fingerprints agree (0 on
+ *   either side means "unknown" and is accepted).
+ * - Each such topic has a single target. The first subscriber heard keeps
+ *   it while it goes on announcing; another subscriber takes over only
+ *   once the target has been silent for STALE_PERIODS announce periods.
+ *   A new port at the target's address is followed straight away.
+ * - Targets are cached in a PeerStore (NVS on the ESP32, a file on Linux),
+ *   written only when a target changes. On the next boot publishers start
+ *   sending to the cached targets before any reply arrives.
+ *
+ * capybarish.discovery speaks the same protocol on the Python side, with the
+ * same single-target rule; its fan_out option, for a host that sends to
+ * every module, has no C++ counterpart.
+ *
+ * Wire format (little-endian): a 52-byte DiscoveryHeader followed by
+ * topicCount 44-byte DiscoveryTopic entries.
+ *
+ * @example
+ * @code
+ * cpy::Node node("motor_module");
+ * cpy::NvsPeerStore peers;
+ * cpy::Discovery discovery(node, {}, &peers);
+ *
+ * void setup() {
+ *     node.initWiFi(WIFI_SSID, WIFI_PASSWORD);
+ *     node.createSubscription<MotorCommand>("/motor/command", onCommand, 6666);
+ *     feedbackPub = node.createPublisher<SensorData>("/motor/feedback", "", 0);  // Discovered
+ *     discovery.begin();  // After the topics exist
+ * }
+ *
+ * void loop() { node.spinFor(5000); }
+ * @endcode
+ *
+ * @author Chen Yu <chenyu@u.northwestern.edu>
+ * @copyright 2025 Chen Yu
+ * @license Apache-2.0
+ */
+
+#pragma once
+
+#ifndef CAPYBARISH_DISCOVERY_H
+#define CAPYBARISH_DISCOVERY_H
+
+#include "capybarish_pubsub.h"
+
+#ifdef ESP32
+    #include <Preferences.h>
+#endif
+
+#include <cstdio>
+
+namespace cpy {
+
+// =============================================================================
+// Wire Format
+// =============================================================================
+
+constexpr uint8_t DISCOVERY_VERSION = 1;
+constexpr uint8_t DISCOVERY_REPLY_REQUESTED = 0x01;  ///< Receivers announce back now
+
+constexpr uint8_t DISCOVERY_PUBLISHER = 1;
+constexpr uint8_t DISCOVERY_SUBSCRIBER = 2;
+
+#pragma pack(push, 1)
+struct DiscoveryHeader {
+    char magic[4];         ///< "CPYD"
+    uint8_t version;
+    uint8_t flags;
+    uint8_t topicCount;
+    uint8_t reserved;
+    uint32_t nodeId;       ///< Tells a node its own looped-back announcements
+    char node[24];         ///< Node name (NUL-padded)
+    char address[16];      ///< Sender's IPv4 address, dotted
+};
+
+struct DiscoveryTopic {
+    char topic[32];        ///< Topic name (NUL-padded, truncated)
+    uint32_t fingerprint;  ///< messageFingerprint<T>(), 0 = unknown
+    uint16_t port;         ///< Subscriber: port it listens on; publisher: port it sends to
+    uint16_t msgSize;
+    uint8_t role;          ///< DISCOVERY_PUBLISHER or DISCOVERY_SUBSCRIBER
+    uint8_t reserved[3];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(DiscoveryHeader) == 52, "DiscoveryHeader must be packed");
+static_assert(sizeof(DiscoveryTopic) == 44, "DiscoveryTopic must be packed");
+
+/**
+ * @brief Discovery settings
+ */
+struct DiscoveryConfig {
+    const char* group = "239.255.0.99";
+    uint16_t port = 7400;
+    float announcePeriodSec = 2.0f;
+    const char* address = nullptr;  ///< Advertised IPv4 (nullptr = WiFi.localIP(), WiFi boards only)
+};
+
+// =============================================================================
+// Peer Cache
+// =============================================================================
+
+/**
+ * @brief Where a topic's target subscriber was last seen
+ */
+struct PeerEndpoint {
+    char topic[32];
+    char address[16];
+    uint32_t fingerprint;
+    uint16_t port;
+    uint16_t reserved;
+};
+
+/**
+ * @brief Persistent storage for the serialized PeerCache
+ */
+class PeerStore {
+public:
+    virtual ~PeerStore() = default;
+
+    /**
+     * @return Bytes read into @p data (0 if nothing is stored)
+     */
+    virtual size_t load(uint8_t* data, size_t capacity) = 0;
+    virtual bool save(const uint8_t* data, size_t len) = 0;
+};
+
+/**
+ * @brief PeerStore in a file (Linux hosts, or SPIFFS/LittleFS paths)
+ *
+ * Writes a temporary file and renames it, so a crash mid-save leaves the
+ * previous cache intact.
+ */
+class FilePeerStore : public PeerStore {
+public:
+    explicit FilePeerStore(const char* path) : _path(path) {}
+
+    size_t load(uint8_t* data, size_t capacity) override {
+        FILE* f = fopen(_path, "rb");
+        if (!f) return 0;
+        size_t len = fread(data, 1, capacity, f);
+        fclose(f);
+        return len;
+    }
+
+    bool save(const uint8_t* data, size_t len) override {
+        char temp[160];
+        snprintf(temp, sizeof(temp), "%s.tmp", _path);
+        FILE* f = fopen(temp, "wb");
+        if (!f) return false;
+        bool ok = fwrite(data, 1, len, f) == len;
+        ok = fclose(f) == 0 && ok;
+        return ok && rename(temp, _path) == 0;
+    }
+
+private:
+    const char* _path;
+};
+
+#ifdef ESP32
+/**
+ * @brief PeerStore in NVS (one blob under namespace "cpy_peers")
+ */
+class NvsPeerStore : public PeerStore {
+public:
+    size_t load(uint8_t* data, size_t capacity) override {
+        Preferences prefs;
+        if (!prefs.begin("cpy_peers", true)) return 0;
+        size_t len = prefs.getBytes("peers", data, capacity);
+        prefs.end();
+        return len;
+    }
+
+    bool save(const uint8_t* data, size_t len) override {
+        Preferences prefs;
+        if (!prefs.begin("cpy_peers", false)) return false;
+        bool ok = prefs.putBytes("peers", data, len) == len;
+        prefs.end();
+        return ok;
+    }
+};
+#endif
+
+/**
+ * @brief Fixed table of publisher targets, one endpoint per topic
+ *
+ * Only topics of publishers awaiting discovery are kept, so the table
+ * cannot outgrow a node. If it is full anyway (topics of an earlier
+ * firmware), the endpoint updated least recently is replaced.
+ */
+class PeerCache {
+public:
+    static constexpr size_t MAX_ENDPOINTS = MAX_PUBLISHERS;
+    static constexpr size_t BLOB_SIZE = 8 + MAX_ENDPOINTS * sizeof(PeerEndpoint);
+
+    /**
+     * @brief Set or refresh the target of @p endpoint's topic
+     * @return true if the table changed (new topic, address, port or fingerprint)
+     */
+    bool update(const PeerEndpoint& endpoint) {
+        size_t slot = _count;
+        if (const PeerEndpoint* current = find(endpoint.topic)) {
+            slot = static_cast<size_t>(current - _entries);
+            _used[slot] = ++_clock;
+            if (strncmp(current->address, endpoint.address, sizeof(endpoint.address)) == 0 &&
+                current->port == endpoint.port && current->fingerprint == endpoint.fingerprint) {
+                return false;
+            }
+        } else if (_count < MAX_ENDPOINTS) {
+            _count++;
+        } else {
+            slot = 0;
+            for (size_t i = 1; i < _count; i++) {
+                if (_used[i] < _used[slot]) slot = i;
+            }
+        }
+        _entries[slot] = endpoint;
+        _used[slot] = ++_clock;
+        return true;
+    }
+
+    /**
+     * @return The target of @p topic, nullptr if it has none
+     */
+    const PeerEndpoint* find(const char* topic) const {
+        for (size_t i = 0; i < _count; i++) {
+            if (strncmp(_entries[i].topic, topic, sizeof(_entries[i].topic) - 1) == 0) return &_entries[i];
+        }
+        return nullptr;
+    }
+
+    size_t size() const { return _count; }
+    const PeerEndpoint& operator[](size_t i) const { return _entries[i]; }
+    void clear() { _count = 0; }
+
+    /**
+     * @brief Write "CPYP", version, count, then the endpoints
+     * @return Bytes written (at most BLOB_SIZE)
+     */
+    size_t serialize(uint8_t* out, size_t capacity) const {
+        size_t len = 8 + _count * sizeof(PeerEndpoint);
+        if (capacity < len) return 0;
+        memcpy(out, "CPYP", 4);
+        out[4] = DISCOVERY_VERSION;
+        out[5] = static_cast<uint8_t>(_count);
+        out[6] = out[7] = 0;
+        memcpy(out + 8, _entries, _count * sizeof(PeerEndpoint));
+        return len;
+    }
+
+    /**
+     * @return false (leaving the cache empty) if @p data is not a valid blob
+     */
+    bool deserialize(const uint8_t* data, size_t len) {
+        _count = 0;
+        if (len < 8 || memcmp(data, "CPYP", 4) != 0 || data[4] != DISCOVERY_VERSION) return false;
+        size_t count = data[5];
+        if (len < 8 + count * sizeof(PeerEndpoint)) return false;
+        for (size_t i = 0; i < count; i++) {
+            PeerEndpoint endpoint;
+            memcpy(&endpoint, data + 8 + i * sizeof(endpoint), sizeof(endpoint));
+            endpoint.topic[sizeof(endpoint.topic) - 1] = '\0';
+            endpoint.address[sizeof(endpoint.address) - 1] = '\0';
+            update(endpoint);  // A cache from an older firmware may repeat topics
+        }
+        return true;
+    }
+
+private:
+    PeerEndpoint _entries[MAX_ENDPOINTS];
+    uint32_t _used[MAX_ENDPOINTS] = {};
+    uint32_t _clock = 0;
+    size_t _count = 0;
+};
+
+// =============================================================================
+// Discovery
+// =============================================================================
+
+/**
+ * @brief Announces a Node's topics and connects its publishers to peers
+ *
+ * Runs on the node's own spin: announcements arrive through a generic
+ * subscription on the discovery group and go out from a node timer. Takes
+ * one publisher, one subscription and one timer slot of the node.
+ */
+class Discovery {
+public:
+    static constexpr size_t MAX_PEERS = 16;
+    static constexpr size_t MAX_TOPICS = MAX_PUBLISHERS + MAX_SUBSCRIPTIONS;
+
+    /**
+     * @brief Announce periods a target may stay silent before another
+     *        subscriber can take its place
+     */
+    static constexpr uint32_t STALE_PERIODS = 3;
+
+    Discovery(Node& node, const DiscoveryConfig& config = DiscoveryConfig(), PeerStore* store = nullptr)
+        : _node(node)
+        , _config(config)
+        , _store(store)
+    {}
+
+    Discovery(const Discovery&) = delete;
+    Discovery& operator=(const Discovery&) = delete;
+
+    /**
+     * @brief Apply cached endpoints, join the group and announce
+     *
+     * Call once the network is up and the node's topics are created;
+     * topics added later go out with the next periodic announcement.
+     *
+     * @return false without an address to announce (WiFi not connected,
+     *         or no WiFi and no DiscoveryConfig::address) or without room
+     *         on the node
+     */
+    bool begin() {
+        if (_config.address) {
+            strncpy(_address, _config.address, sizeof(_address) - 1);
+        } else {
+            #if defined(ESP32) || defined(ESP8266)
+            strncpy(_address, WiFi.localIP().toString().c_str(), sizeof(_address) - 1);
+            #endif
+        }
+        // Peers ignore an announcement without an address
+        if (!_address[0] || strcmp(_address, "0.0.0.0") == 0) {
+            Serial.println("[Discovery] No address to announce; set DiscoveryConfig::address");
+            return false;
+        }
+        _nodeId = fnv1a32(_address, strlen(_address), fnv1a32(_node.getName(), strlen(_node.getName())));
+
+        if (_store) {
+            uint8_t blob[PeerCache::BLOB_SIZE];
+            size_t len = _store->load(blob, sizeof(blob));
+            if (len > 0 && _cache.deserialize(blob, len)) {
+                // Cached targets get STALE_PERIODS to confirm themselves
+                uint32_t now = nowUs();
+                size_t connected = 0;
+                for (size_t i = 0; i < _cache.size(); i++) {
+                    _heardUs[i] = now;
+                    connected += _apply(_cache[i]);
+                }
+                Serial.printf("[Discovery] %u cached endpoints, %u publishers connected\n",
+                              static_cast<unsigned>(_cache.size()), static_cast<unsigned>(connected));
+            }
+        }
+
+        _sub = _node.createGenericSubscription("/cpy/discovery", nullptr,
+            [this](const uint8_t* data, size_t len) { _onPacket(data, len); }, _config.port);
+        if (_sub) _sub->initMulticast(_config.group);
+        _pub = _node.createGenericPublisher("/cpy/discovery", nullptr, _config.group, _config.port);
+        _timer = _node.createTimer(_config.announcePeriodSec, [this]() { announce(); });
+        if (!_sub || !_pub || !_timer) {
+            Serial.println("[Discovery] No room on the node for discovery");
+            return false;
+        }
+
+        Serial.printf("[Discovery] %s at %s, group %s:%d\n", _node.getName(),
+                      _address, _config.group, _config.port);
+        announce(true);
+        return true;
+    }
+
+    /**
+     * @brief Send the node's topics to the group now
+     * @param requestReply Ask every peer to announce back immediately
+     */
+    bool announce(bool requestReply = false) {
+        if (!_pub) return false;
+        uint8_t packet[sizeof(DiscoveryHeader) + MAX_TOPICS * sizeof(DiscoveryTopic)];
+        DiscoveryHeader header = {};
+        memcpy(header.magic, "CPYD", 4);
+        header.version = DISCOVERY_VERSION;
+        header.flags = requestReply ? DISCOVERY_REPLY_REQUESTED : 0;
+        header.nodeId = _nodeId;
+        strncpy(header.node, _node.getName(), sizeof(header.node) - 1);
+        memcpy(header.address, _address, sizeof(header.address));
+
+        size_t count = 0;
+        auto add = [&](const Node::TypeErased& e, uint8_t role) {
+            if (e.ptr == _pub || e.ptr == _sub || !e.describe || count >= MAX_TOPICS) return;
+            TopicInfo info;
+            e.describe(e.ptr, info);
+            DiscoveryTopic topic = {};
+            strncpy(topic.topic, info.name, sizeof(topic.topic) - 1);
+            topic.fingerprint = info.fingerprint;
+            topic.port = info.port;
+            topic.msgSize = static_cast<uint16_t>(info.msgSize);
+            topic.role = role;
+            memcpy(packet + sizeof(header) + count++ * sizeof(topic), &topic, sizeof(topic));
+        };
+        for (size_t i = 0; i < _node._numPubs; i++) add(_node._publishers[i], DISCOVERY_PUBLISHER);
+        for (size_t i = 0; i < _node._numSubs; i++) add(_node._subscriptions[i], DISCOVERY_SUBSCRIBER);
+
+        header.topicCount = static_cast<uint8_t>(count);
+        memcpy(packet, &header, sizeof(header));
+        bool sent = _pub->publish(packet, sizeof(header) + count * sizeof(DiscoveryTopic));
+        if (sent) _announceCount++;
+        return sent;
+    }
+
+    const PeerCache& getCache() const { return _cache; }
+    size_t getPeerCount() const { return _numPeers; }
+    uint32_t getAnnounceCount() const { return _announceCount; }
+    uint32_t getReceiveCount() const { return _receiveCount; }
+    uint32_t getMismatchCount() const { return _mismatchCount; }
+
+private:
+    void _onPacket(const uint8_t* data, size_t len) {
+        DiscoveryHeader header;
+        if (len < sizeof(header)) return;
+        memcpy(&header, data, sizeof(header));
+        if (memcmp(header.magic, "CPYD", 4) != 0 || header.version != DISCOVERY_VERSION) return;
+        if (header.nodeId == _nodeId) return;  // Our own, looped back
+        if (len < sizeof(header) + header.topicCount * sizeof(DiscoveryTopic)) return;
+        header.node[sizeof(header.node) - 1] = '\0';
+        header.address[sizeof(header.address) - 1] = '\0';
+        _receiveCount++;
+
+        if (_notePeer(header.nodeId)) {
+            Serial.printf("[Discovery] Found %s at %s\n", header.node, header.address);
+        }
+
+        bool changed = false;
+        for (size_t i = 0; i < header.topicCount && header.address[0]; i++) {
+            DiscoveryTopic topic;
+            memcpy(&topic, data + sizeof(header) + i * sizeof(topic), sizeof(topic));
+            if (topic.role != DISCOVERY_SUBSCRIBER) continue;
+
+            PeerEndpoint endpoint = {};
+            memcpy(endpoint.topic, topic.topic, sizeof(endpoint.topic) - 1);
+            memcpy(endpoint.address, header.address, sizeof(endpoint.address));
+            endpoint.fingerprint = topic.fingerprint;
+            endpoint.port = topic.port;
+            changed |= _offer(endpoint);
+        }
+
+        if (changed && _store) {
+            uint8_t blob[PeerCache::BLOB_SIZE];
+            _store->save(blob, _cache.serialize(blob, sizeof(blob)));
+        }
+        if (header.flags & DISCOVERY_REPLY_REQUESTED) announce();
+    }
+
+    /**
+     * @brief Make @p endpoint its topic's target if a publisher wants it
+     *        and the current target is the same node or has gone silent
+     * @return true if the target changed (and the cache must be saved)
+     */
+    bool _offer(const PeerEndpoint& endpoint) {
+        if (!_wants(endpoint)) return false;
+
+        uint32_t now = nowUs();
+        uint32_t staleUs = static_cast<uint32_t>(_config.announcePeriodSec * STALE_PERIODS * 1e6f);
+        const PeerEndpoint* current = _cache.find(endpoint.topic);
+        if (current) {
+            size_t slot = static_cast<size_t>(current - &_cache[0]);
+            bool sameNode = strncmp(current->address, endpoint.address, sizeof(endpoint.address)) == 0;
+            if (!sameNode && now - _heardUs[slot] < staleUs) return false;
+        }
+
+        bool changed = _cache.update(endpoint);
+        _heardUs[static_cast<size_t>(_cache.find(endpoint.topic) - &_cache[0])] = now;
+        return changed && _apply(endpoint) > 0;
+    }
+
+    /**
+     * @brief Whether a publisher awaiting discovery sends @p endpoint's
+     *        topic with a compatible layout
+     */
+    bool _wants(const PeerEndpoint& endpoint) {
+        bool wanted = false;
+        for (size_t i = 0; i < _node._numPubs; i++) {
+            const Node::TypeErased& e = _node._publishers[i];
+            if (!e.retarget) continue;
+            TopicInfo info;
+            e.describe(e.ptr, info);
+            if (strncmp(info.name, endpoint.topic, sizeof(endpoint.topic) - 1) != 0) continue;
+            if (info.fingerprint && endpoint.fingerprint && info.fingerprint != endpoint.fingerprint) {
+                _mismatchCount++;
+                Serial.printf("[Discovery] %s: %s expects another message layout (%08x != %08x)\n",
+                              info.name, endpoint.address, static_cast<unsigned>(endpoint.fingerprint),
+                              static_cast<unsigned>(info.fingerprint));
+                continue;
+            }
+            wanted = true;
+        }
+        return wanted;
+    }
+
+    /**
+     * @brief Point publishers awaiting discovery at @p endpoint
+     * @return Publishers retargeted
+     */
+    size_t _apply(const PeerEndpoint& endpoint) {
+        size_t count = 0;
+        for (size_t i = 0; i < _node._numPubs; i++) {
+            const Node::TypeErased& e = _node._publishers[i];
+            if (!e.retarget) continue;
+            TopicInfo info;
+            e.describe(e.ptr, info);
+            if (strncmp(info.name, endpoint.topic, sizeof(endpoint.topic) - 1) != 0) continue;
+            if (info.fingerprint && endpoint.fingerprint && info.fingerprint != endpoint.fingerprint) {
+                _mismatchCount++;
+                Serial.printf("[Discovery] %s: %s expects another message layout (%08x != %08x)\n",
+                              info.name, endpoint.address, static_cast<unsigned>(endpoint.fingerprint),
+                              static_cast<unsigned>(info.fingerprint));
+                continue;
+            }
+            if (e.retarget(e.ptr, endpoint.address, endpoint.port)) {
+                Serial.printf("[Discovery] %s -> %s:%d\n", info.name, endpoint.address, endpoint.port);
+                count++;
+            }
+        }
+        return count;
+    }
+
+    /**
+     * @return true the first time @p nodeId is seen (false once the table
+     *         is full, so unlisted peers are not reported on every packet)
+     */
+    bool _notePeer(uint32_t nodeId) {
+        for (size_t i = 0; i < _numPeers; i++) {
+            if (_peers[i] == nodeId) return false;
+        }
+        if (_numPeers >= MAX_PEERS) return false;
+        _peers[_numPeers++] = nodeId;
+        return true;
+    }
+
+    Node& _node;
+    DiscoveryConfig _config;
+    PeerStore* _store;
+    PeerCache _cache;
+    uint32_t _heardUs[PeerCache::MAX_ENDPOINTS] = {};  // Last announcement of each cached target
+    GenericSubscription* _sub = nullptr;
+    GenericPublisher* _pub = nullptr;
+    Timer* _timer = nullptr;
+    char _address[16] = {};
+    uint32_t _nodeId = 0;
+    uint32_t _peers[MAX_PEERS];
+    size_t _numPeers = 0;
+    uint32_t _announceCount = 0;
+    uint32_t _receiveCount = 0;
+    uint32_t _mismatchCount = 0;
+};
+
+} // namespace cpy
+
+#endif // CAPYBARISH_DISCOVERY_H
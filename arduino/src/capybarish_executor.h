@@ -0,0 +1,705 @@
+/**
+ * @file capybarish_executor.h
+ * @brief Multi-threaded work-stealing executor for subscriptions and timers
+ *
+ * Node::spinOnce() runs every callback on the calling thread. A gateway
+ * serving dozens of modules instead hands its nodes to a cpy::Executor,
+ * which runs callbacks on a pool of worker threads:
+ *
+ * - Each worker owns a lock-free work-stealing deque (Chase-Lev). Ready
+ *   subscriptions and due timers are pushed by whichever worker found
+ *   them; idle workers steal from the others.
+ * - Finding work is itself a task: one idle worker at a time blocks in
+ *   select() on the subscription sockets until data arrives or the next
+ *   timer is due, queues everything that is ready and wakes the rest.
+ *   Sockets of subscriptions that are running are left out of that
+ *   select(), so a worker that finishes a callback pokes the poller
+ *   through a loopback socket and it starts over with the full set.
+ * - Callback groups decide what may overlap. Members of a
+ *   MUTUALLY_EXCLUSIVE group run one at a time, in the order they became
+ *   ready; members of a REENTRANT group run in parallel. A single
+ *   subscription or timer never runs on two workers at once, since its
+ *   receive state is not thread-safe.
+ * - Workers can be pinned to cores (pthread affinity on Linux, the
+ *   esp_pthread core on ESP32).
+ *
+ * Once a node is added, do not also spin it from loop(). A Publisher is
+ * not thread-safe either: publish to it from callbacks in a single
+ * mutually exclusive group, or lock around it.
+ *
+ * @example
+ * @code
+ * cpy::Node gateway("gateway");
+ * for (int i = 0; i < 24; i++) {
+ *     gateway.createSubscription<SensorData>(topics[i], onFeedback, 6700 + i);
+ * }
+ *
+ * cpy::Executor exec({.threads = 4, .firstCore = 0});
+ * exec.add(gateway);  // The node's own exclusive group
+ *
+ * // Independent feedback handlers may overlap with each other
+ * auto* parallel = exec.createCallbackGroup(cpy::CallbackGroupType::REENTRANT);
+ * exec.add(extraSub, parallel);
+ *
+ * exec.spin();  // Until exec.stop()
+ * @endcode
+ *
+ * @author Chen Yu <chenyu@u.northwestern.edu>
+ * @copyright 2025 Chen Yu
+ * @license Apache-2.0
+ */
+
+#pragma once
+
+#ifndef CAPYBARISH_EXECUTOR_H
+#define CAPYBARISH_EXECUTOR_H
+
+#include "capybarish_pubsub.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(ESP32)
+    #include "esp_pthread.h"
+#elif defined(__linux__)
+    #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <pthread.h>
+    #include <sched.h>
+    #include <sys/select.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+namespace cpy {
+
+// =============================================================================
+// Work-Stealing Deque
+// =============================================================================
+
+/**
+ * @brief Bounded Chase-Lev deque of pointers
+ *
+ * The owning worker pushes and pops at the bottom (LIFO, cache-warm);
+ * other workers steal from the top (FIFO). Follows Lê et al., "Correct and
+ * Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013), without
+ * resizing: the executor queues each entity at most once, so the capacity
+ * is fixed by the number of entities.
+ */
+template<typename T>
+class WorkStealingDeque {
+public:
+    /**
+     * @brief Allocate room for @p capacity items (rounded up to a power of 2)
+     *
+     * Not thread-safe; call before the deque is shared.
+     */
+    void reserve(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        _buffer.reset(new std::atomic<T*>[size]);
+        _mask = size - 1;
+        _top.store(0, std::memory_order_relaxed);
+        _bottom.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Add an item at the bottom (owner only)
+     * @return false if full
+     */
+    bool push(T* item) {
+        const int64_t b = _bottom.load(std::memory_order_relaxed);
+        const int64_t t = _top.load(std::memory_order_acquire);
+        if (b - t > static_cast<int64_t>(_mask)) return false;
+        _buffer[b & _mask].store(item, std::memory_order_relaxed);
+        _bottom.store(b + 1, std::memory_order_release);  // Publishes the slot to thieves
+        return true;
+    }
+
+    /**
+     * @brief Take the most recently pushed item (owner only)
+     */
+    T* pop() {
+        const int64_t b = _bottom.load(std::memory_order_relaxed) - 1;
+        _bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = _top.load(std::memory_order_relaxed);
+
+        T* item = nullptr;
+        if (t <= b) {
+            item = _buffer[b & _mask].load(std::memory_order_relaxed);
+            if (t == b) {
+                // Last item: race the thieves for it
+                if (!_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                  std::memory_order_relaxed)) {
+                    item = nullptr;
+                }
+                _bottom.store(b + 1, std::memory_order_relaxed);
+            }
+        } else {
+            _bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    /**
+     * @brief Take the oldest item (any thread)
+     * @return nullptr if empty or another thread won the race
+     */
+    T* steal() {
+        int64_t t = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t b = _bottom.load(std::memory_order_acquire);
+        if (t >= b) return nullptr;
+
+        T* item = _buffer[t & _mask].load(std::memory_order_relaxed);
+        if (!_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    bool empty() const {
+        return _bottom.load(std::memory_order_relaxed) <= _top.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::unique_ptr<std::atomic<T*>[]> _buffer;
+    size_t _mask = 0;
+    alignas(64) std::atomic<int64_t> _top{0};     // Thieves
+    alignas(64) std::atomic<int64_t> _bottom{0};  // Owner
+};
+
+// =============================================================================
+// Callback Groups
+// =============================================================================
+
+enum class CallbackGroupType : uint8_t {
+    MUTUALLY_EXCLUSIVE,  ///< One member at a time, in ready order
+    REENTRANT            ///< Members run in parallel
+};
+
+/**
+ * @brief Set of subscriptions and timers with a shared concurrency rule
+ *
+ * Created by Executor::createCallbackGroup(); owned by the executor.
+ */
+class CallbackGroup {
+public:
+    explicit CallbackGroup(CallbackGroupType type) : _type(type) {}
+
+    CallbackGroupType getType() const { return _type; }
+
+private:
+    friend class Executor;
+
+    CallbackGroupType _type;
+    std::mutex _mutex;             // Exclusive groups only
+    bool _busy = false;
+    std::deque<void*> _waiting;    // Ready members queued behind the running one
+};
+
+// =============================================================================
+// Executor
+// =============================================================================
+
+struct ExecutorOptions {
+    size_t threads = 0;   ///< Worker threads (0 = one per core)
+    int firstCore = -1;   ///< Pin worker i to core firstCore + i (mod cores); -1 = no pinning
+};
+
+/**
+ * @brief Runs the callbacks of one or more nodes on a pool of threads
+ *
+ * Add nodes, subscriptions and timers before start()/spin(). All of them
+ * must outlive the executor.
+ */
+class Executor {
+public:
+    /** Longest select() wait, which bounds how late stop() is noticed */
+    static constexpr uint32_t MAX_POLL_US = 10000;
+
+    /** Period for subscriptions without a socket to select() on */
+    static constexpr uint32_t POLL_ONLY_PERIOD_US = 1000;
+
+    explicit Executor(ExecutorOptions options = {}) : _options(options) {
+        if (_options.threads == 0) {
+            _options.threads = max<size_t>(1, std::thread::hardware_concurrency());
+        }
+    }
+
+    ~Executor() {
+        stop();
+        _join();
+        _closeWake();
+    }
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    /**
+     * @brief Create a callback group (owned by the executor)
+     */
+    CallbackGroup* createCallbackGroup(CallbackGroupType type) {
+        _groups.push_back(std::make_unique<CallbackGroup>(type));
+        return _groups.back().get();
+    }
+
+    /**
+     * @brief Take over every callback subscription, service, client,
+     *        timer and deferring publisher of @p node
+     *
+     * Coroutine waits are not taken over: they are resumed only by
+     * Node::spinOnce(). A node with parked coroutines is refused, and once
+     * added, a co_await on it returns at once as timed out.
+     *
+     * @param group Group for all of them; nullptr creates a mutually
+     *              exclusive group for this node, which keeps the
+     *              single-threaded semantics of Node::spinOnce()
+     */
+    bool add(Node& node, CallbackGroup* group = nullptr) {
+        if (_running) return false;
+        if (node._numWaits > 0) {
+            Serial.printf("[Executor] %s has %u waiting coroutines; spin it with spinOnce()\n",
+                          node._name, static_cast<unsigned>(node._numWaits));
+            return false;
+        }
+        node._onExecutor = true;
+        if (!group) group = createCallbackGroup(CallbackGroupType::MUTUALLY_EXCLUSIVE);
+
+        for (size_t i = 0; i < node._numSubs; i++) {
+            const Node::TypeErased& s = node._subscriptions[i];
+            if (!s.spin) continue;  // Polling subscriptions stay with take()
+            Entity& e = _addEntity(s.ptr, s.spin, group);
+            e.fd = s.fd;
+            e.buffered = s.buffered;
+            e.dueUs = s.dueUs;  // Clients: the earliest call deadline
+        }
+        for (size_t i = 0; i < node._numTimers; i++) add(node._timers[i], group);
+        for (size_t i = 0; i < node._numPubs; i++) {
+            const Node::TypeErased& p = node._publishers[i];
+            if (!p.spin) continue;
+            _addEntity(p.ptr, p.spin, group).dueUs = p.dueUs;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Run a subscription's callback (or output) on the executor
+     *
+     * @tparam Sub Subscription<T> or GenericSubscription
+     * @param group nullptr = a mutually exclusive group of its own
+     */
+    template<typename Sub>
+    bool add(Sub* sub, CallbackGroup* group = nullptr) {
+        if (_running || !Node::_isSpun(sub)) return false;
+        if (!group) group = createCallbackGroup(CallbackGroupType::MUTUALLY_EXCLUSIVE);
+
+        Entity& e = _addEntity(sub, [](void* s) { return static_cast<Sub*>(s)->spinAll(); }, group);
+        e.fd = [](const void* s) { return static_cast<const Sub*>(s)->fd(); };
+        e.buffered = [](const void* s) { return static_cast<const Sub*>(s)->hasBuffered(); };
+        return true;
+    }
+
+    /**
+     * @brief Run a timer on the executor
+     */
+    bool add(Timer* timer, CallbackGroup* group = nullptr) {
+        if (_running) return false;
+        if (!group) group = createCallbackGroup(CallbackGroupType::MUTUALLY_EXCLUSIVE);
+
+        Entity& e = _addEntity(timer, [](void* t) {
+            return static_cast<size_t>(static_cast<Timer*>(t)->spinOnce());
+        }, group);
+        e.dueUs = [](const void* t) {
+            return static_cast<uint32_t>(min<uint64_t>(static_cast<const Timer*>(t)->remainingUs(),
+                                                       UINT32_MAX));
+        };
+        return true;
+    }
+
+    /**
+     * @brief Start the workers in the background
+     */
+    bool start() {
+        if (!_prepare()) return false;
+        for (size_t i = 0; i < _workers.size(); i++) _launch(i);
+        return true;
+    }
+
+    /**
+     * @brief Run until stop(), with the calling thread as worker 0
+     */
+    void spin() {
+        if (!_prepare()) return;
+        for (size_t i = 1; i < _workers.size(); i++) _launch(i);
+        _pin(0);
+        _workerLoop(0);
+        _join();
+    }
+
+    /**
+     * @brief Ask every worker to finish its current callback and exit
+     *
+     * Safe to call from a callback. Outside the executor's threads it also
+     * waits for the workers to exit.
+     */
+    void stop() {
+        _running.store(false, std::memory_order_release);
+        _wake(true);
+        _wakePoller();
+        for (const auto& w : _workers) {
+            if (w->thread.get_id() == std::this_thread::get_id()) return;
+        }
+        _join();
+    }
+
+    bool isRunning() const { return _running.load(std::memory_order_acquire); }
+    size_t getThreadCount() const { return _options.threads; }
+    size_t getEntityCount() const { return _entities.size(); }
+
+    /**
+     * @brief Callbacks (subscription drains, timer fires) run by a worker
+     */
+    uint64_t getExecutedCount(size_t worker) const {
+        return worker < _workers.size() ? _workers[worker]->executed.load(std::memory_order_relaxed) : 0;
+    }
+
+    uint64_t getExecutedCount() const {
+        uint64_t total = 0;
+        for (const auto& w : _workers) total += w->executed.load(std::memory_order_relaxed);
+        return total;
+    }
+
+    /**
+     * @brief Tasks a worker took from another worker's deque
+     */
+    uint64_t getStealCount() const {
+        uint64_t total = 0;
+        for (const auto& w : _workers) total += w->steals.load(std::memory_order_relaxed);
+        return total;
+    }
+
+private:
+    /**
+     * @brief A subscription, timer or publisher the executor schedules
+     */
+    struct Entity {
+        void* ptr;
+        size_t (*run)(void*);
+        int (*fd)(const void*) = nullptr;          // Subscriptions, clients
+        bool (*buffered)(const void*) = nullptr;
+        uint32_t (*dueUs)(const void*) = nullptr;  // Timers, deferring publishers, clients
+        CallbackGroup* group;
+        std::atomic<bool> queued{false};           // In a deque, waiting or running
+    };
+
+    struct Worker {
+        WorkStealingDeque<Entity> deque;
+        std::thread thread;
+        std::atomic<uint64_t> executed{0};
+        std::atomic<uint64_t> steals{0};
+    };
+
+    Entity& _addEntity(void* ptr, size_t (*run)(void*), CallbackGroup* group) {
+        _entities.push_back(std::make_unique<Entity>());
+        Entity& e = *_entities.back();
+        e.ptr = ptr;
+        e.run = run;
+        e.group = group;
+        return e;
+    }
+
+    bool _prepare() {
+        if (_running.exchange(true)) return false;
+        _join();  // A previous run
+        if (_wakeFd < 0) _openWake();
+        _workers.clear();
+        for (size_t i = 0; i < _options.threads; i++) {
+            _workers.push_back(std::make_unique<Worker>());
+            _workers.back()->deque.reserve(_entities.size() + 1);
+        }
+        Serial.printf("[Executor] %u entities on %u workers\n",
+                      static_cast<unsigned>(_entities.size()), static_cast<unsigned>(_workers.size()));
+        return true;
+    }
+
+    void _launch(size_t id) {
+        #ifdef ESP32
+        // esp_pthread applies the configuration to the next thread created
+        esp_pthread_cfg_t cfg = esp_pthread_get_default_config();
+        if (_options.firstCore >= 0) {
+            cfg.pin_to_core = static_cast<int>((_options.firstCore + id) % portNUM_PROCESSORS);
+        }
+        esp_pthread_set_cfg(&cfg);
+        #endif
+        _workers[id]->thread = std::thread([this, id] {
+            _pin(id);
+            _workerLoop(id);
+        });
+    }
+
+    /**
+     * @brief Pin the calling thread to its worker's core (Linux)
+     */
+    void _pin(size_t id) {
+        #if defined(__linux__) && !defined(ESP32)
+        if (_options.firstCore < 0) return;
+        const size_t cores = max<size_t>(1, std::thread::hardware_concurrency());
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET((_options.firstCore + id) % cores, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        #else
+        (void)id;
+        #endif
+    }
+
+    void _join() {
+        for (const auto& w : _workers) {
+            if (w->thread.joinable() && w->thread.get_id() != std::this_thread::get_id()) {
+                w->thread.join();
+            }
+        }
+    }
+
+    void _workerLoop(size_t id) {
+        Worker& self = *_workers[id];
+        while (_running.load(std::memory_order_acquire)) {
+            Entity* e = self.deque.pop();
+            if (!e) e = _steal(id);
+            if (e) {
+                _execute(self, e);
+                continue;
+            }
+
+            // Nothing queued anywhere: one worker looks for more
+            if (!_polling.exchange(true, std::memory_order_seq_cst)) {
+                size_t found = _poll(self);
+                _polling.store(false, std::memory_order_release);
+                // Someone else polls while this worker runs what it found
+                if (found > 0) _wake(found > 1);
+                continue;
+            }
+            _sleep();
+        }
+    }
+
+    Entity* _steal(size_t id) {
+        const size_t n = _workers.size();
+        for (size_t k = 1; k < n; k++) {
+            Entity* e = _workers[(id + k) % n]->deque.steal();
+            if (e) {
+                _workers[id]->steals.fetch_add(1, std::memory_order_relaxed);
+                return e;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Run @p e, or park it behind its exclusive group's running member
+     */
+    void _execute(Worker& self, Entity* e) {
+        CallbackGroup* group = e->group;
+        const bool exclusive = group->getType() == CallbackGroupType::MUTUALLY_EXCLUSIVE;
+        if (exclusive) {
+            std::lock_guard<std::mutex> lock(group->_mutex);
+            if (group->_busy) {
+                group->_waiting.push_back(e);
+                return;
+            }
+            group->_busy = true;
+        }
+
+        while (e) {
+            e->run(e->ptr);
+            self.executed.fetch_add(1, std::memory_order_relaxed);
+            // Pairs with _poll(): either the poller sees the entity free or
+            // this worker sees the poller and restarts its select()
+            e->queued.store(false, std::memory_order_seq_cst);
+            if (_polling.load(std::memory_order_seq_cst)) _wakePoller();
+            if (!exclusive) break;
+
+            // Hand the group to the next waiting member, on this worker
+            std::lock_guard<std::mutex> lock(group->_mutex);
+            if (group->_waiting.empty()) {
+                group->_busy = false;
+                e = nullptr;
+            } else {
+                e = static_cast<Entity*>(group->_waiting.front());
+                group->_waiting.pop_front();
+            }
+        }
+    }
+
+    bool _enqueue(Worker& self, Entity* e) {
+        bool expected = false;
+        if (!e->queued.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) return false;
+        self.deque.push(e);  // Cannot fill up: each entity is queued at most once
+        return true;
+    }
+
+    /**
+     * @brief Queue every ready entity, blocking until one is ready or a
+     *        running one finishes
+     * @return Number of entities queued
+     */
+    size_t _poll(Worker& self) {
+        size_t found = 0;
+        uint32_t waitUs = MAX_POLL_US;
+        const uint32_t now = micros();
+        const uint32_t sincePoll = now - _lastPollOnlyUs;
+        bool pollOnly = false;
+        fd_set readable;
+        FD_ZERO(&readable);
+        int maxFd = -1;
+
+        // Finishes signalled before this scan are seen by the scan itself
+        _drainWake();
+        if (_wakeFd >= 0) {
+            FD_SET(_wakeFd, &readable);
+            maxFd = _wakeFd;
+        }
+
+        for (const auto& owned : _entities) {
+            Entity* e = owned.get();
+            // A queued entity may be running: leave its state alone
+            if (e->queued.load(std::memory_order_seq_cst)) continue;
+
+            if (e->dueUs) {
+                uint32_t due = e->dueUs(e->ptr);
+                if (due == 0) {
+                    found += _enqueue(self, e);
+                    continue;
+                }
+                waitUs = min(waitUs, due);
+                if (!e->fd) continue;  // Nothing to receive
+            }
+            if (e->buffered(e->ptr)) {
+                found += _enqueue(self, e);
+                continue;
+            }
+            int fd = e->fd(e->ptr);
+            if (fd < 0) {
+                // Transport or no sockets: poll it every millisecond
+                if (sincePoll >= POLL_ONLY_PERIOD_US) {
+                    found += _enqueue(self, e);
+                    pollOnly = true;
+                } else {
+                    waitUs = min(waitUs, POLL_ONLY_PERIOD_US - sincePoll);
+                }
+                continue;
+            }
+            FD_SET(fd, &readable);
+            maxFd = max(maxFd, fd);
+        }
+        if (pollOnly) _lastPollOnlyUs = now;
+        if (found > 0) return found;
+
+        if (maxFd < 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(waitUs));  // No wake socket
+            return 0;
+        }
+
+        timeval tv;
+        tv.tv_sec = waitUs / 1000000;
+        tv.tv_usec = waitUs % 1000000;
+        if (select(maxFd + 1, &readable, nullptr, nullptr, &tv) <= 0) return 0;
+
+        for (const auto& owned : _entities) {
+            Entity* e = owned.get();
+            if (!e->fd || e->queued.load(std::memory_order_acquire)) continue;
+            int fd = e->fd(e->ptr);
+            if (fd >= 0 && FD_ISSET(fd, &readable)) found += _enqueue(self, e);
+        }
+        return found;
+    }
+
+    /**
+     * @brief Open the loopback socket that interrupts the poller's select()
+     * 
+     * Without it (e.g. no loopback interface) the poller still wakes
+     * within MAX_POLL_US.
+     */
+    void _openWake() {
+        int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (fd < 0) return;
+        sockaddr_in local = {};
+        local.sin_family = AF_INET;
+        local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(local);
+        if (bind(fd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0 ||
+            getsockname(fd, reinterpret_cast<sockaddr*>(&local), &len) != 0 ||
+            connect(fd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0) {
+            ::close(fd);
+            Serial.printf("[Executor] No wake socket; idle workers poll every %u us\n",
+                          static_cast<unsigned>(MAX_POLL_US));
+            return;
+        }
+        _wakeFd = fd;
+    }
+
+    void _closeWake() {
+        if (_wakeFd >= 0) ::close(_wakeFd);
+        _wakeFd = -1;
+    }
+
+    void _wakePoller() {
+        if (_wakeFd < 0) return;
+        const uint8_t byte = 0;
+        send(_wakeFd, &byte, 1, MSG_DONTWAIT);  // A full buffer means it is awake anyway
+    }
+
+    void _drainWake() {
+        if (_wakeFd < 0) return;
+        uint8_t bytes[16];
+        while (recv(_wakeFd, bytes, sizeof(bytes), MSG_DONTWAIT) > 0) {}
+    }
+
+    /**
+     * @brief Park an idle worker until work is published or a poll ends
+     */
+    void _sleep() {
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        const uint64_t epoch = _epoch;
+        _sleepers++;
+        _wakeup.wait_for(lock, std::chrono::microseconds(MAX_POLL_US), [&] {
+            return _epoch != epoch || !_running.load(std::memory_order_acquire);
+        });
+        _sleepers--;
+    }
+
+    void _wake(bool all) {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        if (_sleepers == 0) return;
+        _epoch++;
+        if (all) _wakeup.notify_all();
+        else _wakeup.notify_one();
+    }
+
+    ExecutorOptions _options;
+    std::vector<std::unique_ptr<CallbackGroup>> _groups;
+    std::vector<std::unique_ptr<Entity>> _entities;
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::atomic<bool> _running{false};
+    std::atomic<bool> _polling{false};
+    uint32_t _lastPollOnlyUs = 0;  // Only touched by the polling worker
+    int _wakeFd = -1;              // Loopback socket connected to itself
+
+    std::mutex _sleepMutex;
+    std::condition_variable _wakeup;
+    uint64_t _epoch = 0;
+    size_t _sleepers = 0;
+};
+
+} // namespace cpy
+
+#endif // CAPYBARISH_EXECUTOR_H
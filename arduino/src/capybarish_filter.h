@@ -0,0 +1,492 @@
+/**
+ * @file capybarish_filter.h
+ * @brief Content filters evaluated on raw message bytes
+ *
+ * A module on a broadcast or multicast command topic receives every
+ * module's messages. A cpy::ContentFilter compiles an expression over
+ * message fields into predicates on byte offsets, so a Subscription can
+ * reject someone else's datagram straight from the receive buffer, before
+ * it is decoded into a struct or reaches the callback.
+ *
+ * Grammar (C-like precedence, whitespace ignored):
+ *
+ *     expr  := and ('||' and)*
+ *     and   := unary ('&&' unary)*
+ *     unary := '!' unary | '(' expr ')' | test
+ *     test  := field ('==' | '!=' | '<' | '<=' | '>' | '>=') number
+ *            | field ['not'] 'in' '{' number (',' number)* '}'
+ *     field := name ['[' index ']']
+ *
+ * Numbers may be integers, decimals or true/false. Integer fields only
+ * compare against integers (64-bit fields as int64_t); float fields
+ * compare in their own precision. Fields are registered by name, from a
+ * member pointer or a byte offset.
+ *
+ * @example
+ * @code
+ * using namespace motor_control;
+ *
+ * cpy::ContentFilter filter;
+ * filter.addField<&MotorCommand::joint_id>("joint_id");
+ * filter.addField<&MotorCommand::command_context>("context");
+ * if (!filter.compile("(joint_id == 3 || joint_id == -1) && context[0] >= 0")) {
+ *     Serial.println(filter.lastError());
+ * }
+ *
+ * auto* sub = node.createMulticastSubscription<MotorCommand>("/motor/cmd", onCommand, 6666);
+ * sub->setFilter(&filter);  // filter must outlive the subscription
+ * @endcode
+ *
+ * @author Chen Yu <chenyu@u.northwestern.edu>
+ * @copyright 2025 Chen Yu
+ * @license Apache-2.0
+ */
+
+#pragma once
+
+#ifndef CAPYBARISH_FILTER_H
+#define CAPYBARISH_FILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+
+namespace cpy {
+
+// =============================================================================
+// Field Descriptors
+// =============================================================================
+
+/**
+ * @brief Primitive type of a message field on the wire (little-endian)
+ */
+enum class FieldType : uint8_t {
+    BOOL, INT8, UINT8, INT16, UINT16, INT32, UINT32, INT64, UINT64, FLOAT32, FLOAT64
+};
+
+inline constexpr size_t fieldTypeSize(FieldType type) {
+    switch (type) {
+        case FieldType::BOOL:
+        case FieldType::INT8:
+        case FieldType::UINT8:   return 1;
+        case FieldType::INT16:
+        case FieldType::UINT16:  return 2;
+        case FieldType::INT32:
+        case FieldType::UINT32:
+        case FieldType::FLOAT32: return 4;
+        default:                 return 8;
+    }
+}
+
+inline constexpr bool fieldTypeIsFloat(FieldType type) {
+    return type == FieldType::FLOAT32 || type == FieldType::FLOAT64;
+}
+
+/**
+ * @brief FieldType of a C++ scalar
+ */
+template<typename V>
+constexpr FieldType fieldTypeOf() {
+    static_assert(std::is_arithmetic_v<V>, "Fields must be arithmetic scalars or arrays of them");
+    if constexpr (std::is_same_v<V, bool>) return FieldType::BOOL;
+    else if constexpr (std::is_floating_point_v<V>) {
+        return sizeof(V) == 4 ? FieldType::FLOAT32 : FieldType::FLOAT64;
+    } else if constexpr (std::is_signed_v<V>) {
+        return sizeof(V) == 1 ? FieldType::INT8 : sizeof(V) == 2 ? FieldType::INT16
+             : sizeof(V) == 4 ? FieldType::INT32 : FieldType::INT64;
+    } else {
+        return sizeof(V) == 1 ? FieldType::UINT8 : sizeof(V) == 2 ? FieldType::UINT16
+             : sizeof(V) == 4 ? FieldType::UINT32 : FieldType::UINT64;
+    }
+}
+
+/**
+ * @brief Name, byte offset and type of one field (count > 1 for arrays)
+ */
+struct FieldInfo {
+    const char* name;
+    uint16_t offset;
+    FieldType type;
+    uint16_t count;
+};
+
+// =============================================================================
+// Content Filter
+// =============================================================================
+
+/**
+ * @brief Field expression compiled to predicates on raw message bytes
+ *
+ * The compiled form is a short postfix program with fixed capacity; match()
+ * neither allocates nor decodes the message. An empty filter matches
+ * everything.
+ */
+class ContentFilter {
+public:
+    static constexpr size_t MAX_FIELDS = 16;
+    static constexpr size_t MAX_OPS = 24;
+    static constexpr size_t MAX_VALUES = 32;
+
+    /**
+     * @brief Make a field available to expressions under @p name
+     */
+    bool addField(const char* name, size_t offset, FieldType type, uint16_t count = 1) {
+        if (_fieldCount >= MAX_FIELDS || offset > UINT16_MAX) return false;
+        _fields[_fieldCount++] = {name, static_cast<uint16_t>(offset), type, count};
+        return true;
+    }
+
+    /**
+     * @brief Register a member (scalar or array) of a message struct
+     */
+    template<auto Field>
+    bool addField(const char* name) {
+        using Traits = MemberOf<decltype(Field)>;
+        using Msg = typename Traits::Class;
+        using Member = typename Traits::Value;
+        static const Msg probe{};
+        // Byte-level addressing: the generated structs are packed
+        const auto* base = reinterpret_cast<const uint8_t*>(&probe);
+        const auto* field = reinterpret_cast<const uint8_t*>(&reinterpret_cast<const char&>(probe.*Field));
+        return addField(name, field - base, fieldTypeOf<std::remove_extent_t<Member>>(),
+                        std::is_array_v<Member> ? std::extent_v<Member> : 1);
+    }
+
+    /**
+     * @brief Parse @p expr and replace the compiled program
+     *
+     * @return false on error; the previous program is kept and lastError()
+     *         describes the problem
+     */
+    bool compile(const char* expr) {
+        Program parsed;
+        _out = &parsed;
+        _p = expr;
+        _error[0] = '\0';
+
+        _skipSpace();
+        if (!*_p) return _fail("empty expression");
+        if (!_parseOr()) return false;
+        _skipSpace();
+        if (*_p) return _fail("unexpected '%.16s'", _p);
+
+        _prog = parsed;
+        return true;
+    }
+
+    /**
+     * @brief Remove the expression (match everything)
+     */
+    void clear() { _prog = Program(); }
+
+    /**
+     * @brief Evaluate the filter on a serialized message
+     * @return false if the message does not match or is too short to test
+     */
+    bool match(const uint8_t* data, size_t len) const {
+        if (_prog.numOps == 0) return true;
+        if (len < _prog.minLength) return false;
+
+        bool stack[MAX_OPS];
+        size_t depth = 0;
+        for (size_t i = 0; i < _prog.numOps; i++) {
+            const Instr& in = _prog.ops[i];
+            switch (in.op) {
+                case Op::AND:
+                    depth--;
+                    stack[depth - 1] = stack[depth - 1] && stack[depth];
+                    break;
+                case Op::OR:
+                    depth--;
+                    stack[depth - 1] = stack[depth - 1] || stack[depth];
+                    break;
+                case Op::NOT:
+                    stack[depth - 1] = !stack[depth - 1];
+                    break;
+                default:
+                    stack[depth++] = _test(in, data + in.offset);
+                    break;
+            }
+        }
+        return stack[0];
+    }
+
+    bool empty() const { return _prog.numOps == 0; }
+
+    /**
+     * @brief Shortest message the program can be evaluated on
+     */
+    size_t minLength() const { return _prog.minLength; }
+
+    const char* lastError() const { return _error; }
+
+private:
+    template<typename M> struct MemberOf;
+    template<typename C, typename V> struct MemberOf<V C::*> {
+        using Class = C;
+        using Value = V;
+    };
+
+    enum class Op : uint8_t { EQ, NE, LT, LE, GT, GE, IN, NOT_IN, AND, OR, NOT };
+
+    union Value {
+        int64_t i;
+        float f;
+        double d;
+    };
+
+    struct Instr {
+        Op op;
+        FieldType type;
+        uint16_t offset;
+        uint8_t value;  // Index into _values
+        uint8_t count;  // Set size for IN / NOT_IN
+    };
+
+    struct Program {
+        Instr ops[MAX_OPS];
+        size_t numOps = 0;
+        Value values[MAX_VALUES];
+        size_t numValues = 0;
+        size_t minLength = 0;
+    };
+
+    // -------------------------------------------------------------------------
+    // Evaluation
+    // -------------------------------------------------------------------------
+
+    template<typename V>
+    static V _load(const uint8_t* p) {
+        V v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    template<typename V>
+    static bool _compare(Op op, V a, V b) {
+        switch (op) {
+            case Op::EQ: return a == b;
+            case Op::NE: return a != b;
+            case Op::LT: return a < b;
+            case Op::LE: return a <= b;
+            case Op::GT: return a > b;
+            default:     return a >= b;
+        }
+    }
+
+    template<typename V>
+    bool _testAs(const Instr& in, V field) const {
+        const Value* values = _prog.values + in.value;
+        auto constant = [&](size_t k) -> V {
+            if constexpr (std::is_same_v<V, float>) return values[k].f;
+            else if constexpr (std::is_same_v<V, double>) return values[k].d;
+            else return values[k].i;
+        };
+        if (in.op == Op::IN || in.op == Op::NOT_IN) {
+            bool found = false;
+            for (size_t k = 0; k < in.count && !found; k++) found = field == constant(k);
+            return found == (in.op == Op::IN);
+        }
+        return _compare(in.op, field, constant(0));
+    }
+
+    bool _test(const Instr& in, const uint8_t* p) const {
+        switch (in.type) {
+            case FieldType::BOOL:
+            case FieldType::UINT8:   return _testAs<int64_t>(in, _load<uint8_t>(p));
+            case FieldType::INT8:    return _testAs<int64_t>(in, _load<int8_t>(p));
+            case FieldType::INT16:   return _testAs<int64_t>(in, _load<int16_t>(p));
+            case FieldType::UINT16:  return _testAs<int64_t>(in, _load<uint16_t>(p));
+            case FieldType::INT32:   return _testAs<int64_t>(in, _load<int32_t>(p));
+            case FieldType::UINT32:  return _testAs<int64_t>(in, _load<uint32_t>(p));
+            case FieldType::INT64:
+            case FieldType::UINT64:  return _testAs<int64_t>(in, _load<int64_t>(p));
+            case FieldType::FLOAT32: return _testAs<float>(in, _load<float>(p));
+            default:                 return _testAs<double>(in, _load<double>(p));
+        }
+    }
+
+    // -------------------------------------------------------------------------
+    // Parsing (recursive descent, emits postfix)
+    // -------------------------------------------------------------------------
+
+    bool _emit(Instr in) {
+        if (_out->numOps >= MAX_OPS) return _fail("expression too long (max %d terms)", (int)MAX_OPS);
+        _out->ops[_out->numOps++] = in;
+        return true;
+    }
+
+    bool _emitOp(Op op) { return _emit({op, FieldType::BOOL, 0, 0, 0}); }
+
+    void _skipSpace() {
+        while (*_p == ' ' || *_p == '\t' || *_p == '\r' || *_p == '\n') _p++;
+    }
+
+    bool _accept(const char* token) {
+        _skipSpace();
+        size_t n = strlen(token);
+        if (strncmp(_p, token, n) != 0) return false;
+        _p += n;
+        return true;
+    }
+
+    /**
+     * @brief Accept a keyword that is not the prefix of a longer name
+     */
+    bool _acceptWord(const char* word) {
+        _skipSpace();
+        size_t n = strlen(word);
+        if (strncmp(_p, word, n) != 0 || _isNameChar(_p[n])) return false;
+        _p += n;
+        return true;
+    }
+
+    static bool _isNameChar(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+               c == '_' || c == '.';
+    }
+
+    bool _parseOr() {
+        if (!_parseAnd()) return false;
+        while (_accept("||")) {
+            if (!_parseAnd() || !_emitOp(Op::OR)) return false;
+        }
+        return true;
+    }
+
+    bool _parseAnd() {
+        if (!_parseUnary()) return false;
+        while (_accept("&&")) {
+            if (!_parseUnary() || !_emitOp(Op::AND)) return false;
+        }
+        return true;
+    }
+
+    bool _parseUnary() {
+        if (_accept("!")) return _parseUnary() && _emitOp(Op::NOT);
+        if (_accept("(")) {
+            if (!_parseOr()) return false;
+            if (!_accept(")")) return _fail("missing ')'");
+            return true;
+        }
+        return _parseTest();
+    }
+
+    bool _parseTest() {
+        _skipSpace();
+        const char* start = _p;
+        while (_isNameChar(*_p)) _p++;
+        if (_p == start) return _fail("expected a field at '%.16s'", start);
+
+        const FieldInfo* field = nullptr;
+        for (size_t i = 0; i < _fieldCount && !field; i++) {
+            const size_t n = strlen(_fields[i].name);
+            if (n == static_cast<size_t>(_p - start) && strncmp(_fields[i].name, start, n) == 0) {
+                field = &_fields[i];
+            }
+        }
+        if (!field) return _fail("unknown field '%.*s'", (int)(_p - start), start);
+
+        size_t offset = field->offset;
+        if (_accept("[")) {
+            _skipSpace();
+            char* end;
+            const long index = strtol(_p, &end, 10);
+            if (end == _p || index < 0 || index >= field->count) {
+                return _fail("%s: index out of range", field->name);
+            }
+            _p = end;
+            if (!_accept("]")) return _fail("%s: missing ']'", field->name);
+            offset += index * fieldTypeSize(field->type);
+        } else if (field->count > 1) {
+            return _fail("%s is an array, index it", field->name);
+        }
+
+        Instr in = {Op::EQ, field->type, static_cast<uint16_t>(offset),
+                    static_cast<uint8_t>(_out->numValues), 1};
+        if (_accept("==")) in.op = Op::EQ;
+        else if (_accept("!=")) in.op = Op::NE;
+        else if (_accept("<=")) in.op = Op::LE;
+        else if (_accept(">=")) in.op = Op::GE;
+        else if (_accept("<")) in.op = Op::LT;
+        else if (_accept(">")) in.op = Op::GT;
+        else if (_acceptWord("in")) in.op = Op::IN;
+        else if (_acceptWord("not") && _acceptWord("in")) in.op = Op::NOT_IN;
+        else return _fail("%s: expected a comparison", field->name);
+
+        if (in.op == Op::IN || in.op == Op::NOT_IN) {
+            if (!_accept("{")) return _fail("%s: expected '{'", field->name);
+            in.count = 0;
+            do {
+                if (!_parseValue(*field)) return false;
+                in.count++;
+            } while (_accept(","));
+            if (!_accept("}")) return _fail("%s: missing '}'", field->name);
+        } else if (!_parseValue(*field)) {
+            return false;
+        }
+
+        const size_t end = offset + fieldTypeSize(field->type);
+        if (end > _out->minLength) _out->minLength = end;
+        return _emit(in);
+    }
+
+    bool _parseValue(const FieldInfo& field) {
+        if (_out->numValues >= MAX_VALUES) return _fail("too many constants (max %d)", (int)MAX_VALUES);
+        Value& v = _out->values[_out->numValues];
+
+        _skipSpace();
+        double d;
+        bool integral;
+        if (_acceptWord("true")) {
+            d = 1;
+            integral = true;
+        } else if (_acceptWord("false")) {
+            d = 0;
+            integral = true;
+        } else {
+            char* endInt;
+            char* endReal;
+            const long long i = strtoll(_p, &endInt, 10);
+            d = strtod(_p, &endReal);
+            if (endReal == _p) return _fail("%s: expected a number at '%.16s'", field.name, _p);
+            integral = endInt >= endReal;
+            if (integral) d = static_cast<double>(i);
+            if (fieldTypeIsFloat(field.type)) {
+                _p = endReal;
+            } else {
+                if (!integral) return _fail("%s: integer field needs an integer", field.name);
+                _p = endInt;
+                v.i = i;
+                _out->numValues++;
+                return true;
+            }
+        }
+
+        if (field.type == FieldType::FLOAT32) v.f = static_cast<float>(d);
+        else if (field.type == FieldType::FLOAT64) v.d = d;
+        else v.i = static_cast<int64_t>(d);
+        _out->numValues++;
+        return true;
+    }
+
+    template<typename... Args>
+    bool _fail(const char* fmt, Args... args) {
+        snprintf(_error, sizeof(_error), fmt, args...);
+        return false;
+    }
+
+    FieldInfo _fields[MAX_FIELDS];
+    size_t _fieldCount = 0;
+    Program _prog;
+    Program* _out = nullptr;  // Program being parsed
+    const char* _p = nullptr;
+    char _error[64] = "";
+};
+
+} // namespace cpy
+
+#endif // CAPYBARISH_FILTER_H
@@ -0,0 +1,398 @@
+/**
+ * @file capybarish_frame.h
+ * @brief Sequenced framing and forward error correction for pub/sub topics
+ *
+ * Plain topics put the raw message struct on the wire. When a topic needs
+ * per-message metadata (e.g. FEC), each datagram is prefixed with a 12-byte
+ * FrameHeader carrying a sequence number and the publisher's stream ID.
+ * Subscriptions detect framed datagrams by size and magic byte, so they
+ * accept both forms.
+ *
+ * FEC is a single XOR parity packet per group of K messages: any one lost
+ * message in a group is rebuilt as soon as the parity arrives, without a
+ * retransmission round trip. Overhead is 1/K extra packets.
+ *
+ * Redundant (multi-path) publishing sends every frame over several paths;
+ * SeqWindow drops the later copies in O(1) by sequence number. A topic port
+ * usually hears from several publishers, so subscriptions keep one window
+ * per stream ID in a StreamTable.
+ *
+ * The Python side (capybarish.framing) uses the same wire format.
+ *
+ * @author Chen Yu <chenyu@u.northwestern.edu>
+ * @copyright 2025 Chen Yu
+ * @license Apache-2.0
+ */
+
+#pragma once
+
+#ifndef CAPYBARISH_FRAME_H
+#define CAPYBARISH_FRAME_H
+
+#include <cstdint>
+#include <cstring>
+
+namespace cpy {
+
+// =============================================================================
+// Frame Header
+// =============================================================================
+
+constexpr uint8_t FRAME_MAGIC = 0xCB;
+
+/**
+ * @brief Frame flag bits
+ */
+enum FrameFlags : uint8_t {
+    FRAME_PARITY = 0x01  ///< Payload is the XOR of a FEC group
+};
+
+/**
+ * @brief Maximum FEC group size (K)
+ */
+constexpr uint8_t MAX_FEC_GROUP = 16;
+
+/**
+ * @brief Header prepended to framed datagrams (little endian on the wire)
+ */
+#pragma pack(push, 1)
+struct FrameHeader {
+    uint8_t magic = FRAME_MAGIC;
+    uint8_t flags = 0;
+    uint8_t fecK = 0;       ///< FEC group size, 0 if the stream has no parity
+    uint8_t fecIndex = 0;   ///< Position in the FEC group (K for parity)
+    uint32_t seq = 0;       ///< Message sequence number (group base for parity)
+    uint32_t stream = 0;    ///< Chosen at random by each publisher when it starts
+
+    bool isParity() const { return flags & FRAME_PARITY; }
+};
+#pragma pack(pop)
+static_assert(sizeof(FrameHeader) == 12, "FrameHeader must be 12 bytes");
+
+/**
+ * @brief Wrap-aware "a is newer than b" for 32-bit sequence numbers
+ */
+inline bool seqNewer(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) > 0;
+}
+
+/**
+ * @brief Check whether a datagram of @p len bytes is a frame carrying @p payloadSize
+ */
+inline bool isFrame(const uint8_t* data, size_t len, size_t payloadSize) {
+    return len == sizeof(FrameHeader) + payloadSize && data[0] == FRAME_MAGIC;
+}
+
+// =============================================================================
+// Duplicate Filter
+// =============================================================================
+
+/**
+ * @brief Sliding-window duplicate filter over sequence numbers
+ *
+ * Tracks the newest sequence number and a 64-bit bitmap of the ones before
+ * it, like an IPsec anti-replay window. Every check is a shift and a mask.
+ * A sequence number far behind the window is taken as a publisher restart.
+ * One window covers one publisher's stream (see StreamTable).
+ */
+class SeqWindow {
+public:
+    static constexpr uint32_t WINDOW = 64;
+    static constexpr uint32_t RESTART_GAP = 1024;
+
+    /**
+     * @brief Check a sequence number and mark it as seen
+     * @return true the first time @p seq is seen, false for duplicates/stale
+     */
+    bool accept(uint32_t seq) {
+        if (!_active) {
+            _reset(seq);
+            return true;
+        }
+
+        const int32_t ahead = static_cast<int32_t>(seq - _top);
+        if (ahead > 0) {
+            _bits = static_cast<uint32_t>(ahead) >= WINDOW ? 0 : _bits << ahead;
+            _bits |= 1;
+            _top = seq;
+            return true;
+        }
+
+        const uint32_t behind = static_cast<uint32_t>(-ahead);
+        if (behind >= WINDOW) {
+            if (behind > RESTART_GAP) {
+                _reset(seq);
+                return true;
+            }
+            return false;
+        }
+
+        const uint64_t bit = 1ull << behind;
+        if (_bits & bit) return false;
+        _bits |= bit;
+        return true;
+    }
+
+    void reset() { _active = false; }
+
+    /**
+     * @brief Newest sequence number accepted so far
+     */
+    uint32_t newest() const { return _top; }
+
+private:
+    void _reset(uint32_t seq) {
+        _active = true;
+        _top = seq;
+        _bits = 1;
+    }
+
+    bool _active = false;
+    uint32_t _top = 0;
+    uint64_t _bits = 0;
+};
+
+// =============================================================================
+// Stream Table
+// =============================================================================
+
+/**
+ * @brief Streams a subscription tracks at once
+ */
+constexpr size_t MAX_FRAME_STREAMS = 8;
+
+/**
+ * @brief Receive state per publisher stream, in a small fixed table
+ *
+ * Publishers pick a random stream ID when they start, so sequence numbers
+ * from different publishers never share a window, and a restarted
+ * publisher gets a fresh one. Copies sent over several paths (or NICs)
+ * carry the same ID and meet in the same entry. When the table is full,
+ * the stream heard from least recently is evicted.
+ *
+ * @tparam State Per-stream state (default constructible)
+ * @tparam S Number of entries
+ */
+template<typename State, size_t S = MAX_FRAME_STREAMS>
+class StreamTable {
+public:
+    /**
+     * @brief State for @p stream, claiming an entry if it is new
+     */
+    State& get(uint32_t stream) {
+        _clock++;
+        Entry* oldest = &_entries[0];
+        for (Entry& entry : _entries) {
+            if (entry.used && entry.stream == stream) {
+                entry.lastUsed = _clock;
+                return entry.state;
+            }
+            if (!entry.used) {
+                oldest = &entry;
+                break;
+            }
+            if (_clock - entry.lastUsed > _clock - oldest->lastUsed) oldest = &entry;  // Wrap-safe age
+        }
+
+        if (oldest->used) _evictedCount++;
+        oldest->used = true;
+        oldest->stream = stream;
+        oldest->lastUsed = _clock;
+        oldest->state = State{};
+        return oldest->state;
+    }
+
+    void reset() {
+        for (Entry& entry : _entries) entry.used = false;
+    }
+
+    /**
+     * @brief Streams dropped to make room for a new one
+     */
+    uint32_t evictedCount() const { return _evictedCount; }
+
+private:
+    struct Entry {
+        bool used = false;
+        uint32_t stream = 0;
+        uint32_t lastUsed = 0;
+        State state{};
+    };
+
+    Entry _entries[S];
+    uint32_t _clock = 0;
+    uint32_t _evictedCount = 0;
+};
+
+// =============================================================================
+// FEC Encoder
+// =============================================================================
+
+/**
+ * @brief Accumulates XOR parity over groups of K payloads
+ *
+ * @tparam N Payload size in bytes
+ */
+template<size_t N>
+class FecEncoder {
+public:
+    /**
+     * @brief Set the group size (0 disables FEC)
+     */
+    void configure(uint8_t k) {
+        _k = k > MAX_FEC_GROUP ? MAX_FEC_GROUP : k;
+        reset();
+    }
+
+    void reset() {
+        _count = 0;
+        memset(_parity, 0, N);
+    }
+
+    bool enabled() const { return _k > 1; }
+    uint8_t groupSize() const { return _k; }
+
+    /**
+     * @brief Index the next payload will take within its group
+     */
+    uint8_t nextIndex() const { return _count; }
+
+    /**
+     * @brief Fold a payload into the running parity
+     * @return true when the group is complete and parity() is ready to send
+     */
+    bool add(const uint8_t* payload) {
+        for (size_t i = 0; i < N; i++) {
+            _parity[i] ^= payload[i];
+        }
+        return ++_count == _k;
+    }
+
+    /**
+     * @brief Parity of the completed group (valid until the next add())
+     */
+    const uint8_t* parity() const { return _parity; }
+
+private:
+    uint8_t _k = 0;
+    uint8_t _count = 0;
+    uint8_t _parity[N];
+};
+
+// =============================================================================
+// FEC Decoder
+// =============================================================================
+
+/**
+ * @brief Result bits returned by FecDecoder::push()
+ */
+enum FecResult : uint8_t {
+    FEC_NONE      = 0,
+    FEC_DELIVER   = 0x01,  ///< Frame payload is a new message
+    FEC_RECOVERED = 0x02   ///< A lost message was rebuilt into the output buffer
+};
+
+/**
+ * @brief Rebuilds a single lost message per FEC group
+ *
+ * Keeps one running XOR of every data and parity payload seen in the current
+ * group. Once the parity and K-1 data payloads have arrived, that XOR is the
+ * missing message. Only the newest group is tracked: data frames from older
+ * groups are delivered without recovery (a reordered frame is not a loss),
+ * their parity is dropped. Duplicates within the group are dropped; across
+ * groups that is left to SeqWindow. One decoder follows one publisher's
+ * stream (see FrameStream).
+ *
+ * Parity is sent last, so a rebuilt message is usually older than data
+ * frames of its group that were already delivered.
+ *
+ * @tparam N Payload size in bytes
+ */
+template<size_t N>
+class FecDecoder {
+public:
+    /**
+     * @brief Feed one frame
+     *
+     * @param hdr Frame header
+     * @param payload Frame payload (N bytes)
+     * @param recovered Output buffer (N bytes) for a rebuilt message
+     * @return FecResult bits
+     */
+    uint8_t push(const FrameHeader& hdr, const uint8_t* payload, uint8_t* recovered) {
+        const bool parity = hdr.isParity();
+        const uint8_t k = hdr.fecK;
+
+        // Stream without FEC: every data frame is new
+        if (k < 2 || k > MAX_FEC_GROUP || (!parity && hdr.fecIndex >= k)) {
+            return parity ? FEC_NONE : FEC_DELIVER;
+        }
+
+        const uint32_t base = parity ? hdr.seq : hdr.seq - hdr.fecIndex;
+        if (!_active || k != _k || seqNewer(base, _base)) {
+            _active = true;
+            _k = k;
+            _base = base;
+            _mask = 0;
+            memset(_acc, 0, N);
+        } else if (base != _base) {
+            // Older group, already recovered or given up. Its data frames
+            // still count (reordered, e.g. by another path); SeqWindow
+            // drops the ones already delivered.
+            return parity ? FEC_NONE : FEC_DELIVER;
+        }
+
+        const uint32_t bit = 1u << (parity ? k : hdr.fecIndex);
+        if (_mask & bit) {
+            return FEC_NONE;  // Duplicate (or already rebuilt)
+        }
+        _mask |= bit;
+        for (size_t i = 0; i < N; i++) {
+            _acc[i] ^= payload[i];
+        }
+
+        uint8_t result = parity ? FEC_NONE : FEC_DELIVER;
+
+        const uint32_t dataMask = (1u << k) - 1;
+        const uint32_t missing = ~_mask & dataMask;
+        if ((_mask & (1u << k)) && missing != 0 && (missing & (missing - 1)) == 0) {
+            memcpy(recovered, _acc, N);
+            _recoveredSeq = _base + __builtin_ctz(missing);
+            _mask |= missing;
+            result |= FEC_RECOVERED;
+        }
+        return result;
+    }
+
+    /**
+     * @brief Sequence number of the last rebuilt message
+     */
+    uint32_t recoveredSeq() const { return _recoveredSeq; }
+
+private:
+    bool _active = false;
+    uint8_t _k = 0;
+    uint32_t _base = 0;
+    uint32_t _mask = 0;
+    uint32_t _recoveredSeq = 0;
+    uint8_t _acc[N];
+};
+
+// =============================================================================
+// Frame Stream
+// =============================================================================
+
+/**
+ * @brief Receive state of one publisher's framed stream
+ *
+ * @tparam N Payload size in bytes
+ */
+template<size_t N>
+struct FrameStream {
+    SeqWindow seen;
+    FecDecoder<N> fec;
+};
+
+} // namespace cpy
+
+#endif // CAPYBARISH_FRAME_H
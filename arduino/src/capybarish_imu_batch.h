@@ -0,0 +1,459 @@
+/**
+ * @file capybarish_imu_batch.h
+ * @brief Batched IMU estimation kernel (structure of arrays, SIMD / fixed point)
+ *
+ * Runs the IMU pipeline of plugins/imu_processor.py (bias removal,
+ * low-pass filtering, complementary orientation, gravity compensation) for
+ * every module in one pass, so estimation fits in the same tick as control.
+ *
+ * State is kept as one array per component (structure of arrays) and the
+ * kernel is written once against a small vector type:
+ *
+ * - simd::VecAvx2  8 float lanes (x86 with -mavx2)
+ * - simd::VecNeon  4 float lanes (ARM with NEON)
+ * - simd::VecFloat 1 lane, portable fallback
+ * - simd::Q24      1 lane, Q8.24 fixed point for cores without an FPU
+ *                  (ESP32-C3/S2) or when bit-exact results are needed
+ *
+ * The update only uses add, multiply and select: the accelerometer is
+ * scaled by 1/g instead of normalised, and the quaternion is renormalised
+ * with one Newton step, so there is no sqrt or divide in the hot loop.
+ * Orientation is a Mahony-style complementary filter: the gyro is
+ * integrated and corrected toward the measured gravity direction by @p kp,
+ * with the correction gated off while |a| is more than 20% away from g
+ * (impacts, free fall).
+ *
+ * @example
+ * @code
+ * cpy::ImuBatch<12> imus;               // Default backend for this target
+ * imus.configure(0.5f, 1.0f);           // Low-pass alpha, complementary gain
+ *
+ * // Each control tick
+ * for (size_t i = 0; i < 12; i++) imus.set(i, modules[i].imu);
+ * imus.step(0.001f);
+ * for (size_t i = 0; i < 12; i++) imus.get(i, estimates[i]);
+ * @endcode
+ *
+ * @author Chen Yu <chenyu@u.northwestern.edu>
+ * @copyright 2025 Chen Yu
+ * @license Apache-2.0
+ */
+
+#pragma once
+
+#ifndef CAPYBARISH_IMU_BATCH_H
+#define CAPYBARISH_IMU_BATCH_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace cpy {
+namespace simd {
+
+// =============================================================================
+// Vector Types
+// =============================================================================
+//
+// Each type provides: Scalar (storage type), LANES, load/store, a broadcast
+// constructor from float, operators + - *, and gate(x, lo, hi, v), which is
+// v where lo <= x <= hi and 0 elsewhere.
+
+/**
+ * @brief Portable single-lane float
+ */
+struct VecFloat {
+    using Scalar = float;
+    static constexpr size_t LANES = 1;
+
+    float v;
+
+    VecFloat() = default;
+    VecFloat(float x) : v(x) {}
+
+    static VecFloat load(const float* p) { return VecFloat(*p); }
+    void store(float* p) const { *p = v; }
+
+    static float toScalar(float x) { return x; }
+    static float toFloat(float x) { return x; }
+
+    friend VecFloat operator+(VecFloat a, VecFloat b) { return a.v + b.v; }
+    friend VecFloat operator-(VecFloat a, VecFloat b) { return a.v - b.v; }
+    friend VecFloat operator*(VecFloat a, VecFloat b) { return a.v * b.v; }
+
+    static VecFloat gate(VecFloat x, VecFloat lo, VecFloat hi, VecFloat val) {
+        return (x.v >= lo.v && x.v <= hi.v) ? val.v : 0.0f;
+    }
+};
+
+/**
+ * @brief Q8.24 fixed point (range +-128, resolution 6e-8)
+ *
+ * Values are clamped when converted from float; keep accelerations within
+ * +-128 m/s^2 (13 g). Products are formed in 64 bits.
+ */
+struct Q24 {
+    using Scalar = int32_t;
+    static constexpr size_t LANES = 1;
+    static constexpr int FRAC = 24;
+
+    int32_t v;
+
+    Q24() = default;
+    Q24(float x) : v(toScalar(x)) {}
+
+    static Q24 raw(int32_t x) {
+        Q24 q;
+        q.v = x;
+        return q;
+    }
+
+    static Q24 load(const int32_t* p) { return raw(*p); }
+    void store(int32_t* p) const { *p = v; }
+
+    static int32_t toScalar(float x) {
+        const float s = x * static_cast<float>(1 << FRAC);
+        if (!(s > -2147483520.0f)) return INT32_MIN;  // Also catches NaN
+        if (s >= 2147483520.0f) return INT32_MAX;
+        return static_cast<int32_t>(s);
+    }
+
+    static float toFloat(int32_t x) { return static_cast<float>(x) * (1.0f / (1 << FRAC)); }
+
+    friend Q24 operator+(Q24 a, Q24 b) { return raw(a.v + b.v); }
+    friend Q24 operator-(Q24 a, Q24 b) { return raw(a.v - b.v); }
+    friend Q24 operator*(Q24 a, Q24 b) {
+        return raw(static_cast<int32_t>((static_cast<int64_t>(a.v) * b.v) >> FRAC));
+    }
+
+    static Q24 gate(Q24 x, Q24 lo, Q24 hi, Q24 val) {
+        return raw((x.v >= lo.v && x.v <= hi.v) ? val.v : 0);
+    }
+};
+
+#if defined(__AVX2__)
+
+/**
+ * @brief 8 float lanes (AVX2)
+ */
+struct VecAvx2 {
+    using Scalar = float;
+    static constexpr size_t LANES = 8;
+
+    __m256 v;
+
+    VecAvx2() = default;
+    VecAvx2(__m256 x) : v(x) {}
+    VecAvx2(float x) : v(_mm256_set1_ps(x)) {}
+
+    static VecAvx2 load(const float* p) { return _mm256_load_ps(p); }
+    void store(float* p) const { _mm256_store_ps(p, v); }
+
+    static float toScalar(float x) { return x; }
+    static float toFloat(float x) { return x; }
+
+    friend VecAvx2 operator+(VecAvx2 a, VecAvx2 b) { return _mm256_add_ps(a.v, b.v); }
+    friend VecAvx2 operator-(VecAvx2 a, VecAvx2 b) { return _mm256_sub_ps(a.v, b.v); }
+    friend VecAvx2 operator*(VecAvx2 a, VecAvx2 b) { return _mm256_mul_ps(a.v, b.v); }
+
+    static VecAvx2 gate(VecAvx2 x, VecAvx2 lo, VecAvx2 hi, VecAvx2 val) {
+        const __m256 in = _mm256_and_ps(_mm256_cmp_ps(x.v, lo.v, _CMP_GE_OQ),
+                                        _mm256_cmp_ps(x.v, hi.v, _CMP_LE_OQ));
+        return _mm256_and_ps(in, val.v);
+    }
+};
+
+using VecDefault = VecAvx2;
+
+#elif defined(__ARM_NEON)
+
+/**
+ * @brief 4 float lanes (NEON)
+ */
+struct VecNeon {
+    using Scalar = float;
+    static constexpr size_t LANES = 4;
+
+    float32x4_t v;
+
+    VecNeon() = default;
+    VecNeon(float32x4_t x) : v(x) {}
+    VecNeon(float x) : v(vdupq_n_f32(x)) {}
+
+    static VecNeon load(const float* p) { return vld1q_f32(p); }
+    void store(float* p) const { vst1q_f32(p, v); }
+
+    static float toScalar(float x) { return x; }
+    static float toFloat(float x) { return x; }
+
+    friend VecNeon operator+(VecNeon a, VecNeon b) { return vaddq_f32(a.v, b.v); }
+    friend VecNeon operator-(VecNeon a, VecNeon b) { return vsubq_f32(a.v, b.v); }
+    friend VecNeon operator*(VecNeon a, VecNeon b) { return vmulq_f32(a.v, b.v); }
+
+    static VecNeon gate(VecNeon x, VecNeon lo, VecNeon hi, VecNeon val) {
+        const uint32x4_t in = vandq_u32(vcgeq_f32(x.v, lo.v), vcleq_f32(x.v, hi.v));
+        return vreinterpretq_f32_u32(vandq_u32(in, vreinterpretq_u32_f32(val.v)));
+    }
+};
+
+using VecDefault = VecNeon;
+
+#else
+
+using VecDefault = VecFloat;
+
+#endif
+
+} // namespace simd
+
+// =============================================================================
+// IMU Batch
+// =============================================================================
+
+/**
+ * @brief IMU state for N modules, updated together by step()
+ *
+ * Body-frame inputs: omega (rad/s) and acceleration (m/s^2, +g on the z
+ * axis when level and at rest). Quaternions rotate body to world (z up).
+ *
+ * @tparam N Number of modules
+ * @tparam V Vector type from cpy::simd (default: widest available)
+ */
+template<size_t N, typename V = simd::VecDefault>
+class ImuBatch {
+public:
+    using Scalar = typename V::Scalar;
+    static constexpr size_t LANES = V::LANES;
+    static constexpr size_t PADDED = (N + LANES - 1) / LANES * LANES;
+    static constexpr float GRAVITY = 9.81f;
+
+    ImuBatch() {
+        for (size_t i = 0; i < PADDED; i++) {
+            _resetLane(i);
+            for (int c = 0; c < 3; c++) {
+                _gyroBias[c][i] = V::toScalar(0.0f);
+                _accBias[c][i] = V::toScalar(0.0f);
+            }
+        }
+    }
+
+    /**
+     * @param alpha Low-pass factor for gyro and accelerometer (1 = off)
+     * @param kp Complementary gain toward the accelerometer (rad/s per unit error)
+     */
+    void configure(float alpha, float kp) {
+        _alpha = alpha;
+        _kp = kp;
+    }
+
+    /**
+     * @brief Calibration offsets subtracted from raw samples of module @p i
+     */
+    void setBias(size_t i, const float gyro[3], const float acc[3]) {
+        for (int c = 0; c < 3; c++) {
+            _gyroBias[c][i] = V::toScalar(gyro[c]);
+            _accBias[c][i] = V::toScalar(acc[c]);
+        }
+    }
+
+    /**
+     * @brief Forget the estimate of module @p i; the next sample re-seeds it
+     */
+    void reset(size_t i) { _resetLane(i); }
+
+    /**
+     * @brief Store the raw sample of module @p i for the next step()
+     *
+     * The first sample after reset() seeds the filters and the tilt.
+     *
+     * @tparam ImuT Generated IMUData (or any struct with omega/acceleration)
+     */
+    template<typename ImuT>
+    void set(size_t i, const ImuT& imu) {
+        const float gyro[3] = {imu.omega.x, imu.omega.y, imu.omega.z};
+        const float acc[3] = {imu.acceleration.x, imu.acceleration.y, imu.acceleration.z};
+        for (int c = 0; c < 3; c++) {
+            _gyro[c][i] = V::toScalar(gyro[c] - V::toFloat(_gyroBias[c][i]));
+            _acc[c][i] = V::toScalar(acc[c] - V::toFloat(_accBias[c][i]));
+        }
+        if (!_primed[i]) _seed(i);
+    }
+
+    /**
+     * @brief Advance every module by @p dt seconds
+     */
+    void step(float dt) {
+        const V alpha(_alpha);
+        const V halfDt(0.5f * dt);
+        const V invG(1.0f / GRAVITY);
+        const V g(GRAVITY);
+        const V two(2.0f);
+        const V threeHalves(1.5f);
+        const V half(0.5f);
+        const V gateLo(0.64f);  // (0.8 g)^2
+        const V gateHi(1.44f);  // (1.2 g)^2
+        const V kp(_kp);
+
+        for (size_t i = 0; i < PADDED; i += LANES) {
+            // Low-pass
+            V gx = _lowPass(_fGyro[0] + i, _gyro[0] + i, alpha);
+            V gy = _lowPass(_fGyro[1] + i, _gyro[1] + i, alpha);
+            V gz = _lowPass(_fGyro[2] + i, _gyro[2] + i, alpha);
+            const V ax = _lowPass(_fAcc[0] + i, _acc[0] + i, alpha);
+            const V ay = _lowPass(_fAcc[1] + i, _acc[1] + i, alpha);
+            const V az = _lowPass(_fAcc[2] + i, _acc[2] + i, alpha);
+
+            V qw = V::load(_q[0] + i);
+            V qx = V::load(_q[1] + i);
+            V qy = V::load(_q[2] + i);
+            V qz = V::load(_q[3] + i);
+
+            // Predicted gravity direction in the body frame
+            V vx = two * (qx * qz - qw * qy);
+            V vy = two * (qw * qx + qy * qz);
+            V vz = qw * qw - qx * qx - qy * qy + qz * qz;
+
+            // Correction toward the measured gravity direction
+            const V nx = ax * invG;
+            const V ny = ay * invG;
+            const V nz = az * invG;
+            const V w = V::gate(nx * nx + ny * ny + nz * nz, gateLo, gateHi, kp);
+            gx = gx + w * (ny * vz - nz * vy);
+            gy = gy + w * (nz * vx - nx * vz);
+            gz = gz + w * (nx * vy - ny * vx);
+
+            // q += dt/2 * q (x) (0, omega)
+            const V dw = V(0.0f) - qx * gx - qy * gy - qz * gz;
+            const V dx = qw * gx + qy * gz - qz * gy;
+            const V dy = qw * gy - qx * gz + qz * gx;
+            const V dz = qw * gz + qx * gy - qy * gx;
+            qw = qw + halfDt * dw;
+            qx = qx + halfDt * dx;
+            qy = qy + halfDt * dy;
+            qz = qz + halfDt * dz;
+
+            // One Newton step toward |q| = 1 (|q| stays within 1e-3 per tick)
+            const V s = threeHalves - half * (qw * qw + qx * qx + qy * qy + qz * qz);
+            qw = qw * s;
+            qx = qx * s;
+            qy = qy * s;
+            qz = qz * s;
+            qw.store(_q[0] + i);
+            qx.store(_q[1] + i);
+            qy.store(_q[2] + i);
+            qz.store(_q[3] + i);
+
+            // Gravity compensation with the updated attitude
+            vx = two * (qx * qz - qw * qy);
+            vy = two * (qw * qx + qy * qz);
+            vz = qw * qw - qx * qx - qy * qy + qz * qz;
+            (ax - g * vx).store(_linAcc[0] + i);
+            (ay - g * vy).store(_linAcc[1] + i);
+            (az - g * vz).store(_linAcc[2] + i);
+        }
+    }
+
+    /**
+     * @brief Write the estimate of module @p i
+     *
+     * Sets quaternion and orientation (roll/pitch/yaw), omega to the
+     * filtered rate and acceleration to the gravity-compensated value.
+     */
+    template<typename ImuT>
+    void get(size_t i, ImuT& imu) const {
+        const float w = V::toFloat(_q[0][i]);
+        const float x = V::toFloat(_q[1][i]);
+        const float y = V::toFloat(_q[2][i]);
+        const float z = V::toFloat(_q[3][i]);
+        imu.quaternion.w = w;
+        imu.quaternion.x = x;
+        imu.quaternion.y = y;
+        imu.quaternion.z = z;
+
+        float sinp = 2.0f * (w * y - z * x);
+        sinp = sinp > 1.0f ? 1.0f : (sinp < -1.0f ? -1.0f : sinp);
+        imu.orientation.x = atan2f(2.0f * (w * x + y * z), 1.0f - 2.0f * (x * x + y * y));
+        imu.orientation.y = asinf(sinp);
+        imu.orientation.z = atan2f(2.0f * (w * z + x * y), 1.0f - 2.0f * (y * y + z * z));
+
+        imu.omega.x = V::toFloat(_fGyro[0][i]);
+        imu.omega.y = V::toFloat(_fGyro[1][i]);
+        imu.omega.z = V::toFloat(_fGyro[2][i]);
+        imu.acceleration.x = V::toFloat(_linAcc[0][i]);
+        imu.acceleration.y = V::toFloat(_linAcc[1][i]);
+        imu.acceleration.z = V::toFloat(_linAcc[2][i]);
+    }
+
+    /**
+     * @brief Gravity-compensated acceleration of module @p i, axis 0-2
+     */
+    float linearAcceleration(size_t i, int axis) const { return V::toFloat(_linAcc[axis][i]); }
+
+    /**
+     * @brief Quaternion component of module @p i (0 = w, 1-3 = x, y, z)
+     */
+    float quaternion(size_t i, int component) const { return V::toFloat(_q[component][i]); }
+
+    static constexpr size_t size() { return N; }
+
+private:
+    static V _lowPass(Scalar* filtered, const Scalar* raw, const V& alpha) {
+        const V f = V::load(filtered);
+        const V y = f + alpha * (V::load(raw) - f);
+        y.store(filtered);
+        return y;
+    }
+
+    void _resetLane(size_t i) {
+        _primed[i] = false;
+        _q[0][i] = V::toScalar(1.0f);
+        for (int c = 0; c < 3; c++) {
+            _q[c + 1][i] = V::toScalar(0.0f);
+            _gyro[c][i] = _acc[c][i] = V::toScalar(0.0f);
+            _fGyro[c][i] = _fAcc[c][i] = V::toScalar(0.0f);
+            _linAcc[c][i] = V::toScalar(0.0f);
+        }
+    }
+
+    // Start from the raw sample and the accelerometer tilt (yaw = 0)
+    void _seed(size_t i) {
+        const float ax = V::toFloat(_acc[0][i]);
+        const float ay = V::toFloat(_acc[1][i]);
+        const float az = V::toFloat(_acc[2][i]);
+        const float roll = atan2f(ay, az);
+        const float pitch = atan2f(-ax, sqrtf(ay * ay + az * az));
+        const float cr = cosf(0.5f * roll), sr = sinf(0.5f * roll);
+        const float cp = cosf(0.5f * pitch), sp = sinf(0.5f * pitch);
+        _q[0][i] = V::toScalar(cr * cp);
+        _q[1][i] = V::toScalar(sr * cp);
+        _q[2][i] = V::toScalar(cr * sp);
+        _q[3][i] = V::toScalar(-sr * sp);
+        for (int c = 0; c < 3; c++) {
+            _fGyro[c][i] = _gyro[c][i];
+            _fAcc[c][i] = _acc[c][i];
+        }
+        _primed[i] = true;
+    }
+
+    alignas(32) Scalar _q[4][PADDED];
+    alignas(32) Scalar _gyro[3][PADDED];
+    alignas(32) Scalar _acc[3][PADDED];
+    alignas(32) Scalar _fGyro[3][PADDED];
+    alignas(32) Scalar _fAcc[3][PADDED];
+    alignas(32) Scalar _linAcc[3][PADDED];
+    Scalar _gyroBias[3][PADDED];
+    Scalar _accBias[3][PADDED];
+    bool _primed[PADDED];
+    float _alpha = 1.0f;
+    float _kp = 1.0f;
+};
+
+} // namespace cpy
+
+#endif // CAPYBARISH_IMU_BATCH_H
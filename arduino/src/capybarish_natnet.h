@@ -0,0 +1,357 @@
+/**
+ * @file capybarish_natnet.h
+ * @brief NatNet (OptiTrack Motive) frame parser for rigid body poses
+ *
+ * Decodes NatNet 3.x/4.x frame-of-data packets straight into generated
+ * pose messages (multi_robot::MocapPose), stamped with the camera
+ * mid-exposure time, so mocap ground truth can be published as a topic
+ * without going through capybarish/natnet/NatNetClient.py.
+ *
+ * Only what is needed for rigid bodies is read. With NatNet 4.1+ every data
+ * section is prefixed with its size, so marker sets, skeletons, assets,
+ * labeled markers, force plates and devices are skipped in one step, and
+ * rigid bodies are visited at a fixed 38-byte stride, decoding only the
+ * tracked IDs. NatNet 3.0-4.0 packets are walked section by section. Every
+ * read is bounds checked; a truncated or malformed packet yields no poses.
+ *
+ * Portable (no Arduino dependency): use it on a module with WiFiUDP or on
+ * the host with a plain socket.
+ *
+ * @example
+ * @code
+ * cpy::natnet::FrameParser<> parser;  // NatNet 4.1 by default
+ * parser.track(1);                    // Only rigid bodies 1 and 2
+ * parser.track(2);
+ *
+ * multi_robot::MocapPose poses[2];
+ * size_t n = parser.parse(packet, len, poses, 2);
+ * for (size_t i = 0; i < n; i++) posePub->publish(poses[i]);
+ * @endcode
+ *
+ * @author Chen Yu <chenyu@u.northwestern.edu>
+ * @copyright 2025 Chen Yu
+ * @license Apache-2.0
+ */
+
+#pragma once
+
+#ifndef CAPYBARISH_NATNET_H
+#define CAPYBARISH_NATNET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace cpy {
+namespace natnet {
+
+// =============================================================================
+// Protocol Constants
+// =============================================================================
+
+constexpr uint16_t NAT_CONNECT = 0;
+constexpr uint16_t NAT_SERVERINFO = 1;
+constexpr uint16_t NAT_FRAMEOFDATA = 7;
+
+constexpr uint16_t COMMAND_PORT = 1510;
+constexpr uint16_t DATA_PORT = 1511;
+constexpr const char* DEFAULT_MULTICAST = "239.255.42.99";
+
+/// Rigid body record since NatNet 3.0: id, position, quaternion, error, params
+constexpr size_t RIGID_BODY_SIZE = 4 + 12 + 16 + 4 + 2;
+/// Labeled marker record since NatNet 3.0: id, position, size, params, residual
+constexpr size_t LABELED_MARKER_SIZE = 4 + 12 + 4 + 2 + 4;
+
+/**
+ * @brief Frame-level fields (prefix and suffix)
+ */
+struct FrameInfo {
+    int32_t frameNumber = 0;
+    uint32_t timecode = 0;
+    uint32_t timecodeSub = 0;
+    double timestamp = 0.0;           ///< Seconds since Motive started streaming
+    uint64_t cameraMidExposure = 0;   ///< Host high-resolution clock ticks
+    uint64_t dataReceived = 0;
+    uint64_t transmit = 0;
+    int16_t params = 0;               ///< Bit 0 recording, bit 1 tracked models changed
+    uint16_t rigidBodyCount = 0;      ///< Rigid bodies in the frame (tracked or not)
+};
+
+// =============================================================================
+// Bounds-Checked Reader
+// =============================================================================
+
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t len) : _p(data), _end(data + len) {}
+
+    bool ok() const { return _ok; }
+    size_t remaining() const { return _ok ? static_cast<size_t>(_end - _p) : 0; }
+    const uint8_t* ptr() const { return _p; }
+
+    bool skip(size_t n) {
+        if (!_ok || n > static_cast<size_t>(_end - _p)) return _ok = false;
+        _p += n;
+        return true;
+    }
+
+    template<typename T>
+    T read() {
+        T v{};
+        if (skip(sizeof(T))) memcpy(&v, _p - sizeof(T), sizeof(T));
+        return v;
+    }
+
+    /**
+     * @brief Read a count, rejecting negative values
+     */
+    uint32_t count() {
+        const int32_t n = read<int32_t>();
+        if (n < 0) _ok = false;
+        return _ok ? static_cast<uint32_t>(n) : 0;
+    }
+
+    /**
+     * @brief Skip @p n records of @p size bytes without overflowing
+     */
+    bool skipRecords(uint32_t n, size_t size) {
+        if (size != 0 && n > remaining() / size) return _ok = false;
+        return skip(n * size);
+    }
+
+    bool skipString() {
+        if (!_ok) return false;
+        const void* nul = memchr(_p, 0, static_cast<size_t>(_end - _p));
+        if (!nul) return _ok = false;
+        _p = static_cast<const uint8_t*>(nul) + 1;
+        return true;
+    }
+
+private:
+    const uint8_t* _p;
+    const uint8_t* _end;
+    bool _ok = true;
+};
+
+// =============================================================================
+// Frame Parser
+// =============================================================================
+
+/**
+ * @brief Extracts rigid body poses from NatNet frame-of-data packets
+ *
+ * @tparam MAX_TRACKED Maximum number of IDs passed to track()
+ */
+template<size_t MAX_TRACKED = 16>
+class FrameParser {
+public:
+    explicit FrameParser(uint8_t major = 4, uint8_t minor = 1) { setVersion(major, minor); }
+
+    /**
+     * @brief NatNet bitstream version sent by the server
+     */
+    void setVersion(uint8_t major, uint8_t minor) {
+        _major = major;
+        _minor = minor;
+    }
+
+    /**
+     * @brief Ticks per second of the server's high-resolution clock
+     *
+     * Needed to convert cameraMidExposure to microseconds; it arrives in the
+     * server info reply (see parseServerInfo()). Without it, poses are
+     * stamped with the frame timestamp instead.
+     */
+    void setClockFrequency(uint64_t hz) { _clockHz = hz; }
+
+    /**
+     * @brief Take version and clock frequency from a NAT_SERVERINFO reply
+     */
+    bool parseServerInfo(const uint8_t* data, size_t len) {
+        Reader r(data, len);
+        if (r.read<uint16_t>() != NAT_SERVERINFO) return false;
+        r.skip(2 + 256 + 4);  // Size, application name, application version
+        const uint8_t major = r.read<uint8_t>();
+        const uint8_t minor = r.read<uint8_t>();
+        r.skip(2);
+        const uint64_t hz = r.read<uint64_t>();
+        if (!r.ok()) return false;
+        setVersion(major, minor);
+        setClockFrequency(hz);
+        return true;
+    }
+
+    /**
+     * @brief Only decode rigid body @p id (call once per body)
+     *
+     * With no tracked IDs, every rigid body is decoded.
+     */
+    bool track(int32_t id) {
+        for (size_t i = 0; i < _trackedCount; i++) {
+            if (_tracked[i] == id) return true;
+        }
+        if (_trackedCount >= MAX_TRACKED) return false;
+        _tracked[_trackedCount++] = id;
+        return true;
+    }
+
+    void clearTracked() { _trackedCount = 0; }
+
+    /**
+     * @brief Decode the tracked rigid bodies of one packet
+     *
+     * @tparam PoseT Generated MocapPose (body_id, frame_number, timestamp_us,
+     *               pose.position, pose.orientation, mean_error, tracking_valid)
+     * @param out Output poses
+     * @param capacity Size of @p out; further bodies are ignored
+     * @return Number of poses written (0 for other messages or bad packets)
+     */
+    template<typename PoseT>
+    size_t parse(const uint8_t* data, size_t len, PoseT* out, size_t capacity) {
+        Reader r(data, len);
+        if (r.read<uint16_t>() != NAT_FRAMEOFDATA) return 0;
+        const uint16_t size = r.read<uint16_t>();
+        if (!r.ok() || size > r.remaining()) return 0;
+        r = Reader(r.ptr(), size);
+
+        _frame = FrameInfo();
+        _frame.frameNumber = r.read<int32_t>();
+        if (_major < 3) return 0;
+
+        const bool sized = _major > 4 || (_major == 4 && _minor >= 1);
+        size_t n = 0;
+
+        if (sized) {
+            _skipSection(r);  // Marker sets
+            _skipSection(r);  // Legacy unlabeled markers
+            const uint32_t bodies = r.count();
+            r.read<int32_t>();
+            n = _rigidBodies(r, bodies, out, capacity);
+            _skipSection(r);  // Skeletons
+            _skipSection(r);  // Assets
+            _skipSection(r);  // Labeled markers
+            _skipSection(r);  // Force plates
+            _skipSection(r);  // Devices
+        } else {
+            for (uint32_t sets = r.count(), i = 0; i < sets && r.ok(); i++) {
+                r.skipString();
+                r.skipRecords(r.count(), 12);
+            }
+            r.skipRecords(r.count(), 12);
+            n = _rigidBodies(r, r.count(), out, capacity);
+            for (uint32_t skeletons = r.count(), i = 0; i < skeletons && r.ok(); i++) {
+                r.skip(4);
+                r.skipRecords(r.count(), RIGID_BODY_SIZE);
+            }
+            r.skipRecords(r.count(), LABELED_MARKER_SIZE);
+            _skipAnalog(r);  // Force plates
+            _skipAnalog(r);  // Devices
+        }
+
+        _frame.timecode = r.read<uint32_t>();
+        _frame.timecodeSub = r.read<uint32_t>();
+        _frame.timestamp = r.read<double>();
+        _frame.cameraMidExposure = r.read<uint64_t>();
+        _frame.dataReceived = r.read<uint64_t>();
+        _frame.transmit = r.read<uint64_t>();
+        if (sized) r.skip(8);  // Precision timestamp (PTP seconds, fraction)
+        _frame.params = r.read<int16_t>();
+        if (!r.ok()) return 0;
+
+        const uint64_t stamp = captureTimeUs();
+        for (size_t i = 0; i < n; i++) {
+            out[i].frame_number = _frame.frameNumber;
+            out[i].timestamp_us = stamp;
+        }
+        return n;
+    }
+
+    /**
+     * @brief Fields of the last packet passed to parse()
+     */
+    const FrameInfo& frame() const { return _frame; }
+
+    /**
+     * @brief Capture time of the last frame in microseconds
+     *
+     * Camera mid-exposure on the server clock if its frequency is known,
+     * otherwise the frame timestamp.
+     */
+    uint64_t captureTimeUs() const {
+        if (_clockHz > 0) {
+            const uint64_t t = _frame.cameraMidExposure;
+            return (t / _clockHz) * 1000000ULL + (t % _clockHz) * 1000000ULL / _clockHz;
+        }
+        return _frame.timestamp > 0.0 ? static_cast<uint64_t>(_frame.timestamp * 1e6) : 0;
+    }
+
+private:
+    bool _wanted(int32_t id) const {
+        if (_trackedCount == 0) return true;
+        for (size_t i = 0; i < _trackedCount; i++) {
+            if (_tracked[i] == id) return true;
+        }
+        return false;
+    }
+
+    template<typename PoseT>
+    size_t _rigidBodies(Reader& r, uint32_t count, PoseT* out, size_t capacity) {
+        const uint8_t* base = r.ptr();
+        if (!r.skipRecords(count, RIGID_BODY_SIZE)) return 0;
+        _frame.rigidBodyCount = static_cast<uint16_t>(count);
+
+        size_t n = 0;
+        for (uint32_t i = 0; i < count && n < capacity; i++) {
+            const uint8_t* p = base + i * RIGID_BODY_SIZE;
+            int32_t id;
+            memcpy(&id, p, 4);
+            if (!_wanted(id)) continue;
+
+            float v[8];
+            int16_t params;
+            memcpy(v, p + 4, sizeof(v));  // Position, quaternion (x, y, z, w), error
+            memcpy(&params, p + 36, 2);
+
+            PoseT& pose = out[n++];
+            pose.body_id = id;
+            pose.pose.position.x = v[0];
+            pose.pose.position.y = v[1];
+            pose.pose.position.z = v[2];
+            pose.pose.orientation.x = v[3];
+            pose.pose.orientation.y = v[4];
+            pose.pose.orientation.z = v[5];
+            pose.pose.orientation.w = v[6];
+            pose.mean_error = v[7];
+            pose.tracking_valid = params & 0x01;
+        }
+        return n;
+    }
+
+    // NatNet 4.1+: count, byte size, payload
+    static void _skipSection(Reader& r) {
+        r.skip(4);
+        r.skip(r.count());
+    }
+
+    // Force plates / devices before 4.1: id, channels of (frame count, floats)
+    static void _skipAnalog(Reader& r) {
+        for (uint32_t items = r.count(), i = 0; i < items && r.ok(); i++) {
+            r.skip(4);
+            for (uint32_t channels = r.count(), c = 0; c < channels && r.ok(); c++) {
+                r.skipRecords(r.count(), 4);
+            }
+        }
+    }
+
+    uint8_t _major = 4;
+    uint8_t _minor = 1;
+    uint64_t _clockHz = 0;
+    int32_t _tracked[MAX_TRACKED];
+    size_t _trackedCount = 0;
+    FrameInfo _frame;
+};
+
+} // namespace natnet
+} // namespace cpy
+
+#endif // CAPYBARISH_NATNET_H
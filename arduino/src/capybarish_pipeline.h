@@ -0,0 +1,463 @@
+/**
+ * @file capybarish_pipeline.h
+ * @brief Message processing pipelines composed at compile time or from config
+ *
+ * Native counterpart of the Python DataProcessorPlugin chain, fast enough
+ * for a 1 kHz control loop. Stages are small value types (filters, unit
+ * conversion, safety clamps) applied in order to a generated message:
+ *
+ * - cpy::Pipeline<Stages...> is composed at compile time. Every stage is a
+ *   member of a tuple and called directly, so the whole chain inlines into
+ *   straight-line code with no virtual calls and no allocation.
+ * - cpy::ProcessorChain<Msg> is built at run time by a
+ *   cpy::ProcessorRegistry<Msg> from a text spec, e.g. read from a config
+ *   file on the host. Each stage costs one indirect call; the chain is
+ *   allocated once when it is loaded.
+ *
+ * Both use the same filters, so a chain prototyped from config can be
+ * frozen into a Pipeline for the module without changing its behaviour.
+ * A stage returns false to drop the message (e.g. a NaN target).
+ *
+ * @example
+ * @code
+ * using namespace motor_control;
+ *
+ * // Compile time: degrees -> radians, smooth, then clamp to the joint range
+ * auto pipeline = cpy::makePipeline(
+ *     cpy::on<&MotorCommand::target>(cpy::Finite{}),
+ *     cpy::on<&MotorCommand::target>(cpy::Scale{0.0174533f}),
+ *     cpy::on<&MotorCommand::target>(cpy::LowPass{0.2f}),
+ *     cpy::on<&MotorCommand::target>(cpy::Clamp{-1.5f, 1.5f}),
+ *     [](MotorCommand& cmd) { cmd.kp = cmd.kp > 40.0f ? 40.0f : cmd.kp; });
+ *
+ * MotorCommand cmd;
+ * if (sub->take(cmd) && pipeline(cmd)) { ... }
+ *
+ * // Run time (host): same chain loaded from config
+ * cpy::ProcessorRegistry<MotorCommand> registry;
+ * registry.addField("target", &MotorCommand::target);
+ * cpy::ProcessorChain<MotorCommand> chain;
+ * if (!registry.load("finite target; scale target 0.0174533; "
+ *                    "lowpass target 0.2; clamp target -1.5 1.5", chain)) {
+ *     printf("%s\n", registry.lastError());
+ * }
+ * @endcode
+ *
+ * @author Chen Yu <chenyu@u.northwestern.edu>
+ * @copyright 2025 Chen Yu
+ * @license Apache-2.0
+ */
+
+#pragma once
+
+#ifndef CAPYBARISH_PIPELINE_H
+#define CAPYBARISH_PIPELINE_H
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace cpy {
+
+// =============================================================================
+// Field Filters
+// =============================================================================
+//
+// A filter processes one float in place and returns false to drop the
+// message. Filters with state provide reset().
+
+/**
+ * @brief Unit conversion: x * gain + offset
+ */
+struct Scale {
+    float gain = 1.0f;
+    float offset = 0.0f;
+
+    bool operator()(float& x) const {
+        x = x * gain + offset;
+        return true;
+    }
+};
+
+/**
+ * @brief Safety clamp to [lo, hi]
+ */
+struct Clamp {
+    float lo;
+    float hi;
+
+    bool operator()(float& x) const {
+        x = x < lo ? lo : (x > hi ? hi : x);
+        return true;
+    }
+};
+
+/**
+ * @brief Drop the message if the value is NaN or infinite
+ */
+struct Finite {
+    bool operator()(float& x) const { return std::isfinite(x); }
+};
+
+/**
+ * @brief First-order low-pass: y += alpha * (x - y)
+ *
+ * The first sample passes through unchanged.
+ */
+struct LowPass {
+    float alpha;
+    float y = 0.0f;
+    bool primed = false;
+
+    explicit LowPass(float a) : alpha(a) {}
+
+    bool operator()(float& x) {
+        y = primed ? y + alpha * (x - y) : x;
+        primed = true;
+        x = y;
+        return true;
+    }
+
+    void reset() { primed = false; }
+};
+
+/**
+ * @brief Limit the change between consecutive messages to maxStep
+ */
+struct RateLimit {
+    float maxStep;
+    float last = 0.0f;
+    bool primed = false;
+
+    explicit RateLimit(float step) : maxStep(step) {}
+
+    bool operator()(float& x) {
+        if (primed) {
+            const float d = x - last;
+            if (d > maxStep) x = last + maxStep;
+            else if (d < -maxStep) x = last - maxStep;
+        }
+        last = x;
+        primed = true;
+        return true;
+    }
+
+    void reset() { primed = false; }
+};
+
+// =============================================================================
+// Compile-Time Pipeline
+// =============================================================================
+
+/**
+ * @brief Apply a filter to one float field of a message
+ *
+ * Generated messages are packed, so the field is copied in and out rather
+ * than bound by reference; the copies vanish after inlining.
+ */
+template<auto Field, typename Filter>
+struct On {
+    Filter filter;
+
+    template<typename Msg>
+    bool operator()(Msg& msg) {
+        float value = msg.*Field;
+        const bool keep = filter(value);
+        msg.*Field = value;
+        return keep;
+    }
+
+    void reset() {
+        if constexpr (requires { filter.reset(); }) filter.reset();
+    }
+};
+
+template<auto Field, typename Filter>
+constexpr On<Field, Filter> on(Filter filter) {
+    return On<Field, Filter>{filter};
+}
+
+/**
+ * @brief Stages applied in order; stops at the first stage returning false
+ *
+ * Stages are field stages from on<>() or any callable taking the message by
+ * reference and returning bool (keep) or void.
+ */
+template<typename... Stages>
+class Pipeline {
+public:
+    constexpr explicit Pipeline(Stages... stages) : _stages(stages...) {}
+
+    /**
+     * @brief Run every stage on @p msg
+     * @return false if a stage dropped the message
+     */
+    template<typename Msg>
+    bool operator()(Msg& msg) {
+        return std::apply([&msg](auto&... stage) { return (_run(stage, msg) && ...); }, _stages);
+    }
+
+    /**
+     * @brief Clear filter state (e.g. after a reconnect)
+     */
+    void reset() {
+        std::apply([](auto&... stage) { (_reset(stage), ...); }, _stages);
+    }
+
+    static constexpr size_t size() { return sizeof...(Stages); }
+
+private:
+    template<typename Stage, typename Msg>
+    static bool _run(Stage& stage, Msg& msg) {
+        if constexpr (std::is_void_v<decltype(stage(msg))>) {
+            stage(msg);
+            return true;
+        } else {
+            return stage(msg);
+        }
+    }
+
+    template<typename Stage>
+    static void _reset(Stage& stage) {
+        if constexpr (requires { stage.reset(); }) stage.reset();
+    }
+
+    std::tuple<Stages...> _stages;
+};
+
+template<typename... Stages>
+constexpr Pipeline<Stages...> makePipeline(Stages... stages) {
+    return Pipeline<Stages...>(stages...);
+}
+
+// =============================================================================
+// Runtime Chain and Registry
+// =============================================================================
+
+/**
+ * @brief Processing chain assembled at run time (see ProcessorRegistry)
+ */
+template<typename Msg>
+class ProcessorChain {
+public:
+    using Stage = std::function<bool(Msg&)>;
+
+    bool operator()(Msg& msg) {
+        for (auto& stage : _stages) {
+            if (!stage(msg)) return false;
+        }
+        return true;
+    }
+
+    void add(Stage stage) { _stages.push_back(std::move(stage)); }
+    void clear() { _stages.clear(); }
+    size_t size() const { return _stages.size(); }
+
+private:
+    std::vector<Stage> _stages;
+};
+
+/**
+ * @brief Builds ProcessorChains from a text spec
+ *
+ * A spec is a list of stages separated by ';' or newlines, each written
+ * as "<stage> <field> [args...]". Built-in stages:
+ *
+ *     scale <field> <gain> [offset]
+ *     clamp <field> <lo> <hi>
+ *     lowpass <field> <alpha>
+ *     rate_limit <field> <max_step>
+ *     finite <field>
+ *
+ * Fields must be registered by name with addField(); custom stages with
+ * addStage().
+ */
+template<typename Msg>
+class ProcessorRegistry {
+public:
+    using Field = float Msg::*;
+    using Stage = typename ProcessorChain<Msg>::Stage;
+
+    /**
+     * @brief Stage factory: returns an empty Stage if the arguments are invalid
+     */
+    using Factory = Stage (*)(Field field, const float* args, size_t count);
+
+    static constexpr size_t MAX_FIELDS = 32;
+    static constexpr size_t MAX_STAGES = 16;
+    static constexpr size_t MAX_ARGS = 4;
+
+    ProcessorRegistry() {
+        addStage("scale", &_scale);
+        addStage("clamp", &_clamp);
+        addStage("lowpass", &_lowpass);
+        addStage("rate_limit", &_rateLimit);
+        addStage("finite", &_finite);
+    }
+
+    /**
+     * @brief Make a float field available to specs under @p name
+     */
+    bool addField(const char* name, Field field) {
+        if (_fieldCount >= MAX_FIELDS) return false;
+        _fields[_fieldCount++] = {name, field};
+        return true;
+    }
+
+    /**
+     * @brief Register (or replace) a stage type under @p name
+     */
+    bool addStage(const char* name, Factory factory) {
+        for (size_t i = 0; i < _stageCount; i++) {
+            if (strcmp(_stages[i].name, name) == 0) {
+                _stages[i].factory = factory;
+                return true;
+            }
+        }
+        if (_stageCount >= MAX_STAGES) return false;
+        _stages[_stageCount++] = {name, factory};
+        return true;
+    }
+
+    /**
+     * @brief Parse @p spec and append its stages to @p chain
+     *
+     * @return false on error; @p chain is left unchanged and lastError()
+     *         describes the problem
+     */
+    bool load(const char* spec, ProcessorChain<Msg>& chain) {
+        ProcessorChain<Msg> parsed;
+        _error[0] = '\0';
+
+        char line[128];
+        const char* p = spec;
+        while (*p) {
+            size_t n = strcspn(p, ";\n");
+            if (n >= sizeof(line)) {
+                return _fail("stage too long: %.32s...", p);
+            }
+            memcpy(line, p, n);
+            line[n] = '\0';
+            p += n + (p[n] ? 1 : 0);
+
+            Stage stage;
+            if (!_parseStage(line, stage)) return false;
+            if (stage) parsed.add(std::move(stage));
+        }
+
+        chain = std::move(parsed);
+        return true;
+    }
+
+    const char* lastError() const { return _error; }
+
+private:
+    struct FieldEntry {
+        const char* name;
+        Field field;
+    };
+
+    struct StageEntry {
+        const char* name;
+        Factory factory;
+    };
+
+    template<typename Filter>
+    static Stage _bind(Field field, Filter filter) {
+        return [field, filter](Msg& msg) mutable {
+            float value = msg.*field;
+            const bool keep = filter(value);
+            msg.*field = value;
+            return keep;
+        };
+    }
+
+    bool _parseStage(char* line, Stage& out) {
+        char* save = nullptr;
+        const char* kind = strtok_r(line, " \t\r", &save);
+        if (!kind || kind[0] == '#') return true;  // Blank line or comment
+
+        const char* fieldName = strtok_r(nullptr, " \t\r", &save);
+        if (!fieldName) return _fail("%s: missing field", kind);
+
+        const Factory factory = _findStage(kind);
+        if (!factory) return _fail("unknown stage '%s'", kind);
+        const FieldEntry* field = _findField(fieldName);
+        if (!field) return _fail("%s: unknown field '%s'", kind, fieldName);
+
+        float args[MAX_ARGS];
+        size_t count = 0;
+        while (const char* tok = strtok_r(nullptr, " \t\r", &save)) {
+            char* end;
+            const float v = strtof(tok, &end);
+            if (*end != '\0' || count >= MAX_ARGS) {
+                return _fail("%s %s: bad argument '%s'", kind, fieldName, tok);
+            }
+            args[count++] = v;
+        }
+
+        out = factory(field->field, args, count);
+        if (!out) return _fail("%s %s: wrong arguments", kind, fieldName);
+        return true;
+    }
+
+    Factory _findStage(const char* name) const {
+        for (size_t i = 0; i < _stageCount; i++) {
+            if (strcmp(_stages[i].name, name) == 0) return _stages[i].factory;
+        }
+        return nullptr;
+    }
+
+    const FieldEntry* _findField(const char* name) const {
+        for (size_t i = 0; i < _fieldCount; i++) {
+            if (strcmp(_fields[i].name, name) == 0) return &_fields[i];
+        }
+        return nullptr;
+    }
+
+    template<typename... Args>
+    bool _fail(const char* fmt, Args... args) {
+        snprintf(_error, sizeof(_error), fmt, args...);
+        return false;
+    }
+
+    static Stage _scale(Field field, const float* a, size_t n) {
+        if (n < 1 || n > 2) return {};
+        return _bind(field, Scale{a[0], n > 1 ? a[1] : 0.0f});
+    }
+
+    static Stage _clamp(Field field, const float* a, size_t n) {
+        if (n != 2 || a[0] > a[1]) return {};
+        return _bind(field, Clamp{a[0], a[1]});
+    }
+
+    static Stage _lowpass(Field field, const float* a, size_t n) {
+        if (n != 1 || !(a[0] > 0.0f && a[0] <= 1.0f)) return {};
+        return _bind(field, LowPass(a[0]));
+    }
+
+    static Stage _rateLimit(Field field, const float* a, size_t n) {
+        if (n != 1 || !(a[0] >= 0.0f)) return {};
+        return _bind(field, RateLimit(a[0]));
+    }
+
+    static Stage _finite(Field field, const float*, size_t n) {
+        if (n != 0) return {};
+        return _bind(field, Finite{});
+    }
+
+    FieldEntry _fields[MAX_FIELDS];
+    size_t _fieldCount = 0;
+    StageEntry _stages[MAX_STAGES];
+    size_t _stageCount = 0;
+    char _error[96];
+};
+
+} // namespace cpy
+
+#endif // CAPYBARISH_PIPELINE_H
@@ -0,0 +1,289 @@
+/**
+ * @file capybarish_pool.h
+ * @brief Fixed pool of reference-counted message buffers for zero-copy fan-out
+ *
+ * When one received message goes to several consumers (a callback, a
+ * recorder task, a forwarding publisher), passing T by value copies the
+ * whole struct per consumer. A MessagePool hands out MessagePtr<T> handles
+ * to buffers with an intrusive reference count instead: giving a consumer
+ * the message costs one atomic increment, and the buffer returns to the
+ * pool when the last handle is dropped, on whichever task drops it.
+ *
+ * - Acquire and release are lock-free (a CAS on a 32-bit occupancy mask
+ *   and an atomic count), so handles may be dropped from an ISR.
+ * - Storage is fixed at compile time; nothing touches the heap.
+ * - A subscription created with a pool decodes straight into a pooled
+ *   buffer; LocalTopic fans a handle out to in-process subscribers and
+ *   Publisher::publish(MessagePtr) forwards it.
+ *
+ * @example
+ * @code
+ * cpy::FixedMessagePool<SensorData, 8> pool;
+ * cpy::LocalTopic<SensorData> feedback;          // In-process consumers
+ *
+ * void setup() {
+ *     auto* fwd = node.createPublisher<SensorData>("/fleet/feedback", serverIP, 7000);
+ *     feedback.subscribe([](const cpy::MessagePtr<SensorData>& m) { updateEstimator(*m); });
+ *     feedback.subscribe([fwd](const cpy::MessagePtr<SensorData>& m) { fwd->publish(m); });
+ *
+ *     node.createSubscription<SensorData>("/motor/feedback", pool,
+ *         [](const cpy::MessagePtr<SensorData>& m) { feedback.publish(m); }, 6667);
+ * }
+ * @endcode
+ *
+ * @author Chen Yu <chenyu@u.northwestern.edu>
+ * @copyright 2025 Chen Yu
+ * @license Apache-2.0
+ */
+
+#pragma once
+
+#ifndef CAPYBARISH_POOL_H
+#define CAPYBARISH_POOL_H
+
+#include "Arduino.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace cpy {
+
+template<typename T> class MessagePool;
+template<typename T> class MessagePtr;
+
+/**
+ * @brief A pool buffer: the message plus its reference count
+ */
+template<typename T>
+struct PooledMessage {
+    T value{};
+    std::atomic<uint32_t> refs{0};
+    MessagePool<T>* pool = nullptr;
+};
+
+// =============================================================================
+// Message Handle
+// =============================================================================
+
+/**
+ * @brief Shared, read-only handle to a pooled message
+ *
+ * Copies share the buffer; the last one to go returns it to its pool.
+ * Handles themselves are not synchronized: give each task its own copy
+ * (copying a handle is safe while other tasks copy or drop theirs).
+ */
+template<typename T>
+class MessagePtr {
+public:
+    MessagePtr() = default;
+
+    MessagePtr(const MessagePtr& other) : _block(other._block) {
+        if (_block) _block->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    MessagePtr(MessagePtr&& other) noexcept : _block(other._block) { other._block = nullptr; }
+
+    MessagePtr& operator=(const MessagePtr& other) {
+        if (this != &other) {
+            if (other._block) other._block->refs.fetch_add(1, std::memory_order_relaxed);
+            reset();
+            _block = other._block;
+        }
+        return *this;
+    }
+
+    MessagePtr& operator=(MessagePtr&& other) noexcept {
+        if (this != &other) {
+            reset();
+            _block = other._block;
+            other._block = nullptr;
+        }
+        return *this;
+    }
+
+    ~MessagePtr() { reset(); }
+
+    /**
+     * @brief Drop this handle's reference
+     */
+    void reset() {
+        if (!_block) return;
+        if (_block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            _block->pool->_release(_block);
+        }
+        _block = nullptr;
+    }
+
+    const T& operator*() const { return _block->value; }
+    const T* operator->() const { return &_block->value; }
+    const T* get() const { return _block ? &_block->value : nullptr; }
+    explicit operator bool() const { return _block != nullptr; }
+
+    /**
+     * @brief Writable access while this is the only handle
+     * @return nullptr if the buffer is shared (or the handle is empty)
+     */
+    T* edit() { return _block && useCount() == 1 ? &_block->value : nullptr; }
+
+    uint32_t useCount() const { return _block ? _block->refs.load(std::memory_order_acquire) : 0; }
+
+private:
+    friend class MessagePool<T>;
+
+    explicit MessagePtr(PooledMessage<T>* block) : _block(block) {}
+
+    PooledMessage<T>* _block = nullptr;
+};
+
+// =============================================================================
+// Pool
+// =============================================================================
+
+/**
+ * @brief Up to 32 message buffers in caller-supplied storage
+ *
+ * See FixedMessagePool for a pool that owns its storage.
+ */
+template<typename T>
+class MessagePool {
+public:
+    static constexpr size_t MAX_BUFFERS = 32;
+
+    MessagePool(PooledMessage<T>* blocks, size_t count)
+        : _blocks(blocks)
+        , _all(count >= MAX_BUFFERS ? 0xFFFFFFFFu : (1u << count) - 1)
+    {}
+
+    MessagePool(const MessagePool&) = delete;
+    MessagePool& operator=(const MessagePool&) = delete;
+
+    /**
+     * @brief Take a free buffer (lock-free); its previous contents remain
+     * @return Empty handle if every buffer is in use
+     */
+    MessagePtr<T> acquire() {
+        uint32_t used = _used.load(std::memory_order_relaxed);
+        while (true) {
+            uint32_t free = ~used & _all;
+            if (free == 0) {
+                _exhaustedCount.fetch_add(1, std::memory_order_relaxed);
+                return MessagePtr<T>();
+            }
+            uint32_t bit = free & (~free + 1);  // Lowest free buffer
+            if (_used.compare_exchange_weak(used, used | bit, std::memory_order_acquire,
+                                            std::memory_order_relaxed)) {
+                PooledMessage<T>* block = &_blocks[__builtin_ctz(bit)];
+                // Set here rather than in the constructor, which runs before
+                // a FixedMessagePool's storage is initialized
+                block->pool = this;
+                block->refs.store(1, std::memory_order_relaxed);
+                return MessagePtr<T>(block);
+            }
+        }
+    }
+
+    /**
+     * @brief Take a buffer holding a copy of @p value
+     */
+    MessagePtr<T> make(const T& value) {
+        MessagePtr<T> msg = acquire();
+        if (msg) *msg.edit() = value;
+        return msg;
+    }
+
+    size_t capacity() const { return __builtin_popcount(_all); }
+    size_t inUse() const { return __builtin_popcount(_used.load(std::memory_order_relaxed)); }
+    size_t available() const { return capacity() - inUse(); }
+
+    /**
+     * @brief acquire() calls that found the pool empty
+     */
+    uint32_t getExhaustedCount() const { return _exhaustedCount.load(std::memory_order_relaxed); }
+
+private:
+    friend class MessagePtr<T>;
+
+    void _release(PooledMessage<T>* block) {
+        _used.fetch_and(~(1u << (block - _blocks)), std::memory_order_release);
+    }
+
+    PooledMessage<T>* _blocks;
+    uint32_t _all;
+    std::atomic<uint32_t> _used{0};
+    std::atomic<uint32_t> _exhaustedCount{0};
+};
+
+/**
+ * @brief MessagePool with its own storage
+ *
+ * @tparam T Message type
+ * @tparam N Buffers (1 to 32): messages alive at once across all holders
+ */
+template<typename T, size_t N>
+class FixedMessagePool : public MessagePool<T> {
+public:
+    static_assert(N >= 1 && N <= MessagePool<T>::MAX_BUFFERS, "FixedMessagePool holds 1 to 32 buffers");
+
+    FixedMessagePool() : MessagePool<T>(_storage, N) {}
+
+private:
+    PooledMessage<T> _storage[N];
+};
+
+// =============================================================================
+// Intra-Process Delivery
+// =============================================================================
+
+/**
+ * @brief Callback receiving a shared message
+ */
+template<typename T>
+using SharedCallback = std::function<void(const MessagePtr<T>&)>;
+
+/**
+ * @brief In-process topic: hands one buffer to every subscriber, in order
+ *
+ * Delivery is synchronous on the publishing task. A subscriber that needs
+ * the message later keeps a copy of the handle.
+ *
+ * @tparam MAX_SUBSCRIBERS Callbacks the topic can hold
+ */
+template<typename T, size_t MAX_SUBSCRIBERS = 4>
+class LocalTopic {
+public:
+    /**
+     * @return false if the topic already has MAX_SUBSCRIBERS callbacks
+     */
+    bool subscribe(SharedCallback<T> callback) {
+        if (_numSubscribers >= MAX_SUBSCRIBERS) {
+            Serial.println("[LocalTopic] Max subscribers reached!");
+            return false;
+        }
+        _subscribers[_numSubscribers++] = callback;
+        return true;
+    }
+
+    /**
+     * @return Number of subscribers called
+     */
+    size_t publish(const MessagePtr<T>& msg) {
+        if (!msg) return 0;
+        for (size_t i = 0; i < _numSubscribers; i++) _subscribers[i](msg);
+        _pubCount++;
+        return _numSubscribers;
+    }
+
+    size_t getSubscriberCount() const { return _numSubscribers; }
+    uint32_t getPublishCount() const { return _pubCount; }
+
+private:
+    SharedCallback<T> _subscribers[MAX_SUBSCRIBERS];
+    size_t _numSubscribers = 0;
+    uint32_t _pubCount = 0;
+};
+
+} // namespace cpy
+
+#endif // CAPYBARISH_POOL_H
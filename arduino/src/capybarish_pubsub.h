@@ -22,6 +22,7 @@
     #include "esp_wifi.h"
     #include "lwip/igmp.h"
     #include "lwip/ip_addr.h"
+    #include "lwip/sockets.h"
     #include "freertos/FreeRTOS.h"
     #include "freertos/task.h"
     #include "freertos/queue.h"
@@ -32,16 +33,33 @@
 
 #include <WiFiUdp.h>
 #include <functional>
+#include <cmath>
 #include <cstring>
+#include <optional>
+#include <utility>
 #include <vector>
 
+#include "capybarish_auth.h"
+#include "capybarish_clock.h"
+#include "capybarish_filter.h"
+#include "capybarish_frame.h"
+#include "capybarish_pool.h"
+#include "capybarish_schema.h"
+#include "capybarish_shared.h"
+#include "capybarish_trace.h"
+#include "capybarish_transport.h"
+
 namespace cpy {
 
 // Forward declarations
 template<typename T> class Publisher;
 template<typename T> class Subscription;
+class GenericPublisher;
+class GenericSubscription;
 class Timer;
 class Node;
+class Executor;
+class Discovery;
 
 // =============================================================================
 // QoS Configuration
@@ -63,6 +81,58 @@ enum class QoSHistory {
     KEEP_ALL       ///< Keep all messages (bounded by depth)
 };
 
+/**
+ * @brief Traffic class (WMM access category) for a topic
+ * 
+ * Ordered from lowest to highest priority. The class is written into the
+ * IP header as a DSCP code point; the WiFi driver (ESP-IDF on the module,
+ * mac80211 on Linux) derives the 802.11 user priority from the top three
+ * DSCP bits and queues the frame in the matching access category.
+ */
+enum class TrafficClass : uint8_t {
+    BACKGROUND = 0,  ///< AC_BK - bulk logs, debug dumps
+    BEST_EFFORT,     ///< AC_BE - default for all traffic
+    VIDEO,           ///< AC_VI - telemetry that must stay fresh
+    VOICE            ///< AC_VO - control commands
+};
+
+/**
+ * @brief DSCP code point for a traffic class
+ * 
+ * VOICE uses CS6 rather than EF: EF (46) maps to user priority 5, which
+ * both ESP-IDF and mac80211 still place in AC_VI.
+ */
+inline constexpr uint8_t trafficClassDscp(TrafficClass cls) {
+    return cls == TrafficClass::BACKGROUND ? 8    // CS1  -> UP 1
+         : cls == TrafficClass::VIDEO      ? 34   // AF41 -> UP 4
+         : cls == TrafficClass::VOICE      ? 48   // CS6  -> UP 6
+         : 0;                                     // CS0  -> UP 0
+}
+
+/**
+ * @brief IPv4 TOS byte (DSCP << 2, ECN bits clear) for a traffic class
+ */
+inline constexpr uint8_t trafficClassTos(TrafficClass cls) {
+    return static_cast<uint8_t>(trafficClassDscp(cls) << 2);
+}
+
+inline const char* trafficClassName(TrafficClass cls) {
+    switch (cls) {
+        case TrafficClass::BACKGROUND: return "BK";
+        case TrafficClass::VIDEO:      return "VI";
+        case TrafficClass::VOICE:      return "VO";
+        default:                       return "BE";
+    }
+}
+
+/**
+ * @brief What a publisher does when its bandwidth budget is used up
+ */
+enum class RateLimitAction : uint8_t {
+    DROP,   ///< Discard the message, publish() returns false
+    DEFER   ///< Hold the latest message and send it once the budget refills
+};
+
 /**
  * @brief Quality of Service profile
  */
@@ -70,6 +140,30 @@ struct QoSProfile {
     QoSReliability reliability = QoSReliability::BEST_EFFORT;
     QoSHistory history = QoSHistory::KEEP_LAST;
     uint8_t depth = 10;
+    TrafficClass trafficClass = TrafficClass::BEST_EFFORT;
+    uint8_t fecGroupSize = 0;  ///< Send one XOR parity packet every N messages (0 = off)
+    uint32_t rateLimitBytesPerSec = 0;  ///< Token bucket refill rate (0 = unlimited)
+    uint32_t burstBytes = 0;            ///< Bucket depth (0 = 100 ms of budget)
+    RateLimitAction rateLimitAction = RateLimitAction::DROP;
+    bool dropStaleRecovered = false;    ///< Drop a message rebuilt by FEC once a newer one was delivered
+    
+    /**
+     * @brief Copy of this profile with a hard per-topic bandwidth budget
+     * 
+     * Bytes are counted on the wire: every path, frame headers and parity.
+     * 
+     * @param bytesPerSec Sustained budget
+     * @param burst Bucket depth in bytes (0 = 100 ms of budget)
+     * @param action Drop or defer messages published over budget
+     */
+    QoSProfile withBudget(uint32_t bytesPerSec, uint32_t burst = 0,
+                          RateLimitAction action = RateLimitAction::DROP) const {
+        QoSProfile qos = *this;
+        qos.rateLimitBytesPerSec = bytesPerSec;
+        qos.burstBytes = burst;
+        qos.rateLimitAction = action;
+        return qos;
+    }
     
     static QoSProfile sensorData() {
         return QoSProfile{QoSReliability::BEST_EFFORT, QoSHistory::KEEP_LAST, 5};
@@ -78,6 +172,43 @@ struct QoSProfile {
     static QoSProfile defaultProfile() {
         return QoSProfile{QoSReliability::BEST_EFFORT, QoSHistory::KEEP_LAST, 10};
     }
+    
+    /**
+     * @brief Profile for control commands (only the latest matters, AC_VO)
+     * 
+     * A command rebuilt by FEC after a newer one arrived is dropped, so
+     * the stream never steps back to an older command.
+     */
+    static QoSProfile control() {
+        QoSProfile qos{QoSReliability::BEST_EFFORT, QoSHistory::KEEP_LAST, 1,
+                       TrafficClass::VOICE};
+        qos.dropStaleRecovered = true;
+        return qos;
+    }
+    
+    /**
+     * @brief Profile for control streams on lossy links
+     * 
+     * Like control(), plus one parity packet every @p groupSize commands so
+     * an isolated loss is rebuilt without waiting for the next command.
+     * Only the last command of a group is ever rebuilt in time to be
+     * used; earlier ones are already superseded (dropStaleRecovered).
+     */
+    static QoSProfile lossyControl(uint8_t groupSize = 5) {
+        QoSProfile qos = control();
+        qos.fecGroupSize = groupSize;
+        return qos;
+    }
+    
+    /**
+     * @brief Profile for service calls (see Service and Client)
+     * 
+     * Nothing is retransmitted: the client's timeout is what makes a call
+     * complete, with a response or without.
+     */
+    static QoSProfile services() {
+        return QoSProfile{QoSReliability::RELIABLE, QoSHistory::KEEP_LAST, 10};
+    }
 };
 
 // =============================================================================
@@ -92,6 +223,7 @@ struct TopicInfo {
     uint16_t port;
     size_t msgSize;
     bool isPublisher;  // true = we publish, false = we subscribe
+    uint32_t fingerprint = 0;  // messageFingerprint<T>(), 0 = unknown
 };
 
 /**
@@ -167,6 +299,368 @@ private:
     size_t _numTopics = 0;
 };
 
+// =============================================================================
+// Bandwidth Accounting
+// =============================================================================
+
+/**
+ * @brief Exponentially decayed rate estimator (events/s or bytes/s)
+ * 
+ * Each sample adds weight / tau and the total decays by exp(-dt / tau), so
+ * irregular publish times need no fixed sampling window, a steady stream
+ * reads its true rate after a few tau, and a stream that stops decays to
+ * zero instead of freezing at its last value.
+ */
+class RateEstimator {
+public:
+    explicit RateEstimator(float tauSec = 1.0f) : _tauUs(tauSec * 1e6f) {}
+    
+    void add(uint64_t nowUs, float weight = 1.0f) {
+        _rate = rate(nowUs) + weight * 1e6f / _tauUs;
+        _lastUs = nowUs;
+    }
+    
+    /**
+     * @brief Estimated rate per second at @p nowUs
+     */
+    float rate(uint64_t nowUs) const {
+        if (_rate == 0.0f) return 0.0f;
+        return _rate * expf(-static_cast<float>(nowUs - _lastUs) / _tauUs);
+    }
+    
+    void reset() { _rate = 0.0f; }
+    
+private:
+    float _tauUs;
+    float _rate = 0.0f;
+    uint64_t _lastUs = 0;
+};
+
+/**
+ * @brief Token bucket holding up to @c burst bytes, refilled at @c rate
+ * 
+ * Disabled (always admits) while the rate is 0.
+ */
+class TokenBucket {
+public:
+    void configure(uint32_t bytesPerSec, uint32_t burstBytes, uint64_t nowUs) {
+        _rate = bytesPerSec;
+        _burst = burstBytes;
+        _tokens = burstBytes;
+        _lastUs = nowUs;
+    }
+    
+    bool enabled() const { return _rate > 0; }
+    
+    /**
+     * @brief Take @p bytes if the bucket holds that many
+     */
+    bool tryConsume(uint64_t nowUs, uint32_t bytes) {
+        if (!enabled()) return true;
+        _refill(nowUs);
+        if (_tokens < bytes) return false;
+        _tokens -= bytes;
+        return true;
+    }
+    
+    /**
+     * @brief Take @p bytes unconditionally (the bucket may go into debt)
+     */
+    void consume(uint64_t nowUs, uint32_t bytes) {
+        if (!enabled()) return;
+        _refill(nowUs);
+        _tokens -= bytes;
+    }
+    
+    /**
+     * @brief Microseconds until @p bytes are available (0 if now)
+     */
+    uint32_t waitUs(uint64_t nowUs, uint32_t bytes) const {
+        if (!enabled()) return 0;
+        float tokens = min(static_cast<float>(_burst),
+                           _tokens + (nowUs - _lastUs) * 1e-6f * _rate);
+        if (tokens >= bytes) return 0;
+        return static_cast<uint32_t>(ceilf((bytes - tokens) * 1e6f / _rate));
+    }
+    
+    float tokens() const { return _tokens; }
+    
+private:
+    void _refill(uint64_t nowUs) {
+        _tokens = min(static_cast<float>(_burst),
+                      _tokens + (nowUs - _lastUs) * 1e-6f * _rate);
+        _lastUs = nowUs;
+    }
+    
+    uint32_t _rate = 0;
+    uint32_t _burst = 0;
+    float _tokens = 0.0f;
+    uint64_t _lastUs = 0;
+};
+
+// =============================================================================
+// UDP Socket
+// =============================================================================
+
+/**
+ * @brief UDP socket with a pre-resolved destination
+ * 
+ * On ESP32 this owns an lwIP socket directly so that socket options such
+ * as IP_TOS can be set (WiFiUDP keeps its descriptor private), the
+ * destination address is parsed once instead of on every beginPacket(),
+ * and Node::spinUntil() can select() on the descriptor.
+ * Other platforms fall back to WiFiUDP without traffic class support.
+ */
+class UdpSocket {
+public:
+    UdpSocket() = default;
+    ~UdpSocket() { close(); }
+    
+    UdpSocket(const UdpSocket&) = delete;
+    UdpSocket& operator=(const UdpSocket&) = delete;
+    
+#ifdef ESP32
+    /**
+     * @brief Open the socket, optionally bound to a local port
+     */
+    bool begin(uint16_t localPort = 0) {
+        close();
+        _fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (_fd < 0) return false;
+        
+        int yes = 1;
+        setsockopt(_fd, SOL_SOCKET, SO_BROADCAST, &yes, sizeof(yes));
+        
+        if (localPort > 0) {
+            setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+            
+            sockaddr_in local = {};
+            local.sin_family = AF_INET;
+            local.sin_port = htons(localPort);
+            local.sin_addr.s_addr = htonl(INADDR_ANY);
+            if (bind(_fd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) < 0) {
+                close();
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    /**
+     * @brief Set the destination for send()
+     */
+    bool setRemote(const char* ip, uint16_t port) {
+        _remote = {};
+        _remote.sin_family = AF_INET;
+        _remote.sin_port = htons(port);
+        return inet_aton(ip, &_remote.sin_addr) != 0;
+    }
+    
+    /**
+     * @brief Whether a sender reported by receiveFrom() is the remote
+     */
+    bool isRemote(uint32_t address, uint16_t port) const {
+        return address == _remote.sin_addr.s_addr && port == ntohs(_remote.sin_port);
+    }
+    
+    /**
+     * @brief Join a multicast group on every interface
+     */
+    bool joinMulticast(const char* group) {
+        if (_fd < 0) return false;
+        ip_mreq mreq = {};
+        if (inet_aton(group, &mreq.imr_multiaddr) == 0) return false;
+        mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+        return setsockopt(_fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) == 0;
+    }
+    
+    /**
+     * @brief Mark outgoing packets with the DSCP of a traffic class
+     */
+    bool setTrafficClass(TrafficClass cls) {
+        if (_fd < 0) return false;
+        int tos = trafficClassTos(cls);
+        return setsockopt(_fd, IPPROTO_IP, IP_TOS, &tos, sizeof(tos)) == 0;
+    }
+    
+    bool send(const uint8_t* data, size_t len) {
+        if (_fd < 0) return false;
+        return sendto(_fd, data, len, 0, reinterpret_cast<const sockaddr*>(&_remote),
+                      sizeof(_remote)) == static_cast<ssize_t>(len);
+    }
+    
+    /**
+     * @brief Read the next pending datagram without blocking
+     * @return Bytes copied (a longer datagram is truncated to @p capacity),
+     *         0 if none is pending
+     */
+    size_t receive(uint8_t* buffer, size_t capacity) {
+        if (_fd < 0) return 0;
+        ssize_t n = recv(_fd, buffer, capacity, MSG_DONTWAIT);
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+    
+    /**
+     * @brief receive(), also reporting the sender
+     * @param[out] address Sender IPv4 address (network byte order, as in IPAddress)
+     * @param[out] port Sender port
+     */
+    size_t receiveFrom(uint8_t* buffer, size_t capacity, uint32_t& address, uint16_t& port) {
+        if (_fd < 0) return 0;
+        sockaddr_in from = {};
+        socklen_t fromLen = sizeof(from);
+        ssize_t n = recvfrom(_fd, buffer, capacity, MSG_DONTWAIT,
+                             reinterpret_cast<sockaddr*>(&from), &fromLen);
+        if (n <= 0) return 0;
+        address = from.sin_addr.s_addr;
+        port = ntohs(from.sin_port);
+        return static_cast<size_t>(n);
+    }
+    
+    /**
+     * @brief Send one datagram to an address other than the remote
+     */
+    bool sendTo(const uint8_t* data, size_t len, uint32_t address, uint16_t port) {
+        if (_fd < 0) return false;
+        sockaddr_in to = {};
+        to.sin_family = AF_INET;
+        to.sin_port = htons(port);
+        to.sin_addr.s_addr = address;
+        return sendto(_fd, data, len, 0, reinterpret_cast<const sockaddr*>(&to),
+                      sizeof(to)) == static_cast<ssize_t>(len);
+    }
+    
+    void close() {
+        if (_fd >= 0) {
+            ::close(_fd);
+            _fd = -1;
+        }
+    }
+    
+    int fd() const { return _fd; }
+    
+private:
+    int _fd = -1;
+    sockaddr_in _remote = {};
+#else
+    bool begin(uint16_t localPort = 0) {
+        _localPort = localPort;
+        return localPort > 0 ? _udp.begin(localPort) : true;
+    }
+    
+    bool setRemote(const char* ip, uint16_t port) {
+        _remoteIP = ip;
+        _remotePort = port;
+        return true;
+    }
+    
+    bool isRemote(uint32_t address, uint16_t port) const {
+        IPAddress remote;
+        return remote.fromString(_remoteIP) && static_cast<uint32_t>(remote) == address &&
+               port == _remotePort;
+    }
+    
+    bool joinMulticast(const char* group) {
+        IPAddress addr;
+        if (!addr.fromString(group)) return false;
+        _udp.stop();
+        return _udp.beginMulticast(addr, _localPort);
+    }
+    
+    bool setTrafficClass(TrafficClass cls) {
+        return cls == TrafficClass::BEST_EFFORT;
+    }
+    
+    bool send(const uint8_t* data, size_t len) {
+        _udp.beginPacket(_remoteIP, _remotePort);
+        _udp.write(data, len);
+        return _udp.endPacket();
+    }
+    
+    size_t receive(uint8_t* buffer, size_t capacity) {
+        int packetSize = _udp.parsePacket();
+        if (packetSize <= 0) return 0;
+        size_t len = _udp.read(buffer, min((size_t)packetSize, capacity));
+        while (_udp.available()) _udp.read();  // Flush the rest
+        return len;
+    }
+    
+    size_t receiveFrom(uint8_t* buffer, size_t capacity, uint32_t& address, uint16_t& port) {
+        size_t len = receive(buffer, capacity);
+        if (len > 0) {
+            address = static_cast<uint32_t>(_udp.remoteIP());
+            port = _udp.remotePort();
+        }
+        return len;
+    }
+    
+    bool sendTo(const uint8_t* data, size_t len, uint32_t address, uint16_t port) {
+        _udp.beginPacket(IPAddress(address), port);
+        _udp.write(data, len);
+        return _udp.endPacket();
+    }
+    
+    void close() { _udp.stop(); }
+    
+    int fd() const { return -1; }
+    
+private:
+    WiFiUDP _udp;
+    const char* _remoteIP = nullptr;
+    uint16_t _remotePort = 0;
+    uint16_t _localPort = 0;
+#endif
+};
+
+// =============================================================================
+// Message Encoding
+// =============================================================================
+
+// Generated messages have serialize()/fromBytes(); any other T goes on the
+// wire as its raw bytes. Publishers, subscriptions, services and clients
+// all encode and decode through these two.
+namespace detail {
+
+template<typename T>
+inline void encodeMessage(const T& msg, uint8_t* out) {
+    if constexpr (requires { msg.serialize((uint8_t*)nullptr); }) {
+        msg.serialize(out);
+    } else {
+        memcpy(out, &msg, sizeof(T));
+    }
+}
+
+template<typename T>
+inline void decodeMessage(const uint8_t* in, T& msg) {
+    if constexpr (requires { T::fromBytes(in, sizeof(T)); }) {
+        msg = T::fromBytes(in, sizeof(T));
+    } else {
+        memcpy(&msg, in, sizeof(T));
+    }
+}
+
+/**
+ * @brief 32-bit value for stream and correlation IDs, from the hardware
+ *        RNG on the ESP32 and ESP8266
+ * 
+ * Elsewhere it mixes micros() with a call counter: IDs still differ
+ * between calls and restarts, but they can be guessed, so they are no
+ * guard against forged responses there (use setAuth() for that).
+ */
+inline uint32_t randomId() {
+#ifdef ESP32
+    return esp_random();
+#elif defined(ESP8266)
+    return ESP.random();
+#else
+    static uint32_t calls = 0;  // Distinct IDs even within one microsecond
+    uint32_t x = (static_cast<uint32_t>(micros()) + ++calls * 0x9E3779B9u) * 2654435761u;  // Knuth's multiplicative hash
+    return x ^ (x >> 16);
+#endif
+}
+
+} // namespace detail
+
 // =============================================================================
 // Publisher
 // =============================================================================
@@ -189,6 +683,34 @@ private:
  * // Broadcast mode (auto-discovery)
  * auto pub = node.createBroadcastPublisher<MotorCommand>("/motor/command", 6666);
  * 
+ * // Control topic in the WMM voice access category
+ * auto pub = node.createPublisher<MotorCommand>("/motor/command", ip, 6666,
+ *                                                cpy::QoSProfile::control());
+ * 
+ * // Same, with an XOR parity packet after every 5 commands (20% overhead)
+ * auto pub = node.createPublisher<MotorCommand>("/motor/command", ip, 6666,
+ *                                                cpy::QoSProfile::lossyControl(5));
+ * 
+ * // Redundant: every message also goes to the server's second address;
+ * // the subscriber keeps whichever copy arrives first
+ * pub->addPath(serverWiredIP, 6666);
+ * 
+ * // Telemetry capped at 20 kB/s; over budget, only the latest message waits
+ * auto pub = node.createPublisher<SensorData>("/motor/feedback", ip, 6667,
+ *     cpy::QoSProfile::sensorData().withBudget(20000, 0, cpy::RateLimitAction::DEFER));
+ * Serial.printf("%.0f B/s\n", pub->getBytesPerSec());
+ * 
+ * // Publish-on-change: skip messages until the joint moves 1 mrad or the
+ * // IMU 10 mrad, but send at least every 200 ms
+ * pub->setDeadband("motor.pos", 0.001);
+ * pub->setDeadband("imu.orientation.x", 0.01);
+ * pub->setHeartbeat(200000);
+ * 
+ * // Over USB instead of WiFi (remote IP is ignored, the port selects the topic)
+ * cpy::SerialTransport<> usb(Serial);
+ * cpy::Publisher<MotorCommand> usbPub("/motor/command", "", 6666, 0,
+ *                                     cpy::QoSProfile::defaultProfile(), false, &usb);
+ * 
  * MotorCommand msg = {1.5f, 0.0f, 10.0f, 0.5f};
  * pub->publish(msg);
  * @endcode
@@ -198,34 +720,54 @@ class Publisher {
 public:
     Publisher(const char* topicName, const char* remoteIP, uint16_t remotePort,
               uint16_t localPort = 0, QoSProfile qos = QoSProfile::defaultProfile(),
-              bool broadcast = false)
+              bool broadcast = false, Transport* transport = nullptr)
         : _topicName(topicName)
         , _remoteIP(remoteIP)
         , _remotePort(remotePort)
         , _localPort(localPort)
         , _qos(qos)
         , _broadcast(broadcast)
+        , _transport(transport)
         , _pubCount(0)
+        , _usesDiscovery(!transport && !broadcast && (!remoteIP || remoteIP[0] == '\0'))
         , _initialized(false)
     {
         TopicRegistry::instance().registerTopic(topicName, remotePort, sizeof(T), true);
+        _fec.configure(qos.fecGroupSize);
+        _configureBudget();
     }
     
     /**
      * @brief Initialize the publisher (call after WiFi is connected)
      */
     bool init() {
-        if (_localPort > 0) {
-            _initialized = _udp.begin(_localPort);
-        } else {
-            _initialized = true;  // No local binding needed for sending
+        if (_transport) {
+            _initialized = true;
+            Serial.printf("[Publisher] %s -> %s:%d\n", _topicName, _transport->name(), _remotePort);
+            return true;
+        }
+        
+        // Local port 0 leaves the socket unbound (sending only). Without a
+        // remote IP the destination comes later from setRemote()
+        _initialized = _socket.begin(_localPort) &&
+                       (_usesDiscovery ||
+                        _socket.setRemote(_broadcast ? "255.255.255.255" : _remoteIP, _remotePort));
+        
+        if (_initialized && !_socket.setTrafficClass(_qos.trafficClass)) {
+            Serial.printf("[Publisher] %s: traffic class %s not supported, using BE\n",
+                          _topicName, trafficClassName(_qos.trafficClass));
         }
         
         if (_initialized) {
             if (_broadcast) {
-                Serial.printf("[Publisher] %s -> BROADCAST:%d\n", _topicName, _remotePort);
+                Serial.printf("[Publisher] %s -> BROADCAST:%d [%s]\n", _topicName, _remotePort,
+                              trafficClassName(_qos.trafficClass));
+            } else if (_usesDiscovery) {
+                Serial.printf("[Publisher] %s -> (awaiting discovery) [%s]\n", _topicName,
+                              trafficClassName(_qos.trafficClass));
             } else {
-                Serial.printf("[Publisher] %s -> %s:%d\n", _topicName, _remoteIP, _remotePort);
+                Serial.printf("[Publisher] %s -> %s:%d [%s]\n", _topicName, _remoteIP, _remotePort,
+                              trafficClassName(_qos.trafficClass));
             }
         }
         return _initialized;
@@ -233,64 +775,537 @@ public:
     
     /**
      * @brief Publish a message
+     * 
+     * With a bandwidth budget, a message over budget is dropped (returns
+     * false) or, with RateLimitAction::DEFER, held until flush() can send
+     * it. A newer message replaces a held one.
      */
     bool publish(const T& msg) {
         if (!_initialized) return false;
         
-        // Use broadcast address if enabled
-        if (_broadcast) {
-            _udp.beginPacket(IPAddress(255, 255, 255, 255), _remotePort);
-        } else {
-            _udp.beginPacket(_remoteIP, _remotePort);
-        }
-        
-        // Use serialize() if available, otherwise raw memory
-        if constexpr (requires { msg.serialize((uint8_t*)nullptr); }) {
-            uint8_t buffer[sizeof(T)];
-            msg.serialize(buffer);
-            _udp.write(buffer, sizeof(T));
-        } else {
-            _udp.write(reinterpret_cast<const uint8_t*>(&msg), sizeof(T));
+        // The reference moves only once the message is sent or held, so
+        // a dropped one does not suppress the same change next time
+        uint8_t encoded[sizeof(T)];
+        if (_onChange) {
+            detail::encodeMessage(msg, encoded);
+            if (!_changedEnough(encoded)) {
+                _suppressedCount++;
+                return true;
+            }
         }
         
-        bool success = _udp.endPacket();
-        if (success) {
-            _pubCount++;
-            _lastPubTime = micros();
+        if (_bucket.enabled()) {
+            if (!_bucket.tryConsume(nowUs(), _wireCost())) {
+                if (_qos.rateLimitAction == RateLimitAction::DEFER) {
+                    if (_hasDeferred) _throttledCount++;  // Superseded
+                    _deferred = msg;
+                    _hasDeferred = true;
+                    if (_onChange) _setReference(encoded);
+                    return true;
+                }
+                _throttledCount++;
+                return false;
+            }
+            if (_hasDeferred) {
+                _hasDeferred = false;
+                _throttledCount++;  // Superseded
+            }
         }
-        return success;
+        bool sent = _publishNow(msg);
+        if (sent && _onChange) _setReference(encoded);
+        return sent;
+    }
+    
+    /**
+     * @brief Publish a pooled message (e.g. forwarded from a subscription)
+     * 
+     * Reads the message in place rather than copying it out of the pool.
+     * A plain struct is sent straight from the shared buffer; a type with
+     * serialize() is encoded into the wire buffer as publish(const T&)
+     * does. A message held back by a DEFER budget is copied.
+     */
+    bool publish(const MessagePtr<T>& msg) {
+        return msg ? publish(*msg) : false;
+    }
+    
+    /**
+     * @brief Send the held message once the budget allows it
+     * 
+     * Called by Node::spinOnce(); call it from loop() for a publisher
+     * that is not owned by a node.
+     * 
+     * @return true if a held message was sent
+     */
+    bool flush() {
+        if (!_hasDeferred || !_bucket.tryConsume(nowUs(), _wireCost())) return false;
+        _hasDeferred = false;
+        return _publishNow(_deferred);
+    }
+    
+    /**
+     * @brief Microseconds until flush() can send the held message
+     * @return UINT32_MAX if no message is held
+     */
+    uint32_t deferredWaitUs() const {
+        return _hasDeferred ? _bucket.waitUs(nowUs(), _wireCost()) : UINT32_MAX;
     }
     
     /**
      * @brief Publish raw bytes
+     * 
+     * Counts against the bandwidth budget, but is never deferred.
      */
     bool publishRaw(const uint8_t* data, size_t len) {
         if (!_initialized) return false;
         
-        _udp.beginPacket(_remoteIP, _remotePort);
-        _udp.write(data, len);
-        return _udp.endPacket();
+        if (!_bucket.tryConsume(nowUs(), len)) {
+            _throttledCount++;
+            return false;
+        }
+        return _send(data, len);
     }
     
-    const char* getTopicName() const { return _topicName; }
-    uint32_t getPublishCount() const { return _pubCount; }
-    uint64_t getLastPublishTime() const { return _lastPubTime; }
-    
-    static constexpr size_t msgSize() { return sizeof(T); }
+    /**
+     * @brief Send every message over an additional path as well
+     * 
+     * Each path has its own socket and destination (e.g. the server's WiFi
+     * and wired addresses). Once a path is added, messages are sent as
+     * sequenced frames so subscribers can drop the duplicate copies.
+     * 
+     * @param remoteIP Destination IP for this path
+     * @param remotePort Destination port for this path
+     * @return true if the path was opened
+     */
+    bool addPath(const char* remoteIP, uint16_t remotePort) {
+        if (!_initialized || _numPaths >= MAX_PATHS - 1) return false;
+        
+        UdpSocket& path = _paths[_numPaths];
+        if (!path.begin() || !path.setRemote(remoteIP, remotePort)) {
+            path.close();
+            return false;
+        }
+        path.setTrafficClass(_qos.trafficClass);
+        _numPaths++;
+        _configureBudget();  // Every message now costs one more datagram
+        
+        Serial.printf("[Publisher] %s => %s:%d (path %d)\n", _topicName, remoteIP, remotePort,
+                      _numPaths + 1);
+        return true;
+    }
+    
+    /**
+     * @brief Publish only when @p field moves by more than @p deadband
+     * 
+     * Turns on publish-on-change: publish() sends a message only if a
+     * watched field moved beyond its deadband since the last message it
+     * sent, or the heartbeat interval has elapsed. Other messages are
+     * suppressed (counted, not sent). An array field is watched element by
+     * element.
+     * 
+     * @param field Flattened name from T's generated FIELDS table,
+     *        e.g. "motor.pos"
+     * @param deadband Largest move that is not a change (0 = any change)
+     * @return false if T has no such field or DeadbandSet::MAX_FIELDS
+     *         fields are already watched
+     */
+    bool setDeadband(const char* field, double deadband) {
+        FieldInfo info;
+        bool found = false;
+        if constexpr (requires { T::FIELDS; }) {
+            found = findGeneratedField<T>(field, info);
+        }
+        if (!found || !_deadbands.add(info, deadband)) {
+            Serial.printf("[Publisher] %s: cannot watch field '%s'\n", _topicName, field);
+            return false;
+        }
+        _onChange = true;
+        return true;
+    }
+    
+    /**
+     * @brief Longest gap between messages in publish-on-change mode
+     * 
+     * Lets subscribers tell an idle publisher from a dead one. Checked on
+     * each publish() call, so it is rounded up to the caller's period.
+     * A non-zero interval turns on publish-on-change (see
+     * setPublishOnChange()) if it is not on yet.
+     * 
+     * @param intervalUs 0 = no heartbeat; the mode is left as it is
+     */
+    void setHeartbeat(uint32_t intervalUs) {
+        _heartbeatUs = intervalUs;
+        if (intervalUs) _onChange = true;
+    }
+    
+    /**
+     * @brief Publish only messages that differ from the last one sent
+     * 
+     * Without deadbands any byte of the encoded message counts as a
+     * change; setDeadband() narrows it to the watched fields.
+     */
+    void setPublishOnChange() { _onChange = true; }
+    
+    /**
+     * @brief Leave publish-on-change mode and publish every message again
+     */
+    void clearDeadbands() {
+        _deadbands.clear();
+        _heartbeatUs = 0;
+        _onChange = false;
+        _hasReference = false;
+    }
+    
+    const char* getTopicName() const { return _topicName; }
+    TrafficClass getTrafficClass() const { return _qos.trafficClass; }
+    uint32_t getPublishCount() const { return _pubCount; }
+    
+    /**
+     * @brief Messages skipped by publish-on-change
+     */
+    uint32_t getSuppressedCount() const { return _suppressedCount; }
+    uint32_t getParityCount() const { return _parityCount; }
+    size_t getPathCount() const { return _numPaths + 1; }
+    uint64_t getLastPublishTime() const { return _lastPubTime; }
+    
+    /**
+     * @brief Record this publisher's activity in @p trace (nullptr = stop)
+     */
+    void setTrace(TraceRecorder* trace) {
+        _trace = trace;
+        _traceId = trace ? trace->addEntity(TraceEntityKind::PUBLISHER, _topicName) : TraceRecorder::NO_ENTITY;
+    }
+    
+    /**
+     * @brief Authenticate every datagram with @p key (see capybarish_auth.h)
+     * 
+     * Subscribers must use the same key. Sequence numbers must never
+     * repeat under one key and sender, so @p firstSeq has to grow across
+     * restarts (e.g. from authBootSequence()). Another publisher of the
+     * same topic on this device needs its own @p sender.
+     */
+    void setAuth(const AuthKey& key, uint64_t firstSeq, uint32_t sender = authSenderId()) {
+        _auth.begin(key, _topicName);
+        _authSeq = firstSeq;
+        _authSender = sender;
+        _configureBudget();
+    }
+    
+    /**
+     * @brief Send unauthenticated datagrams again
+     */
+    void clearAuth() {
+        _auth.end();
+        _configureBudget();
+    }
+    
+    bool hasAuth() const { return _auth.enabled(); }
+    
+    /**
+     * @brief Send to a different destination from now on
+     * 
+     * A UDP publisher created with an empty remote IP sends nothing until
+     * this is called, e.g. by Discovery once a subscriber is found. The
+     * address is copied. On a Transport only the port matters.
+     */
+    bool setRemote(const char* ip, uint16_t port) {
+        strncpy(_remoteBuffer, ip, sizeof(_remoteBuffer) - 1);
+        _remoteBuffer[sizeof(_remoteBuffer) - 1] = '\0';
+        _remoteIP = _remoteBuffer;
+        _remotePort = port;
+        if (_transport || _broadcast) return true;
+        return _socket.setRemote(_remoteIP, _remotePort);
+    }
+    
+    bool hasRemote() const { return _remoteIP && _remoteIP[0] != '\0'; }
+    bool usesDiscovery() const { return _usesDiscovery; }
+    const char* getRemoteIP() const { return hasRemote() ? _remoteIP : ""; }
+    uint16_t getRemotePort() const { return _remotePort; }
+    
+    /**
+     * @brief Bytes put on the wire (all paths, headers and parity)
+     */
+    uint64_t getByteCount() const { return _byteCount; }
+    
+    /**
+     * @brief Messages dropped or superseded by the bandwidth budget
+     */
+    uint32_t getThrottledCount() const { return _throttledCount; }
+    
+    /**
+     * @brief Exponentially decayed send rates (1 s time constant)
+     */
+    float getBytesPerSec() const { return _byteRate.rate(nowUs()); }
+    float getMessagesPerSec() const { return _msgRate.rate(nowUs()); }
+    
+    bool hasDeferred() const { return _hasDeferred; }
+    
+    static constexpr size_t msgSize() { return sizeof(T); }
+    
+    static constexpr size_t MAX_PATHS = 3;
     
 private:
+    // Largest datagram: a frame plus the authentication trailer
+    static constexpr size_t SEALED_SIZE = sizeof(FrameHeader) + sizeof(T) + AUTH_TRAILER_SIZE;
+    
+    /**
+     * @brief Send a message now, bypassing the budget check
+     */
+    bool _publishNow(const T& msg) {
+        bool success;
+        if (_fec.enabled() || _numPaths > 0) {
+            success = _publishFramed(msg);
+        } else if constexpr (requires { msg.serialize((uint8_t*)nullptr); }) {
+            uint8_t buffer[sizeof(T)];
+            detail::encodeMessage(msg, buffer);
+            success = _send(buffer, sizeof(T));
+        } else {
+            success = _send(reinterpret_cast<const uint8_t*>(&msg), sizeof(T));  // Straight from msg
+        }
+        
+        if (success) {
+            _pubCount++;
+            _lastPubTime = nowUs();
+            _msgRate.add(_lastPubTime);
+            if (_trace) _trace->record(TraceEventType::PUBLISH, _traceId, sizeof(T));
+        }
+        return success;
+    }
+    
+    /**
+     * @brief Whether the encoded message moved far enough from the last
+     *        message sent, or the heartbeat is due
+     */
+    bool _changedEnough(const uint8_t* bytes) const {
+        if (!_hasReference) return true;
+        if (_heartbeatUs && nowUs() - _referenceUs >= _heartbeatUs) return true;
+        return _deadbands.size() > 0 ? _deadbands.changed(_reference, bytes)
+                                     : memcmp(_reference, bytes, sizeof(T)) != 0;
+    }
+    
+    /**
+     * @brief Make a sent (or held) message the one later ones are compared to
+     */
+    void _setReference(const uint8_t* bytes) {
+        memcpy(_reference, bytes, sizeof(T));
+        _referenceUs = nowUs();
+        _hasReference = true;
+    }
+    
+    /**
+     * @brief Bytes one message puts on the wire across every path
+     */
+    uint32_t _wireCost() const {
+        size_t datagram = (_fec.enabled() || _numPaths > 0) ? sizeof(FrameHeader) + sizeof(T)
+                                                            : sizeof(T);
+        if (_auth.enabled()) datagram += AUTH_TRAILER_SIZE;
+        return datagram * (_numPaths + 1);
+    }
+    
+    /**
+     * @brief (Re)fill the token bucket from the QoS budget
+     * 
+     * The bucket always holds at least one message, or nothing could pass.
+     */
+    void _configureBudget() {
+        if (_qos.rateLimitBytesPerSec == 0) return;
+        uint32_t burst = _qos.burstBytes > 0 ? _qos.burstBytes : _qos.rateLimitBytesPerSec / 10;
+        _bucket.configure(_qos.rateLimitBytesPerSec, max(burst, _wireCost()), nowUs());
+    }
+    
+    void _account(size_t len) {
+        _byteCount += len;
+        _byteRate.add(nowUs(), len);
+    }
+    
+    /**
+     * @brief Send a datagram on the primary path, sealed if authenticated
+     */
+    bool _send(const uint8_t* data, size_t len) {
+        uint8_t sealed[SEALED_SIZE];
+        if (_auth.enabled()) {
+            len = _auth.seal(data, len, sealed, sizeof(sealed), _authSender, _authSeq++);
+            if (len == 0) return false;
+            data = sealed;
+        }
+        return _transmit(data, len);
+    }
+    
+    /**
+     * @brief Put a finished datagram on the primary path (transport or UDP)
+     */
+    bool _transmit(const uint8_t* data, size_t len) {
+        if (_usesDiscovery && !hasRemote()) return false;  // No subscriber found yet
+        bool sent = _transport ? _transport->send(_remotePort, data, len) : _socket.send(data, len);
+        if (sent) _account(len);
+        return sent;
+    }
+    
+    /**
+     * @brief Send a datagram on every path
+     * 
+     * Every copy carries the same sequence number, so subscribers keep
+     * the first one.
+     * 
+     * @return true if at least one path accepted it
+     */
+    bool _sendAll(const uint8_t* data, size_t len) {
+        uint8_t sealed[SEALED_SIZE];
+        if (_auth.enabled()) {
+            len = _auth.seal(data, len, sealed, sizeof(sealed), _authSender, _authSeq++);
+            if (len == 0) return false;
+            data = sealed;
+        }
+        bool sent = _transmit(data, len);
+        for (size_t i = 0; i < _numPaths; i++) {
+            if (_paths[i].send(data, len)) {
+                _account(len);
+                sent = true;
+            }
+        }
+        return sent;
+    }
+    
+    /**
+     * @brief Send msg as a frame, followed by the group parity when complete
+     */
+    bool _publishFramed(const T& msg) {
+        uint8_t frame[sizeof(FrameHeader) + sizeof(T)];
+        uint8_t* payload = frame + sizeof(FrameHeader);
+        detail::encodeMessage(msg, payload);
+        
+        FrameHeader hdr;
+        if (_fec.enabled()) {
+            hdr.fecK = _fec.groupSize();
+            hdr.fecIndex = _fec.nextIndex();
+        }
+        hdr.seq = _seq++;
+        hdr.stream = _stream;
+        memcpy(frame, &hdr, sizeof(hdr));
+        bool success = _sendAll(frame, sizeof(frame));
+        
+        // Parity is built from what we meant to send, even if this send failed
+        if (_fec.enabled() && _fec.add(payload)) {
+            hdr.flags = FRAME_PARITY;
+            hdr.fecIndex = hdr.fecK;
+            hdr.seq = hdr.seq - (hdr.fecK - 1);  // Group base
+            memcpy(frame, &hdr, sizeof(hdr));
+            memcpy(payload, _fec.parity(), sizeof(T));
+            _fec.reset();
+            // Parity completes a group that was already admitted, so it is
+            // charged to the budget rather than gated by it
+            _bucket.consume(nowUs(), sizeof(frame) * (_numPaths + 1));
+            if (_sendAll(frame, sizeof(frame))) {
+                _parityCount++;
+            }
+        }
+        return success;
+    }
+    
     const char* _topicName;
     const char* _remoteIP;
+    char _remoteBuffer[16] = {};  // Set by setRemote()
     uint16_t _remotePort;
     uint16_t _localPort;
     QoSProfile _qos;
     bool _broadcast;
-    WiFiUDP _udp;
+    Transport* _transport;
+    UdpSocket _socket;
+    UdpSocket _paths[MAX_PATHS - 1];
+    size_t _numPaths = 0;
+    FecEncoder<sizeof(T)> _fec;
+    uint32_t _seq = 0;
+    uint32_t _stream = detail::randomId();  // Fresh on every start, so restarts get a new window
+    MessageAuth _auth;
+    uint64_t _authSeq = 0;
+    uint32_t _authSender = 0;
     uint32_t _pubCount;
+    uint32_t _parityCount = 0;
     uint64_t _lastPubTime = 0;
+    uint64_t _byteCount = 0;
+    uint32_t _throttledCount = 0;
+    RateEstimator _byteRate;
+    RateEstimator _msgRate;
+    TokenBucket _bucket;
+    T _deferred;
+    bool _hasDeferred = false;
+    DeadbandSet _deadbands;
+    uint8_t _reference[sizeof(T)];  // Last message sent in on-change mode
+    uint32_t _referenceUs = 0;
+    uint32_t _heartbeatUs = 0;
+    uint32_t _suppressedCount = 0;
+    bool _hasReference = false;
+    bool _onChange = false;
+    TraceRecorder* _trace = nullptr;
+    uint8_t _traceId = TraceRecorder::NO_ENTITY;
+    bool _usesDiscovery;
     bool _initialized;
 };
 
+// =============================================================================
+// Coroutine Waits
+// =============================================================================
+
+/**
+ * @brief A suspended coroutine parked in a Node until a condition holds
+ *        or a deadline passes
+ * 
+ * Filled in by the awaiters below (sub.next(), timer.tick(),
+ * node.sleepFor()); Node::spinOnce() polls and resumes them. The
+ * coroutine type itself is in capybarish_coro.h.
+ */
+struct CoroutineWait {
+    void* awaiter;
+    bool (*ready)(void* awaiter);                // nullptr: deadline only
+    void (*resume)(void* awaiter, bool timedOut);
+    int fd = -1;                                 // Socket that signals readiness, if any
+    bool poll = true;                            // ready() can change without fd or timer activity
+    uint32_t deadlineUs = 0;
+    bool timed = false;
+};
+
+bool addCoroutineWait(Node* node, const CoroutineWait& wait);
+
+/**
+ * @brief Common part of the awaiters: parks the coroutine in a Node
+ * 
+ * await_suspend() is a template on the handle type, so this header does
+ * not depend on <coroutine>.
+ */
+class CoroutineAwaiter {
+public:
+    bool timedOut() const { return _timedOut; }
+    
+protected:
+    /**
+     * @return false (resume immediately) if there is no node to wait in
+     */
+    template<typename Handle>
+    bool _park(Handle handle, Node* node, bool (*ready)(void*), int fd, bool poll, uint32_t timeoutUs) {
+        _frame = handle.address();
+        _resumeFrame = [](void* frame) { Handle::from_address(frame).resume(); };
+        
+        CoroutineWait wait;
+        wait.awaiter = this;
+        wait.ready = ready;
+        wait.resume = [](void* self, bool timedOut) {
+            auto* awaiter = static_cast<CoroutineAwaiter*>(self);
+            awaiter->_timedOut = timedOut;
+            awaiter->_resumeFrame(awaiter->_frame);
+        };
+        wait.fd = fd;
+        wait.poll = poll;
+        wait.timed = timeoutUs > 0;
+        wait.deadlineUs = nowUs() + timeoutUs;
+        if (node && addCoroutineWait(node, wait)) return true;
+        _timedOut = true;
+        return false;
+    }
+    
+    void* _frame = nullptr;
+    void (*_resumeFrame)(void*) = nullptr;
+    bool _timedOut = false;
+};
+
 // =============================================================================
 // Subscription
 // =============================================================================
@@ -313,17 +1328,25 @@ using SubscriptionCallback = std::function<void(const T&)>;
  * }
  * 
  * auto sub = node.createSubscription<MotorCommand>("/motor/command", onCommand, 6666);
+ * 
+ * // Shared broadcast topic: skip other joints' commands before decoding
+ * static cpy::ContentFilter mine;
+ * mine.addField<&MotorCommand::joint_id>("joint_id");
+ * mine.compile("joint_id == 3 || joint_id == -1");
+ * sub->setFilter(&mine);
  * @endcode
  */
 template<typename T>
 class Subscription {
 public:
     Subscription(const char* topicName, SubscriptionCallback<T> callback,
-                 uint16_t localPort, QoSProfile qos = QoSProfile::defaultProfile())
+                 uint16_t localPort, QoSProfile qos = QoSProfile::defaultProfile(),
+                 Transport* transport = nullptr)
         : _topicName(topicName)
         , _callback(callback)
         , _localPort(localPort)
         , _qos(qos)
+        , _transport(transport)
         , _recvCount(0)
         , _dropCount(0)
         , _initialized(false)
@@ -335,7 +1358,13 @@ public:
      * @brief Initialize the subscription (bind to port)
      */
     bool init() {
-        _initialized = _udp.begin(_localPort);
+        if (_transport) {
+            _initialized = true;
+            Serial.printf("[Subscription] %s <- %s:%d\n", _topicName, _transport->name(), _localPort);
+            return true;
+        }
+        
+        _initialized = _sock.begin(_localPort);
         if (_initialized) {
             Serial.printf("[Subscription] %s <- port %d\n", _topicName, _localPort);
         } else {
@@ -349,30 +1378,13 @@ public:
      * @param multicastIP Multicast group IP to join (e.g., "239.255.0.1")
      */
     bool initMulticast(const char* multicastIP) {
-        IPAddress mcastAddr;
-        mcastAddr.fromString(multicastIP);
-        
-        // ESP32 WiFiUDP has beginMulticast method
-        _initialized = _udp.beginMulticast(mcastAddr, _localPort);
+        if (_transport) return init();  // Point-to-point link, no groups
         
+        _initialized = _sock.begin(_localPort) && _sock.joinMulticast(multicastIP);
         if (_initialized) {
             Serial.printf("[Subscription] %s <- MULTICAST %s:%d\n", _topicName, multicastIP, _localPort);
         } else {
-            // Fallback: try regular bind and manually join multicast group
-            _initialized = _udp.begin(_localPort);
-            if (_initialized) {
-                #ifdef ESP32
-                // Join multicast group using IGMP
-                ip4_addr_t mcast4;
-                mcast4.addr = (uint32_t)mcastAddr;
-                ip4_addr_t any4 = {0};  // 0.0.0.0 = any interface
-                igmp_joingroup(&any4, &mcast4);
-                #endif
-                Serial.printf("[Subscription] %s <- MULTICAST %s:%d (igmp)\n", 
-                              _topicName, multicastIP, _localPort);
-            } else {
-                Serial.printf("[Subscription] FAILED multicast %s:%d\n", multicastIP, _localPort);
-            }
+            Serial.printf("[Subscription] FAILED multicast %s:%d\n", multicastIP, _localPort);
         }
         return _initialized;
     }
@@ -382,35 +1394,16 @@ public:
      * @return true if a message was processed
      */
     bool spinOnce() {
-        if (!_initialized) return false;
-        
-        int packetSize = _udp.parsePacket();
-        if (packetSize == 0) return false;
-        
-        if ((size_t)packetSize < sizeof(T)) {
-            // Flush invalid packet
-            while (_udp.available()) _udp.read();
-            _dropCount++;
-            return false;
-        }
-        
-        uint8_t buffer[sizeof(T)];
-        _udp.read(buffer, sizeof(T));
+        if (_pool) return _spinShared();
         
         T msg;
-        // Use fromBytes() if available, otherwise deserialize()
-        if constexpr (requires { T::fromBytes(buffer, sizeof(T)); }) {
-            msg = T::fromBytes(buffer, sizeof(T));
-        } else {
-            memcpy(&msg, buffer, sizeof(T));
-        }
-        
-        _recvCount++;
-        _lastRecvTime = micros();
+        if (!_receive(msg)) return false;
         
         // Call the callback
         if (_callback) {
+            if (_trace) _trace->record(TraceEventType::CALLBACK_BEGIN, _traceId);
             _callback(msg);
+            if (_trace) _trace->record(TraceEventType::CALLBACK_END, _traceId);
         }
         
         return true;
@@ -433,48 +1426,1321 @@ public:
      * @brief Take a message without callback (polling mode)
      */
     bool take(T& msg) {
-        if (!_initialized) return false;
+        return _receive(msg);
+    }
+    
+    /**
+     * @brief Take a message into a pooled buffer (polling mode, see setPool())
+     * @return false if none is pending, no pool is set or it is exhausted
+     */
+    bool take(MessagePtr<T>& msg) {
+        if (!_pool) return false;
+        MessagePtr<T> next = _pool->acquire();
+        if (!next || !_receive(*next.edit())) return false;
+        msg = std::move(next);
+        return true;
+    }
+    
+    /**
+     * @brief Awaiter for the next message (C++20 coroutines)
+     * 
+     * Used on a subscription created without a callback, in a coroutine
+     * run by the owning Node (see capybarish_coro.h).
+     */
+    class NextAwaiter : public CoroutineAwaiter {
+    public:
+        NextAwaiter(Subscription* sub, uint32_t timeoutUs) : _sub(sub), _timeoutUs(timeoutUs) {}
         
-        int packetSize = _udp.parsePacket();
-        if (packetSize == 0) return false;
+        bool await_ready() { return _sub->take(_msg); }
         
-        if ((size_t)packetSize < sizeof(T)) {
-            while (_udp.available()) _udp.read();
-            _dropCount++;
-            return false;
+        template<typename Handle>
+        bool await_suspend(Handle handle) {
+            return _park(handle, _sub->_node, [](void* self) {
+                auto* a = static_cast<NextAwaiter*>(static_cast<CoroutineAwaiter*>(self));
+                return a->_sub->take(a->_msg);
+            }, _sub->fd(), true, _timeoutUs);
         }
         
-        uint8_t buffer[sizeof(T)];
-        _udp.read(buffer, sizeof(T));
-        
-        if constexpr (requires { T::fromBytes(buffer, sizeof(T)); }) {
-            msg = T::fromBytes(buffer, sizeof(T));
-        } else {
-            memcpy(&msg, buffer, sizeof(T));
+        std::optional<T> await_resume() {
+            if (_timedOut) return std::nullopt;
+            return _msg;
         }
         
-        _recvCount++;
-        _lastRecvTime = micros();
-        return true;
+    private:
+        Subscription* _sub;
+        uint32_t _timeoutUs;
+        T _msg;
+    };
+    
+    /**
+     * @brief co_await the next message
+     * 
+     * @param timeoutUs Give up after this long (0 = wait forever)
+     * @return The message, or std::nullopt on timeout
+     */
+    NextAwaiter next(uint32_t timeoutUs = 0) { return NextAwaiter(this, timeoutUs); }
+    
+    /**
+     * @brief Only deliver messages matching @p filter (nullptr = all)
+     * 
+     * The filter runs on the serialized payload, before the message is
+     * decoded or counted as received. It is not copied and must outlive
+     * the subscription.
+     */
+    void setFilter(const ContentFilter* filter) { _filter = filter; }
+    
+    /**
+     * @brief Also store every accepted message in @p output (nullptr = off)
+     * 
+     * The subscription is the output's only writer; other tasks or ISRs
+     * read the latest message from it without locking. Not copied, must
+     * outlive the subscription.
+     */
+    void setOutput(Seqlock<T>* output) { _seqlockOut = output; }
+    void setOutput(TripleBuffer<T>* output) { _tripleOut = output; }
+    
+    /**
+     * @brief Receive into buffers from @p pool and pass them to @p callback
+     *        as shared handles instead of copies (nullptr pool = off)
+     * 
+     * The callback may keep the handle (queue it for another task, hand it
+     * to a LocalTopic); the buffer returns to the pool when the last copy
+     * is dropped. While every buffer is held, incoming messages are
+     * dropped and counted by getPoolDropCount().
+     */
+    void setPool(MessagePool<T>* pool, SharedCallback<T> callback = nullptr) {
+        _pool = pool;
+        _sharedCallback = callback;
     }
     
+    /**
+     * @brief Descriptor that becomes readable when a datagram arrives
+     * @return -1 when the subscription can only be polled (transport or
+     *         a platform without lwIP sockets)
+     */
+    int fd() const { return _transport ? -1 : _sock.fd(); }
+    
+    /**
+     * @brief Whether a message is already buffered (rebuilt by FEC)
+     */
+    bool hasBuffered() const { return _hasRecovered; }
+    
+    bool hasCallback() const { return static_cast<bool>(_callback) || static_cast<bool>(_sharedCallback); }
+    bool hasOutput() const { return _seqlockOut || _tripleOut; }
+    
     const char* getTopicName() const { return _topicName; }
+    uint16_t getLocalPort() const { return _localPort; }
     uint32_t getReceiveCount() const { return _recvCount; }
     uint32_t getDropCount() const { return _dropCount; }
+    uint32_t getRecoveredCount() const { return _recoveredCount; }
+    
+    /**
+     * @brief Rebuilt messages dropped because a newer one had already been
+     *        delivered (QoSProfile::dropStaleRecovered)
+     */
+    uint32_t getStaleRecoveredCount() const { return _staleRecoveredCount; }
+    uint32_t getDuplicateCount() const { return _duplicateCount; }
+    uint32_t getFilteredCount() const { return _filteredCount; }
+    uint32_t getPoolDropCount() const { return _poolDropCount; }
     uint64_t getLastReceiveTime() const { return _lastRecvTime; }
     
+    /**
+     * @brief Datagrams dropped for a missing or wrong authentication tag,
+     *        or from a sender beyond ReplayGuard::MAX_SENDERS
+     */
+    uint32_t getAuthFailCount() const { return _authFailCount; }
+    
+    /**
+     * @brief Accept only datagrams sealed with @p key (see capybarish_auth.h)
+     * 
+     * Replayed datagrams are dropped and counted as duplicates. On the
+     * ESP32 the replay checkpoints saved in NVS before a reboot are
+     * restored, and new ones are saved as they are reached.
+     */
+    void setAuth(const AuthKey& key) {
+        _auth.begin(key, _topicName);
+        _replay.reset();
+        #ifdef ESP32
+        loadReplayCheckpoints(_topicName, _replay);
+        #endif
+    }
+    
+    void clearAuth() { _auth.end(); }
+    bool hasAuth() const { return _auth.enabled(); }
+    
+    /**
+     * @brief Accept the next authentic sequence number of every sender,
+     *        however old, checkpoints included
+     * 
+     * For a publisher that had to start over (e.g. lost its boot counter);
+     * until then its datagrams count as duplicates.
+     */
+    void resetReplayWindow() { _replay.reset(); }
+    
+    /**
+     * @brief Record this subscription's activity in @p trace (nullptr = stop)
+     */
+    void setTrace(TraceRecorder* trace) {
+        _trace = trace;
+        _traceId = trace ? trace->addEntity(TraceEntityKind::SUBSCRIPTION, _topicName) : TraceRecorder::NO_ENTITY;
+    }
+    
     static constexpr size_t msgSize() { return sizeof(T); }
     
-private:
-    const char* _topicName;
-    SubscriptionCallback<T> _callback;
+private:
+    friend class Node;
+    
+    /**
+     * @brief Receive the next message, plain or framed
+     * 
+     * A message rebuilt by FEC is parked in _recovered and returned by the
+     * following call, so spinOnce()/take() still yield one message each.
+     */
+    bool _receive(T& msg) {
+        if (!_initialized) return false;
+        
+        if (_hasRecovered) {
+            _hasRecovered = false;
+            if (_accept(_recovered)) {
+                _decode(_recovered, msg);
+                _output(msg);
+                _recvCount++;
+                _recoveredCount++;
+                _lastRecvTime = nowUs();
+                if (_trace) _trace->record(TraceEventType::PACKET, _traceId, sizeof(T));
+                return true;
+            }
+        }
+        
+        while (true) {
+            // One spare byte so an oversized datagram never passes as a frame
+            uint8_t buffer[sizeof(FrameHeader) + sizeof(T) + AUTH_TRAILER_SIZE + 1];
+            size_t packetSize = _readPacket(buffer, sizeof(buffer));
+            if (packetSize == 0) return false;
+            
+            if (_auth.enabled()) {
+                uint32_t sender;
+                uint64_t seq;
+                size_t opened = packetSize < sizeof(buffer) ? _auth.open(buffer, packetSize, sender, seq) : 0;
+                if (opened == 0) {
+                    _authFailCount++;
+                    continue;
+                }
+                ReplayResult result = _replay.accept(sender, seq);
+                if (result == ReplayResult::TOO_MANY_SENDERS) {
+                    _authFailCount++;
+                    continue;
+                }
+                if (result == ReplayResult::REPLAYED) {
+                    _duplicateCount++;  // Replayed, or a later copy from another path
+                    continue;
+                }
+                #ifdef ESP32
+                if (_replay.checkpointDue()) saveReplayCheckpoints(_topicName, _replay);
+                #endif
+                packetSize = opened;
+            }
+            
+            if (packetSize < sizeof(T)) {
+                _dropCount++;
+                return false;
+            }
+            size_t len = min(packetSize, sizeof(buffer));
+            
+            const uint8_t* payload = buffer;
+            if (isFrame(buffer, packetSize, sizeof(T))) {
+                FrameHeader hdr;
+                memcpy(&hdr, buffer, sizeof(hdr));
+                payload = buffer + sizeof(FrameHeader);
+                
+                // Later copies from redundant paths
+                FrameStream<sizeof(T)>& stream = _streams.get(hdr.stream);
+                if (!hdr.isParity() && !stream.seen.accept(hdr.seq)) {
+                    _duplicateCount++;
+                    continue;
+                }
+                
+                uint8_t result = stream.fec.push(hdr, payload, _recovered);
+                if (result & FEC_RECOVERED) {
+                    const uint32_t seq = stream.fec.recoveredSeq();
+                    const bool stale = !seqNewer(seq, stream.seen.newest());
+                    _hasRecovered = stream.seen.accept(seq);
+                    if (_hasRecovered && stale && _qos.dropStaleRecovered) {
+                        _hasRecovered = false;
+                        _staleRecoveredCount++;
+                    }
+                }
+                if (!(result & FEC_DELIVER)) {
+                    if (_hasRecovered) return _receive(msg);
+                    continue;  // Parity, duplicate or stale frame
+                }
+            } else if (len < sizeof(T)) {
+                _dropCount++;
+                return false;
+            }
+            
+            if (!_accept(payload)) continue;
+            _decode(payload, msg);
+            _output(msg);
+            _recvCount++;
+            _lastRecvTime = nowUs();
+            if (_trace) _trace->record(TraceEventType::PACKET, _traceId, static_cast<uint32_t>(packetSize));
+            return true;
+        }
+    }
+    
+    /**
+     * @brief Read the next datagram from the transport or UDP socket
+     * @return Datagram length (the socket caps it at @p capacity), 0 if
+     *         none is pending
+     */
+    size_t _readPacket(uint8_t* buffer, size_t capacity) {
+        if (_transport) {
+            return _transport->receive(_localPort, buffer, capacity);
+        }
+        return _sock.receive(buffer, capacity);
+    }
+    
+    /**
+     * @brief Apply the content filter to a serialized payload
+     */
+    bool _accept(const uint8_t* payload) {
+        if (!_filter || _filter->match(payload, sizeof(T))) return true;
+        _filteredCount++;
+        return false;
+    }
+    
+    /**
+     * @brief spinOnce() with a pool: decode in place, share the buffer
+     */
+    bool _spinShared() {
+        MessagePtr<T> msg = _pool->acquire();
+        if (!msg) {
+            // Every buffer is still held; drop rather than stall the socket
+            T scratch;
+            if (!_receive(scratch)) return false;
+            _poolDropCount++;
+            return true;
+        }
+        if (!_receive(*msg.edit())) return false;
+        
+        if (_sharedCallback) {
+            if (_trace) _trace->record(TraceEventType::CALLBACK_BEGIN, _traceId);
+            _sharedCallback(msg);
+            if (_trace) _trace->record(TraceEventType::CALLBACK_END, _traceId);
+        }
+        return true;
+    }
+    
+    void _output(const T& msg) {
+        if (_seqlockOut) _seqlockOut->write(msg);
+        if (_tripleOut) _tripleOut->write(msg);
+    }
+    
+    static void _decode(const uint8_t* buffer, T& msg) { detail::decodeMessage(buffer, msg); }
+    
+    const char* _topicName;
+    SubscriptionCallback<T> _callback;
+    uint16_t _localPort;
+    QoSProfile _qos;
+    Transport* _transport;
+    UdpSocket _sock;
+    StreamTable<FrameStream<sizeof(T)>> _streams;  // Duplicate filter and FEC per publisher
+    MessageAuth _auth;
+    ReplayGuard _replay;
+    uint32_t _authFailCount = 0;
+    uint8_t _recovered[sizeof(T)];
+    bool _hasRecovered = false;
+    uint32_t _recvCount;
+    uint32_t _dropCount;
+    uint32_t _recoveredCount = 0;
+    uint32_t _staleRecoveredCount = 0;
+    uint32_t _duplicateCount = 0;
+    uint32_t _filteredCount = 0;
+    const ContentFilter* _filter = nullptr;
+    Seqlock<T>* _seqlockOut = nullptr;
+    TripleBuffer<T>* _tripleOut = nullptr;
+    MessagePool<T>* _pool = nullptr;
+    SharedCallback<T> _sharedCallback;
+    uint32_t _poolDropCount = 0;
+    uint64_t _lastRecvTime = 0;
+    Node* _node = nullptr;  // Owner, for coroutine waits
+    TraceRecorder* _trace = nullptr;
+    uint8_t _traceId = TraceRecorder::NO_ENTITY;
+    bool _initialized;
+};
+
+// =============================================================================
+// Generic Publisher / Subscription
+// =============================================================================
+
+/**
+ * @brief Callback for untyped messages (valid only during the call)
+ */
+using GenericCallback = std::function<void(const uint8_t* data, size_t len)>;
+
+/**
+ * @brief Largest datagram an opaque GenericSubscription accepts
+ * 
+ * One UDP datagram in a 1500-byte Ethernet/WiFi MTU.
+ */
+constexpr size_t MAX_GENERIC_MESSAGE_SIZE = 1472;
+
+/**
+ * @brief Subscribes to a topic whose type is only known at run time
+ * 
+ * With a MessageSchema, it behaves like Subscription<T> for a T of that
+ * size: sequenced frames are unwrapped and deduplicated, datagrams too
+ * short for the message are dropped, and a content filter (built from the
+ * schema fields) can reject messages. FEC parity is skipped, since lost
+ * frames are not rebuilt here. Without a schema the subscription is
+ * opaque: every datagram, framed or not, is delivered verbatim, which is
+ * what a bridge forwarding to another transport wants.
+ * 
+ * @example
+ * @code
+ * cpy::SchemaSet schemas;
+ * const cpy::MessageSchema* fb = schemas.add<SensorData>();
+ * 
+ * auto* sub = node.createGenericSubscription("/motor/feedback", fb,
+ *     [&](const uint8_t* data, size_t len) {
+ *         cpy::MessageView view(*fb, data, len);
+ *         double pos;
+ *         if (view.getDouble("motor.pos", pos)) Serial.println(pos);
+ *     }, 6667);
+ * @endcode
+ */
+class GenericSubscription {
+public:
+    GenericSubscription(const char* topicName, const MessageSchema* schema, GenericCallback callback,
+                        uint16_t localPort, QoSProfile qos = QoSProfile::defaultProfile(),
+                        Transport* transport = nullptr)
+        : _topicName(topicName)
+        , _schema(schema)
+        , _callback(callback)
+        , _localPort(localPort)
+        , _qos(qos)
+        , _transport(transport)
+        // One spare byte so an oversized datagram never passes as a frame
+        , _buffer(schema ? sizeof(FrameHeader) + schema->size() + 1 : MAX_GENERIC_MESSAGE_SIZE)
+    {
+        TopicRegistry::instance().registerTopic(topicName, localPort, schema ? schema->size() : 0, false);
+    }
+    
+    /**
+     * @brief Initialize the subscription (bind to port)
+     */
+    bool init() {
+        if (_transport) {
+            _initialized = true;
+            Serial.printf("[Subscription] %s <- %s:%d (generic)\n", _topicName, _transport->name(), _localPort);
+            return true;
+        }
+        
+        _initialized = _sock.begin(_localPort);
+        if (_initialized) {
+            Serial.printf("[Subscription] %s <- port %d (generic)\n", _topicName, _localPort);
+        } else {
+            Serial.printf("[Subscription] FAILED to bind %s to port %d\n", _topicName, _localPort);
+        }
+        return _initialized;
+    }
+    
+    /**
+     * @brief Initialize with multicast group membership
+     */
+    bool initMulticast(const char* multicastIP) {
+        if (_transport) return init();
+        
+        _initialized = _sock.begin(_localPort) && _sock.joinMulticast(multicastIP);
+        if (!_initialized) {
+            Serial.printf("[Subscription] FAILED multicast %s:%d\n", multicastIP, _localPort);
+        }
+        return _initialized;
+    }
+    
+    /**
+     * @brief Process one pending message (non-blocking)
+     * @return true if a message was processed
+     */
+    bool spinOnce() {
+        const uint8_t* data;
+        size_t len = _receive(data);
+        if (len == 0) return false;
+        if (_callback) {
+            if (_trace) _trace->record(TraceEventType::CALLBACK_BEGIN, _traceId);
+            _callback(data, len);
+            if (_trace) _trace->record(TraceEventType::CALLBACK_END, _traceId);
+        }
+        return true;
+    }
+    
+    /**
+     * @brief Process all pending messages (at most the QoS depth)
+     */
+    size_t spinAll() {
+        size_t count = 0;
+        while (count < _qos.depth && spinOnce()) count++;
+        return count;
+    }
+    
+    /**
+     * @brief Copy the next message into @p out (polling mode)
+     * @return Message length, 0 if none is pending or it exceeds @p capacity
+     */
+    size_t take(uint8_t* out, size_t capacity) {
+        const uint8_t* data;
+        size_t len = _receive(data);
+        if (len == 0 || len > capacity) return 0;
+        memcpy(out, data, len);
+        return len;
+    }
+    
+    /**
+     * @brief Only deliver messages matching @p filter (nullptr = all)
+     * 
+     * Register the fields with MessageSchema::addToFilter(). The filter is
+     * not copied and must outlive the subscription.
+     */
+    void setFilter(const ContentFilter* filter) { _filter = filter; }
+    
+    int fd() const { return _transport ? -1 : _sock.fd(); }
+    bool hasBuffered() const { return false; }
+    bool hasCallback() const { return static_cast<bool>(_callback); }
+    
+    const char* getTopicName() const { return _topicName; }
+    const MessageSchema* getSchema() const { return _schema; }
+    uint16_t getLocalPort() const { return _localPort; }
+    uint32_t getReceiveCount() const { return _recvCount; }
+    uint32_t getDropCount() const { return _dropCount; }
+    uint32_t getDuplicateCount() const { return _duplicateCount; }
+    uint32_t getFilteredCount() const { return _filteredCount; }
+    uint64_t getLastReceiveTime() const { return _lastRecvTime; }
+    
+    /**
+     * @brief Record this subscription's activity in @p trace (nullptr = stop)
+     */
+    void setTrace(TraceRecorder* trace) {
+        _trace = trace;
+        _traceId = trace ? trace->addEntity(TraceEntityKind::SUBSCRIPTION, _topicName) : TraceRecorder::NO_ENTITY;
+    }
+    
+private:
+    /**
+     * @brief Receive the next message into _buffer
+     * @return Message length (0 if none), with @p data set to its first byte
+     */
+    size_t _receive(const uint8_t*& data) {
+        if (!_initialized) return 0;
+        
+        while (true) {
+            size_t packetSize = _transport
+                ? _transport->receive(_localPort, _buffer.data(), _buffer.size())
+                : _sock.receive(_buffer.data(), _buffer.size());
+            if (packetSize == 0) return 0;
+            
+            size_t len = min(packetSize, _buffer.size());
+            data = _buffer.data();
+            if (_schema) {
+                if (isFrame(data, packetSize, _schema->size())) {
+                    FrameHeader hdr;
+                    memcpy(&hdr, data, sizeof(hdr));
+                    if (hdr.isParity()) continue;
+                    if (!_streams.get(hdr.stream).accept(hdr.seq)) {
+                        _duplicateCount++;
+                        continue;
+                    }
+                    data += sizeof(FrameHeader);
+                } else if (len < _schema->size()) {
+                    _dropCount++;
+                    return 0;
+                }
+                len = _schema->size();
+            }
+            
+            if (_filter && !_filter->match(data, len)) {
+                _filteredCount++;
+                continue;
+            }
+            _recvCount++;
+            _lastRecvTime = nowUs();
+            if (_trace) _trace->record(TraceEventType::PACKET, _traceId, static_cast<uint32_t>(packetSize));
+            return len;
+        }
+    }
+    
+    const char* _topicName;
+    const MessageSchema* _schema;
+    GenericCallback _callback;
+    uint16_t _localPort;
+    QoSProfile _qos;
+    Transport* _transport;
+    UdpSocket _sock;
+    StreamTable<SeqWindow> _streams;  // Duplicate filter per publisher
+    std::vector<uint8_t> _buffer;
+    const ContentFilter* _filter = nullptr;
+    uint32_t _recvCount = 0;
+    uint32_t _dropCount = 0;
+    uint32_t _duplicateCount = 0;
+    uint32_t _filteredCount = 0;
+    uint64_t _lastRecvTime = 0;
+    TraceRecorder* _trace = nullptr;
+    uint8_t _traceId = TraceRecorder::NO_ENTITY;
+    bool _initialized = false;
+};
+
+/**
+ * @brief Publishes raw buffers to a topic whose type is only known at run time
+ * 
+ * Buffers go out as single datagrams, exactly as given, so a bridge keeps
+ * the sender's frame headers intact. With a schema, buffers of the wrong
+ * size are refused. A bandwidth budget applies as for Publisher<T>, but
+ * over budget messages are always dropped (nothing is deferred).
+ */
+class GenericPublisher {
+public:
+    GenericPublisher(const char* topicName, const MessageSchema* schema, const char* remoteIP,
+                     uint16_t remotePort, uint16_t localPort = 0,
+                     QoSProfile qos = QoSProfile::defaultProfile(), bool broadcast = false,
+                     Transport* transport = nullptr)
+        : _topicName(topicName)
+        , _schema(schema)
+        , _remoteIP(remoteIP)
+        , _remotePort(remotePort)
+        , _localPort(localPort)
+        , _qos(qos)
+        , _broadcast(broadcast)
+        , _transport(transport)
+    {
+        TopicRegistry::instance().registerTopic(topicName, remotePort, schema ? schema->size() : 0, true);
+        if (qos.rateLimitBytesPerSec > 0) {
+            // Room for at least one datagram, or nothing could pass
+            uint32_t burst = qos.burstBytes > 0 ? qos.burstBytes : qos.rateLimitBytesPerSec / 10;
+            size_t largest = schema ? sizeof(FrameHeader) + schema->size() : MAX_GENERIC_MESSAGE_SIZE;
+            _bucket.configure(qos.rateLimitBytesPerSec, max<uint32_t>(burst, largest), nowUs());
+        }
+    }
+    
+    /**
+     * @brief Initialize the publisher (call after WiFi is connected)
+     */
+    bool init() {
+        if (_transport) {
+            _initialized = true;
+            Serial.printf("[Publisher] %s -> %s:%d (generic)\n", _topicName, _transport->name(), _remotePort);
+            return true;
+        }
+        
+        _initialized = _socket.begin(_localPort) &&
+                       _socket.setRemote(_broadcast ? "255.255.255.255" : _remoteIP, _remotePort);
+        if (_initialized) {
+            _socket.setTrafficClass(_qos.trafficClass);
+            Serial.printf("[Publisher] %s -> %s:%d (generic) [%s]\n", _topicName,
+                          _broadcast ? "BROADCAST" : _remoteIP, _remotePort,
+                          trafficClassName(_qos.trafficClass));
+        }
+        return _initialized;
+    }
+    
+    /**
+     * @brief Send one message (or frame) as a datagram
+     * @return false if refused by size or budget, or the send failed
+     */
+    bool publish(const uint8_t* data, size_t len) {
+        if (!_initialized) return false;
+        if (_schema && len != _schema->size() &&
+            !isFrame(data, len, _schema->size())) {
+            return false;
+        }
+        if (!_bucket.tryConsume(nowUs(), len)) {
+            _throttledCount++;
+            return false;
+        }
+        
+        bool sent = _transport ? _transport->send(_remotePort, data, len) : _socket.send(data, len);
+        if (sent) {
+            _pubCount++;
+            _byteCount += len;
+            _lastPubTime = nowUs();
+            _byteRate.add(_lastPubTime, len);
+            _msgRate.add(_lastPubTime);
+            if (_trace) _trace->record(TraceEventType::PUBLISH, _traceId, static_cast<uint32_t>(len));
+        }
+        return sent;
+    }
+    
+    const char* getTopicName() const { return _topicName; }
+    const MessageSchema* getSchema() const { return _schema; }
+    uint16_t getRemotePort() const { return _remotePort; }
+    uint32_t getPublishCount() const { return _pubCount; }
+    uint64_t getByteCount() const { return _byteCount; }
+    uint32_t getThrottledCount() const { return _throttledCount; }
+    uint64_t getLastPublishTime() const { return _lastPubTime; }
+    
+    /**
+     * @brief Record this publisher's activity in @p trace (nullptr = stop)
+     */
+    void setTrace(TraceRecorder* trace) {
+        _trace = trace;
+        _traceId = trace ? trace->addEntity(TraceEntityKind::PUBLISHER, _topicName) : TraceRecorder::NO_ENTITY;
+    }
+    float getBytesPerSec() const { return _byteRate.rate(nowUs()); }
+    float getMessagesPerSec() const { return _msgRate.rate(nowUs()); }
+    
+private:
+    const char* _topicName;
+    const MessageSchema* _schema;
+    const char* _remoteIP;
+    uint16_t _remotePort;
+    uint16_t _localPort;
+    QoSProfile _qos;
+    bool _broadcast;
+    Transport* _transport;
+    UdpSocket _socket;
+    uint32_t _pubCount = 0;
+    uint64_t _byteCount = 0;
+    uint32_t _throttledCount = 0;
+    uint64_t _lastPubTime = 0;
+    RateEstimator _byteRate;
+    RateEstimator _msgRate;
+    TokenBucket _bucket;
+    TraceRecorder* _trace = nullptr;
+    uint8_t _traceId = TraceRecorder::NO_ENTITY;
+    bool _initialized = false;
+};
+
+// =============================================================================
+// Services
+// =============================================================================
+
+constexpr uint8_t RPC_MAGIC = 0xCC;  ///< First byte of every service datagram
+constexpr uint8_t RPC_REQUEST = 1;
+constexpr uint8_t RPC_RESPONSE = 2;
+
+/**
+ * @brief Outcome of a service call
+ */
+enum class RpcStatus : uint8_t {
+    OK = 0,
+    REJECTED = 1,     ///< The handler refused the request
+    BAD_REQUEST = 2,  ///< The request does not have the service's request type
+    TIMEOUT = 3,      ///< No response before the deadline (set by the client)
+    CANCELLED = 4,    ///< Given up with Client::cancel() (set by the client)
+};
+
+inline const char* rpcStatusName(RpcStatus status) {
+    switch (status) {
+        case RpcStatus::OK:          return "OK";
+        case RpcStatus::REJECTED:    return "REJECTED";
+        case RpcStatus::BAD_REQUEST: return "BAD_REQUEST";
+        case RpcStatus::TIMEOUT:     return "TIMEOUT";
+        case RpcStatus::CANCELLED:   return "CANCELLED";
+    }
+    return "?";
+}
+
+/**
+ * @brief Header in front of every request and response datagram
+ * 
+ * A request carries a Req, a response with status OK a Resp; other
+ * responses are the header alone.
+ */
+#pragma pack(push, 1)
+struct RpcHeader {
+    uint8_t magic = RPC_MAGIC;
+    uint8_t kind = RPC_REQUEST;
+    uint8_t status = 0;        ///< RpcStatus (responses)
+    uint8_t reserved = 0;
+    uint32_t id = 0;           ///< Correlation ID chosen by the client, never 0
+    uint16_t replyPort = 0;    ///< Client's port, for transports that carry no sender address
+    uint16_t size = 0;         ///< Payload bytes that follow
+};
+#pragma pack(pop)
+static_assert(sizeof(RpcHeader) == 12, "RpcHeader must be 12 bytes");
+
+/**
+ * @brief Handler type for services
+ * @return false to reject the request (the client gets RpcStatus::REJECTED)
+ */
+template<typename Req, typename Resp>
+using ServiceHandler = std::function<bool(const Req& request, Resp& response)>;
+
+/**
+ * @brief Answers requests on a port, one response per request
+ * 
+ * For control-plane operations ("read a motor parameter", "calibrate and
+ * report") that would otherwise be flags in the command stream. Each
+ * request is handled in the node's spin and answered at once, to the
+ * address and port it came from (over a transport, to the port named in
+ * its header). Nothing is buffered or allocated per call.
+ * 
+ * @tparam Req Request message type
+ * @tparam Resp Response message type
+ * 
+ * @example
+ * @code
+ * node.createService<ParamRequest, ParamValue>("/motor/get_param",
+ *     [](const ParamRequest& req, ParamValue& resp) {
+ *         if (req.index >= NUM_PARAMS) return false;  // REJECTED
+ *         resp.value = params[req.index];
+ *         return true;
+ *     }, 6670);
+ * @endcode
+ */
+template<typename Req, typename Resp>
+class Service {
+public:
+    Service(const char* serviceName, ServiceHandler<Req, Resp> handler, uint16_t localPort,
+            QoSProfile qos = QoSProfile::services(), Transport* transport = nullptr)
+        : _serviceName(serviceName)
+        , _handler(handler)
+        , _localPort(localPort)
+        , _qos(qos)
+        , _transport(transport)
+    {}
+    
+    /**
+     * @brief Bind to the service port
+     */
+    bool init() {
+        if (_transport) {
+            _initialized = true;
+            Serial.printf("[Service] %s <- %s:%d\n", _serviceName, _transport->name(), _localPort);
+            return true;
+        }
+        
+        _initialized = _sock.begin(_localPort);
+        if (_initialized) {
+            _sock.setTrafficClass(_qos.trafficClass);
+            Serial.printf("[Service] %s <- port %d\n", _serviceName, _localPort);
+        } else {
+            Serial.printf("[Service] FAILED to bind %s to port %d\n", _serviceName, _localPort);
+        }
+        return _initialized;
+    }
+    
+    /**
+     * @brief Answer one pending request (non-blocking)
+     * @return true if a request was answered
+     */
+    bool spinOnce() {
+        if (!_initialized) return false;
+        
+        while (true) {
+            // One spare byte so an oversized request is caught
+            uint8_t buffer[sizeof(RpcHeader) + sizeof(Req) + 1];
+            uint32_t address = 0;
+            uint16_t port = 0;
+            size_t len = _transport ? _transport->receive(_localPort, buffer, sizeof(buffer))
+                                    : _sock.receiveFrom(buffer, sizeof(buffer), address, port);
+            if (len == 0) return false;
+            
+            RpcHeader request;
+            if (len < sizeof(request)) {
+                _dropCount++;
+                continue;
+            }
+            memcpy(&request, buffer, sizeof(request));
+            if (request.magic != RPC_MAGIC || request.kind != RPC_REQUEST || request.id == 0) {
+                _dropCount++;
+                continue;
+            }
+            if (_transport) port = request.replyPort;
+            if (_trace) _trace->record(TraceEventType::PACKET, _traceId, static_cast<uint32_t>(len));
+            
+            uint8_t reply[sizeof(RpcHeader) + sizeof(Resp)];
+            RpcHeader response;
+            response.kind = RPC_RESPONSE;
+            response.id = request.id;
+            response.replyPort = _localPort;
+            
+            if (request.size != sizeof(Req) || len != sizeof(RpcHeader) + sizeof(Req)) {
+                response.status = static_cast<uint8_t>(RpcStatus::BAD_REQUEST);
+                _badRequestCount++;
+            } else {
+                Req req;
+                detail::decodeMessage(buffer + sizeof(RpcHeader), req);
+                Resp resp{};
+                if (_trace) _trace->record(TraceEventType::CALLBACK_BEGIN, _traceId);
+                bool ok = _handler && _handler(req, resp);
+                if (_trace) _trace->record(TraceEventType::CALLBACK_END, _traceId);
+                if (ok) {
+                    detail::encodeMessage(resp, reply + sizeof(RpcHeader));
+                    response.size = sizeof(Resp);
+                } else {
+                    response.status = static_cast<uint8_t>(RpcStatus::REJECTED);
+                    _rejectCount++;
+                }
+            }
+            memcpy(reply, &response, sizeof(response));
+            
+            size_t replyLen = sizeof(RpcHeader) + response.size;
+            bool sent = _transport ? _transport->send(port, reply, replyLen)
+                                   : _sock.sendTo(reply, replyLen, address, port);
+            if (sent) {
+                _callCount++;
+                if (_trace) _trace->record(TraceEventType::PUBLISH, _traceId, static_cast<uint32_t>(replyLen));
+            } else {
+                _sendFailCount++;
+            }
+            return true;
+        }
+    }
+    
+    /**
+     * @brief Answer pending requests (at most qos.depth per call)
+     * @return Number of requests answered
+     */
+    size_t spinAll() {
+        size_t count = 0;
+        while (count < _qos.depth && spinOnce()) count++;
+        return count;
+    }
+    
+    /**
+     * @brief Descriptor that becomes readable when a request arrives
+     */
+    int fd() const { return _transport ? -1 : _sock.fd(); }
+    bool hasBuffered() const { return false; }
+    
+    const char* getServiceName() const { return _serviceName; }
+    uint16_t getLocalPort() const { return _localPort; }
+    uint32_t getCallCount() const { return _callCount; }           ///< Responses sent, rejections included
+    uint32_t getRejectCount() const { return _rejectCount; }
+    uint32_t getBadRequestCount() const { return _badRequestCount; }
+    uint32_t getDropCount() const { return _dropCount; }           ///< Datagrams that were not requests
+    uint32_t getSendFailCount() const { return _sendFailCount; }
+    
+    /**
+     * @brief Record this service's activity in @p trace (nullptr = stop)
+     */
+    void setTrace(TraceRecorder* trace) {
+        _trace = trace;
+        _traceId = trace ? trace->addEntity(TraceEntityKind::SERVICE, _serviceName) : TraceRecorder::NO_ENTITY;
+    }
+    
+private:
+    const char* _serviceName;
+    ServiceHandler<Req, Resp> _handler;
+    uint16_t _localPort;
+    QoSProfile _qos;
+    Transport* _transport;
+    UdpSocket _sock;
+    uint32_t _callCount = 0;
+    uint32_t _rejectCount = 0;
+    uint32_t _badRequestCount = 0;
+    uint32_t _dropCount = 0;
+    uint32_t _sendFailCount = 0;
+    TraceRecorder* _trace = nullptr;
+    uint8_t _traceId = TraceRecorder::NO_ENTITY;
+    bool _initialized = false;
+};
+
+/**
+ * @brief Callback type for clients: the outcome of one call
+ * 
+ * @p response is only meaningful when @p status is RpcStatus::OK.
+ */
+template<typename Resp>
+using ResponseCallback = std::function<void(uint32_t id, RpcStatus status, const Resp& response)>;
+
+/**
+ * @brief Calls a Service, matching responses to requests by correlation ID
+ * 
+ * Up to MAX_PENDING calls can be outstanding; each has a slot in a fixed
+ * table, with room for its response, and a deadline. The node's spin
+ * collects responses and expires deadlines. A finished call is then:
+ * - passed to the callback, if the client has one, or
+ * - kept in its slot until take(), or
+ * - returned by co_await call() in a coroutine.
+ * Responses to calls that already timed out or were cancelled are
+ * dropped (getLateCount()). Requests are not retransmitted.
+ * 
+ * Over UDP only datagrams from the server's address and port count, and
+ * IDs start at a random value, so a host that cannot see the requests
+ * can only guess at a response. (A transport carries no sender address.)
+ * 
+ * @tparam Req Request message type
+ * @tparam Resp Response message type
+ * @tparam MAX_PENDING Size of the pending-call table
+ * 
+ * @example
+ * @code
+ * auto* getParam = node.createClient<ParamRequest, ParamValue>(
+ *     "/motor/get_param", MODULE_IP, 6670, 6671);
+ * 
+ * cpy::Task readGains(cpy::Node& node) {
+ *     ParamRequest req{.index = KP};
+ *     if (auto kp = co_await getParam->call(req, 20000)) {
+ *         Serial.printf("kp = %.3f\n", kp->value);
+ *     }
+ * }
+ * 
+ * // Without coroutines: poll by ID
+ * uint32_t id = getParam->send(req, 20000);
+ * ...
+ * ParamValue value;
+ * cpy::RpcStatus status;
+ * if (getParam->take(id, value, status) && status == cpy::RpcStatus::OK) { ... }
+ * @endcode
+ */
+template<typename Req, typename Resp, size_t MAX_PENDING = 4>
+class Client {
+public:
+    /**
+     * @param serviceName Service name (for logs and traces)
+     * @param serverIP Address of the node running the service
+     * @param serverPort Service port
+     * @param localPort Port responses come back to
+     * @param callback Called with every finished call (nullptr = use take()/call())
+     */
+    Client(const char* serviceName, const char* serverIP, uint16_t serverPort, uint16_t localPort,
+           ResponseCallback<Resp> callback = nullptr, QoSProfile qos = QoSProfile::services(),
+           Transport* transport = nullptr)
+        : _serviceName(serviceName)
+        , _serverIP(serverIP)
+        , _serverPort(serverPort)
+        , _localPort(localPort)
+        , _callback(callback)
+        , _qos(qos)
+        , _transport(transport)
+        , _nextId(detail::randomId())  // Unlike a previous boot's IDs (and hard to guess on the ESPs)
+    {}
+    
+    /**
+     * @brief Bind the response port (call after WiFi is connected)
+     */
+    bool init() {
+        if (_transport) {
+            _initialized = true;
+            Serial.printf("[Client] %s -> %s:%d\n", _serviceName, _transport->name(), _serverPort);
+            return true;
+        }
+        
+        _initialized = _sock.begin(_localPort) && _sock.setRemote(_serverIP, _serverPort);
+        if (_initialized) {
+            _sock.setTrafficClass(_qos.trafficClass);
+            Serial.printf("[Client] %s -> %s:%d\n", _serviceName, _serverIP, _serverPort);
+        } else {
+            Serial.printf("[Client] FAILED %s -> %s:%d\n", _serviceName, _serverIP, _serverPort);
+        }
+        return _initialized;
+    }
+    
+    /**
+     * @brief Send a request
+     * 
+     * @param timeoutUs Give up on the response after this long (0 = never;
+     *                  free the slot with cancel())
+     * @return Correlation ID of the call, 0 if every slot is taken or the
+     *         send failed
+     */
+    uint32_t send(const Req& request, uint32_t timeoutUs) {
+        if (!_initialized) return 0;
+        Slot* slot = _find(0, FREE);
+        if (!slot) {
+            _busyCount++;
+            return 0;
+        }
+        
+        uint32_t id = _nextId++;
+        if (id == 0) id = _nextId++;
+        
+        uint8_t buffer[sizeof(RpcHeader) + sizeof(Req)];
+        RpcHeader header;
+        header.id = id;
+        header.replyPort = _localPort;
+        header.size = sizeof(Req);
+        memcpy(buffer, &header, sizeof(header));
+        detail::encodeMessage(request, buffer + sizeof(RpcHeader));
+        
+        bool sent = _transport ? _transport->send(_serverPort, buffer, sizeof(buffer))
+                               : _sock.send(buffer, sizeof(buffer));
+        if (!sent) {
+            _sendFailCount++;
+            return 0;
+        }
+        if (_trace) _trace->record(TraceEventType::PUBLISH, _traceId, sizeof(buffer));
+        
+        uint32_t now = nowUs();
+        slot->id = id;
+        slot->state = WAITING;
+        slot->status = RpcStatus::TIMEOUT;
+        slot->awaited = false;
+        slot->timed = timeoutUs > 0;
+        slot->sentUs = now;
+        slot->deadlineUs = now + timeoutUs;
+        _requestCount++;
+        return id;
+    }
+    
+    /**
+     * @brief Collect responses and expire deadlines
+     * @return Number of calls finished
+     */
+    size_t spinAll() {
+        if (!_initialized) return 0;
+        size_t count = 0;
+        for (size_t n = 0; n < _qos.depth && _receive(count); n++) {}
+        
+        uint32_t now = nowUs();
+        for (Slot& slot : _slots) {
+            if (slot.state != WAITING || !slot.timed) continue;
+            if (static_cast<int32_t>(now - slot.deadlineUs) < 0) continue;
+            slot.status = RpcStatus::TIMEOUT;
+            _timeoutCount++;
+            _finish(slot);
+            count++;
+        }
+        return count;
+    }
+    
+    /**
+     * @brief Take the outcome of a finished call, freeing its slot
+     * 
+     * @param[out] response The response (only written when @p status is OK)
+     * @param[out] status Outcome of the call
+     * @return false if @p id is still waiting or unknown
+     */
+    bool take(uint32_t id, Resp& response, RpcStatus& status) {
+        spinAll();
+        Slot* slot = _find(id, DONE);
+        if (!slot) return false;
+        status = slot->status;
+        if (status == RpcStatus::OK) response = slot->response;
+        slot->state = FREE;
+        return true;
+    }
+    
+    /**
+     * @brief Give up on a call; a late response is dropped
+     * @return false if @p id is unknown (already taken or never sent)
+     */
+    bool cancel(uint32_t id) {
+        Slot* slot = _find(id, WAITING);
+        if (!slot) slot = _find(id, DONE);
+        if (!slot) return false;
+        slot->state = FREE;
+        return true;
+    }
+    
+    /**
+     * @brief Awaiter for the response to one request (C++20 coroutines)
+     * 
+     * Sends the request in await_ready(), so a full table or failed send
+     * completes the co_await at once with std::nullopt.
+     */
+    class CallAwaiter : public CoroutineAwaiter {
+    public:
+        CallAwaiter(Client* client, const Req& request, uint32_t timeoutUs)
+            : _client(client), _request(request), _timeoutUs(timeoutUs) {}
+        
+        bool await_ready() {
+            _id = _client->send(_request, _timeoutUs);
+            if (_id == 0) return true;
+            _client->_find(_id, WAITING)->awaited = true;
+            return false;
+        }
+        
+        template<typename Handle>
+        bool await_suspend(Handle handle) {
+            // The client's own deadline ends the wait, so the park has none
+            return _park(handle, _client->_node, [](void* self) {
+                auto* a = static_cast<CallAwaiter*>(static_cast<CoroutineAwaiter*>(self));
+                return a->_client->_find(a->_id, WAITING) == nullptr;
+            }, _client->fd(), true, 0);
+        }
+        
+        /**
+         * @return The response, or std::nullopt unless the status is OK
+         */
+        std::optional<Resp> await_resume() {
+            if (_id == 0) return std::nullopt;
+            Resp response;
+            RpcStatus status = RpcStatus::CANCELLED;
+            Slot* slot = _client->_find(_id, DONE);
+            if (slot) {
+                status = slot->status;
+                if (status == RpcStatus::OK) response = slot->response;
+            }
+            _client->cancel(_id);  // Frees the slot, also if the park failed
+            if (status != RpcStatus::OK) return std::nullopt;
+            return response;
+        }
+        
+    private:
+        Client* _client;
+        Req _request;
+        uint32_t _timeoutUs;
+        uint32_t _id = 0;
+    };
+    
+    /**
+     * @brief co_await a call: send @p request and wait for the response
+     * 
+     * Used in a coroutine run by the owning Node (see capybarish_coro.h).
+     * 
+     * @param timeoutUs Give up after this long (0 = wait forever)
+     * @return The response, or std::nullopt on timeout, rejection or a full table
+     */
+    CallAwaiter call(const Req& request, uint32_t timeoutUs) { return CallAwaiter(this, request, timeoutUs); }
+    
+    /**
+     * @brief Microseconds until the earliest pending deadline
+     * @return UINT32_MAX if no call has one
+     */
+    uint32_t deadlineWaitUs() const {
+        uint32_t now = nowUs();
+        uint32_t waitUs = UINT32_MAX;
+        for (const Slot& slot : _slots) {
+            if (slot.state != WAITING || !slot.timed) continue;
+            int32_t left = static_cast<int32_t>(slot.deadlineUs - now);
+            waitUs = min<uint32_t>(waitUs, left > 0 ? left : 0);
+        }
+        return waitUs;
+    }
+    
+    /**
+     * @brief Descriptor that becomes readable when a response arrives
+     */
+    int fd() const { return _transport ? -1 : _sock.fd(); }
+    bool hasBuffered() const { return false; }
+    
+    /**
+     * @brief Calls waiting for a response
+     */
+    size_t getPendingCount() const {
+        size_t count = 0;
+        for (const Slot& slot : _slots) count += slot.state == WAITING;
+        return count;
+    }
+    
+    const char* getServiceName() const { return _serviceName; }
+    uint16_t getLocalPort() const { return _localPort; }
+    uint32_t getRequestCount() const { return _requestCount; }
+    uint32_t getResponseCount() const { return _responseCount; }
+    uint32_t getTimeoutCount() const { return _timeoutCount; }
+    uint32_t getBusyCount() const { return _busyCount; }         ///< send() refused for a full table
+    uint32_t getLateCount() const { return _lateCount; }         ///< Responses to no pending call
+    uint32_t getDropCount() const { return _dropCount; }         ///< Datagrams that were not the server's responses
+    uint32_t getSendFailCount() const { return _sendFailCount; }
+    uint32_t getLastRoundTripUs() const { return _lastRoundTripUs; }
+    
+    /**
+     * @brief Record this client's activity in @p trace (nullptr = stop)
+     */
+    void setTrace(TraceRecorder* trace) {
+        _trace = trace;
+        _traceId = trace ? trace->addEntity(TraceEntityKind::CLIENT, _serviceName) : TraceRecorder::NO_ENTITY;
+    }
+    
+    static constexpr size_t maxPending() { return MAX_PENDING; }
+    
+private:
+    friend class Node;
+    
+    enum SlotState : uint8_t { FREE, WAITING, DONE };
+    
+    struct Slot {
+        uint32_t id = 0;
+        uint32_t sentUs = 0;
+        uint32_t deadlineUs = 0;
+        RpcStatus status = RpcStatus::TIMEOUT;
+        SlotState state = FREE;
+        bool timed = false;
+        bool awaited = false;    // A coroutine takes it, not the callback
+        Resp response{};
+    };
+    
+    /**
+     * @brief Slot in @p state with @p id (any ID for FREE)
+     */
+    Slot* _find(uint32_t id, SlotState state) {
+        for (Slot& slot : _slots) {
+            if (slot.state == state && (state == FREE || slot.id == id)) return &slot;
+        }
+        return nullptr;
+    }
+    
+    /**
+     * @brief Handle one pending datagram
+     * @param[in,out] finished Incremented if it finished a call
+     * @return false if none was pending
+     */
+    bool _receive(size_t& finished) {
+        // One spare byte so an oversized response is caught
+        uint8_t buffer[sizeof(RpcHeader) + sizeof(Resp) + 1];
+        uint32_t address = 0;
+        uint16_t port = 0;
+        size_t len = _transport ? _transport->receive(_localPort, buffer, sizeof(buffer))
+                                : _sock.receiveFrom(buffer, sizeof(buffer), address, port);
+        if (len == 0) return false;
+        
+        // Only the server answers (a transport carries no sender address)
+        RpcHeader header;
+        if (len < sizeof(header) || (!_transport && !_sock.isRemote(address, port))) {
+            _dropCount++;
+            return true;
+        }
+        memcpy(&header, buffer, sizeof(header));
+        RpcStatus status = static_cast<RpcStatus>(header.status);
+        bool valid = header.magic == RPC_MAGIC && header.kind == RPC_RESPONSE &&
+                     len == sizeof(RpcHeader) + header.size &&
+                     (status == RpcStatus::OK ? header.size == sizeof(Resp) : header.size == 0);
+        if (!valid) {
+            _dropCount++;
+            return true;
+        }
+        
+        Slot* slot = _find(header.id, WAITING);
+        if (!slot) {
+            _lateCount++;
+            return true;
+        }
+        if (_trace) _trace->record(TraceEventType::PACKET, _traceId, static_cast<uint32_t>(len));
+        if (status == RpcStatus::OK) detail::decodeMessage(buffer + sizeof(RpcHeader), slot->response);
+        slot->status = status;
+        _lastRoundTripUs = nowUs() - slot->sentUs;
+        _responseCount++;
+        _finish(*slot);
+        finished++;
+        return true;
+    }
+    
+    /**
+     * @brief Hand a finished call to the callback, or keep it for take()
+     */
+    void _finish(Slot& slot) {
+        slot.state = DONE;
+        if (!_callback || slot.awaited) return;
+        slot.state = FREE;  // The callback may send again and reuse it
+        if (_trace) _trace->record(TraceEventType::CALLBACK_BEGIN, _traceId);
+        _callback(slot.id, slot.status, slot.response);
+        if (_trace) _trace->record(TraceEventType::CALLBACK_END, _traceId);
+    }
+    
+    const char* _serviceName;
+    const char* _serverIP;
+    uint16_t _serverPort;
     uint16_t _localPort;
+    ResponseCallback<Resp> _callback;
     QoSProfile _qos;
-    WiFiUDP _udp;
-    uint32_t _recvCount;
-    uint32_t _dropCount;
-    uint64_t _lastRecvTime = 0;
-    bool _initialized;
+    Transport* _transport;
+    UdpSocket _sock;
+    Slot _slots[MAX_PENDING];
+    uint32_t _nextId;
+    uint32_t _requestCount = 0;
+    uint32_t _responseCount = 0;
+    uint32_t _timeoutCount = 0;
+    uint32_t _busyCount = 0;
+    uint32_t _lateCount = 0;
+    uint32_t _dropCount = 0;
+    uint32_t _sendFailCount = 0;
+    uint32_t _lastRoundTripUs = 0;
+    Node* _node = nullptr;  // Owner, for coroutine waits
+    TraceRecorder* _trace = nullptr;
+    uint8_t _traceId = TraceRecorder::NO_ENTITY;
+    bool _initialized = false;
 };
 
 // =============================================================================
@@ -502,12 +2768,14 @@ using TimerCallback = std::function<void()>;
  */
 class Timer {
 public:
-    Timer(float periodSec, TimerCallback callback)
+    Timer(float periodSec, TimerCallback callback,
+          TrafficClass trafficClass = TrafficClass::BEST_EFFORT)
         : _periodUs(static_cast<uint64_t>(periodSec * 1000000))
         , _callback(callback)
         , _lastFire(0)
         , _callCount(0)
         , _active(true)
+        , _trafficClass(trafficClass)
     {}
     
     /**
@@ -517,19 +2785,66 @@ public:
     bool spinOnce() {
         if (!_active) return false;
         
-        uint64_t now = micros();
+        uint64_t now = nowUs();
         if (now - _lastFire >= _periodUs) {
+            if (_trace && _callCount > 0) {
+                _trace->record(TraceEventType::TIMER_LATENESS, _traceId,
+                               static_cast<uint32_t>(now - _lastFire - _periodUs));
+            }
             _lastFire = now;
             _callCount++;
             if (_callback) {
+                if (_trace) _trace->record(TraceEventType::CALLBACK_BEGIN, _traceId);
                 _callback();
+                if (_trace) _trace->record(TraceEventType::CALLBACK_END, _traceId);
             }
             return true;
         }
         return false;
     }
     
-    void reset() { _lastFire = micros(); }
+    /**
+     * @brief Microseconds until the timer is next due (0 if due now)
+     */
+    uint64_t remainingUs(uint64_t now = nowUs()) const {
+        if (!_active) return UINT64_MAX;
+        uint64_t elapsed = now - _lastFire;
+        return elapsed >= _periodUs ? 0 : _periodUs - elapsed;
+    }
+    
+    /**
+     * @brief Awaiter for the timer's next firing (C++20 coroutines)
+     */
+    class TickAwaiter : public CoroutineAwaiter {
+    public:
+        explicit TickAwaiter(Timer* timer) : _timer(timer), _count(timer->_callCount) {}
+        
+        bool await_ready() const { return false; }
+        
+        template<typename Handle>
+        bool await_suspend(Handle handle) {
+            // Fired by Node::spinOnce(), whose sleep already follows the timer
+            return _park(handle, _timer->_node, [](void* self) {
+                auto* a = static_cast<TickAwaiter*>(static_cast<CoroutineAwaiter*>(self));
+                return a->_timer->_callCount != a->_count;
+            }, -1, false, 0);
+        }
+        
+        void await_resume() const {}
+        
+    private:
+        Timer* _timer;
+        uint32_t _count;
+    };
+    
+    /**
+     * @brief co_await the next firing of a timer owned by a Node
+     * 
+     * The callback (if any) runs first.
+     */
+    TickAwaiter tick() { return TickAwaiter(this); }
+    
+    void reset() { _lastFire = nowUs(); }
     void cancel() { _active = false; }
     void resume() { _active = true; reset(); }
     
@@ -537,13 +2852,34 @@ public:
     uint32_t getCallCount() const { return _callCount; }
     float getPeriod() const { return _periodUs / 1000000.0f; }
     float getFrequency() const { return 1000000.0f / _periodUs; }
+    TrafficClass getTrafficClass() const { return _trafficClass; }
+    
+    /**
+     * @brief Record this timer's firings and lateness in @p trace (nullptr = stop)
+     */
+    void setTrace(TraceRecorder* trace) {
+        _trace = trace;
+        if (!trace) {
+            _traceId = TraceRecorder::NO_ENTITY;
+            return;
+        }
+        char name[TraceRecorder::NAME_SIZE];
+        snprintf(name, sizeof(name), "timer %.1f Hz", getFrequency());
+        _traceId = trace->addEntity(TraceEntityKind::TIMER, name);
+    }
     
 private:
+    friend class Node;
+    
     uint64_t _periodUs;
     TimerCallback _callback;
     uint64_t _lastFire;
     uint32_t _callCount;
     bool _active;
+    TrafficClass _trafficClass;
+    Node* _node = nullptr;  // Owner, for coroutine waits
+    TraceRecorder* _trace = nullptr;
+    uint8_t _traceId = TraceRecorder::NO_ENTITY;
 };
 
 // =============================================================================
@@ -566,28 +2902,21 @@ private:
 class Rate {
 public:
     Rate(float hz) : _periodUs(static_cast<uint64_t>(1000000.0f / hz)) {
-        _lastTime = micros();
+        _lastTime = nowUs();
     }
     
     /**
      * @brief Sleep to maintain the target rate
      */
     void sleep() {
-        uint64_t now = micros();
+        uint64_t now = nowUs();
         uint64_t elapsed = now - _lastTime;
         
         if (elapsed < _periodUs) {
-            uint64_t sleepUs = _periodUs - elapsed;
-            if (sleepUs > 1000) {
-                // Use delay for longer sleeps
-                delay(sleepUs / 1000);
-            } else {
-                // Busy wait for short sleeps
-                delayMicroseconds(sleepUs);
-            }
+            sleepUs(static_cast<uint32_t>(_periodUs - elapsed));
         }
         
-        _lastTime = micros();
+        _lastTime = nowUs();
     }
     
     float getPeriod() const { return _periodUs / 1000000.0f; }
@@ -608,6 +2937,7 @@ private:
 constexpr size_t MAX_PUBLISHERS = 8;
 constexpr size_t MAX_SUBSCRIPTIONS = 8;
 constexpr size_t MAX_TIMERS = 8;
+constexpr size_t MAX_COROUTINE_WAITS = 8;
 
 /**
  * @brief A computational node with publishers, subscribers, and timers
@@ -629,8 +2959,12 @@ constexpr size_t MAX_TIMERS = 8;
  * node.createTimer(0.01, controlLoop);
  * 
  * void loop() {
- *     node.spinOnce();
+ *     node.spinFor(5000);  // Sleeps until a datagram or the next timer
  * }
+ * 
+ * // Same topics over USB-CDC instead of WiFi
+ * cpy::SerialTransport<> usb(Serial);
+ * cpy::Node tethered("motor_module", "", &usb);
  * @endcode
  */
 class Node {
@@ -639,10 +2973,12 @@ public:
      * @brief Create a node
      * @param name Node name
      * @param ns Optional namespace
+     * @param transport Carry all topics over this transport instead of WiFi UDP
      */
-    Node(const char* name, const char* ns = "")
+    Node(const char* name, const char* ns = "", Transport* transport = nullptr)
         : _name(name)
         , _namespace(ns)
+        , _transport(transport)
         , _numPubs(0)
         , _numSubs(0)
         , _numTimers(0)
@@ -696,9 +3032,9 @@ public:
             return nullptr;
         }
         
-        auto* pub = new Publisher<T>(topic, remoteIP, remotePort, 0, qos, false);
+        auto* pub = new Publisher<T>(topic, remoteIP, remotePort, 0, qos, false, _transport);
         pub->init();
-        _publishers[_numPubs++] = {pub, [](void* p) { delete static_cast<Publisher<T>*>(p); }};
+        _publishers[_numPubs++] = _traced(_erasePublisher(pub, qos));
         
         return pub;
     }
@@ -725,9 +3061,9 @@ public:
         }
         
         // Use broadcast mode (IP is ignored when broadcast=true)
-        auto* pub = new Publisher<T>(topic, "255.255.255.255", remotePort, 0, qos, true);
+        auto* pub = new Publisher<T>(topic, "255.255.255.255", remotePort, 0, qos, true, _transport);
         pub->init();
-        _publishers[_numPubs++] = {pub, [](void* p) { delete static_cast<Publisher<T>*>(p); }};
+        _publishers[_numPubs++] = _traced(_erasePublisher(pub, qos));
         
         return pub;
     }
@@ -757,9 +3093,9 @@ public:
         }
         
         // Multicast uses the multicast IP directly
-        auto* pub = new Publisher<T>(topic, multicastIP, remotePort, 0, qos, false);
+        auto* pub = new Publisher<T>(topic, multicastIP, remotePort, 0, qos, false, _transport);
         pub->init();
-        _publishers[_numPubs++] = {pub, [](void* p) { delete static_cast<Publisher<T>*>(p); }};
+        _publishers[_numPubs++] = _traced(_erasePublisher(pub, qos));
         
         Serial.printf("[Publisher] %s -> MULTICAST %s:%d\n", topic, multicastIP, remotePort);
         return pub;
@@ -783,9 +3119,10 @@ public:
             return nullptr;
         }
         
-        auto* sub = new Subscription<T>(topic, callback, localPort, qos);
+        auto* sub = new Subscription<T>(topic, callback, localPort, qos, _transport);
+        sub->_node = this;
         sub->init();
-        _subscriptions[_numSubs++] = {sub, [](void* s) { delete static_cast<Subscription<T>*>(s); }};
+        _subscriptions[_numSubs++] = _traced(_eraseSubscription(sub));
         
         return sub;
     }
@@ -799,6 +3136,49 @@ public:
         return createSubscription<T>(topic, nullptr, localPort, qos);
     }
     
+    /**
+     * @brief Create a subscription that stores each message in @p output
+     * 
+     * The node's spin writes the latest message; any other task or ISR
+     * reads it from @p output without locking. @p output must outlive the
+     * node.
+     */
+    template<typename T>
+    Subscription<T>* createSubscription(const char* topic, Seqlock<T>& output, uint16_t localPort,
+                                         QoSProfile qos = QoSProfile::defaultProfile()) {
+        return _createSubscriptionWithOutput<T>(topic, output, localPort, qos);
+    }
+    
+    template<typename T>
+    Subscription<T>* createSubscription(const char* topic, TripleBuffer<T>& output, uint16_t localPort,
+                                         QoSProfile qos = QoSProfile::defaultProfile()) {
+        return _createSubscriptionWithOutput<T>(topic, output, localPort, qos);
+    }
+    
+    /**
+     * @brief Create a subscription that shares pooled buffers with its
+     *        consumers instead of copying (see Subscription::setPool())
+     * 
+     * @param pool Buffers to receive into; must outlive the node
+     * @param callback Gets a handle it may keep or pass on
+     */
+    template<typename T>
+    Subscription<T>* createSubscription(const char* topic, MessagePool<T>& pool, SharedCallback<T> callback,
+                                         uint16_t localPort, QoSProfile qos = QoSProfile::defaultProfile()) {
+        if (_numSubs >= MAX_SUBSCRIPTIONS) {
+            Serial.println("[Node] Max subscriptions reached!");
+            return nullptr;
+        }
+        
+        auto* sub = new Subscription<T>(topic, nullptr, localPort, qos, _transport);
+        sub->_node = this;
+        sub->setPool(&pool, callback);
+        sub->init();
+        _subscriptions[_numSubs++] = _traced(_eraseSubscription(sub));
+        
+        return sub;
+    }
+    
     /**
      * @brief Create a multicast subscription (works across subnets!)
      * 
@@ -823,11 +3203,12 @@ public:
             return nullptr;
         }
         
-        auto* sub = new Subscription<T>(topic, callback, localPort, qos);
+        auto* sub = new Subscription<T>(topic, callback, localPort, qos, _transport);
+        sub->_node = this;
         
         // Initialize with multicast group
         if (sub->initMulticast(multicastIP)) {
-            _subscriptions[_numSubs++] = {sub, [](void* s) { delete static_cast<Subscription<T>*>(s); }};
+            _subscriptions[_numSubs++] = _traced(_eraseSubscription(sub));
             Serial.printf("[Subscription] %s <- MULTICAST %s:%d\n", topic, multicastIP, localPort);
             return sub;
         } else {
@@ -836,21 +3217,148 @@ public:
         }
     }
     
+    /**
+     * @brief Create a subscription for a type known only at run time
+     * 
+     * @param topic Topic name
+     * @param schema Message layout, or nullptr to forward raw datagrams
+     * @param callback Called with each message's bytes
+     * @param localPort Local port to bind
+     * @param qos QoS profile
+     * @return Subscription pointer (owned by node)
+     */
+    GenericSubscription* createGenericSubscription(const char* topic, const MessageSchema* schema,
+                                                   GenericCallback callback, uint16_t localPort,
+                                                   QoSProfile qos = QoSProfile::defaultProfile()) {
+        if (_numSubs >= MAX_SUBSCRIPTIONS) {
+            Serial.println("[Node] Max subscriptions reached!");
+            return nullptr;
+        }
+        
+        auto* sub = new GenericSubscription(topic, schema, callback, localPort, qos, _transport);
+        sub->init();
+        _subscriptions[_numSubs++] = _traced(_eraseSubscription(sub));
+        
+        return sub;
+    }
+    
+    /**
+     * @brief Create a publisher for a type known only at run time
+     * 
+     * @param schema Message layout used to check sizes, or nullptr
+     * @return Publisher pointer (owned by node)
+     */
+    GenericPublisher* createGenericPublisher(const char* topic, const MessageSchema* schema,
+                                             const char* remoteIP, uint16_t remotePort,
+                                             QoSProfile qos = QoSProfile::defaultProfile()) {
+        if (_numPubs >= MAX_PUBLISHERS) {
+            Serial.println("[Node] Max publishers reached!");
+            return nullptr;
+        }
+        
+        auto* pub = new GenericPublisher(topic, schema, remoteIP, remotePort, 0, qos, false, _transport);
+        pub->init();
+        _publishers[_numPubs++] = _traced(_erasePublisher(pub));
+        
+        return pub;
+    }
+    
+    /**
+     * @brief Create a service
+     * 
+     * Takes a subscription slot; requests are answered in spinOnce().
+     * 
+     * @tparam Req Request message type
+     * @tparam Resp Response message type
+     * @param name Service name
+     * @param handler Fills in the response, or returns false to reject
+     * @param localPort Port to answer on
+     * @return Service pointer (owned by node)
+     */
+    template<typename Req, typename Resp>
+    Service<Req, Resp>* createService(const char* name, ServiceHandler<Req, Resp> handler, uint16_t localPort,
+                                      QoSProfile qos = QoSProfile::services()) {
+        if (_numSubs >= MAX_SUBSCRIPTIONS) {
+            Serial.println("[Node] Max subscriptions reached!");
+            return nullptr;
+        }
+        
+        auto* service = new Service<Req, Resp>(name, handler, localPort, qos, _transport);
+        service->init();
+        _subscriptions[_numSubs++] = _traced(_eraseEndpoint(service));
+        
+        return service;
+    }
+    
+    /**
+     * @brief Create a client for a service on another node
+     * 
+     * Takes a subscription slot; spinOnce() collects responses and expires
+     * deadlines, and the node wakes for the earliest deadline.
+     * 
+     * @tparam Req Request message type
+     * @tparam Resp Response message type
+     * @tparam MAX_PENDING Calls that can be outstanding at once
+     * @param name Service name
+     * @param serverIP Address of the node running the service
+     * @param serverPort Service port
+     * @param localPort Port for responses
+     * @param callback Called with every finished call (nullptr = take()/call())
+     * @return Client pointer (owned by node)
+     */
+    template<typename Req, typename Resp, size_t MAX_PENDING = 4>
+    Client<Req, Resp, MAX_PENDING>* createClient(const char* name, const char* serverIP, uint16_t serverPort,
+                                                 uint16_t localPort, ResponseCallback<Resp> callback = nullptr,
+                                                 QoSProfile qos = QoSProfile::services()) {
+        if (_numSubs >= MAX_SUBSCRIPTIONS) {
+            Serial.println("[Node] Max subscriptions reached!");
+            return nullptr;
+        }
+        
+        auto* client = new Client<Req, Resp, MAX_PENDING>(name, serverIP, serverPort, localPort,
+                                                          callback, qos, _transport);
+        client->_node = this;
+        client->init();
+        TypeErased e = _eraseEndpoint(client);
+        e.dueUs = [](const void* c) {
+            return static_cast<const Client<Req, Resp, MAX_PENDING>*>(c)->deadlineWaitUs();
+        };
+        _subscriptions[_numSubs++] = _traced(e);
+        
+        return client;
+    }
+    
     /**
      * @brief Create a periodic timer
      * 
+     * Timers are kept ordered by traffic class so that, when several are due
+     * in the same spin, the one driving control publishes runs (and sends)
+     * before telemetry timers.
+     * 
      * @param periodSec Period in seconds
      * @param callback Callback function
+     * @param trafficClass Class of the traffic this timer publishes
      * @return Timer pointer (owned by node)
      */
-    Timer* createTimer(float periodSec, TimerCallback callback) {
+    Timer* createTimer(float periodSec, TimerCallback callback,
+                       TrafficClass trafficClass = TrafficClass::BEST_EFFORT) {
         if (_numTimers >= MAX_TIMERS) {
             Serial.println("[Node] Max timers reached!");
             return nullptr;
         }
         
-        auto* timer = new Timer(periodSec, callback);
-        _timers[_numTimers++] = timer;
+        auto* timer = new Timer(periodSec, callback, trafficClass);
+        timer->_node = this;
+        
+        // Stable insert: after every timer of the same or higher class
+        size_t pos = _numTimers;
+        while (pos > 0 && _timers[pos - 1]->getTrafficClass() < trafficClass) {
+            _timers[pos] = _timers[pos - 1];
+            pos--;
+        }
+        _timers[pos] = timer;
+        _numTimers++;
+        if (_trace) timer->setTrace(_trace);
         
         Serial.printf("[Node] Timer created: %.1f Hz\n", 1.0f / periodSec);
         return timer;
@@ -858,6 +3366,9 @@ public:
     
     /**
      * @brief Process all pending callbacks once
+     * 
+     * Subscriptions created without a callback are left for take().
+     * 
      * @return Number of callbacks executed
      */
     size_t spinOnce() {
@@ -865,19 +3376,162 @@ public:
         
         // Process subscriptions
         for (size_t i = 0; i < _numSubs; i++) {
-            // Each subscription manages its own type
-            // spinOnce() is called through the stored function pointer pattern
-            // For now, we rely on the user calling sub->spinOnce() or take()
+            if (_subscriptions[i].spin) count += _subscriptions[i].spin(_subscriptions[i].ptr);
         }
         
-        // Process timers
+        // Process timers (highest traffic class first)
         for (size_t i = 0; i < _numTimers; i++) {
             if (_timers[i]->spinOnce()) count++;
         }
         
+        // Resume coroutines whose message, tick or deadline has come
+        count += _resumeWaits();
+        
+        // Send messages held back by a bandwidth budget, unless a timer
+        // above just replaced them with a newer one
+        for (size_t i = 0; i < _numPubs; i++) {
+            if (_publishers[i].spin) _publishers[i].spin(_publishers[i].ptr);
+        }
+        
+        return count;
+    }
+    
+    /**
+     * @brief Process callbacks until a deadline, sleeping while idle
+     * 
+     * Between passes the task blocks in select() on the subscription
+     * sockets, with a timeout of whichever comes first: the next timer or
+     * the deadline, in microseconds. It wakes as soon as a datagram
+     * arrives instead of polling, and the idle time goes back to FreeRTOS.
+     * Subscriptions that can only be polled (transport, non-ESP32) are
+     * checked every millisecond instead, which adds up to 1 ms of latency
+     * to them.
+     * 
+     * @param deadlineUs Absolute time in nowUs() units (wraparound safe)
+     * @return Number of callbacks executed
+     */
+    size_t spinUntil(uint32_t deadlineUs) {
+        size_t count = 0;
+        while (true) {
+            count += spinOnce();
+            
+            uint32_t now = nowUs();
+            int32_t left = static_cast<int32_t>(deadlineUs - now);
+            if (left <= 0) break;
+            
+            uint32_t waitUs = getIdleUs(now, static_cast<uint32_t>(left));
+            if (waitUs > 0) {
+                if (_trace) _trace->record(TraceEventType::IDLE_BEGIN, _traceId, waitUs);
+                _wait(waitUs);
+                if (_trace) _trace->record(TraceEventType::IDLE_END, _traceId);
+            }
+        }
         return count;
     }
     
+    /**
+     * @brief Time until the next timer, held-back publish, service call
+     *        or coroutine deadline is due, i.e. how long the node may sleep if no
+     *        message arrives
+     * 
+     * @param now Current nowUs()
+     * @param limitUs Upper bound on the result
+     * @return 0 if something is due now
+     */
+    uint32_t getIdleUs(uint32_t now, uint32_t limitUs = UINT32_MAX) const {
+        uint64_t waitUs = limitUs;
+        for (size_t i = 0; i < _numTimers; i++) {
+            waitUs = min(waitUs, _timers[i]->remainingUs(now));
+        }
+        for (size_t i = 0; i < _numPubs; i++) {
+            if (!_publishers[i].dueUs) continue;
+            waitUs = min<uint64_t>(waitUs, _publishers[i].dueUs(_publishers[i].ptr));
+        }
+        for (size_t i = 0; i < _numSubs; i++) {
+            if (!_subscriptions[i].dueUs) continue;
+            waitUs = min<uint64_t>(waitUs, _subscriptions[i].dueUs(_subscriptions[i].ptr));
+        }
+        for (size_t i = 0; i < _numWaits; i++) {
+            if (!_waits[i].timed) continue;
+            int32_t due = static_cast<int32_t>(_waits[i].deadlineUs - now);
+            waitUs = min<uint64_t>(waitUs, due > 0 ? due : 0);
+        }
+        return static_cast<uint32_t>(waitUs);
+    }
+    
+    /**
+     * @brief Process callbacks for a duration, sleeping while idle
+     */
+    size_t spinFor(uint32_t durationUs) {
+        return spinUntil(nowUs() + durationUs);
+    }
+    
+    /**
+     * @brief Awaiter that resumes a coroutine after a delay
+     */
+    class SleepAwaiter : public CoroutineAwaiter {
+    public:
+        SleepAwaiter(Node* node, uint32_t durationUs) : _node(node), _durationUs(durationUs) {}
+        
+        bool await_ready() const { return _durationUs == 0; }
+        
+        template<typename Handle>
+        bool await_suspend(Handle handle) {
+            return _park(handle, _node, nullptr, -1, false, _durationUs);
+        }
+        
+        void await_resume() const {}
+        
+    private:
+        Node* _node;
+        uint32_t _durationUs;
+    };
+    
+    /**
+     * @brief co_await a delay, resumed by spinOnce() (C++20 coroutines)
+     */
+    SleepAwaiter sleepFor(uint32_t durationUs) { return SleepAwaiter(this, durationUs); }
+    
+    /**
+     * @brief Park a suspended coroutine until its condition or deadline
+     * @return false if every wait slot is taken, or an Executor runs the
+     *         node (nothing would resume it); the co_await then returns
+     *         at once as timed out
+     */
+    bool addWait(const CoroutineWait& wait) {
+        if (_onExecutor) {
+            Serial.printf("[Node] %s: coroutines need spinOnce(), not an Executor\n", _name);
+            return false;
+        }
+        if (_numWaits >= MAX_COROUTINE_WAITS) {
+            Serial.println("[Node] Max coroutine waits reached!");
+            return false;
+        }
+        _waits[_numWaits++] = wait;
+        return true;
+    }
+    
+    size_t getWaitCount() const { return _numWaits; }
+    
+    /**
+     * @brief Record the node's activity in @p trace (nullptr = stop)
+     * 
+     * Registers the node, its coroutines and every publisher, subscription
+     * and timer, including ones created later. Call it once per recorder:
+     * each call adds the tracks again.
+     */
+    void setTrace(TraceRecorder* trace) {
+        _trace = trace;
+        _traceId = trace ? trace->addEntity(TraceEntityKind::NODE, _name) : TraceRecorder::NO_ENTITY;
+        _coroutineTraceId = trace ? trace->addEntity(TraceEntityKind::COROUTINES, "coroutines")
+                                  : TraceRecorder::NO_ENTITY;
+        for (size_t i = 0; i < _numPubs; i++) _publishers[i].trace(_publishers[i].ptr, trace);
+        for (size_t i = 0; i < _numSubs; i++) _subscriptions[i].trace(_subscriptions[i].ptr, trace);
+        for (size_t i = 0; i < _numTimers; i++) _timers[i]->setTrace(trace);
+    }
+    
+    TraceRecorder* getTrace() const { return _trace; }
+    
     /**
      * @brief Spin a specific subscription
      */
@@ -892,6 +3546,11 @@ public:
     const char* getName() const { return _name; }
     const char* getNamespace() const { return _namespace; }
     
+    /**
+     * @brief Transport shared by the node's topics (nullptr = WiFi UDP)
+     */
+    Transport* getTransport() const { return _transport; }
+    
     /**
      * @brief Get logger
      */
@@ -942,24 +3601,264 @@ public:
     }
     
 private:
+    friend class Executor;   // Takes over spinning (capybarish_executor.h)
+    friend class Discovery;  // Advertises and retargets topics (capybarish_discovery.h)
+    
     const char* _name;
     const char* _namespace;
+    Transport* _transport;
     
     // Type-erased storage for publishers/subscriptions
     struct TypeErased {
         void* ptr;
         void (*deleter)(void*);
+        size_t (*spin)(void*) = nullptr;         // Callback subscriptions, deferring publishers
+        int (*fd)(const void*) = nullptr;
+        bool (*buffered)(const void*) = nullptr;
+        uint32_t (*dueUs)(const void*) = nullptr;                      // Deferring publishers, clients
+        void (*trace)(void*, TraceRecorder*) = nullptr;
+        void (*describe)(const void*, TopicInfo&) = nullptr;           // For Discovery
+        bool (*retarget)(void*, const char*, uint16_t) = nullptr;      // Publishers awaiting discovery
     };
     
+    template<typename Entity>
+    static void _setTrace(void* p, TraceRecorder* trace) {
+        static_cast<Entity*>(p)->setTrace(trace);
+    }
+    
+    /**
+     * @brief Attach a new publisher or subscription to the node's trace
+     */
+    TypeErased _traced(TypeErased e) {
+        if (_trace) e.trace(e.ptr, _trace);
+        return e;
+    }
+    
+    template<typename T>
+    static TypeErased _erasePublisher(Publisher<T>* pub, const QoSProfile& qos) {
+        TypeErased e = {pub, [](void* p) { delete static_cast<Publisher<T>*>(p); }};
+        e.trace = _setTrace<Publisher<T>>;
+        e.describe = [](const void* p, TopicInfo& info) {
+            auto* pub = static_cast<const Publisher<T>*>(p);
+            info = {pub->getTopicName(), pub->getRemotePort(), sizeof(T), true, messageFingerprint<T>()};
+        };
+        if (pub->usesDiscovery()) {
+            e.retarget = [](void* p, const char* ip, uint16_t port) {
+                return static_cast<Publisher<T>*>(p)->setRemote(ip, port);
+            };
+        }
+        if (qos.rateLimitBytesPerSec > 0 && qos.rateLimitAction == RateLimitAction::DEFER) {
+            e.spin = [](void* p) { return static_cast<size_t>(static_cast<Publisher<T>*>(p)->flush()); };
+            e.dueUs = [](const void* p) {
+                return static_cast<const Publisher<T>*>(p)->deferredWaitUs();
+            };
+        }
+        return e;
+    }
+    
+    static TypeErased _erasePublisher(GenericPublisher* pub) {
+        TypeErased e = {pub, [](void* p) { delete static_cast<GenericPublisher*>(p); }};
+        e.trace = _setTrace<GenericPublisher>;
+        e.describe = [](const void* p, TopicInfo& info) {
+            auto* pub = static_cast<const GenericPublisher*>(p);
+            info = {pub->getTopicName(), pub->getRemotePort(),
+                    pub->getSchema() ? pub->getSchema()->size() : 0, true, 0};
+        };
+        return e;
+    }
+    
+    template<typename T, typename Output>
+    Subscription<T>* _createSubscriptionWithOutput(const char* topic, Output& output, uint16_t localPort,
+                                                   QoSProfile qos) {
+        if (_numSubs >= MAX_SUBSCRIPTIONS) {
+            Serial.println("[Node] Max subscriptions reached!");
+            return nullptr;
+        }
+        
+        auto* sub = new Subscription<T>(topic, nullptr, localPort, qos, _transport);
+        sub->_node = this;
+        sub->setOutput(&output);
+        sub->init();
+        _subscriptions[_numSubs++] = _traced(_eraseSubscription(sub));
+        
+        return sub;
+    }
+    
+    /**
+     * @brief Whether the node drains @p sub itself (callback or output);
+     *        otherwise it is left to take()/next()
+     */
+    template<typename Sub>
+    static bool _isSpun(const Sub* sub) {
+        if constexpr (requires { sub->hasOutput(); }) {
+            if (sub->hasOutput()) return true;
+        }
+        return sub->hasCallback();
+    }
+    
+    template<typename T>
+    static uint32_t _fingerprint(const Subscription<T>*) { return messageFingerprint<T>(); }
+    
+    template<typename Sub>
+    static TypeErased _eraseSubscription(Sub* sub) {
+        TypeErased e = {sub, [](void* s) { delete static_cast<Sub*>(s); }};
+        e.trace = _setTrace<Sub>;
+        e.describe = [](const void* s, TopicInfo& info) {
+            auto* sub = static_cast<const Sub*>(s);
+            info = {sub->getTopicName(), sub->getLocalPort(), 0, false, 0};
+            if constexpr (requires { Sub::msgSize(); }) {
+                info.msgSize = Sub::msgSize();
+                info.fingerprint = _fingerprint(sub);
+            } else if (sub->getSchema()) {
+                info.msgSize = sub->getSchema()->size();
+            }
+        };
+        if (_isSpun(sub)) {
+            e.spin = [](void* s) { return static_cast<Sub*>(s)->spinAll(); };
+            e.fd = [](const void* s) { return static_cast<const Sub*>(s)->fd(); };
+            e.buffered = [](const void* s) { return static_cast<const Sub*>(s)->hasBuffered(); };
+        }
+        return e;
+    }
+    
+    /**
+     * @brief Erase a service or client: always spun, never advertised
+     */
+    template<typename Endpoint>
+    static TypeErased _eraseEndpoint(Endpoint* endpoint) {
+        TypeErased e = {endpoint, [](void* p) { delete static_cast<Endpoint*>(p); }};
+        e.trace = _setTrace<Endpoint>;
+        e.spin = [](void* p) { return static_cast<Endpoint*>(p)->spinAll(); };
+        e.fd = [](const void* p) { return static_cast<const Endpoint*>(p)->fd(); };
+        e.buffered = [](const void* p) { return static_cast<const Endpoint*>(p)->hasBuffered(); };
+        return e;
+    }
+    
+    /**
+     * @brief Resume every coroutine whose wait is over
+     * 
+     * A resumed coroutine may park again (appending a new wait), so the
+     * slot is freed before it runs and new waits are checked on the next
+     * pass.
+     */
+    size_t _resumeWaits() {
+        size_t count = 0;
+        size_t pending = _numWaits;
+        uint32_t now = nowUs();
+        for (size_t i = 0; i < pending;) {
+            const CoroutineWait& w = _waits[i];
+            bool ready = w.ready && w.ready(w.awaiter);
+            bool expired = w.timed && static_cast<int32_t>(now - w.deadlineUs) >= 0;
+            if (!ready && !expired) {
+                i++;
+                continue;
+            }
+            bool timedOut = !ready && w.ready;  // A plain sleep ends, it does not time out
+            
+            CoroutineWait done = w;
+            for (size_t k = i + 1; k < _numWaits; k++) _waits[k - 1] = _waits[k];
+            _numWaits--;
+            pending--;
+            if (_trace) _trace->record(TraceEventType::CALLBACK_BEGIN, _coroutineTraceId);
+            done.resume(done.awaiter, timedOut);
+            if (_trace) _trace->record(TraceEventType::CALLBACK_END, _coroutineTraceId);
+            count++;
+        }
+        return count;
+    }
+    
+    /**
+     * @brief Sleep up to @p timeoutUs, returning early when a subscription
+     *        with a callback has data
+     * 
+     * On ESP32 this is one select() on every subscription socket, with the
+     * timeout in microseconds (lwIP rounds it to whole milliseconds).
+     * Endpoints without a descriptor (transports, other platforms) cannot
+     * wake the task: while any exists the sleep is capped at 1 ms, so
+     * they are polled once a millisecond. With nothing to wake up for,
+     * the node sleeps in delay() and busy-waits only the sub-millisecond
+     * remainder, so timers never fire late.
+     */
+    void _wait(uint32_t timeoutUs) {
+        bool pollOnly = false;  // A callback endpoint with no descriptor to select() on
+        #ifdef ESP32
+        fd_set readable;
+        FD_ZERO(&readable);
+        int maxFd = -1;
+        #endif
+        for (size_t i = 0; i < _numSubs; i++) {
+            const TypeErased& e = _subscriptions[i];
+            if (!e.spin) continue;
+            if (e.buffered(e.ptr)) return;
+            int fd = e.fd(e.ptr);
+            if (fd < 0) {
+                pollOnly = true;
+                continue;
+            }
+            #ifdef ESP32
+            FD_SET(fd, &readable);
+            maxFd = max(maxFd, fd);
+            #endif
+        }
+        for (size_t i = 0; i < _numWaits; i++) {
+            const CoroutineWait& w = _waits[i];
+            if (!w.ready) continue;
+            if (w.fd < 0) {
+                if (w.poll) pollOnly = true;
+                continue;
+            }
+            #ifdef ESP32
+            FD_SET(w.fd, &readable);
+            maxFd = max(maxFd, w.fd);
+            #endif
+        }
+        
+        // A virtual clock has nothing to wait for; time just moves on
+        if (activeClock()) {
+            sleepUs(timeoutUs);
+            return;
+        }
+        
+        if (pollOnly) timeoutUs = min<uint32_t>(timeoutUs, 1000);
+        
+        #ifdef ESP32
+        if (maxFd >= 0) {
+            timeval tv;
+            tv.tv_sec = timeoutUs / 1000000;
+            tv.tv_usec = timeoutUs % 1000000;
+            select(maxFd + 1, &readable, nullptr, nullptr, &tv);
+            return;
+        }
+        #endif
+        
+        // delay() sleeps in whole ticks; a longer remainder is left to the
+        // next pass
+        if (timeoutUs < 1000) {
+            delayMicroseconds(timeoutUs);
+        } else {
+            delay(timeoutUs / 1000);
+        }
+    }
+    
     TypeErased _publishers[MAX_PUBLISHERS];
     TypeErased _subscriptions[MAX_SUBSCRIPTIONS];
     Timer* _timers[MAX_TIMERS];
+    CoroutineWait _waits[MAX_COROUTINE_WAITS];
     
     size_t _numPubs;
     size_t _numSubs;
     size_t _numTimers;
+    size_t _numWaits = 0;
+    bool _onExecutor = false;  // Set by Executor::add(Node&)
+    TraceRecorder* _trace = nullptr;
+    uint8_t _traceId = TraceRecorder::NO_ENTITY;
+    uint8_t _coroutineTraceId = TraceRecorder::NO_ENTITY;
 };
 
+inline bool addCoroutineWait(Node* node, const CoroutineWait& wait) {
+    return node->addWait(wait);
+}
+
 // =============================================================================
 // Global Functions (ROS2-like)
 // =============================================================================
@@ -0,0 +1,756 @@
+/**
+ * @file capybarish_schema.h
+ * @brief Runtime message schemas for code that does not know the type
+ *
+ * A bridge, recorder or dashboard that forwards every topic in the system
+ * cannot instantiate Subscription<T> for each one. cpy::SchemaSet holds
+ * message layouts at run time instead, loaded either from .cpy schema text
+ * (the same files capybarish-gen reads) or from the FIELDS tables the
+ * generator emits into each struct. Every message is flattened to its
+ * primitive fields, with dotted names for nested messages
+ * ("imu.quaternion.w") and "name[i]." for arrays of them.
+ *
+ * With a MessageSchema, MessageView reads and writes fields of a raw
+ * buffer by name, and Reencoder converts between two layouts of the same
+ * message (fields matched by name, types converted, missing fields
+ * zeroed), e.g. to talk to firmware built against an older schema.
+ *
+ * @example
+ * @code
+ * cpy::SchemaSet schemas;
+ * schemas.add<motor_control::SensorData>();    // From the generated table
+ * schemas.parse(R"(
+ * message Heartbeat:
+ *     uint32 uptime_ms
+ *     float32[3] temps
+ * )");
+ * if (schemas.lastError()[0]) Serial.println(schemas.lastError());
+ *
+ * const cpy::MessageSchema* hb = schemas.find("Heartbeat");
+ * cpy::MessageView view(*hb, data, len);
+ * double temp;
+ * if (view.getDouble("temps", temp, 2)) Serial.printf("T2 = %.1f\n", temp);
+ * @endcode
+ *
+ * @author Chen Yu <chenyu@u.northwestern.edu>
+ * @copyright 2025 Chen Yu
+ * @license Apache-2.0
+ */
+
+#pragma once
+
+#ifndef CAPYBARISH_SCHEMA_H
+#define CAPYBARISH_SCHEMA_H
+
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "capybarish_filter.h"
+
+namespace cpy {
+
+// =============================================================================
+// Type Names
+// =============================================================================
+
+/**
+ * @brief Parse a .cpy primitive type name, including its aliases
+ *
+ * Matches capybarish.codegen: float/double/int/byte/char are aliases of
+ * float32/float64/int32/uint8/int8, and names are case-insensitive.
+ *
+ * @return false if @p name is not a primitive (e.g. a nested message)
+ */
+inline bool fieldTypeFromName(const char* name, size_t len, FieldType& type) {
+    static constexpr struct { const char* name; FieldType type; } NAMES[] = {
+        {"bool", FieldType::BOOL},
+        {"int8", FieldType::INT8},     {"char", FieldType::INT8},
+        {"uint8", FieldType::UINT8},   {"byte", FieldType::UINT8},
+        {"int16", FieldType::INT16},   {"uint16", FieldType::UINT16},
+        {"int32", FieldType::INT32},   {"int", FieldType::INT32},
+        {"uint32", FieldType::UINT32},
+        {"int64", FieldType::INT64},   {"uint64", FieldType::UINT64},
+        {"float32", FieldType::FLOAT32}, {"float", FieldType::FLOAT32},
+        {"float64", FieldType::FLOAT64}, {"double", FieldType::FLOAT64},
+    };
+    for (const auto& entry : NAMES) {
+        if (strlen(entry.name) != len) continue;
+        size_t i = 0;
+        while (i < len && entry.name[i] == tolower(static_cast<unsigned char>(name[i]))) i++;
+        if (i == len) {
+            type = entry.type;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool fieldTypeFromName(const char* name, FieldType& type) {
+    return fieldTypeFromName(name, strlen(name), type);
+}
+
+// =============================================================================
+// Field Access
+// =============================================================================
+
+/**
+ * @brief Read element @p index of a field as a 64-bit integer
+ *
+ * Float fields are truncated toward zero. No bounds checks: the caller
+ * guarantees data holds the whole message.
+ */
+inline int64_t readFieldInt(const uint8_t* data, const FieldInfo& field, size_t index = 0) {
+    const uint8_t* p = data + field.offset + index * fieldTypeSize(field.type);
+    switch (field.type) {
+        case FieldType::BOOL:    return *p != 0;
+        case FieldType::INT8:    { int8_t v;   memcpy(&v, p, 1); return v; }
+        case FieldType::UINT8:   return *p;
+        case FieldType::INT16:   { int16_t v;  memcpy(&v, p, 2); return v; }
+        case FieldType::UINT16:  { uint16_t v; memcpy(&v, p, 2); return v; }
+        case FieldType::INT32:   { int32_t v;  memcpy(&v, p, 4); return v; }
+        case FieldType::UINT32:  { uint32_t v; memcpy(&v, p, 4); return v; }
+        case FieldType::INT64:
+        case FieldType::UINT64:  { int64_t v;  memcpy(&v, p, 8); return v; }
+        case FieldType::FLOAT32: { float v;    memcpy(&v, p, 4); return static_cast<int64_t>(v); }
+        case FieldType::FLOAT64: { double v;   memcpy(&v, p, 8); return static_cast<int64_t>(v); }
+    }
+    return 0;
+}
+
+/**
+ * @brief Read element @p index of a field as a double
+ */
+inline double readFieldDouble(const uint8_t* data, const FieldInfo& field, size_t index = 0) {
+    const uint8_t* p = data + field.offset + index * fieldTypeSize(field.type);
+    switch (field.type) {
+        case FieldType::FLOAT32: { float v;    memcpy(&v, p, 4); return v; }
+        case FieldType::FLOAT64: { double v;   memcpy(&v, p, 8); return v; }
+        case FieldType::UINT64:  { uint64_t v; memcpy(&v, p, 8); return static_cast<double>(v); }
+        default:                 return static_cast<double>(readFieldInt(data, field, index));
+    }
+}
+
+/**
+ * @brief Write element @p index of a field from a 64-bit integer
+ *
+ * Narrower integer fields keep the low bytes, like a C cast.
+ */
+inline void writeFieldInt(uint8_t* data, const FieldInfo& field, size_t index, int64_t value) {
+    uint8_t* p = data + field.offset + index * fieldTypeSize(field.type);
+    switch (field.type) {
+        case FieldType::BOOL:    *p = value != 0; break;
+        case FieldType::FLOAT32: { float v = static_cast<float>(value); memcpy(p, &v, 4); break; }
+        case FieldType::FLOAT64: { double v = static_cast<double>(value); memcpy(p, &v, 8); break; }
+        default:                 memcpy(p, &value, fieldTypeSize(field.type)); break;  // Little-endian
+    }
+}
+
+/**
+ * @brief Write element @p index of a field from a double
+ */
+inline void writeFieldDouble(uint8_t* data, const FieldInfo& field, size_t index, double value) {
+    uint8_t* p = data + field.offset + index * fieldTypeSize(field.type);
+    switch (field.type) {
+        case FieldType::FLOAT32: { float v = static_cast<float>(value); memcpy(p, &v, 4); break; }
+        case FieldType::FLOAT64: memcpy(p, &value, 8); break;
+        case FieldType::UINT64:  { uint64_t v = static_cast<uint64_t>(value); memcpy(p, &v, 8); break; }
+        default:                 writeFieldInt(data, field, index, static_cast<int64_t>(value)); break;
+    }
+}
+
+/**
+ * @brief Look up a field of a generated message by flattened name
+ *
+ * @tparam T Generated message type (with a FIELDS table)
+ * @param name e.g. "motor.pos" or "command_context" (the whole array)
+ * @return false if T has no such primitive field
+ */
+template<typename T>
+bool findGeneratedField(const char* name, FieldInfo& out) {
+    for (size_t i = 0; i < T::FIELD_COUNT; i++) {
+        const auto& layout = T::FIELDS[i];
+        if (strcmp(layout.name, name) != 0) continue;
+        out.name = layout.name;
+        out.offset = layout.offset;
+        out.count = layout.count;
+        return fieldTypeFromName(layout.type, out.type);
+    }
+    return false;
+}
+
+// =============================================================================
+// Fingerprints
+// =============================================================================
+
+/**
+ * @brief 32-bit FNV-1a over @p len bytes, continuing from @p hash
+ */
+inline uint32_t fnv1a32(const void* data, size_t len, uint32_t hash = 2166136261u) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < len; i++) hash = (hash ^ p[i]) * 16777619u;
+    return hash;
+}
+
+/**
+ * @brief Python struct format character for a schema type name (0 if unknown)
+ */
+inline char structFormatChar(const char* typeName) {
+    static constexpr struct { const char* name; char format; } FORMATS[] = {
+        {"bool", '?'},    {"char", 'c'},
+        {"int8", 'b'},    {"uint8", 'B'},   {"byte", 'B'},
+        {"int16", 'h'},   {"uint16", 'H'},
+        {"int32", 'i'},   {"int", 'i'},     {"uint32", 'I'},
+        {"int64", 'q'},   {"uint64", 'Q'},
+        {"float32", 'f'}, {"float", 'f'},   {"float64", 'd'}, {"double", 'd'},
+    };
+    for (const auto& entry : FORMATS) {
+        if (strcmp(entry.name, typeName) == 0) return entry.format;
+    }
+    return 0;
+}
+
+/**
+ * @brief Wire-compatibility fingerprint of a generated message type
+ *
+ * FNV-1a of "Name:" followed by the flattened struct format (one
+ * character per element, e.g. "MotorCommand:ffffiiii..."), the same value
+ * capybarish.discovery computes from a generated Python class's _FORMAT.
+ * Peers with different fingerprints for a topic would misread each other.
+ *
+ * @return 0 for types without a FIELDS table ("unknown", always accepted)
+ */
+template<typename T>
+uint32_t messageFingerprint() {
+    if constexpr (requires { T::NAME; T::FIELD_COUNT; T::FIELDS; }) {
+        uint32_t hash = fnv1a32(T::NAME, strlen(T::NAME));
+        hash = fnv1a32(":", 1, hash);
+        for (size_t i = 0; i < T::FIELD_COUNT; i++) {
+            char format = structFormatChar(T::FIELDS[i].type);
+            for (size_t k = 0; k < T::FIELDS[i].count; k++) hash = fnv1a32(&format, 1, hash);
+        }
+        return hash ? hash : 1;
+    } else {
+        return 0;
+    }
+}
+
+// =============================================================================
+// Deadbands
+// =============================================================================
+
+/**
+ * @brief Per-field thresholds for deciding whether a message changed
+ *
+ * changed() compares two serialized copies of a message field by field
+ * and reports a change when any element of a watched field moved by more
+ * than its deadband. Fixed capacity, no allocation.
+ */
+class DeadbandSet {
+public:
+    static constexpr size_t MAX_FIELDS = 8;
+
+    /**
+     * @brief Watch @p field; a move larger than @p deadband is a change
+     * @return false if the set is full
+     */
+    bool add(const FieldInfo& field, double deadband) {
+        for (size_t i = 0; i < _count; i++) {
+            if (_entries[i].field.offset == field.offset) {
+                _entries[i].deadband = deadband;  // Replace
+                return true;
+            }
+        }
+        if (_count >= MAX_FIELDS) return false;
+        _entries[_count++] = {field, deadband};
+        return true;
+    }
+
+    /**
+     * @brief Whether any watched field differs by more than its deadband
+     *
+     * A value turning NaN (or back) always counts as a change.
+     */
+    bool changed(const uint8_t* previous, const uint8_t* current) const {
+        for (size_t i = 0; i < _count; i++) {
+            const Entry& e = _entries[i];
+            for (size_t k = 0; k < e.field.count; k++) {
+                double a = readFieldDouble(previous, e.field, k);
+                double b = readFieldDouble(current, e.field, k);
+                if (a != a || b != b) {
+                    if ((a != a) != (b != b)) return true;
+                    continue;
+                }
+                double delta = b - a;
+                if (delta > e.deadband || -delta > e.deadband) return true;
+            }
+        }
+        return false;
+    }
+
+    size_t size() const { return _count; }
+    void clear() { _count = 0; }
+
+private:
+    struct Entry {
+        FieldInfo field;
+        double deadband;
+    };
+
+    Entry _entries[MAX_FIELDS];
+    size_t _count = 0;
+};
+
+// =============================================================================
+// Message Schema
+// =============================================================================
+
+/**
+ * @brief Flattened wire layout of one message type
+ *
+ * Owned by a SchemaSet; field names point into it (or into the generated
+ * header), so schemas are neither copied nor moved.
+ */
+class MessageSchema {
+public:
+    explicit MessageSchema(const char* name) : _name(name) {}
+    MessageSchema(const MessageSchema&) = delete;
+    MessageSchema& operator=(const MessageSchema&) = delete;
+
+    const char* name() const { return _name.c_str(); }
+
+    /**
+     * @brief Serialized size in bytes
+     */
+    size_t size() const { return _size; }
+
+    size_t fieldCount() const { return _fields.size(); }
+    const FieldInfo& field(size_t i) const { return _fields[i]; }
+
+    /**
+     * @brief Field by flattened name, e.g. "motor.pos"
+     */
+    const FieldInfo* find(const char* name) const {
+        for (const FieldInfo& f : _fields) {
+            if (strcmp(f.name, name) == 0) return &f;
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Make field @p name available to @p filter expressions
+     */
+    bool addToFilter(ContentFilter& filter, const char* name) const {
+        const FieldInfo* f = find(name);
+        return f && filter.addField(f->name, f->offset, f->type, f->count);
+    }
+
+private:
+    friend class SchemaSet;
+
+    /**
+     * @brief Append a field; @p name is copied unless it is static
+     */
+    void _append(const char* name, FieldType type, uint16_t count, bool copyName) {
+        if (copyName) {
+            _names.emplace_back(name);
+            name = _names.back().c_str();
+        }
+        _fields.push_back({name, static_cast<uint16_t>(_size), type, count});
+        _size += fieldTypeSize(type) * count;
+    }
+
+    std::string _name;
+    std::vector<FieldInfo> _fields;
+    std::deque<std::string> _names;  // Deque: growing it never moves the strings
+    size_t _size = 0;
+};
+
+// =============================================================================
+// Schema Set
+// =============================================================================
+
+/**
+ * @brief Registry of message schemas, by message name
+ */
+class SchemaSet {
+public:
+    static constexpr size_t MAX_NESTING = 8;
+
+    /**
+     * @brief Register a generated message type from its FIELDS table
+     * @return The schema (the existing one if the name is already known)
+     */
+    template<typename T>
+    const MessageSchema* add() {
+        if (const MessageSchema* known = find(T::NAME)) return known;
+
+        auto schema = std::make_unique<MessageSchema>(T::NAME);
+        for (size_t i = 0; i < T::FIELD_COUNT; i++) {
+            const auto& layout = T::FIELDS[i];
+            FieldType type;
+            if (!fieldTypeFromName(layout.type, type)) {
+                _fail("%s.%s: unknown type '%s'", T::NAME, layout.name, layout.type);
+                return nullptr;
+            }
+            schema->_append(layout.name, type, layout.count, false);
+        }
+        if (schema->size() != T::SIZE) {
+            _fail("%s: table covers %u of %u bytes", T::NAME,
+                  static_cast<unsigned>(schema->size()), static_cast<unsigned>(T::SIZE));
+            return nullptr;
+        }
+        _schemas.push_back(std::move(schema));
+        return _schemas.back().get();
+    }
+
+    /**
+     * @brief Load every message in .cpy schema text
+     *
+     * Messages may refer to each other in any order. Nothing is added if
+     * the text has an error; lastError() then names the line.
+     *
+     * @return Number of messages added
+     */
+    size_t parse(const char* text) {
+        _error[0] = '\0';
+        std::vector<Decl> decls;
+        if (!_parseDecls(text, decls)) return 0;
+
+        std::vector<std::unique_ptr<MessageSchema>> parsed;
+        for (const Decl& decl : decls) {
+            if (find(decl.name.c_str())) {
+                _fail("line %u: message '%s' already defined", decl.line, decl.name.c_str());
+                return 0;
+            }
+            auto schema = std::make_unique<MessageSchema>(decl.name.c_str());
+            if (!_flatten(decls, decl, *schema, "", 0)) return 0;
+            parsed.push_back(std::move(schema));
+        }
+        for (auto& schema : parsed) _schemas.push_back(std::move(schema));
+        return parsed.size();
+    }
+
+    /**
+     * @brief Schema by message name, nullptr if unknown
+     */
+    const MessageSchema* find(const char* name) const {
+        for (const auto& schema : _schemas) {
+            if (strcmp(schema->name(), name) == 0) return schema.get();
+        }
+        return nullptr;
+    }
+
+    size_t size() const { return _schemas.size(); }
+    const MessageSchema& at(size_t i) const { return *_schemas[i]; }
+
+    /**
+     * @brief Package name from the last parsed text ("" if none)
+     */
+    const char* package() const { return _package.c_str(); }
+
+    const char* lastError() const { return _error; }
+
+private:
+    struct RawField {
+        std::string type;
+        std::string name;
+        uint16_t count;
+    };
+
+    struct Decl {
+        std::string name;
+        std::vector<RawField> fields;
+        unsigned line;
+    };
+
+    /**
+     * @brief Split the text into message declarations (pass 1)
+     *
+     * Same line grammar as capybarish.codegen.parser: "package x",
+     * "message Name:", indented "type[N] name", and # comments.
+     */
+    bool _parseDecls(const char* text, std::vector<Decl>& decls) {
+        unsigned lineNum = 0;
+        while (*text) {
+            const char* end = strchr(text, '\n');
+            if (!end) end = text + strlen(text);
+            lineNum++;
+
+            const char* hash = static_cast<const char*>(memchr(text, '#', end - text));
+            std::string line(text, hash ? hash : end);
+            text = *end ? end + 1 : end;
+
+            bool indented = !line.empty() && (line[0] == ' ' || line[0] == '\t');
+            char word[64], name[64];
+            unsigned count = 0;
+            int used = 0;
+            if (sscanf(line.c_str(), " %63s%n", word, &used) != 1) continue;  // Blank
+
+            if (!indented && strcmp(word, "package") == 0) {
+                if (sscanf(line.c_str() + used, " %63[A-Za-z0-9_]", name) == 1) _package = name;
+            } else if (!indented && strcmp(word, "import") == 0) {
+                continue;  // Imported files are parsed separately
+            } else if (!indented && strcmp(word, "message") == 0) {
+                char colon = 0;
+                if (sscanf(line.c_str() + used, " %63[A-Za-z0-9_] %c", name, &colon) != 2 ||
+                    colon != ':') {
+                    return _fail("line %u: expected 'message Name:'", lineNum);
+                }
+                decls.push_back({name, {}, lineNum});
+            } else if (indented && !decls.empty()) {
+                // "type name" or "type[N] name"
+                std::string type(word);
+                size_t bracket = type.find('[');
+                if (bracket != std::string::npos) {
+                    if (sscanf(type.c_str() + bracket, "[%u]", &count) != 1 || count == 0) {
+                        return _fail("line %u: bad array size in '%s'", lineNum, word);
+                    }
+                    type.resize(bracket);
+                } else {
+                    count = 0;
+                }
+                if (sscanf(line.c_str() + used, " %63[A-Za-z0-9_]", name) != 1) {
+                    return _fail("line %u: expected 'type name'", lineNum);
+                }
+                decls.back().fields.push_back({type, name, static_cast<uint16_t>(count)});
+            } else {
+                return _fail("line %u: unrecognized '%.24s'", lineNum, word);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Append the primitive fields of @p decl to @p out (pass 2)
+     */
+    bool _flatten(const std::vector<Decl>& decls, const Decl& decl, MessageSchema& out,
+                  const std::string& prefix, size_t depth) {
+        if (depth > MAX_NESTING) {
+            return _fail("message '%s' nests too deep (recursive?)", decl.name.c_str());
+        }
+        for (const RawField& f : decl.fields) {
+            std::string name = prefix + f.name;
+            FieldType type;
+            if (fieldTypeFromName(f.type.c_str(), f.type.size(), type)) {
+                out._append(name.c_str(), type, f.count ? f.count : 1, true);
+                continue;
+            }
+
+            const Decl* nested = nullptr;
+            for (const Decl& d : decls) {
+                if (d.name == f.type) nested = &d;
+            }
+            if (!nested) {
+                return _fail("line %u: unknown type '%s' in message '%s'", decl.line,
+                             f.type.c_str(), decl.name.c_str());
+            }
+            if (f.count == 0) {
+                if (!_flatten(decls, *nested, out, name + ".", depth + 1)) return false;
+                continue;
+            }
+            for (unsigned i = 0; i < f.count; i++) {
+                char index[16];
+                snprintf(index, sizeof(index), "[%u].", i);
+                if (!_flatten(decls, *nested, out, name + index, depth + 1)) return false;
+            }
+        }
+        if (out.size() > UINT16_MAX) return _fail("message '%s' too large", decl.name.c_str());
+        return true;
+    }
+
+    template<typename... Args>
+    bool _fail(const char* fmt, Args... args) {
+        snprintf(_error, sizeof(_error), fmt, args...);
+        return false;
+    }
+
+    std::vector<std::unique_ptr<MessageSchema>> _schemas;
+    std::string _package;
+    char _error[96] = {};
+};
+
+// =============================================================================
+// Message View
+// =============================================================================
+
+/**
+ * @brief Field access by name on a serialized message
+ *
+ * A view over a const buffer refuses writes. Getters and setters return
+ * false for unknown fields, out-of-range indices or a short buffer.
+ */
+class MessageView {
+public:
+    MessageView(const MessageSchema& schema, uint8_t* data, size_t len)
+        : _schema(schema), _data(data), _len(len), _writable(true) {}
+    MessageView(const MessageSchema& schema, const uint8_t* data, size_t len)
+        : _schema(schema), _data(const_cast<uint8_t*>(data)), _len(len), _writable(false) {}
+
+    bool valid() const { return _len >= _schema.size(); }
+    const MessageSchema& schema() const { return _schema; }
+
+    bool getDouble(const char* name, double& value, size_t index = 0) const {
+        const FieldInfo* f = _lookup(name, index);
+        if (f) value = readFieldDouble(_data, *f, index);
+        return f != nullptr;
+    }
+
+    bool getInt(const char* name, int64_t& value, size_t index = 0) const {
+        const FieldInfo* f = _lookup(name, index);
+        if (f) value = readFieldInt(_data, *f, index);
+        return f != nullptr;
+    }
+
+    bool setDouble(const char* name, double value, size_t index = 0) {
+        const FieldInfo* f = _writable ? _lookup(name, index) : nullptr;
+        if (f) writeFieldDouble(_data, *f, index, value);
+        return f != nullptr;
+    }
+
+    bool setInt(const char* name, int64_t value, size_t index = 0) {
+        const FieldInfo* f = _writable ? _lookup(name, index) : nullptr;
+        if (f) writeFieldInt(_data, *f, index, value);
+        return f != nullptr;
+    }
+
+    /**
+     * @brief Write the message as one JSON object, e.g. for a dashboard
+     *
+     * Arrays become JSON arrays; nested messages keep their dotted keys.
+     *
+     * @return Length written (snprintf-style: >= @p capacity if truncated),
+     *         0 if the buffer is short
+     */
+    size_t toJson(char* out, size_t capacity) const {
+        if (!valid()) return 0;
+        size_t n = 0;
+        auto put = [&](const char* fmt, auto... args) {
+            int w = snprintf(n < capacity ? out + n : nullptr, n < capacity ? capacity - n : 0,
+                             fmt, args...);
+            if (w > 0) n += w;
+        };
+        put("{");
+        for (size_t i = 0; i < _schema.fieldCount(); i++) {
+            const FieldInfo& f = _schema.field(i);
+            put(i ? ",\"%s\":" : "\"%s\":", f.name);
+            if (f.count > 1) put("[");
+            for (size_t k = 0; k < f.count; k++) {
+                if (k) put(",");
+                if (fieldTypeIsFloat(f.type)) {
+                    put("%.9g", readFieldDouble(_data, f, k));
+                } else if (f.type == FieldType::BOOL) {
+                    put(readFieldInt(_data, f, k) ? "true" : "false");
+                } else if (f.type == FieldType::UINT64) {
+                    put("%llu", static_cast<unsigned long long>(readFieldInt(_data, f, k)));
+                } else {
+                    put("%lld", static_cast<long long>(readFieldInt(_data, f, k)));
+                }
+            }
+            if (f.count > 1) put("]");
+        }
+        put("}");
+        return n;
+    }
+
+private:
+    const FieldInfo* _lookup(const char* name, size_t index) const {
+        if (!valid()) return nullptr;
+        const FieldInfo* f = _schema.find(name);
+        return f && index < f->count ? f : nullptr;
+    }
+
+    const MessageSchema& _schema;
+    uint8_t* _data;
+    size_t _len;
+    bool _writable;
+};
+
+// =============================================================================
+// Re-encoding
+// =============================================================================
+
+/**
+ * @brief Converts messages between two layouts of the same type
+ *
+ * Fields are matched by name once, at construction; convert() then runs
+ * a flat list of copies. Same-typed fields are copied as bytes, integers
+ * convert through int64_t and anything involving a float through double.
+ * Destination fields missing from the source (or array elements past its
+ * length) are zeroed.
+ */
+class Reencoder {
+public:
+    Reencoder(const MessageSchema& from, const MessageSchema& to) : _from(from), _to(to) {
+        for (size_t i = 0; i < to.fieldCount(); i++) {
+            const FieldInfo& dst = to.field(i);
+            const FieldInfo* src = from.find(dst.name);
+            if (!src) continue;
+            Copy c = {src, &dst, src->count < dst.count ? src->count : dst.count, 0};
+            if (src->type == dst.type) c.bytes = c.count * fieldTypeSize(dst.type);
+
+            // A byte copy that continues the previous one on both sides joins it
+            if (c.bytes && !_copies.empty()) {
+                Copy& last = _copies.back();
+                if (last.bytes && last.src->offset + last.bytes == src->offset &&
+                    last.dst->offset + last.bytes == dst.offset) {
+                    last.bytes += c.bytes;
+                    continue;
+                }
+            }
+            _copies.push_back(c);
+        }
+    }
+
+    /**
+     * @brief Convert @p in (a @p from message) into @p out
+     * @return to.size(), or 0 if either buffer is too short
+     */
+    size_t convert(const uint8_t* in, size_t inLen, uint8_t* out, size_t outCapacity) const {
+        if (inLen < _from.size() || outCapacity < _to.size()) return 0;
+        memset(out, 0, _to.size());
+        for (const Copy& c : _copies) {
+            const FieldInfo& src = *c.src;
+            const FieldInfo& dst = *c.dst;
+            if (c.bytes) {
+                memcpy(out + dst.offset, in + src.offset, c.bytes);
+            } else if (fieldTypeIsFloat(src.type) || fieldTypeIsFloat(dst.type)) {
+                for (size_t k = 0; k < c.count; k++) {
+                    writeFieldDouble(out, dst, k, readFieldDouble(in, src, k));
+                }
+            } else {
+                for (size_t k = 0; k < c.count; k++) {
+                    writeFieldInt(out, dst, k, readFieldInt(in, src, k));
+                }
+            }
+        }
+        return _to.size();
+    }
+
+    /**
+     * @brief Number of copy steps per message (after merging)
+     */
+    size_t steps() const { return _copies.size(); }
+
+private:
+    struct Copy {
+        const FieldInfo* src;
+        const FieldInfo* dst;
+        uint16_t count;
+        size_t bytes;  // Same type on both sides: one memcpy (may span later fields)
+    };
+
+    const MessageSchema& _from;
+    const MessageSchema& _to;
+    std::vector<Copy> _copies;
+};
+
+} // namespace cpy
+
+#endif // CAPYBARISH_SCHEMA_H
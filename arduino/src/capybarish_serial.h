@@ -0,0 +1,332 @@
+/**
+ * @file capybarish_serial.h
+ * @brief Serial / USB-CDC transport with COBS framing and CRC-16
+ *
+ * Carries the same datagrams as the UDP path over any Arduino Stream
+ * (HardwareSerial, USB-CDC Serial, ...). Each datagram is sent as
+ *
+ *     0x00 COBS( port:u16 | datagram | crc16:u16 ) 0x00
+ *
+ * with little-endian fields and CRC-16/CCITT-FALSE over port and datagram.
+ * COBS removes every zero byte from the packet, so 0x00 only ever marks a
+ * packet boundary and the receiver resynchronises after one lost byte.
+ * The leading delimiter also means Serial.print() log text on the same
+ * port is discarded as one bad packet instead of corrupting the next one.
+ *
+ * Buffering is arranged for the UART/USB DMA engines rather than the CPU:
+ * a packet is encoded into one contiguous, word-aligned buffer and handed
+ * to the driver with a single write(), and received bytes are drained in
+ * 64-byte blocks (one USB full-speed packet / UART FIFO) instead of one
+ * read() per byte. On ESP32, enlarge the UART RX ring with
+ * Serial.setRxBufferSize() before begin() at high rates.
+ *
+ * The Python side (capybarish.serial_transport) uses the same format.
+ *
+ * @example
+ * @code
+ * cpy::SerialTransport<> link(Serial);
+ * cpy::Node node("module", "", &link);   // Every topic now goes over USB
+ *
+ * auto pub = node.createPublisher<SensorData>("/feedback", "", 6666);
+ * auto sub = node.createSubscription<MotorCommand>("/command", onCommand, 6667);
+ * @endcode
+ *
+ * @author Chen Yu <chenyu@u.northwestern.edu>
+ * @copyright 2025 Chen Yu
+ * @license Apache-2.0
+ */
+
+#pragma once
+
+#ifndef CAPYBARISH_SERIAL_H
+#define CAPYBARISH_SERIAL_H
+
+#include "Arduino.h"
+
+#include <cstring>
+#ifndef ESP8266
+#include <mutex>
+#endif
+
+#include "capybarish_transport.h"
+
+namespace cpy {
+
+// =============================================================================
+// COBS and CRC
+// =============================================================================
+
+/**
+ * @brief Worst-case COBS encoded size for @p len input bytes (no delimiter)
+ */
+constexpr size_t cobsMaxEncoded(size_t len) {
+    return len + len / 254 + 1;
+}
+
+/**
+ * @brief COBS-encode @p len bytes
+ *
+ * @param out Output buffer of at least cobsMaxEncoded(len) bytes
+ * @return Encoded length (without the 0x00 delimiter)
+ */
+inline size_t cobsEncode(const uint8_t* in, size_t len, uint8_t* out) {
+    size_t codeIdx = 0;
+    size_t o = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < len; i++) {
+        if (in[i] == 0) {
+            out[codeIdx] = code;
+            codeIdx = o++;
+            code = 1;
+        } else {
+            out[o++] = in[i];
+            if (++code == 0xFF) {
+                out[codeIdx] = code;
+                codeIdx = o++;
+                code = 1;
+            }
+        }
+    }
+    out[codeIdx] = code;
+    return o;
+}
+
+/**
+ * @brief Decode one COBS packet (without the 0x00 delimiter)
+ *
+ * @param out Output buffer of at least @p len bytes
+ * @param outLen Decoded length
+ * @return false if the packet is malformed
+ */
+inline bool cobsDecode(const uint8_t* in, size_t len, uint8_t* out, size_t& outLen) {
+    size_t i = 0;
+    size_t o = 0;
+    while (i < len) {
+        const uint8_t code = in[i++];
+        if (code == 0) return false;
+        for (uint8_t j = 1; j < code; j++) {
+            if (i >= len || in[i] == 0) return false;
+            out[o++] = in[i++];
+        }
+        if (code != 0xFF && i < len) {
+            out[o++] = 0;
+        }
+    }
+    outLen = o;
+    return true;
+}
+
+/**
+ * @brief CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+ */
+inline uint16_t crc16(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF) {
+    for (size_t i = 0; i < len; i++) {
+        crc ^= static_cast<uint16_t>(data[i]) << 8;
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021)
+                                 : static_cast<uint16_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// =============================================================================
+// Serial Transport
+// =============================================================================
+
+/**
+ * @brief Transport over an Arduino Stream with COBS framing and CRC-16
+ *
+ * Received datagrams are parked in a fixed set of slots until the
+ * subscription for their port takes them; when every slot is full the
+ * oldest datagram is dropped. No heap allocation.
+ *
+ * Every subscription on the transport receives through the same slots and
+ * every publisher encodes into the same TX buffer, so send() and
+ * receive()/poll() each hold a mutex: an Executor may run subscriptions
+ * and publishers of one transport on several threads. The two directions
+ * have separate locks and scratch buffers, so a send never waits for a
+ * receive. (ESP8266 has a single thread and no locks.)
+ *
+ * @tparam MAX_DATAGRAM Largest datagram carried (bytes)
+ * @tparam SLOTS Received datagrams buffered across all ports
+ */
+template<size_t MAX_DATAGRAM = 512, size_t SLOTS = 8>
+class SerialTransport : public Transport {
+public:
+    static constexpr size_t RAW_MAX = 2 + MAX_DATAGRAM + 2;
+    static constexpr size_t ENCODED_MAX = cobsMaxEncoded(RAW_MAX) + 2;
+    static constexpr size_t RX_BLOCK = 64;
+
+    explicit SerialTransport(Stream& stream) : _stream(stream) {}
+
+    bool send(uint16_t port, const uint8_t* data, size_t len) override {
+        if (len > MAX_DATAGRAM) return false;
+        Lock lock(_txMutex);
+
+        _txRaw[0] = port & 0xFF;
+        _txRaw[1] = port >> 8;
+        memcpy(_txRaw + 2, data, len);
+        const uint16_t crc = crc16(_txRaw, len + 2);
+        _txRaw[len + 2] = crc & 0xFF;
+        _txRaw[len + 3] = crc >> 8;
+
+        _tx[0] = 0;
+        size_t n = 1 + cobsEncode(_txRaw, len + 4, _tx + 1);
+        _tx[n++] = 0;
+        return _stream.write(_tx, n) == n;
+    }
+
+    size_t receive(uint16_t port, uint8_t* buffer, size_t capacity) override {
+        Lock lock(_rxMutex);
+        _poll();
+
+        Slot* oldest = nullptr;
+        for (size_t i = 0; i < SLOTS; i++) {
+            Slot& s = _slots[i];
+            if (s.used && s.port == port && (!oldest || _before(s.order, oldest->order))) {
+                oldest = &s;
+            }
+        }
+        if (!oldest) return 0;
+
+        memcpy(buffer, oldest->data, oldest->len < capacity ? oldest->len : capacity);
+        oldest->used = false;
+        return oldest->len;
+    }
+
+    const char* name() const override { return "serial"; }
+
+    /**
+     * @brief Drain the stream and decode complete packets into slots
+     *
+     * Called by receive(); call it directly to keep the driver's RX ring
+     * from overflowing when topics are polled rarely.
+     */
+    void poll() {
+        Lock lock(_rxMutex);
+        _poll();
+    }
+
+    /**
+     * @brief Number of datagrams waiting in slots (all ports)
+     */
+    size_t pending() const {
+        Lock lock(_rxMutex);
+        size_t count = 0;
+        for (size_t i = 0; i < SLOTS; i++) {
+            count += _slots[i].used;
+        }
+        return count;
+    }
+
+    uint32_t getCrcErrors() const { return _crcErrors; }
+    uint32_t getFramingErrors() const { return _framingErrors; }
+    uint32_t getOverflowCount() const { return _overflows; }
+
+private:
+#ifdef ESP8266
+    struct Mutex {};
+    struct Lock {
+        explicit Lock(Mutex&) {}
+    };
+#else
+    using Mutex = std::mutex;
+    using Lock = std::lock_guard<std::mutex>;
+#endif
+
+    struct Slot {
+        bool used = false;
+        uint16_t port = 0;
+        uint16_t len = 0;
+        uint32_t order = 0;
+        uint8_t data[MAX_DATAGRAM];
+    };
+
+    static bool _before(uint32_t a, uint32_t b) {
+        return static_cast<int32_t>(a - b) < 0;
+    }
+
+    void _poll() {
+        int avail;
+        while ((avail = _stream.available()) > 0) {
+            size_t n = _stream.readBytes(_rxBlock, avail < (int)RX_BLOCK ? avail : RX_BLOCK);
+            if (n == 0) break;
+            for (size_t i = 0; i < n; i++) {
+                _consume(_rxBlock[i]);
+            }
+        }
+    }
+
+    void _consume(uint8_t byte) {
+        if (byte != 0) {
+            if (_rxLen < sizeof(_rxFrame)) {
+                _rxFrame[_rxLen++] = byte;
+            } else {
+                _rxDiscard = true;  // Oversized: skip to the next delimiter
+            }
+            return;
+        }
+
+        if (_rxDiscard) {
+            _framingErrors++;
+        } else if (_rxLen > 0) {
+            _deliver();
+        }
+        _rxLen = 0;
+        _rxDiscard = false;
+    }
+
+    void _deliver() {
+        size_t len;
+        if (!cobsDecode(_rxFrame, _rxLen, _rxRaw, len) || len < 4 || len > RAW_MAX) {
+            _framingErrors++;
+            return;
+        }
+
+        const uint16_t crc = _rxRaw[len - 2] | (_rxRaw[len - 1] << 8);
+        if (crc16(_rxRaw, len - 2) != crc) {
+            _crcErrors++;
+            return;
+        }
+
+        Slot* slot = nullptr;
+        for (size_t i = 0; i < SLOTS && !slot; i++) {
+            if (!_slots[i].used) slot = &_slots[i];
+        }
+        if (!slot) {
+            // Full: overwrite the oldest datagram
+            slot = &_slots[0];
+            for (size_t i = 1; i < SLOTS; i++) {
+                if (_before(_slots[i].order, slot->order)) slot = &_slots[i];
+            }
+            _overflows++;
+        }
+
+        slot->used = true;
+        slot->port = _rxRaw[0] | (_rxRaw[1] << 8);
+        slot->len = static_cast<uint16_t>(len - 4);
+        slot->order = _order++;
+        memcpy(slot->data, _rxRaw + 2, slot->len);
+    }
+
+    Stream& _stream;
+    mutable Mutex _txMutex;  // _tx, _txRaw and writes to the stream
+    mutable Mutex _rxMutex;  // Everything else
+    alignas(4) uint8_t _tx[ENCODED_MAX];
+    alignas(4) uint8_t _rxBlock[RX_BLOCK];
+    uint8_t _txRaw[RAW_MAX];
+    uint8_t _rxRaw[cobsMaxEncoded(RAW_MAX)];
+    uint8_t _rxFrame[cobsMaxEncoded(RAW_MAX)];
+    size_t _rxLen = 0;
+    bool _rxDiscard = false;
+    Slot _slots[SLOTS];
+    uint32_t _order = 0;
+    uint32_t _crcErrors = 0;
+    uint32_t _framingErrors = 0;
+    uint32_t _overflows = 0;
+};
+
+} // namespace cpy
+
+#endif // CAPYBARISH_SERIAL_H
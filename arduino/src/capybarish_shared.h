@@ -0,0 +1,286 @@
+/**
+ * @file capybarish_shared.h
+ * @brief Lock-free latest-value sharing between tasks and ISRs
+ *
+ * A subscription usually runs on one task while the control loop, a
+ * second core or an ISR wants the latest command or sensor state. Plain
+ * globals tear (a half-updated 84-byte MotorCommand) and a mutex cannot be
+ * taken from an ISR. Both types here have a single wait-free writer and
+ * never block:
+ *
+ * - Seqlock<T>: one copy of T guarded by a sequence counter. Readers copy
+ *   the value and retry if a write overlapped. Smallest footprint; best
+ *   for small messages read less often than they are written.
+ * - TripleBuffer<T>: three copies of T. The reader owns one, the writer
+ *   owns one, and the third is swapped with a single atomic exchange.
+ *   Reads never retry and never copy; best for large messages or a
+ *   reader that must have a bounded read time.
+ *
+ * Both are cache-line aligned so they do not share lines with unrelated
+ * data. Either can be set as the output of a Subscription, which then
+ * stores every accepted message in it (see Node::createSubscription).
+ *
+ * @example
+ * @code
+ * cpy::Seqlock<MotorCommand> command;        // Written by the subscription
+ * cpy::TripleBuffer<SensorData> feedback;    // Written by the sensor task
+ *
+ * void setup() {
+ *     node.createSubscription<MotorCommand>("/motor/command", command, 6666);
+ * }
+ *
+ * void controlTask(void*) {
+ *     uint32_t seen = 0;
+ *     MotorCommand cmd;
+ *     while (true) {
+ *         if (command.readIfNewer(cmd, seen)) applyCommand(cmd);
+ *         if (feedback.update()) log(feedback.read());
+ *         vTaskDelay(1);
+ *     }
+ * }
+ * @endcode
+ *
+ * @author Chen Yu <chenyu@u.northwestern.edu>
+ * @copyright 2025 Chen Yu
+ * @license Apache-2.0
+ */
+
+#pragma once
+
+#ifndef CAPYBARISH_SHARED_H
+#define CAPYBARISH_SHARED_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace cpy {
+
+/**
+ * @brief Alignment used to keep shared state off neighbouring cache lines
+ *
+ * 64 bytes covers x86/ARM hosts; the ESP32's 32-byte lines are a divisor.
+ */
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+// =============================================================================
+// Seqlock
+// =============================================================================
+
+/**
+ * @brief Latest value of T behind a sequence counter
+ *
+ * The counter is odd while a write is in progress. A reader copies the
+ * value between two loads of the counter and keeps the copy only if both
+ * loads saw the same even count. The value is held as 32-bit relaxed
+ * atomics so a racing copy is well defined; on 32-bit targets each word is
+ * a plain load or store.
+ *
+ * There must be only one writer at a time. write() is wait-free and safe
+ * in an ISR. read() and readIfNewer() spin while a write is in progress,
+ * so an ISR that can preempt the writer must use tryRead() or
+ * tryReadIfNewer() instead.
+ *
+ * @tparam T Trivially copyable message type
+ */
+template<typename T>
+class alignas(CACHE_LINE_SIZE) Seqlock {
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "Seqlock needs a trivially copyable type");
+
+    Seqlock() {
+        for (auto& word : _words) word.store(0, std::memory_order_relaxed);
+    }
+
+    explicit Seqlock(const T& initial) : Seqlock() { write(initial); }
+
+    Seqlock(const Seqlock&) = delete;
+    Seqlock& operator=(const Seqlock&) = delete;
+
+    /**
+     * @brief Replace the value (single writer)
+     */
+    void write(const T& value) {
+        uint32_t seq = _seq.load(std::memory_order_relaxed);
+        _seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        const uint8_t* src = reinterpret_cast<const uint8_t*>(&value);
+        for (size_t i = 0; i < WORDS; i++) {
+            uint32_t word = 0;
+            memcpy(&word, src + i * 4, _chunk(i));
+            _words[i].store(word, std::memory_order_relaxed);
+        }
+
+        _seq.store(seq + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copy the value once, without retrying
+     * @return false if a write was in progress (@p out is then garbage)
+     */
+    bool tryRead(T& out) const {
+        uint32_t before = _seq.load(std::memory_order_acquire);
+        if (before & 1) return false;
+        _copyOut(out);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return _seq.load(std::memory_order_relaxed) == before;
+    }
+
+    /**
+     * @brief Copy a consistent value, retrying while writes overlap
+     */
+    void read(T& out) const {
+        while (!tryRead(out)) {
+        }
+    }
+
+    T read() const {
+        T out;
+        read(out);
+        return out;
+    }
+
+    /**
+     * @brief Copy the value only if it changed since @p lastVersion
+     *
+     * @param out Receives the value
+     * @param lastVersion Version the caller saw last; updated on success
+     *        (start from 0, which is "never written")
+     * @return true if @p out holds a newer value
+     *
+     * Spins while a write is in progress: not for an ISR that can preempt
+     * the writer (see tryReadIfNewer()).
+     */
+    bool readIfNewer(T& out, uint32_t& lastVersion) const {
+        while (_seq.load(std::memory_order_acquire) != lastVersion * 2) {
+            if (tryReadIfNewer(out, lastVersion)) return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief readIfNewer() without retrying, safe in an ISR
+     *
+     * @return false if nothing changed or a write was in progress (ask
+     *         again later); @p lastVersion is then unchanged
+     */
+    bool tryReadIfNewer(T& out, uint32_t& lastVersion) const {
+        uint32_t before = _seq.load(std::memory_order_acquire);
+        if (before == lastVersion * 2 || (before & 1)) return false;
+        _copyOut(out);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_seq.load(std::memory_order_relaxed) != before) return false;
+        lastVersion = before / 2;
+        return true;
+    }
+
+    /**
+     * @brief Number of completed writes (wraps)
+     */
+    uint32_t version() const { return _seq.load(std::memory_order_acquire) / 2; }
+
+private:
+    static constexpr size_t WORDS = (sizeof(T) + 3) / 4;
+
+    static constexpr size_t _chunk(size_t i) {
+        return i + 1 < WORDS ? 4 : sizeof(T) - i * 4;
+    }
+
+    void _copyOut(T& out) const {
+        uint8_t* dst = reinterpret_cast<uint8_t*>(&out);
+        for (size_t i = 0; i < WORDS; i++) {
+            uint32_t word = _words[i].load(std::memory_order_relaxed);
+            memcpy(dst + i * 4, &word, _chunk(i));
+        }
+    }
+
+    std::atomic<uint32_t> _seq{0};
+    std::atomic<uint32_t> _words[WORDS];
+};
+
+// =============================================================================
+// Triple Buffer
+// =============================================================================
+
+/**
+ * @brief Three copies of T handed between one writer and one reader
+ *
+ * The writer fills its back buffer and publish() swaps it with the shared
+ * middle buffer; update() on the reader swaps the middle buffer with its
+ * front buffer if the writer has published since. Each side touches only
+ * its own buffer in between, so neither ever waits or copies. Intermediate
+ * values are skipped when the writer is faster than the reader.
+ *
+ * Each buffer sits on its own cache lines, and the shared index on another,
+ * so the two sides only exchange the line holding the index.
+ *
+ * @tparam T Message type
+ */
+template<typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+
+    explicit TripleBuffer(const T& initial) {
+        for (auto& slot : _slots) slot.value = initial;
+    }
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // --- Writer ---
+
+    /**
+     * @brief Buffer to fill in place before publish()
+     */
+    T& writeBuffer() { return _slots[_back].value; }
+
+    /**
+     * @brief Make the write buffer the latest value (wait-free)
+     */
+    void publish() {
+        _back = _middle.exchange(_back | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    void write(const T& value) {
+        writeBuffer() = value;
+        publish();
+    }
+
+    // --- Reader ---
+
+    /**
+     * @brief Take the latest published value, if any (wait-free)
+     * @return true if read() now returns a newer value
+     */
+    bool update() {
+        if (!(_middle.load(std::memory_order_relaxed) & FRESH)) return false;
+        _front = _middle.exchange(_front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    /**
+     * @brief Value taken by the last update(); stable until the next one
+     */
+    const T& read() const { return _slots[_front].value; }
+
+private:
+    static constexpr uint8_t INDEX = 0x03;
+    static constexpr uint8_t FRESH = 0x04;
+
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        T value{};
+    };
+
+    Slot _slots[3];
+    alignas(CACHE_LINE_SIZE) std::atomic<uint8_t> _middle{1};
+    alignas(CACHE_LINE_SIZE) uint8_t _back = 2;   // Writer only
+    alignas(CACHE_LINE_SIZE) uint8_t _front = 0;  // Reader only
+};
+
+} // namespace cpy
+
+#endif // CAPYBARISH_SHARED_H
@@ -0,0 +1,452 @@
+/**
+ * @file capybarish_sim.h
+ * @brief Discrete-event simulation of many Nodes on an in-memory network
+ *
+ * Runs hundreds of cpy::Node instances in one process, faster than real
+ * time and bit-for-bit reproducible, for scaling and timing-regression
+ * tests:
+ *
+ * - The Simulation installs a VirtualClock (capybarish_clock.h), so
+ *   timers, rates, budgets and coroutine deadlines see virtual time.
+ * - Each node talks through a SimTransport endpoint of one SimNetwork.
+ *   A datagram sent to a port reaches every other endpoint that receives
+ *   on that port, after a fixed latency plus seeded jitter, unless it is
+ *   dropped by the seeded loss model or a full receive queue.
+ * - run() spins every node until nothing more happens at the current
+ *   instant, then jumps straight to the next event: the earliest timer,
+ *   deferred publish, coroutine deadline or datagram delivery.
+ *
+ * Nodes are spun in the order they were added and the random stream is a
+ * fixed SplitMix64 sequence, so a given seed gives the same run on every
+ * platform. Nothing sleeps; a run costs only the callbacks it executes.
+ *
+ * @example
+ * @code
+ * cpy::Simulation sim({.latencyUs = 500, .jitterUs = 200, .lossRate = 0.01f});
+ *
+ * cpy::Node server("server", "", sim.createTransport("server"));
+ * server.createSubscription<SensorData>("/feedback", onFeedback, 6666);
+ * auto* cmd = server.createPublisher<MotorCommand>("/command", "", 6667);
+ * server.createTimer(0.02f, [&] { cmd->publish(nextCommand()); });
+ * sim.addNode(&server);
+ *
+ * std::vector<std::unique_ptr<Module>> modules;   // Each owns a Node
+ * for (int i = 0; i < 200; i++) {
+ *     modules.push_back(std::make_unique<Module>(i, sim.createTransport("module")));
+ *     sim.addNode(&modules.back()->node);
+ * }
+ *
+ * sim.runFor(60 * 1000000ull);   // One virtual minute, in about a second
+ * @endcode
+ *
+ * @author Chen Yu <chenyu@u.northwestern.edu>
+ * @copyright 2025 Chen Yu
+ * @license Apache-2.0
+ */
+
+#pragma once
+
+#ifndef CAPYBARISH_SIM_H
+#define CAPYBARISH_SIM_H
+
+#include "capybarish_pubsub.h"
+
+#include <deque>
+#include <memory>
+#include <queue>
+#include <vector>
+
+namespace cpy {
+
+// =============================================================================
+// Network Model
+// =============================================================================
+
+/**
+ * @brief Delivery model shared by every endpoint of a SimNetwork
+ */
+struct SimLinkConfig {
+    uint32_t latencyUs = 100;  ///< Fixed one-way delay
+    uint32_t jitterUs = 0;     ///< Extra delay, uniform in [0, jitterUs]
+    float lossRate = 0.0f;     ///< Probability a datagram is dropped
+    size_t queueDepth = 64;    ///< Datagrams per endpoint and port before drops
+};
+
+/**
+ * @brief SplitMix64: small, fast and identical on every platform
+ *
+ * The standard distributions are implementation defined, so they would
+ * break bit-for-bit reproducibility across toolchains.
+ */
+class SimRandom {
+public:
+    explicit SimRandom(uint64_t seed) : _state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (_state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * @return Uniform in [0, 1)
+     */
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+    /**
+     * @return Uniform in [0, bound]
+     */
+    uint32_t below(uint32_t bound) { return static_cast<uint32_t>(next() % (uint64_t(bound) + 1)); }
+
+private:
+    uint64_t _state;
+};
+
+class SimNetwork;
+class Simulation;
+
+/**
+ * @brief One node's attachment to a SimNetwork
+ *
+ * A port starts receiving the first time receive() is called on it, like
+ * binding a UDP socket: datagrams sent earlier are not queued for it.
+ */
+class SimTransport : public Transport {
+public:
+    SimTransport(SimNetwork* network, const char* name) : _network(network), _name(name) {}
+
+    bool send(uint16_t port, const uint8_t* data, size_t len) override;
+
+    size_t receive(uint16_t port, uint8_t* buffer, size_t capacity) override {
+        Inbox& inbox = _inbox(port);
+        if (inbox.queue.empty()) return 0;
+
+        std::vector<uint8_t>& datagram = inbox.queue.front();
+        size_t len = datagram.size();
+        memcpy(buffer, datagram.data(), min(len, capacity));
+        inbox.queue.pop_front();
+        return len;
+    }
+
+    const char* name() const override { return _name; }
+
+    /**
+     * @brief Whether a datagram arrived since the owning node was last spun,
+     *        or is still queued after it
+     */
+    bool hasArrivals() const { return _arrived; }
+
+    uint32_t getReceiveCount() const { return _received; }
+    uint32_t getOverflowCount() const { return _overflows; }
+
+private:
+    friend class SimNetwork;
+    friend class Simulation;
+
+    struct Inbox {
+        uint16_t port;
+        std::deque<std::vector<uint8_t>> queue;
+    };
+
+    Inbox& _inbox(uint16_t port);
+
+    bool _hasQueued() const {
+        for (const auto& inbox : _inboxes) {
+            if (!inbox.queue.empty()) return true;
+        }
+        return false;
+    }
+
+    SimNetwork* _network;
+    const char* _name;
+    std::deque<Inbox> _inboxes;  // Stable references as ports are added
+    bool _arrived = false;
+    uint32_t _received = 0;
+    uint32_t _overflows = 0;
+};
+
+/**
+ * @brief In-memory datagram network on a virtual clock
+ */
+class SimNetwork {
+public:
+    SimNetwork(VirtualClock& clock, const SimLinkConfig& config = {}, uint64_t seed = 1)
+        : _clock(clock), _config(config), _random(seed) {}
+
+    SimNetwork(const SimNetwork&) = delete;
+    SimNetwork& operator=(const SimNetwork&) = delete;
+
+    /**
+     * @brief Attach a new endpoint (owned by the network)
+     */
+    SimTransport* createEndpoint(const char* name) {
+        _endpoints.push_back(std::make_unique<SimTransport>(this, name));
+        return _endpoints.back().get();
+    }
+
+    /**
+     * @brief Whether @p transport is one of this network's endpoints
+     */
+    SimTransport* findEndpoint(const Transport* transport) const {
+        for (const auto& endpoint : _endpoints) {
+            if (endpoint.get() == transport) return endpoint.get();
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Time of the earliest datagram still in flight (UINT64_MAX if none)
+     */
+    uint64_t nextDeliveryUs() const { return _inFlight.empty() ? UINT64_MAX : _inFlight.top().atUs; }
+
+    /**
+     * @brief Hand every datagram due by now to its receivers
+     * @return Datagrams delivered
+     */
+    size_t deliverDue() {
+        size_t count = 0;
+        uint64_t now = _clock.now64();
+        while (!_inFlight.empty() && _inFlight.top().atUs <= now) {
+            const InFlight& d = _inFlight.top();
+            for (auto& binding : _bindings) {
+                if (binding.port != d.port) continue;
+                for (auto [endpoint, inbox] : binding.receivers) {
+                    if (endpoint == d.from) continue;
+                    if (inbox->queue.size() >= _config.queueDepth) {
+                        endpoint->_overflows++;
+                        _overflowCount++;
+                        continue;
+                    }
+                    inbox->queue.push_back(d.data);
+                    endpoint->_arrived = true;
+                    endpoint->_received++;
+                    count++;
+                }
+                break;
+            }
+            _inFlight.pop();
+        }
+        _deliveredCount += count;
+        return count;
+    }
+
+    const SimLinkConfig& config() const { return _config; }
+    void setConfig(const SimLinkConfig& config) { _config = config; }
+
+    uint64_t getSentCount() const { return _sentCount; }
+    uint64_t getDeliveredCount() const { return _deliveredCount; }
+    uint64_t getLostCount() const { return _lostCount; }
+    uint64_t getOverflowCount() const { return _overflowCount; }
+
+private:
+    friend class SimTransport;
+
+    struct InFlight {
+        uint64_t atUs;
+        uint64_t order;  // Send order breaks ties, so equal times stay FIFO
+        const SimTransport* from;
+        uint16_t port;
+        std::vector<uint8_t> data;
+
+        bool operator>(const InFlight& other) const {
+            return atUs != other.atUs ? atUs > other.atUs : order > other.order;
+        }
+    };
+
+    /**
+     * @brief Receivers of one port, in the order they bound it
+     */
+    struct Binding {
+        uint16_t port;
+        std::vector<std::pair<SimTransport*, SimTransport::Inbox*>> receivers;
+    };
+
+    void _bind(SimTransport* endpoint, SimTransport::Inbox* inbox) {
+        for (auto& binding : _bindings) {
+            if (binding.port == inbox->port) {
+                binding.receivers.push_back({endpoint, inbox});
+                return;
+            }
+        }
+        _bindings.push_back({inbox->port, {{endpoint, inbox}}});
+    }
+
+    void _send(const SimTransport* from, uint16_t port, const uint8_t* data, size_t len) {
+        _sentCount++;
+        if (_config.lossRate > 0.0f && _random.uniform() < _config.lossRate) {
+            _lostCount++;
+            return;
+        }
+        uint64_t delay = _config.latencyUs;
+        if (_config.jitterUs) delay += _random.below(_config.jitterUs);
+        _inFlight.push({_clock.now64() + delay, _order++, from, port,
+                        std::vector<uint8_t>(data, data + len)});
+    }
+
+    VirtualClock& _clock;
+    SimLinkConfig _config;
+    SimRandom _random;
+    std::vector<std::unique_ptr<SimTransport>> _endpoints;
+    std::vector<Binding> _bindings;
+    std::priority_queue<InFlight, std::vector<InFlight>, std::greater<InFlight>> _inFlight;
+    uint64_t _order = 0;
+    uint64_t _sentCount = 0;
+    uint64_t _deliveredCount = 0;
+    uint64_t _lostCount = 0;
+    uint64_t _overflowCount = 0;
+};
+
+inline bool SimTransport::send(uint16_t port, const uint8_t* data, size_t len) {
+    _network->_send(this, port, data, len);
+    return true;  // Like UDP, a lost datagram was still sent
+}
+
+inline SimTransport::Inbox& SimTransport::_inbox(uint16_t port) {
+    for (auto& inbox : _inboxes) {
+        if (inbox.port == port) return inbox;
+    }
+    _inboxes.push_back({port, {}});
+    _network->_bind(this, &_inboxes.back());
+    return _inboxes.back();
+}
+
+// =============================================================================
+// Simulation
+// =============================================================================
+
+/**
+ * @brief Virtual clock, network and the nodes run on them
+ *
+ * At each instant only the nodes with something to do are spun: a timer,
+ * publish or coroutine deadline that is due, or a datagram that arrived on
+ * their endpoint. Idle nodes cost one comparison, so a step is cheap even
+ * with hundreds of nodes.
+ *
+ * Installs its clock with setClock() for its lifetime, so create it before
+ * the nodes and keep only one alive at a time.
+ */
+class Simulation {
+public:
+    /**
+     * @brief Spin passes per instant before time is forced forward, in
+     *        case callbacks keep triggering each other with zero latency
+     */
+    static constexpr size_t MAX_PASSES = 64;
+
+    explicit Simulation(const SimLinkConfig& link = {}, uint64_t seed = 1, uint64_t startUs = 0)
+        : _clock(startUs), _network(_clock, link, seed) {
+        setClock(&_clock);
+    }
+
+    ~Simulation() {
+        if (activeClock() == &_clock) setClock(nullptr);
+    }
+
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    /**
+     * @brief New network endpoint for a node's constructor
+     */
+    SimTransport* createTransport(const char* name) { return _network.createEndpoint(name); }
+
+    /**
+     * @brief Spin @p node during run() (not owned)
+     *
+     * A node on another transport is spun at every instant, since its
+     * arrivals cannot be seen.
+     */
+    void addNode(Node* node) {
+        _nodes.push_back({node, _network.findEndpoint(node->getTransport()), 0});
+    }
+
+    /**
+     * @brief Run until virtual time @p endUs, processing every event
+     * @return Callbacks executed
+     */
+    size_t runUntil(uint64_t endUs) {
+        // Timers may have been created or reset since the last run
+        for (auto& entry : _nodes) entry.dueUs = 0;
+
+        size_t count = 0;
+        while (true) {
+            count += _settle();
+
+            uint64_t now = _clock.now64();
+            if (now >= endUs) break;
+
+            uint64_t next = min(endUs, _network.nextDeliveryUs());
+            for (const auto& entry : _nodes) next = min(next, entry.dueUs);
+            _clock.advanceTo(next);
+            _steps++;
+        }
+        return count;
+    }
+
+    size_t runFor(uint64_t durationUs) { return runUntil(_clock.now64() + durationUs); }
+
+    uint64_t now() const { return _clock.now64(); }
+    VirtualClock& clock() { return _clock; }
+    SimNetwork& network() { return _network; }
+    size_t getNodeCount() const { return _nodes.size(); }
+
+    /**
+     * @brief Distinct instants visited so far
+     */
+    uint64_t getStepCount() const { return _steps; }
+
+    /**
+     * @brief Node spins so far (idle nodes are skipped)
+     */
+    uint64_t getSpinCount() const { return _spins; }
+
+private:
+    struct Entry {
+        Node* node;
+        SimTransport* endpoint;  // nullptr: spun every instant
+        uint64_t dueUs;          // Next timer, publish or coroutine deadline
+    };
+
+    /**
+     * @brief Deliver and spin until nothing more happens at this instant
+     */
+    size_t _settle() {
+        uint64_t now = _clock.now64();
+        uint32_t now32 = static_cast<uint32_t>(now);
+        size_t callbacks = 0;
+        for (size_t pass = 0; pass < MAX_PASSES; pass++) {
+            size_t work = _network.deliverDue();
+            for (auto& entry : _nodes) {
+                bool arrived = !entry.endpoint || entry.endpoint->_arrived;
+                if (!arrived && entry.dueUs > now) continue;
+
+                size_t n = entry.node->spinOnce();
+                callbacks += n;
+                work += n;
+                _spins++;
+
+                // A subscription drains at most its QoS depth per spin, so
+                // the node stays due while datagrams are left over
+                if (entry.endpoint) entry.endpoint->_arrived = entry.endpoint->_hasQueued();
+
+                // Something due that did not run now (e.g. a budget that
+                // is still short) is retried 1 us later
+                uint32_t idle = entry.node->getIdleUs(now32);
+                entry.dueUs = now + max<uint32_t>(idle, n == 0 ? 1 : 0);
+            }
+            if (work == 0) break;
+        }
+        return callbacks;
+    }
+
+    VirtualClock _clock;
+    SimNetwork _network;
+    std::vector<Entry> _nodes;
+    uint64_t _steps = 0;
+    uint64_t _spins = 0;
+};
+
+} // namespace cpy
+
+#endif // CAPYBARISH_SIM_H
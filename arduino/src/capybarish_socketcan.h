@@ -0,0 +1,182 @@
+/**
+ * @file capybarish_socketcan.h
+ * @brief Linux SocketCAN backend for CanFrame codecs
+ *
+ * Lets the CyberGear codec (capybarish_cybergear.h) drive motors from a
+ * Linux host or SBC (can0, USB-CAN adapters, or vcan0 for testing). A
+ * batch of frames goes out with one sendmmsg() call, so a control tick for
+ * a whole leg costs one syscall instead of one per motor. Not built on
+ * Arduino targets.
+ *
+ * @example
+ * @code
+ * cpy::SocketCan bus;
+ * if (!bus.open("can0")) return;
+ * bus.setFilter(cpy::cybergear::DEFAULT_HOST_ID);  // Only frames addressed to us
+ *
+ * cpy::CanFrame frames[4];
+ * cpy::cybergear::encodeMotionBatch(ids, cmds, 4, frames);
+ * bus.send(frames, 4);
+ *
+ * cpy::CanFrame rx;
+ * while (bus.receive(rx, 0)) { ... }
+ * @endcode
+ *
+ * @author Chen Yu <chenyu@u.northwestern.edu>
+ * @copyright 2025 Chen Yu
+ * @license Apache-2.0
+ */
+
+#pragma once
+
+#ifndef CAPYBARISH_SOCKETCAN_H
+#define CAPYBARISH_SOCKETCAN_H
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include <cstring>
+
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "capybarish_cybergear.h"
+
+namespace cpy {
+
+/**
+ * @brief Raw CAN socket bound to one interface
+ */
+class SocketCan {
+public:
+    static constexpr size_t MAX_BATCH = 32;
+
+    SocketCan() = default;
+    ~SocketCan() { close(); }
+
+    SocketCan(const SocketCan&) = delete;
+    SocketCan& operator=(const SocketCan&) = delete;
+
+    /**
+     * @brief Open and bind a raw CAN socket
+     *
+     * @param interface Interface name (e.g. "can0", "vcan0")
+     * @return true on success
+     */
+    bool open(const char* interface) {
+        close();
+        _fd = ::socket(PF_CAN, SOCK_RAW | SOCK_CLOEXEC, CAN_RAW);
+        if (_fd < 0) return false;
+
+        struct ifreq ifr;
+        memset(&ifr, 0, sizeof(ifr));
+        strncpy(ifr.ifr_name, interface, IFNAMSIZ - 1);
+        struct sockaddr_can addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.can_family = AF_CAN;
+        if (::ioctl(_fd, SIOCGIFINDEX, &ifr) < 0 ||
+            (addr.can_ifindex = ifr.ifr_ifindex,
+             ::bind(_fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (_fd >= 0) {
+            ::close(_fd);
+            _fd = -1;
+        }
+    }
+
+    bool isOpen() const { return _fd >= 0; }
+    int fd() const { return _fd; }
+
+    /**
+     * @brief Only receive extended frames whose destination byte is @p target
+     *
+     * Filtering in the kernel keeps other hosts' traffic off this socket.
+     */
+    bool setFilter(uint8_t target) {
+        struct can_filter filter;
+        filter.can_id = CAN_EFF_FLAG | target;
+        filter.can_mask = CAN_EFF_FLAG | CAN_RTR_FLAG | 0xFF;
+        return ::setsockopt(_fd, SOL_CAN_RAW, CAN_RAW_FILTER, &filter, sizeof(filter)) == 0;
+    }
+
+    /**
+     * @brief Send frames with one sendmmsg() per MAX_BATCH frames
+     *
+     * @return Number of frames queued to the driver
+     */
+    size_t send(const CanFrame* frames, size_t n) {
+        struct can_frame raw[MAX_BATCH];
+        struct iovec iov[MAX_BATCH];
+        struct mmsghdr msgs[MAX_BATCH];
+
+        size_t sent = 0;
+        while (sent < n) {
+            const size_t batch = (n - sent) < MAX_BATCH ? (n - sent) : MAX_BATCH;
+            for (size_t i = 0; i < batch; i++) {
+                _toRaw(frames[sent + i], raw[i]);
+                iov[i].iov_base = &raw[i];
+                iov[i].iov_len = sizeof(raw[i]);
+                memset(&msgs[i], 0, sizeof(msgs[i]));
+                msgs[i].msg_hdr.msg_iov = &iov[i];
+                msgs[i].msg_hdr.msg_iovlen = 1;
+            }
+            const int r = ::sendmmsg(_fd, msgs, static_cast<unsigned>(batch), 0);
+            if (r <= 0) break;
+            sent += static_cast<size_t>(r);
+            if (static_cast<size_t>(r) < batch) break;  // TX queue full (ENOBUFS)
+        }
+        return sent;
+    }
+
+    bool send(const CanFrame& frame) { return send(&frame, 1) == 1; }
+
+    /**
+     * @brief Receive one extended data frame
+     *
+     * Standard-ID, RTR and error frames are skipped.
+     *
+     * @param timeoutMs 0 polls, -1 blocks
+     * @return true if @p frame was filled
+     */
+    bool receive(CanFrame& frame, int timeoutMs = 0) {
+        struct pollfd pfd = {_fd, POLLIN, 0};
+        struct can_frame raw;
+        while (::poll(&pfd, 1, timeoutMs) > 0) {
+            if (::read(_fd, &raw, sizeof(raw)) != static_cast<ssize_t>(sizeof(raw))) return false;
+            if ((raw.can_id & CAN_EFF_FLAG) && !(raw.can_id & (CAN_RTR_FLAG | CAN_ERR_FLAG))) {
+                frame.id = raw.can_id & CAN_EFF_MASK;
+                frame.len = raw.can_dlc > 8 ? 8 : raw.can_dlc;
+                memcpy(frame.data, raw.data, 8);
+                return true;
+            }
+            timeoutMs = 0;
+        }
+        return false;
+    }
+
+private:
+    static void _toRaw(const CanFrame& f, struct can_frame& raw) {
+        memset(&raw, 0, sizeof(raw));
+        raw.can_id = (f.id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+        raw.can_dlc = f.len > 8 ? 8 : f.len;
+        memcpy(raw.data, f.data, 8);
+    }
+
+    int _fd = -1;
+};
+
+} // namespace cpy
+
+#endif // __linux__ && !ARDUINO
+
+#endif // CAPYBARISH_SOCKETCAN_H
@@ -0,0 +1,274 @@
+/**
+ * @file capybarish_trace.h
+ * @brief Compact on-device trace of Node activity, viewable in Perfetto
+ *
+ * Jitter in a control loop is hard to explain from counters alone: which
+ * callback ran long, whether the packet arrived late or the timer fired
+ * late, how long the node slept. A TraceRecorder keeps the most recent
+ * events in a fixed ring of 10-byte records:
+ *
+ * - begin/end of every subscription, timer and coroutine callback
+ * - packet arrival (bytes) and publish (bytes) per topic
+ * - timer lateness (microseconds past the period)
+ * - idle time while the node sleeps between passes
+ *
+ * Recording is wait-free (one atomic increment and a store), so it stays
+ * on in the field; freeze() stops it right after an anomaly so the ring
+ * holds the lead-up. dump() writes a binary blob to any Print-like
+ * output; `capybarish trace` turns it into Chrome/Perfetto trace JSON
+ * (open in ui.perfetto.dev or chrome://tracing).
+ *
+ * Timestamps come from nowUs(), so a trace of a simulation is in virtual
+ * time.
+ *
+ * @example
+ * @code
+ * cpy::TraceBuffer<2048> trace;  // 20 KB, ~2 s at 1 kHz with one topic
+ *
+ * void setup() {
+ *     node.setTrace(&trace);
+ * }
+ *
+ * void loop() {
+ *     node.spinFor(5000);
+ *     if (Serial.read() == 't') {
+ *         trace.freeze();
+ *         trace.dump(Serial);   // capybarish trace capture.bin -o trace.json
+ *         trace.clear();
+ *     }
+ * }
+ * @endcode
+ *
+ * @author Chen Yu <chenyu@u.northwestern.edu>
+ * @copyright 2025 Chen Yu
+ * @license Apache-2.0
+ */
+
+#pragma once
+
+#ifndef CAPYBARISH_TRACE_H
+#define CAPYBARISH_TRACE_H
+
+#include "capybarish_clock.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace cpy {
+
+// =============================================================================
+// Events
+// =============================================================================
+
+enum class TraceEventType : uint8_t {
+    CALLBACK_BEGIN = 1,
+    CALLBACK_END = 2,
+    PACKET = 3,          ///< arg = bytes received
+    PUBLISH = 4,         ///< arg = bytes sent
+    TIMER_LATENESS = 5,  ///< arg = microseconds past the period
+    IDLE_BEGIN = 6,
+    IDLE_END = 7,
+};
+
+/**
+ * @brief What a trace entity is (one track in the viewer)
+ */
+enum class TraceEntityKind : uint8_t {
+    NODE = 0,
+    SUBSCRIPTION = 1,
+    PUBLISHER = 2,
+    TIMER = 3,
+    COROUTINES = 4,
+    SERVICE = 5,
+    CLIENT = 6,
+};
+
+#pragma pack(push, 1)
+/**
+ * @brief One trace record (10 bytes, little-endian in dumps)
+ */
+struct TraceEvent {
+    uint32_t timeUs;  ///< nowUs() (wraps; the converter unwraps it)
+    uint32_t arg;
+    uint8_t type;     ///< TraceEventType
+    uint8_t entity;   ///< Index returned by TraceRecorder::addEntity()
+};
+#pragma pack(pop)
+
+static_assert(sizeof(TraceEvent) == 10, "TraceEvent must be packed");
+
+// =============================================================================
+// Recorder
+// =============================================================================
+
+/**
+ * @brief Ring of trace events plus the names of the entities they refer to
+ *
+ * Storage is supplied by the caller (see TraceBuffer). When the ring is
+ * full the oldest events are overwritten and counted as dropped.
+ *
+ * record() may be called from several tasks at once; each call claims its
+ * own slot. dump() reads the ring without locking, so freeze() first (or
+ * dump from the only task that records).
+ */
+class TraceRecorder {
+public:
+    static constexpr size_t MAX_ENTITIES = 32;
+    static constexpr size_t NAME_SIZE = 24;      ///< Longer names are truncated
+    static constexpr uint8_t NO_ENTITY = 0xFF;
+    static constexpr uint16_t FORMAT_VERSION = 1;
+
+    /**
+     * @param events Ring storage
+     * @param capacity Number of events; must be a power of two
+     */
+    TraceRecorder(TraceEvent* events, size_t capacity)
+        : _events(events)
+        , _mask(capacity - 1)
+    {}
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    /**
+     * @brief Register a track (call during setup, from one task)
+     * @return Entity index for record(), NO_ENTITY if the table is full
+     */
+    uint8_t addEntity(TraceEntityKind kind, const char* name) {
+        if (_numEntities >= MAX_ENTITIES) {
+            Serial.printf("[Trace] Max entities reached, '%s' not traced\n", name);
+            return NO_ENTITY;
+        }
+        Entity& e = _entities[_numEntities];
+        e.kind = kind;
+        strncpy(e.name, name ? name : "", NAME_SIZE - 1);
+        e.name[NAME_SIZE - 1] = '\0';
+        return static_cast<uint8_t>(_numEntities++);
+    }
+
+    /**
+     * @brief Append an event stamped with nowUs() (wait-free)
+     */
+    void record(TraceEventType type, uint8_t entity, uint32_t arg = 0) {
+        if (entity == NO_ENTITY || _frozen.load(std::memory_order_relaxed)) return;
+        uint32_t index = _head.fetch_add(1, std::memory_order_relaxed);
+        TraceEvent& e = _events[index & _mask];
+        e.timeUs = nowUs();
+        e.arg = arg;
+        e.type = static_cast<uint8_t>(type);
+        e.entity = entity;
+    }
+
+    /**
+     * @brief Stop recording, keeping what the ring holds now
+     */
+    void freeze() { _frozen.store(true, std::memory_order_relaxed); }
+    void unfreeze() { _frozen.store(false, std::memory_order_relaxed); }
+    bool isFrozen() const { return _frozen.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Drop all events (entities stay registered) and resume recording
+     */
+    void clear() {
+        _head.store(0, std::memory_order_relaxed);
+        unfreeze();
+    }
+
+    /**
+     * @brief Events currently held
+     */
+    size_t size() const {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        return head > capacity() ? capacity() : head;
+    }
+
+    size_t capacity() const { return _mask + 1; }
+
+    /**
+     * @brief Events overwritten since the last clear()
+     */
+    uint32_t getDroppedCount() const {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        return head > capacity() ? head - static_cast<uint32_t>(capacity()) : 0;
+    }
+
+    size_t getEntityCount() const { return _numEntities; }
+
+    /**
+     * @brief Write the trace in binary form
+     *
+     * Layout (little-endian): "CPYTRACE", u16 version, u16 entity count,
+     * u32 event count, u32 dropped count; per entity u8 kind, u8 name
+     * length, name bytes; then the events, oldest first.
+     *
+     * @param out Anything with write(const uint8_t*, size_t), e.g. Serial
+     * @return Bytes written
+     */
+    template<typename Out>
+    size_t dump(Out& out) const {
+        uint32_t head = _head.load(std::memory_order_acquire);
+        uint32_t count = static_cast<uint32_t>(size());
+        uint32_t dropped = getDroppedCount();
+        uint16_t entities = static_cast<uint16_t>(_numEntities);
+
+        size_t written = 0;
+        written += out.write(reinterpret_cast<const uint8_t*>("CPYTRACE"), 8);
+        written += _writeValue(out, FORMAT_VERSION);
+        written += _writeValue(out, entities);
+        written += _writeValue(out, count);
+        written += _writeValue(out, dropped);
+
+        for (size_t i = 0; i < _numEntities; i++) {
+            const Entity& e = _entities[i];
+            uint8_t header[2] = {static_cast<uint8_t>(e.kind), static_cast<uint8_t>(strlen(e.name))};
+            written += out.write(header, sizeof(header));
+            written += out.write(reinterpret_cast<const uint8_t*>(e.name), header[1]);
+        }
+
+        for (uint32_t i = head - count; i != head; i++) {
+            written += out.write(reinterpret_cast<const uint8_t*>(&_events[i & _mask]), sizeof(TraceEvent));
+        }
+        return written;
+    }
+
+private:
+    struct Entity {
+        TraceEntityKind kind;
+        char name[NAME_SIZE];
+    };
+
+    template<typename Out, typename V>
+    static size_t _writeValue(Out& out, V value) {
+        return out.write(reinterpret_cast<const uint8_t*>(&value), sizeof(value));
+    }
+
+    TraceEvent* _events;
+    size_t _mask;
+    std::atomic<uint32_t> _head{0};
+    std::atomic<bool> _frozen{false};
+    Entity _entities[MAX_ENTITIES];
+    size_t _numEntities = 0;
+};
+
+/**
+ * @brief TraceRecorder with its own storage
+ *
+ * @tparam CAPACITY Events kept (power of two; 10 bytes each)
+ */
+template<size_t CAPACITY>
+class TraceBuffer : public TraceRecorder {
+public:
+    static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0,
+                  "TraceBuffer capacity must be a power of two");
+
+    TraceBuffer() : TraceRecorder(_storage, CAPACITY) {}
+
+private:
+    TraceEvent _storage[CAPACITY];
+};
+
+} // namespace cpy
+
+#endif // CAPYBARISH_TRACE_H
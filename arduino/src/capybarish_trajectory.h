@@ -0,0 +1,392 @@
+/**
+ * @file capybarish_trajectory.h
+ * @brief Onboard playback of timestamped trajectory chunks
+ *
+ * Instead of streaming one setpoint per control tick, the server sends
+ * TrajectoryChunk messages (see schemas/motor_control.cpy) holding a short
+ * horizon of timestamped position/velocity points at a low rate (e.g. 50 Hz).
+ * TrajectoryBuffer keeps those points and samples them at the local control
+ * rate (e.g. 1 kHz), so a lost packet no longer leaves a gap in the command.
+ *
+ * Sender time is mapped to local time with a minimum-delay offset estimate,
+ * and playback runs a fixed playout delay behind it to absorb jitter. When
+ * the buffer runs dry, the last point is extrapolated with its velocity
+ * ramped down to zero, then held; the next chunk resumes from there.
+ *
+ * Usage:
+ * @code
+ * cpy::TrajectoryBuffer<> traj;
+ * traj.configure(cpy::Interpolation::CUBIC_HERMITE, 0.03f, 0.1f);
+ *
+ * void onChunk(const motor_control::TrajectoryChunk& chunk) {
+ *     traj.push(chunk, micros());
+ * }
+ *
+ * void controlLoop() {  // 1 kHz
+ *     cpy::TrajectorySample s = traj.sample(micros());
+ *     if (s.state != cpy::TrajectoryState::EMPTY) {
+ *         motor.setTarget(s.pos, s.vel, traj.kp(), traj.kd());
+ *     }
+ * }
+ * @endcode
+ *
+ * @author Chen Yu <chenyu@u.northwestern.edu>
+ * @copyright 2025 Chen Yu
+ * @license Apache-2.0
+ */
+
+#pragma once
+
+#ifndef CAPYBARISH_TRAJECTORY_H
+#define CAPYBARISH_TRAJECTORY_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "capybarish_frame.h"
+
+namespace cpy {
+
+// =============================================================================
+// Types
+// =============================================================================
+
+/**
+ * @brief Interpolation between consecutive trajectory points
+ */
+enum class Interpolation : uint8_t {
+    LINEAR,        ///< Piecewise linear position, piecewise constant velocity
+    CUBIC_HERMITE  ///< Cubic through both positions and velocities (C1 smooth)
+};
+
+/**
+ * @brief Where a sample came from
+ */
+enum class TrajectoryState : uint8_t {
+    EMPTY,          ///< No trajectory received yet (sample is not valid)
+    PLAYING,        ///< Inside the received horizon
+    EXTRAPOLATING,  ///< Past the last point, velocity ramping down
+    HOLDING         ///< Past the extrapolation limit, holding position
+};
+
+/**
+ * @brief One sampled setpoint
+ */
+struct TrajectorySample {
+    float pos = 0.0f;
+    float vel = 0.0f;
+    TrajectoryState state = TrajectoryState::EMPTY;
+};
+
+// =============================================================================
+// Trajectory Buffer
+// =============================================================================
+
+/**
+ * @brief Fixed-size playback buffer for timestamped setpoints
+ *
+ * All storage is inline, no heap. Newer chunks replace any buffered points
+ * at or after their first point, so the server can replan at every chunk.
+ *
+ * @tparam CAPACITY Maximum number of buffered points
+ */
+template<size_t CAPACITY = 32>
+class TrajectoryBuffer {
+    static_assert(CAPACITY >= 2, "TrajectoryBuffer needs room for one segment");
+
+public:
+    /**
+     * @brief Buffered point, time on the sender clock (seconds)
+     */
+    struct Point {
+        float t;
+        float pos;
+        float vel;
+    };
+
+    /**
+     * @brief Set playback parameters
+     *
+     * @param mode Interpolation between points
+     * @param playoutDelay Seconds playback runs behind the newest sender time
+     * @param maxExtrapolation Seconds to extrapolate past the last point
+     */
+    void configure(Interpolation mode, float playoutDelay = 0.03f,
+                   float maxExtrapolation = 0.1f) {
+        _mode = mode;
+        _playoutDelay = playoutDelay;
+        _maxExtrapolation = maxExtrapolation;
+    }
+
+    /**
+     * @brief Drop all points and the clock estimate
+     */
+    void reset() {
+        _head = 0;
+        _count = 0;
+        _synced = false;
+        _hasSeq = false;
+    }
+
+    /**
+     * @brief Add a generated TrajectoryChunk
+     *
+     * Chunks older than the last accepted one (by seq) are ignored, unless
+     * seq or the sender clock jumped back far enough to mean the sender
+     * restarted: then the buffer and clock estimate start over, resuming
+     * from the current setpoint.
+     *
+     * @param chunk Chunk with timestamp, count, t[], target[], target_vel[], kp, kd
+     * @param nowUs Local time of arrival (micros())
+     * @return true if the chunk was accepted
+     */
+    template<typename Chunk>
+    bool push(const Chunk& chunk, uint32_t nowUs) {
+        const uint32_t seq = static_cast<uint32_t>(chunk.seq);
+        TrajectorySample resume;
+        if (_hasSeq && _isRestart(seq, chunk.timestamp)) {
+            resume = sample(nowUs);
+            reset();
+            _restartCount++;
+        } else if (_hasSeq && !seqNewer(seq, _lastSeq)) {
+            return false;
+        }
+        _hasSeq = true;
+        _lastSeq = seq;
+        _lastTimestamp = chunk.timestamp;
+
+        sync(chunk.timestamp, nowUs);
+        _kp = chunk.kp;
+        _kd = chunk.kd;
+
+        // Resume from where the dropout left the setpoint, not the stale point
+        if (resume.state != TrajectoryState::EMPTY) {
+            addPoint(playbackTime(nowUs), resume.pos, resume.vel);
+        } else if (_count > 0) {
+            const TrajectorySample cur = sample(nowUs);
+            if (cur.state != TrajectoryState::PLAYING) {
+                _head = 0;
+                _count = 0;
+                addPoint(playbackTime(nowUs), cur.pos, cur.vel);
+            }
+        }
+
+        const size_t maxPoints = sizeof(chunk.t) / sizeof(chunk.t[0]);
+        const size_t n = chunk.count < 0 ? 0
+                       : static_cast<size_t>(chunk.count) > maxPoints ? maxPoints
+                       : static_cast<size_t>(chunk.count);
+        for (size_t i = 0; i < n; i++) {
+            addPoint(chunk.timestamp + chunk.t[i], chunk.target[i], chunk.target_vel[i],
+                     i == 0);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Update the sender-to-local clock offset
+     *
+     * Keeps the smallest local-minus-sender difference seen (the least
+     * delayed packet) and relaxes slowly upwards to follow clock drift.
+     *
+     * @param remoteTime Sender time stamped on the message (seconds)
+     * @param nowUs Local time of arrival (micros())
+     */
+    void sync(float remoteTime, uint32_t nowUs) {
+        if (!_synced) {
+            _synced = true;
+            _clockUs = 0;
+            _clockLastUs = nowUs;
+            _offsetUs = -_remoteUs(remoteTime);
+            return;
+        }
+        _advanceClock(nowUs);
+        const int64_t observed = _clockUs - _remoteUs(remoteTime);
+        if (observed < _offsetUs) {
+            _offsetUs = observed;
+        } else {
+            _offsetUs += static_cast<int64_t>(SYNC_GAIN * static_cast<float>(observed - _offsetUs));
+        }
+    }
+
+    /**
+     * @brief Append one point on the sender clock
+     *
+     * @param replace Drop buffered points at or after @p t first
+     * @return false if @p t does not follow the last buffered point
+     */
+    bool addPoint(float t, float pos, float vel, bool replace = false) {
+        if (replace) {
+            while (_count > 0 && _at(_count - 1).t >= t) {
+                _count--;
+            }
+        }
+        if (_count > 0 && t <= _at(_count - 1).t) {
+            return false;
+        }
+        if (_count == CAPACITY) {
+            _head = (_head + 1) % CAPACITY;
+            _count--;
+        }
+        _at(_count) = Point{t, pos, vel};
+        _count++;
+        return true;
+    }
+
+    /**
+     * @brief Sample the trajectory at local time @p nowUs
+     */
+    TrajectorySample sample(uint32_t nowUs) {
+        TrajectorySample out;
+        if (_count == 0 || !_synced) {
+            return out;
+        }
+
+        _advanceClock(nowUs);
+        const float t = playbackTime(nowUs);
+
+        // Keep the point just before t as the start of the current segment
+        while (_count >= 2 && _at(1).t <= t) {
+            _head = (_head + 1) % CAPACITY;
+            _count--;
+        }
+
+        const Point& p0 = _at(0);
+        if (t <= p0.t) {
+            out.pos = p0.pos;
+            out.state = TrajectoryState::PLAYING;
+            return out;
+        }
+
+        if (_count >= 2) {
+            _interpolate(p0, _at(1), t, out);
+            out.state = TrajectoryState::PLAYING;
+            return out;
+        }
+
+        // Dropout: ramp the velocity down to zero over maxExtrapolation
+        const float tau = t - p0.t;
+        const float h = _maxExtrapolation;
+        if (h <= 0.0f || tau >= h) {
+            out.pos = p0.pos + 0.5f * p0.vel * (h > 0.0f ? h : 0.0f);
+            out.state = TrajectoryState::HOLDING;
+        } else {
+            out.pos = p0.pos + p0.vel * (tau - 0.5f * tau * tau / h);
+            out.vel = p0.vel * (1.0f - tau / h);
+            out.state = TrajectoryState::EXTRAPOLATING;
+        }
+        return out;
+    }
+
+    /**
+     * @brief Current playback time on the sender clock (seconds)
+     */
+    float playbackTime(uint32_t nowUs) const {
+        return static_cast<float>(_localUs(nowUs) - _offsetUs) * 1e-6f - _playoutDelay;
+    }
+
+    /**
+     * @brief Seconds of trajectory left ahead of playback (negative on dropout)
+     */
+    float horizon(uint32_t nowUs) const {
+        if (_count == 0) return 0.0f;
+        return _at(_count - 1).t - playbackTime(nowUs);
+    }
+
+    size_t size() const { return _count; }
+    bool empty() const { return _count == 0; }
+    float kp() const { return _kp; }
+    float kd() const { return _kd; }
+
+    /**
+     * @brief Sender restarts detected by push()
+     */
+    uint32_t restartCount() const { return _restartCount; }
+
+private:
+    static constexpr float SYNC_GAIN = 0.01f;
+    static constexpr float RESTART_SECONDS = 1.0f;  ///< Sender clock jump back that means a restart
+
+    Point& _at(size_t i) { return _points[(_head + i) % CAPACITY]; }
+    const Point& _at(size_t i) const { return _points[(_head + i) % CAPACITY]; }
+
+    /**
+     * @brief Local time in µs since the clock estimate was seeded
+     *
+     * 64-bit so it neither wraps with micros() nor loses precision;
+     * @p nowUs may be up to ~35 minutes from the last sync() or sample().
+     */
+    int64_t _localUs(uint32_t nowUs) const {
+        return _clockUs + static_cast<int32_t>(nowUs - _clockLastUs);
+    }
+
+    void _advanceClock(uint32_t nowUs) {
+        _clockUs = _localUs(nowUs);
+        _clockLastUs = nowUs;
+    }
+
+    static int64_t _remoteUs(float remoteTime) {
+        return static_cast<int64_t>(static_cast<double>(remoteTime) * 1e6);
+    }
+
+    /**
+     * @brief Whether a chunk can only come from a restarted sender
+     *
+     * A reordered chunk is a little older in both seq and timestamp; a
+     * restart sends seq far back, or the sender clock far back, or seq
+     * back while the clock moves on.
+     */
+    bool _isRestart(uint32_t seq, float timestamp) const {
+        if (_lastTimestamp - timestamp > RESTART_SECONDS) return true;
+        if (seqNewer(seq, _lastSeq)) return false;
+        return _lastSeq - seq > SeqWindow::RESTART_GAP || timestamp > _lastTimestamp;
+    }
+
+    void _interpolate(const Point& p0, const Point& p1, float t, TrajectorySample& out) const {
+        const float h = p1.t - p0.t;
+        const float s = (t - p0.t) / h;
+
+        if (_mode == Interpolation::LINEAR) {
+            out.pos = p0.pos + s * (p1.pos - p0.pos);
+            out.vel = (p1.pos - p0.pos) / h;
+            return;
+        }
+
+        const float s2 = s * s;
+        const float s3 = s2 * s;
+        const float h00 = 2.0f * s3 - 3.0f * s2 + 1.0f;
+        const float h10 = s3 - 2.0f * s2 + s;
+        const float h01 = -2.0f * s3 + 3.0f * s2;
+        const float h11 = s3 - s2;
+        out.pos = h00 * p0.pos + h10 * h * p0.vel + h01 * p1.pos + h11 * h * p1.vel;
+
+        const float d00 = 6.0f * s2 - 6.0f * s;
+        const float d10 = 3.0f * s2 - 4.0f * s + 1.0f;
+        const float d11 = 3.0f * s2 - 2.0f * s;
+        out.vel = (d00 * (p0.pos - p1.pos)) / h + d10 * p0.vel + d11 * p1.vel;
+    }
+
+    Point _points[CAPACITY];
+    size_t _head = 0;
+    size_t _count = 0;
+
+    Interpolation _mode = Interpolation::CUBIC_HERMITE;
+    float _playoutDelay = 0.03f;
+    float _maxExtrapolation = 0.1f;
+
+    bool _synced = false;
+    int64_t _clockUs = 0;
+    uint32_t _clockLastUs = 0;
+    int64_t _offsetUs = 0;  ///< Local minus sender time
+
+    bool _hasSeq = false;
+    uint32_t _lastSeq = 0;
+    float _lastTimestamp = 0.0f;
+    uint32_t _restartCount = 0;
+
+    float _kp = 0.0f;
+    float _kd = 0.0f;
+};
+
+} // namespace cpy
+
+#endif // CAPYBARISH_TRAJECTORY_H
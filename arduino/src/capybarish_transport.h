@@ -0,0 +1,56 @@
+/**
+ * @file capybarish_transport.h
+ * @brief Pluggable datagram transport for pub/sub and UDPComm
+ *
+ * Publisher, Subscription, Node and UDPComm use WiFi UDP by default. Passing
+ * a Transport at construction sends the same datagrams over another link
+ * (e.g. SerialTransport over USB-CDC) without changing message code. A
+ * transport carries one datagram at a time, addressed by the UDP port the
+ * topic would otherwise use, so several topics share one link.
+ *
+ * @author Chen Yu <chenyu@u.northwestern.edu>
+ * @copyright 2025 Chen Yu
+ * @license Apache-2.0
+ */
+
+#pragma once
+
+#ifndef CAPYBARISH_TRANSPORT_H
+#define CAPYBARISH_TRANSPORT_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cpy {
+
+/**
+ * @brief Port-addressed datagram link
+ */
+class Transport {
+public:
+    virtual ~Transport() = default;
+
+    /**
+     * @brief Send one datagram to @p port on the other end
+     * @return true if the whole datagram was queued
+     */
+    virtual bool send(uint16_t port, const uint8_t* data, size_t len) = 0;
+
+    /**
+     * @brief Take the oldest pending datagram addressed to @p port (non-blocking)
+     *
+     * @param buffer Output buffer
+     * @param capacity Buffer size; longer datagrams are truncated
+     * @return Datagram length before truncation, 0 if none is pending
+     */
+    virtual size_t receive(uint16_t port, uint8_t* buffer, size_t capacity) = 0;
+
+    /**
+     * @brief Short name for log messages
+     */
+    virtual const char* name() const = 0;
+};
+
+} // namespace cpy
+
+#endif // CAPYBARISH_TRANSPORT_H
@@ -0,0 +1,413 @@
+/**
+ * @file capybarish_uwb.h
+ * @brief Batch UWB multilateration for SensorData.uwb
+ *
+ * Solves every module's position from its anchor ranges (UWBDistances) in
+ * one pass:
+ *
+ * 1. Linearised least squares. Subtracting a reference anchor's range
+ *    equation from the others gives A x = b, where A depends only on the
+ *    anchor geometry. The pseudo-inverse (A^T A)^-1 A^T is computed once per
+ *    set of usable anchors and cached, so for every module sharing that
+ *    geometry the solve is a small matrix-vector product.
+ * 2. Gauss-Newton refinement on the true range residuals (optional, a few
+ *    3x3 or 2x2 solves per module).
+ * 3. Outlier rejection: ranges that are invalid, out of range or far from the
+ *    prediction of the previous fix are dropped before solving. If the fit
+ *    residual is still large and there are spare anchors, each leave-one-out
+ *    subset is tried and the best one is kept.
+ *
+ * Planar mode solves x/y at a known height, which is what most setups
+ * need since anchors are usually mounted at similar heights (a 3D solve
+ * then needs non-coplanar anchors).
+ *
+ * @example
+ * @code
+ * cpy::UwbSolver<12> uwb;
+ * uwb.setAnchor(0, 0.0f, 0.0f, 2.0f);
+ * uwb.setAnchor(1, 6.0f, 0.0f, 2.0f);
+ * uwb.setAnchor(2, 6.0f, 4.0f, 2.0f);
+ * uwb.setAnchor(3, 0.0f, 4.0f, 2.0f);
+ * uwb.setPlanar(0.1f);   // Modules move on the floor
+ *
+ * // Each tick
+ * for (size_t i = 0; i < 12; i++) uwb.set(i, sensors[i].uwb);
+ * uwb.solve();
+ * multi_robot::Position3D p;
+ * if (uwb.get(3, p)) { ... }
+ * @endcode
+ *
+ * @author Chen Yu <chenyu@u.northwestern.edu>
+ * @copyright 2025 Chen Yu
+ * @license Apache-2.0
+ */
+
+#pragma once
+
+#ifndef CAPYBARISH_UWB_H
+#define CAPYBARISH_UWB_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace cpy {
+
+/**
+ * @brief Multilateration for N modules against ANCHORS fixed anchors
+ *
+ * @tparam N Number of modules
+ * @tparam ANCHORS Number of anchors (4 for UWBDistances)
+ */
+template<size_t N, size_t ANCHORS = 4>
+class UwbSolver {
+    static_assert(ANCHORS >= 3 && ANCHORS <= 8, "UwbSolver supports 3-8 anchors");
+
+public:
+    static constexpr size_t MASKS = size_t(1) << ANCHORS;
+
+    UwbSolver() {
+        for (size_t i = 0; i < N; i++) reset(i);
+    }
+
+    void setAnchor(size_t k, float x, float y, float z) {
+        _anchor[k][0] = x;
+        _anchor[k][1] = y;
+        _anchor[k][2] = z;
+        _invalidate();
+    }
+
+    /**
+     * @brief Solve x/y only, with every module at height @p z
+     */
+    void setPlanar(float z) {
+        _dims = 2;
+        _height = z;
+        _invalidate();
+    }
+
+    /**
+     * @brief Solve x/y/z (needs non-coplanar anchors)
+     */
+    void set3D() {
+        _dims = 3;
+        _invalidate();
+    }
+
+    /**
+     * @param maxRange Ranges above this (or <= 0, NaN) are discarded (m)
+     * @param maxResidual RMS range residual above which a fix is an outlier (m)
+     * @param gate Drop ranges further than this from the previous fix's
+     *             prediction (m, 0 = off)
+     * @param iterations Gauss-Newton iterations after the linear solve
+     */
+    void configure(float maxRange, float maxResidual, float gate, int iterations) {
+        _maxRange = maxRange;
+        _maxResidual = maxResidual;
+        _gate = gate;
+        _iterations = iterations;
+    }
+
+    /**
+     * @brief Forget module @p i's fix (disables gating until the next one)
+     */
+    void reset(size_t i) {
+        _valid[i] = false;
+        _hasFix[i] = false;
+        _used[i] = 0;
+        _residual[i] = 0.0f;
+        for (int c = 0; c < 3; c++) _pos[c][i] = 0.0f;
+    }
+
+    /**
+     * @brief Store the ranges of module @p i from a UWBDistances message
+     */
+    template<typename UwbT>
+    void set(size_t i, const UwbT& uwb) {
+        static_assert(ANCHORS == 4, "UWBDistances carries four ranges; use setRanges()");
+        const float d[4] = {uwb.d0, uwb.d1, uwb.d2, uwb.d3};
+        setRanges(i, d);
+    }
+
+    void setRanges(size_t i, const float* ranges) {
+        for (size_t k = 0; k < ANCHORS; k++) _range[k][i] = ranges[k];
+    }
+
+    /**
+     * @brief Solve every module from the stored ranges
+     */
+    void solve() {
+        for (size_t i = 0; i < N; i++) {
+            _solveModule(i);
+        }
+    }
+
+    /**
+     * @brief Position of module @p i (x, y, z members)
+     * @return false if the last solve produced no fix
+     */
+    template<typename PosT>
+    bool get(size_t i, PosT& out) const {
+        out.x = _pos[0][i];
+        out.y = _pos[1][i];
+        out.z = _pos[2][i];
+        return _valid[i];
+    }
+
+    bool valid(size_t i) const { return _valid[i]; }
+    float residual(size_t i) const { return _residual[i]; }
+
+    /**
+     * @brief Bit k set if anchor k contributed to module @p i's last fix
+     */
+    uint8_t anchorsUsed(size_t i) const { return _used[i]; }
+
+    uint32_t getRejectedCount() const { return _rejected; }
+
+private:
+    static constexpr size_t ROWS = ANCHORS - 1;
+
+    /**
+     * @brief Cached solution operator for one set of anchors
+     */
+    struct Factor {
+        bool built = false;
+        bool usable = false;
+        uint8_t ref = 0;
+        uint8_t rows = 0;
+        uint8_t row[ROWS];   ///< Anchor index of each row
+        float c[ROWS];       ///< Geometry part of b
+        float P[3][ROWS];    ///< (A^T A)^-1 A^T
+    };
+
+    static int _popcount(uint32_t m) {
+        int n = 0;
+        for (; m; m &= m - 1) n++;
+        return n;
+    }
+
+    void _invalidate() {
+        for (size_t m = 0; m < MASKS; m++) _factor[m].built = false;
+    }
+
+    const Factor& _getFactor(uint32_t mask) {
+        Factor& f = _factor[mask];
+        if (!f.built) _build(mask, f);
+        return f;
+    }
+
+    void _build(uint32_t mask, Factor& f) {
+        f.built = true;
+        f.usable = false;
+        if (_popcount(mask) < _dims + 1) return;
+
+        f.rows = 0;
+        f.ref = 0;
+        while (!(mask & (1u << f.ref))) f.ref++;
+        const float* r = _anchor[f.ref];
+        const float r2 = r[0] * r[0] + r[1] * r[1] + r[2] * r[2];
+
+        // Rows of A: 2 (a_k - a_ref); in planar mode z moves to the right side
+        float A[ROWS][3];
+        for (uint8_t k = 0; k < ANCHORS; k++) {
+            if (k == f.ref || !(mask & (1u << k))) continue;
+            const float* a = _anchor[k];
+            const uint8_t j = f.rows++;
+            f.row[j] = k;
+            f.c[j] = a[0] * a[0] + a[1] * a[1] + a[2] * a[2] - r2;
+            for (int c = 0; c < 3; c++) A[j][c] = 2.0f * (a[c] - r[c]);
+            if (_dims == 2) f.c[j] -= A[j][2] * _height;
+        }
+
+        float M[3][3];
+        for (int p = 0; p < _dims; p++) {
+            for (int q = 0; q < _dims; q++) {
+                M[p][q] = 0.0f;
+                for (uint8_t j = 0; j < f.rows; j++) M[p][q] += A[j][p] * A[j][q];
+            }
+        }
+        float Minv[3][3];
+        if (!_invert(M, Minv, _dims)) return;
+
+        for (int p = 0; p < 3; p++) {
+            for (uint8_t j = 0; j < f.rows; j++) {
+                float s = 0.0f;
+                for (int q = 0; q < _dims && p < _dims; q++) s += Minv[p][q] * A[j][q];
+                f.P[p][j] = s;
+            }
+        }
+        f.usable = true;
+    }
+
+    // Inverse of a symmetric 2x2 or 3x3 matrix; false if (nearly) singular
+    static bool _invert(const float (&M)[3][3], float (&out)[3][3], int dims) {
+        float scale = 0.0f;
+        for (int p = 0; p < dims; p++) scale += M[p][p];
+        if (!(scale > 0.0f)) return false;
+
+        if (dims == 2) {
+            const float det = M[0][0] * M[1][1] - M[0][1] * M[1][0];
+            if (!(fabsf(det) > 1e-6f * scale * scale)) return false;
+            out[0][0] = M[1][1] / det;
+            out[0][1] = out[1][0] = -M[0][1] / det;
+            out[1][1] = M[0][0] / det;
+            return true;
+        }
+
+        const float c00 = M[1][1] * M[2][2] - M[1][2] * M[2][1];
+        const float c01 = M[1][2] * M[2][0] - M[1][0] * M[2][2];
+        const float c02 = M[1][0] * M[2][1] - M[1][1] * M[2][0];
+        const float det = M[0][0] * c00 + M[0][1] * c01 + M[0][2] * c02;
+        if (!(fabsf(det) > 1e-6f * scale * scale * scale)) return false;
+        const float inv = 1.0f / det;
+        out[0][0] = c00 * inv;
+        out[0][1] = out[1][0] = c01 * inv;
+        out[0][2] = out[2][0] = c02 * inv;
+        out[1][1] = (M[0][0] * M[2][2] - M[0][2] * M[2][0]) * inv;
+        out[1][2] = out[2][1] = (M[0][2] * M[1][0] - M[0][0] * M[1][2]) * inv;
+        out[2][2] = (M[0][0] * M[1][1] - M[0][1] * M[1][0]) * inv;
+        return true;
+    }
+
+    /**
+     * @brief Solve with the anchors in @p mask; returns the RMS residual
+     * (INFINITY if the subset cannot be solved)
+     */
+    float _solveMask(size_t i, uint32_t mask, float (&x)[3]) {
+        const Factor& f = _getFactor(mask);
+        if (!f.usable) return INFINITY;
+
+        const float dr = _range[f.ref][i];
+        float b[ROWS];
+        for (uint8_t j = 0; j < f.rows; j++) {
+            const float d = _range[f.row[j]][i];
+            b[j] = f.c[j] - d * d + dr * dr;
+        }
+        for (int p = 0; p < 3; p++) {
+            float s = 0.0f;
+            for (uint8_t j = 0; j < f.rows; j++) s += f.P[p][j] * b[j];
+            x[p] = s;
+        }
+        if (_dims == 2) x[2] = _height;
+
+        for (int it = 0; it < _iterations; it++) {
+            _gaussNewton(i, mask, x);
+        }
+        return _rms(i, mask, x);
+    }
+
+    void _gaussNewton(size_t i, uint32_t mask, float (&x)[3]) {
+        float H[3][3] = {};
+        float g[3] = {};
+        for (size_t k = 0; k < ANCHORS; k++) {
+            if (!(mask & (1u << k))) continue;
+            float u[3];
+            float dist = 0.0f;
+            for (int c = 0; c < 3; c++) {
+                u[c] = x[c] - _anchor[k][c];
+                dist += u[c] * u[c];
+            }
+            dist = sqrtf(dist);
+            if (dist < 1e-3f) return;
+            const float r = dist - _range[k][i];
+            for (int p = 0; p < _dims; p++) {
+                const float jp = u[p] / dist;
+                g[p] += jp * r;
+                for (int q = 0; q < _dims; q++) H[p][q] += jp * u[q] / dist;
+            }
+        }
+        float Hinv[3][3];
+        if (!_invert(H, Hinv, _dims)) return;
+        for (int p = 0; p < _dims; p++) {
+            float step = 0.0f;
+            for (int q = 0; q < _dims; q++) step += Hinv[p][q] * g[q];
+            x[p] -= step;
+        }
+    }
+
+    float _rms(size_t i, uint32_t mask, const float (&x)[3]) const {
+        float sum = 0.0f;
+        int n = 0;
+        for (size_t k = 0; k < ANCHORS; k++) {
+            if (!(mask & (1u << k))) continue;
+            const float r = _predicted(k, x) - _range[k][i];
+            sum += r * r;
+            n++;
+        }
+        return sqrtf(sum / n);
+    }
+
+    float _predicted(size_t k, const float (&x)[3]) const {
+        const float dx = x[0] - _anchor[k][0];
+        const float dy = x[1] - _anchor[k][1];
+        const float dz = x[2] - _anchor[k][2];
+        return sqrtf(dx * dx + dy * dy + dz * dz);
+    }
+
+    void _solveModule(size_t i) {
+        const float prev[3] = {_pos[0][i], _pos[1][i], _pos[2][i]};
+
+        uint32_t mask = 0;
+        for (size_t k = 0; k < ANCHORS; k++) {
+            const float d = _range[k][i];
+            if (!(d > 0.0f && d <= _maxRange)) continue;
+            if (_gate > 0.0f && _hasFix[i] && fabsf(_predicted(k, prev) - d) > _gate) {
+                _rejected++;
+                continue;
+            }
+            mask |= 1u << k;
+        }
+
+        float x[3];
+        float rms = _solveMask(i, mask, x);
+
+        // Spare anchors: try dropping each one and keep the best fit
+        if (!(rms <= _maxResidual) && _popcount(mask) > _dims + 1) {
+            uint32_t bestMask = mask;
+            for (size_t k = 0; k < ANCHORS; k++) {
+                if (!(mask & (1u << k))) continue;
+                float y[3];
+                const float r = _solveMask(i, mask & ~(1u << k), y);
+                if (r < rms) {
+                    rms = r;
+                    bestMask = mask & ~(1u << k);
+                    for (int c = 0; c < 3; c++) x[c] = y[c];
+                }
+            }
+            if (bestMask != mask) _rejected++;
+            mask = bestMask;
+        }
+
+        _residual[i] = rms;
+        _valid[i] = rms <= _maxResidual;
+        if (_valid[i]) {
+            _used[i] = static_cast<uint8_t>(mask);
+            _hasFix[i] = true;
+            for (int c = 0; c < 3; c++) _pos[c][i] = x[c];
+        } else {
+            _used[i] = 0;
+            _hasFix[i] = false;  // Re-acquire without gating next time
+        }
+    }
+
+    float _anchor[ANCHORS][3] = {};
+    int _dims = 2;
+    float _height = 0.0f;
+    float _maxRange = 50.0f;
+    float _maxResidual = 0.3f;
+    float _gate = 0.0f;
+    int _iterations = 2;
+    Factor _factor[MASKS];
+
+    float _range[ANCHORS][N];
+    float _pos[3][N];
+    float _residual[N];
+    uint8_t _used[N];
+    bool _valid[N];
+    bool _hasFix[N];
+    uint32_t _rejected = 0;
+};
+
+} // namespace cpy
+
+#endif // CAPYBARISH_UWB_H
@@ -82,6 +82,8 @@ from .pubsub import (
     QoSReliabilityPolicy,
     QoSHistoryPolicy,
     QoSDurabilityPolicy,
+    TrafficClass,
+    RateLimitAction,
     # Executors
     SingleThreadedExecutor,
     MultiThreadedExecutor,
@@ -99,6 +101,7 @@ from .pubsub import (
     # Pre-defined QoS profiles
     qos_profile_sensor_data,
     qos_profile_default,
+    qos_profile_control,
     qos_profile_services,
     qos_profile_parameters,
     # Logging
@@ -106,6 +109,9 @@ from .pubsub import (
     LogLevel,
 )
 
+# Serial / USB-CDC transport for tethered modules
+from .serial_transport import SerialTransport
+
 __all__ = [
     # Legacy API
     "Interface",
@@ -142,6 +148,8 @@ __all__ = [
     "QoSReliabilityPolicy",
     "QoSHistoryPolicy",
     "QoSDurabilityPolicy",
+    "TrafficClass",
+    "RateLimitAction",
     "SingleThreadedExecutor",
     "MultiThreadedExecutor",
     "Rate",
@@ -155,9 +163,11 @@ __all__ = [
     "get_node_names",
     "qos_profile_sensor_data",
     "qos_profile_default",
+    "qos_profile_control",
     "qos_profile_services",
     "qos_profile_parameters",
     "NodeLogger",
     "LogLevel",
+    "SerialTransport",
     "__version__",
 ]
@@ -0,0 +1,279 @@
+"""
+Per-topic message authentication, compatible with ``capybarish_auth.h``.
+
+A topic with a key appends a 20-byte trailer to every datagram::
+
+    payload | u32 sender | u64 sequence | u64 SipHash-2-4 tag   (little-endian)
+
+The tag covers the payload, the sender ID and the sequence number under a
+key derived from the shared 128-bit key and the topic name. Receivers drop
+datagrams with a wrong tag and, through :class:`ReplayGuard`, any sequence
+number a sender has already used or that is older than its 64-number
+window. Each sender of a topic has its own window, up to ``MAX_SENDERS``.
+
+Sequence numbers must keep growing across restarts under one key and
+sender, so :class:`MessageAuth` starts at the current wall-clock time in
+microseconds unless told otherwise. The default sender ID comes from the
+MAC address; a second publisher of the same topic on one host needs its
+own.
+
+A receiver that restarts would take the first authentic datagram at face
+value, so a recorded stream could be replayed to it. With a state file
+(``Subscription.set_auth(key, state_path=...)``) it checkpoints each
+sender's highest sequence number on first contact and every
+``CHECKPOINT_INTERVAL`` datagrams, as the ESP32 does in NVS, and rejects
+everything up to the checkpoints after a restart. Datagrams sent after the
+last checkpoint can still be replayed until the live stream overtakes
+them; without a state file, so can any recording.
+
+Example Usage:
+    ```python
+    key = parse_key("000102030405060708090a0b0c0d0e0f")
+    cmd_pub = node.create_publisher(MotorCommand, '/motor/command')
+    cmd_pub.add_remote_endpoint(module_ip, 6666)
+    cmd_pub.set_auth(key)
+    ```
+
+Copyright 2025 Chen Yu <chenyu@u.northwestern.edu>
+Licensed under the Apache License, Version 2.0
+"""
+
+import hmac
+import json
+import os
+import struct
+import time
+import uuid
+from enum import Enum
+from typing import Dict, Optional, Tuple, Union
+
+TRAILER_SIZE = 20
+WINDOW = 64
+MAX_SENDERS = 4
+CHECKPOINT_INTERVAL = 1 << 16
+
+_MASK = 0xFFFFFFFFFFFFFFFF
+_TRAILER = struct.Struct("<IQQ")
+
+
+def _rotl(x: int, b: int) -> int:
+    return ((x << b) | (x >> (64 - b))) & _MASK
+
+
+def _sip_round(v0: int, v1: int, v2: int, v3: int) -> Tuple[int, int, int, int]:
+    v0 = (v0 + v1) & _MASK
+    v1 = _rotl(v1, 13) ^ v0
+    v0 = _rotl(v0, 32)
+    v2 = (v2 + v3) & _MASK
+    v3 = _rotl(v3, 16) ^ v2
+    v0 = (v0 + v3) & _MASK
+    v3 = _rotl(v3, 21) ^ v0
+    v2 = (v2 + v1) & _MASK
+    v1 = _rotl(v1, 17) ^ v2
+    v2 = _rotl(v2, 32)
+    return v0, v1, v2, v3
+
+
+def siphash24(k0: int, k1: int, data: bytes) -> int:
+    """SipHash-2-4 of ``data`` under the key (k0, k1)."""
+    v0 = k0 ^ 0x736F6D6570736575
+    v1 = k1 ^ 0x646F72616E646F6D
+    v2 = k0 ^ 0x6C7967656E657261
+    v3 = k1 ^ 0x7465646279746573
+
+    end = len(data) & ~7
+    words = [m for (m,) in struct.iter_unpack("<Q", data[:end])]
+    words.append((len(data) & 0xFF) << 56 | int.from_bytes(data[end:], "little"))
+    for m in words:
+        v3 ^= m
+        v0, v1, v2, v3 = _sip_round(v0, v1, v2, v3)
+        v0, v1, v2, v3 = _sip_round(v0, v1, v2, v3)
+        v0 ^= m
+
+    v2 ^= 0xFF
+    for _ in range(4):
+        v0, v1, v2, v3 = _sip_round(v0, v1, v2, v3)
+    return v0 ^ v1 ^ v2 ^ v3
+
+
+def parse_key(key: Union[str, bytes]) -> bytes:
+    """Accept a 16-byte key or its 32 hex digits."""
+    if isinstance(key, str):
+        key = bytes.fromhex(key)
+    if len(key) != 16:
+        raise ValueError("authentication keys are 16 bytes (32 hex digits)")
+    return bytes(key)
+
+
+class ReplayWindow:
+    """Anti-replay window over 64-bit sequence numbers (never moves back)."""
+
+    def __init__(self):
+        self._top: Optional[int] = None
+        self._bits = 0
+
+    def accept(self, seq: int) -> bool:
+        """True the first time ``seq`` is seen within the window."""
+        if self._top is None or seq > self._top:
+            ahead = WINDOW if self._top is None else seq - self._top
+            self._bits = ((self._bits << ahead) if ahead < WINDOW else 0) & _MASK | 1
+            self._top = seq
+            return True
+        behind = self._top - seq
+        if behind >= WINDOW or self._bits & (1 << behind):
+            return False
+        self._bits |= 1 << behind
+        return True
+
+    def reset(self) -> None:
+        self._top = None
+        self._bits = 0
+
+
+class ReplayResult(Enum):
+    """Outcome of :meth:`ReplayGuard.accept` (``cpy::ReplayResult``)."""
+
+    ACCEPTED = 0
+    REPLAYED = 1          # Seen before, behind the window or at or below the checkpoint
+    TOO_MANY_SENDERS = 2  # The sender table is full
+
+
+class _Sender:
+    def __init__(self, floor: Optional[int] = None):
+        self.window = ReplayWindow()
+        self.floor = floor              # Restored checkpoint
+        self.checkpoint = floor
+        self.heard = False              # Accepted a datagram since restore()
+
+
+class ReplayGuard:
+    """One topic's replay windows, one per sender, with checkpoints
+    (``cpy::ReplayGuard``).
+
+    A full table takes a new sender only in place of a restored one that
+    has not been heard from.
+    """
+
+    def __init__(self):
+        self._senders: Dict[int, _Sender] = {}
+        self.checkpoint_due = False
+
+    def accept(self, sender: int, seq: int) -> ReplayResult:
+        entry = self._senders.get(sender)
+        if entry is None:
+            if len(self._senders) >= MAX_SENDERS:
+                unheard = next((s for s, e in self._senders.items() if not e.heard), None)
+                if unheard is None:
+                    return ReplayResult.TOO_MANY_SENDERS
+                del self._senders[unheard]
+            entry = self._senders[sender] = _Sender()
+        if entry.floor is not None and seq <= entry.floor:
+            return ReplayResult.REPLAYED
+        if not entry.window.accept(seq):
+            return ReplayResult.REPLAYED
+
+        entry.heard = True
+        if entry.checkpoint is None or seq - entry.checkpoint >= CHECKPOINT_INTERVAL:
+            entry.checkpoint = seq
+            self.checkpoint_due = True
+        return ReplayResult.ACCEPTED
+
+    def reset(self) -> None:
+        """Forget every sender, floors included."""
+        self._senders.clear()
+        self.checkpoint_due = False
+
+    def checkpoints(self) -> Dict[int, int]:
+        """Sender -> checkpoint, clearing :attr:`checkpoint_due`."""
+        self.checkpoint_due = False
+        return {sender: entry.checkpoint for sender, entry in self._senders.items()
+                if entry.checkpoint is not None}
+
+    def restore(self, checkpoints: Dict[int, int]) -> None:
+        """Take saved checkpoints as floors (forgetting every sender first)."""
+        self.reset()
+        for sender, seq in list(checkpoints.items())[:MAX_SENDERS]:
+            self._senders[int(sender)] = _Sender(int(seq))
+
+    def load(self, path: str) -> bool:
+        """Restore checkpoints from a JSON file (False if there are none)."""
+        try:
+            with open(path) as f:
+                self.restore({int(s): int(q) for s, q in json.load(f).items()})
+            return True
+        except (OSError, ValueError, TypeError, AttributeError):
+            return False
+
+    def save(self, path: str) -> None:
+        """Write the checkpoints to a JSON file (atomically)."""
+        temp = path + ".tmp"
+        with open(temp, "w") as f:
+            json.dump({str(s): q for s, q in self.checkpoints().items()}, f)
+        os.replace(temp, path)
+
+
+def default_sender_id() -> int:
+    """Sender ID from the MAC address, folded to 32 bits like ``authSenderId()``."""
+    mac = uuid.getnode()
+    return (mac ^ (mac >> 32)) & 0xFFFFFFFF
+
+
+class MessageAuth:
+    """Seals and opens one topic's datagrams.
+
+    Args:
+        key: Shared key (16 bytes or 32 hex digits).
+        topic: Topic name; the tag key is derived from it.
+        first_seq: First sequence number for sealing (default: wall-clock
+            microseconds, which keeps growing across restarts).
+        sender: Sender ID for sealing (default: :func:`default_sender_id`).
+    """
+
+    def __init__(self, key: Union[str, bytes], topic: str, first_seq: Optional[int] = None,
+                 sender: Optional[int] = None):
+        k0, k1 = struct.unpack("<QQ", parse_key(key))
+        name = topic.encode()
+        self._k0 = siphash24(k0, k1, name)
+        self._k1 = siphash24(k1, k0, name)
+        self.seq = time.time_ns() // 1000 if first_seq is None else first_seq
+        self.sender = default_sender_id() if sender is None else sender
+        self.guard = ReplayGuard()
+
+    def seal(self, payload: bytes) -> bytes:
+        """Append the sender, the next sequence number and the tag."""
+        data = payload + struct.pack("<IQ", self.sender, self.seq)
+        self.seq = (self.seq + 1) & _MASK
+        return data + struct.pack("<Q", siphash24(self._k0, self._k1, data))
+
+    def open(self, data: bytes) -> Optional[Tuple[bytes, int, int]]:
+        """Check a sealed datagram's tag.
+
+        Returns:
+            (payload, sender, sequence number), or None if the tag is wrong.
+        """
+        if len(data) <= TRAILER_SIZE:
+            return None
+        payload = len(data) - TRAILER_SIZE
+        sender, seq, tag = _TRAILER.unpack_from(data, payload)
+        expected = siphash24(self._k0, self._k1, data[:-8])
+        if not hmac.compare_digest(struct.pack("<Q", tag), struct.pack("<Q", expected)):
+            return None
+        return data[:payload], sender, seq
+
+    def accept(self, data: bytes) -> Tuple[Optional[bytes], bool]:
+        """Open a datagram and check it against the sender's replay window.
+
+        Returns:
+            (payload or None, whether it was accepted as authentic). A
+            valid tag with a payload of None means the datagram was
+            replayed; a sender beyond ``MAX_SENDERS`` counts as not
+            authentic.
+        """
+        opened = self.open(data)
+        if opened is None:
+            return None, False
+        payload, sender, seq = opened
+        result = self.guard.accept(sender, seq)
+        if result == ReplayResult.TOO_MANY_SENDERS:
+            return None, False
+        return (payload if result == ReplayResult.ACCEPTED else None), True
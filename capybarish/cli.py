@@ -5,6 +5,7 @@ Provides CLI commands for:
 - Code generation from .cpy schema files
 - Arduino library installation
 - Project scaffolding
+- Trace conversion (on-device Node traces to Perfetto/Chrome JSON)
 
 Copyright 2025 Chen Yu <chenyu@u.northwestern.edu>
 
@@ -17,6 +18,8 @@ import sys
 from pathlib import Path
 from typing import List, Optional
 
+from . import trace
+
 
 def get_arduino_library_path() -> Path:
     """Get the path to the bundled Arduino library."""
@@ -215,6 +218,11 @@ message Status:
     return 0
 
 
+def cmd_trace(args: argparse.Namespace) -> int:
+    """Convert Node trace dumps to Chrome/Perfetto JSON."""
+    return trace.run(args)
+
+
 def create_parser() -> argparse.ArgumentParser:
     """Create the argument parser."""
     parser = argparse.ArgumentParser(
@@ -318,6 +326,14 @@ def create_parser() -> argparse.ArgumentParser:
         help="Overwrite existing file",
     )
     
+    # trace command
+    trace_parser = subparsers.add_parser(
+        "trace",
+        help="Convert Node trace dumps to Perfetto JSON",
+        description="Convert binary dumps from cpy::TraceRecorder to Chrome/Perfetto trace JSON",
+    )
+    trace.add_arguments(trace_parser)
+    
     return parser
 
 
@@ -338,6 +354,8 @@ def main(argv: Optional[List[str]] = None) -> int:
         return cmd_validate(args)
     elif args.command == "init":
         return cmd_init(args)
+    elif args.command == "trace":
+        return cmd_trace(args)
     else:
         parser.print_help()
         return 1
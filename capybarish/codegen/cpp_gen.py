@@ -59,6 +59,26 @@ class CppGenerator:
         FieldType.CHAR: "'\\0'",
     }
     
+    # Canonical wire type names used in field layout tables
+    LAYOUT_TYPES = {
+        FieldType.INT8: "int8",
+        FieldType.INT16: "int16",
+        FieldType.INT32: "int32",
+        FieldType.INT64: "int64",
+        FieldType.UINT8: "uint8",
+        FieldType.UINT16: "uint16",
+        FieldType.UINT32: "uint32",
+        FieldType.UINT64: "uint64",
+        FieldType.FLOAT32: "float32",
+        FieldType.FLOAT64: "float64",
+        FieldType.FLOAT: "float32",
+        FieldType.DOUBLE: "float64",
+        FieldType.INT: "int32",
+        FieldType.BOOL: "bool",
+        FieldType.BYTE: "uint8",
+        FieldType.CHAR: "int8",
+    }
+    
     def __init__(self, schema: SchemaDef):
         self.schema = schema
         self.parser = SchemaParser()
@@ -95,6 +115,10 @@ class CppGenerator:
             lines.append(f"struct {msg_name};")
         lines.append("")
         
+        # Layout table entry type (read by cpy::SchemaSet for generic access)
+        lines.extend(self._generate_layout_struct())
+        lines.append("")
+        
         # Generate structs
         for msg_name in msg_order:
             msg = self.schema.messages[msg_name]
@@ -194,6 +218,10 @@ class CppGenerator:
         lines.append(f"    static constexpr size_t SIZE = {msg_size};")
         lines.append("")
         
+        # Runtime field layout
+        lines.extend(self._generate_field_table(msg))
+        lines.append("")
+        
         # Serialize method
         lines.extend(self._generate_serialize_method(msg))
         lines.append("")
@@ -234,6 +262,52 @@ class CppGenerator:
         
         return lines
     
+    def _generate_layout_struct(self) -> List[str]:
+        """Generate the field layout entry type shared by all messages."""
+        return [
+            "/** One primitive field in a message's flattened wire layout */",
+            "struct FieldLayout {",
+            "    const char* name;  ///< Dotted path for nested fields, e.g. \"pose.position.x\"",
+            "    const char* type;  ///< Wire type: int8..uint64, float32, float64, bool",
+            "    uint16_t offset;   ///< Byte offset in the serialized message",
+            "    uint16_t count;    ///< Array length (1 for scalars)",
+            "};",
+        ]
+    
+    def _flatten_fields(self, msg: MessageDef, prefix: str = "", base: int = 0) -> List[tuple]:
+        """Flatten a message into (name, type, offset, count) primitive entries."""
+        entries = []
+        offset = base
+        for f in msg.fields:
+            name = prefix + f.name
+            if f.is_nested:
+                nested = self.schema.messages[f.type_name]
+                size = nested.get_size(self.schema.messages)
+                if f.is_array:
+                    for i in range(f.array_size):
+                        entries.extend(self._flatten_fields(nested, f"{name}[{i}].", offset + i * size))
+                else:
+                    entries.extend(self._flatten_fields(nested, name + ".", offset))
+                offset += size * (f.array_size or 1)
+            else:
+                _, _, _, size = f.get_type_info()
+                entries.append((name, self.LAYOUT_TYPES[f.field_type], offset, f.array_size or 1))
+                offset += size * (f.array_size or 1)
+        return entries
+    
+    def _generate_field_table(self, msg: MessageDef) -> List[str]:
+        """Generate the NAME and flattened FIELDS layout table."""
+        entries = self._flatten_fields(msg)
+        lines = [
+            f'    static constexpr const char* NAME = "{msg.name}";',
+            f"    static constexpr size_t FIELD_COUNT = {len(entries)};",
+            "    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {",
+        ]
+        for name, type_name, offset, count in entries:
+            lines.append(f'        {{"{name}", "{type_name}", {offset}, {count}}},')
+        lines.append("    };")
+        return lines
+    
     def _generate_serialize_method(self, msg: MessageDef) -> List[str]:
         """Generate serialize method."""
         return [
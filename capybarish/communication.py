@@ -148,6 +148,60 @@ class UDPProtocol(CommunicationProtocol):
         self.is_setup = False
 
 
+class SerialProtocol(CommunicationProtocol):
+    """Serial / USB-CDC protocol implementation (COBS framing with CRC).
+
+    Speaks the same datagrams as UDPProtocol to a module built with
+    ``cpy::SerialTransport``. Received data is reported as coming from
+    (device, port), and replies go to the port in the address.
+    """
+
+    def __init__(self):
+        self.transport = None
+        self.channel = None
+        self.is_setup = False
+
+    def setup(self, device: str = "/dev/ttyACM0", port: int = 6666,
+              baudrate: int = 921600, **kwargs) -> None:
+        """Open the serial device and listen on ``port``."""
+        from .serial_transport import SerialTransport
+
+        self.transport = SerialTransport(device, baudrate=baudrate)
+        self.channel = self.transport.open_channel(port)
+        self.is_setup = True
+
+    def send_data(self, data: bytes, address: Tuple[str, int]) -> bool:
+        """Send data over the serial line."""
+        if not self.is_setup or not self.channel:
+            return False
+
+        try:
+            self.channel.sendto(data, address)
+            return True
+        except Exception as e:
+            print(f"[ERROR] Failed to send data to {address}: {e}")
+            return False
+
+    def receive_data(self, timeout: float = 0.0) -> Optional[Tuple[bytes, Tuple[str, int]]]:
+        """Receive data from the serial line with timeout."""
+        if not self.is_setup or not self.channel:
+            return None
+
+        self.channel.settimeout(timeout if timeout > 0 else 0.0)
+        try:
+            return self.channel.recvfrom(1024)
+        except (BlockingIOError, socket.timeout):
+            return None
+
+    def close(self) -> None:
+        """Close the serial device."""
+        if self.transport:
+            self.transport.close()
+            self.transport = None
+            self.channel = None
+        self.is_setup = False
+
+
 class CommunicationManager:
     """
     Modern communication manager for robot middleware.
@@ -6,6 +6,7 @@ functionality for various motor controllers and drivers.
 
 Available Devices:
     - CybergearErrorDecoder: Xiaomi Cybergear motor controller
+    - CybergearBus: Cybergear CAN codec over Linux SocketCAN
 
 Example:
     ```python
@@ -16,9 +17,10 @@ Example:
     ```
 """
 
-from .cybergear import CybergearErrorDecoder
+from .cybergear import CybergearBus, CybergearErrorDecoder
 
 __all__ = [
+    "CybergearBus",
     "CybergearErrorDecoder",
 ]
 
@@ -1,8 +1,19 @@
 """
-Xiaomi Cybergear Motor Error Decoder.
+Xiaomi Cybergear Motor Support.
 
 This module provides error decoding specific to the Xiaomi Cybergear
-motor controller, translating error codes into human-readable messages.
+motor controller, translating error codes into human-readable messages,
+plus the Cybergear CAN codec and a Linux SocketCAN bus for driving motors
+directly from a host. The codec mirrors ``capybarish_cybergear.h`` on the
+ESP32 side bit for bit.
+
+CAN Frame Reference:
+    29-bit extended ID: type (bits 28-24) | data area 2 (bits 23-8) | target (bits 7-0)
+    Motion (type 1): torque in the ID, pos/vel/kp/kd as big-endian uint16
+    Feedback (type 2): motor ID, fault bits and mode in the ID;
+        pos/vel/torque/temperature as big-endian uint16
+    Parameter read/write (types 17/18): little-endian index and value
+    Fault report (type 21): little-endian fault and warning words
 
 Error Code Reference:
     Motor Error (st.error_state & 0x3F):
@@ -30,6 +41,12 @@ Copyright 2025 Chen Yu <chenyu@u.northwestern.edu>
 Licensed under the Apache License, Version 2.0
 """
 
+import math
+import socket
+import struct
+from dataclasses import dataclass
+from typing import Iterable, List, Optional, Sequence, Tuple
+
 from ..error_decoder import BaseErrorDecoder
 
 
@@ -151,3 +168,319 @@ class CybergearErrorDecoder(BaseErrorDecoder):
             }
         }
 
+
+# =============================================================================
+# CAN Codec
+# =============================================================================
+
+TYPE_GET_ID = 0
+TYPE_MOTION = 1
+TYPE_FEEDBACK = 2
+TYPE_ENABLE = 3
+TYPE_STOP = 4
+TYPE_SET_ZERO = 6
+TYPE_SET_CAN_ID = 7
+TYPE_PARAM_READ = 17
+TYPE_PARAM_WRITE = 18
+TYPE_FAULT = 21
+
+PARAM_RUN_MODE = 0x7005
+PARAM_IQ_REF = 0x7006
+PARAM_SPD_REF = 0x700A
+PARAM_LIMIT_TORQUE = 0x700B
+PARAM_CUR_KP = 0x7010
+PARAM_CUR_KI = 0x7011
+PARAM_CUR_FILT = 0x7014
+PARAM_LOC_REF = 0x7016
+PARAM_LIMIT_SPD = 0x7017
+PARAM_LIMIT_CUR = 0x7018
+PARAM_MECH_POS = 0x7019
+PARAM_IQF = 0x701A
+PARAM_MECH_VEL = 0x701B
+PARAM_VBUS = 0x701C
+PARAM_LOC_KP = 0x701E
+PARAM_SPD_KP = 0x701F
+PARAM_SPD_KI = 0x7020
+
+MODE_MOTION = 0
+MODE_POSITION = 1
+MODE_SPEED = 2
+MODE_CURRENT = 3
+
+DEFAULT_HOST_ID = 0xFD
+
+P_MIN, P_MAX = -4 * math.pi, 4 * math.pi
+V_MIN, V_MAX = -30.0, 30.0
+T_MIN, T_MAX = -12.0, 12.0
+KP_MAX = 500.0
+KD_MAX = 5.0
+
+_BE4 = struct.Struct('>4H')
+_PARAM = struct.Struct('<HHf')
+_FAULT = struct.Struct('<II')
+
+# (id, data) as carried on the bus; data is always 8 bytes
+CanFrame = Tuple[int, bytes]
+
+
+def _to_uint16(x: float, lo: float, hi: float) -> int:
+    scaled = (x - lo) * (65535.0 / (hi - lo))
+    if not scaled > 0.0:  # Also catches NaN
+        return 0
+    return 65535 if scaled >= 65535.0 else int(scaled + 0.5)
+
+
+def _from_uint16(v: int, lo: float, hi: float) -> float:
+    return lo + v * ((hi - lo) / 65535.0)
+
+
+def make_id(frame_type: int, area2: int, target: int) -> int:
+    """Build a 29-bit Cybergear CAN ID."""
+    return ((frame_type & 0x1F) << 24) | ((area2 & 0xFFFF) << 8) | (target & 0xFF)
+
+
+def frame_type(can_id: int) -> int:
+    """Communication type of a CAN ID."""
+    return (can_id >> 24) & 0x1F
+
+
+def source_id(can_id: int) -> int:
+    """Motor that sent a feedback, parameter or fault frame."""
+    return (can_id >> 8) & 0xFF
+
+
+def encode_motion(
+    motor_id: int,
+    pos: float = 0.0,
+    vel: float = 0.0,
+    kp: float = 0.0,
+    kd: float = 0.0,
+    torque: float = 0.0,
+) -> CanFrame:
+    """Encode an MIT-mode setpoint: tau = kp (pos - q) + kd (vel - dq) + torque."""
+    return (
+        make_id(TYPE_MOTION, _to_uint16(torque, T_MIN, T_MAX), motor_id),
+        _BE4.pack(
+            _to_uint16(pos, P_MIN, P_MAX),
+            _to_uint16(vel, V_MIN, V_MAX),
+            _to_uint16(kp, 0.0, KP_MAX),
+            _to_uint16(kd, 0.0, KD_MAX),
+        ),
+    )
+
+
+def encode_motion_batch(
+    motor_ids: Sequence[int],
+    commands: Iterable[Sequence[float]],
+) -> List[CanFrame]:
+    """Encode one MIT-mode frame per motor.
+
+    Args:
+        motor_ids: CAN IDs of the motors
+        commands: (pos, vel, kp, kd, torque) per motor
+    """
+    return [encode_motion(mid, *cmd) for mid, cmd in zip(motor_ids, commands)]
+
+
+def encode_enable(motor_id: int, host_id: int = DEFAULT_HOST_ID) -> CanFrame:
+    return make_id(TYPE_ENABLE, host_id, motor_id), bytes(8)
+
+
+def encode_stop(motor_id: int, clear_fault: bool = False, host_id: int = DEFAULT_HOST_ID) -> CanFrame:
+    return make_id(TYPE_STOP, host_id, motor_id), bytes([int(clear_fault)]) + bytes(7)
+
+
+def encode_set_zero(motor_id: int, host_id: int = DEFAULT_HOST_ID) -> CanFrame:
+    return make_id(TYPE_SET_ZERO, host_id, motor_id), b'\x01' + bytes(7)
+
+
+def encode_param_read(motor_id: int, index: int, host_id: int = DEFAULT_HOST_ID) -> CanFrame:
+    return make_id(TYPE_PARAM_READ, host_id, motor_id), _PARAM.pack(index, 0, 0.0)
+
+
+def encode_param_write(
+    motor_id: int,
+    index: int,
+    value: float,
+    host_id: int = DEFAULT_HOST_ID,
+) -> CanFrame:
+    """Write a parameter; PARAM_RUN_MODE takes an integer mode, others a float."""
+    if index == PARAM_RUN_MODE:
+        data = struct.pack('<HHB3x', index, 0, int(value))
+    else:
+        data = _PARAM.pack(index, 0, value)
+    return make_id(TYPE_PARAM_WRITE, host_id, motor_id), data
+
+
+@dataclass
+class CybergearFeedback:
+    """Decoded type-2 feedback frame."""
+
+    motor_id: int
+    faults: int       # Same bits as CybergearErrorDecoder.MOTOR_ERROR_BITS
+    mode: int         # 0 reset, 1 calibration, 2 running
+    pos: float
+    vel: float
+    torque: float
+    temperature: float
+
+
+def parse_feedback(can_id: int, data: bytes) -> Optional[CybergearFeedback]:
+    """Decode a feedback frame, or return None for other frame types."""
+    if frame_type(can_id) != TYPE_FEEDBACK or len(data) < 8:
+        return None
+    pos, vel, torque, temp = _BE4.unpack_from(data)
+    return CybergearFeedback(
+        motor_id=source_id(can_id),
+        faults=(can_id >> 16) & 0x3F,
+        mode=(can_id >> 22) & 0x03,
+        pos=_from_uint16(pos, P_MIN, P_MAX),
+        vel=_from_uint16(vel, V_MIN, V_MAX),
+        torque=_from_uint16(torque, T_MIN, T_MAX),
+        temperature=temp * 0.1,
+    )
+
+
+def parse_param(can_id: int, data: bytes) -> Optional[Tuple[int, float]]:
+    """Decode a parameter read response as (index, value)."""
+    if frame_type(can_id) != TYPE_PARAM_READ or len(data) < 8:
+        return None
+    index, _, value = _PARAM.unpack_from(data)
+    return index, value
+
+
+def apply_feedback(can_id: int, data: bytes, motor) -> bool:
+    """Update a MotorData message from any motor -> host frame.
+
+    Feedback frames set pos/large_pos/vel/torque/temperature/motor_error/
+    motor_mode; PARAM_VBUS and PARAM_IQF responses set voltage/current;
+    fault frames set driver_error (temperature warning in bit 24).
+
+    Returns:
+        True if ``motor`` changed
+    """
+    kind = frame_type(can_id)
+    if kind == TYPE_FEEDBACK:
+        fb = parse_feedback(can_id, data)
+        if fb is None:
+            return False
+        motor.pos = motor.large_pos = fb.pos
+        motor.vel = fb.vel
+        motor.torque = fb.torque
+        motor.temperature = int(fb.temperature)
+        motor.motor_error = fb.faults
+        motor.motor_mode = fb.mode
+        return True
+    if kind == TYPE_PARAM_READ:
+        param = parse_param(can_id, data)
+        if param is None or param[0] not in (PARAM_VBUS, PARAM_IQF):
+            return False
+        if param[0] == PARAM_VBUS:
+            motor.voltage = param[1]
+        else:
+            motor.current = param[1]
+        return True
+    if kind == TYPE_FAULT and len(data) >= 8:
+        faults, warnings = _FAULT.unpack_from(data)
+        motor.driver_error = (faults & 0x00FFFFFF) | ((warnings & 1) << 24)
+        return True
+    return False
+
+
+# =============================================================================
+# SocketCAN Bus
+# =============================================================================
+
+_CAN_FRAME = struct.Struct('=IB3x8s')
+_CAN_EFF_FLAG = 0x80000000
+_CAN_RTR_FLAG = 0x40000000
+_CAN_ERR_FLAG = 0x20000000
+_CAN_EFF_MASK = 0x1FFFFFFF
+
+
+class CybergearBus:
+    """Raw SocketCAN socket for Cybergear frames (Linux only).
+
+    Works on real adapters (can0) and on a virtual bus for testing::
+
+        sudo modprobe vcan
+        sudo ip link add dev vcan0 type vcan && sudo ip link set up vcan0
+
+    Example:
+        ```python
+        from capybarish.devices import cybergear as cg
+
+        with cg.CybergearBus('can0') as bus:
+            bus.send(cg.encode_enable(1))
+            bus.send_batch(cg.encode_motion_batch([1, 2], [(0.0, 0.0, 20.0, 1.0, 0.0)] * 2))
+            frame = bus.receive(timeout=0.01)
+        ```
+    """
+
+    def __init__(self, interface: str, host_id: Optional[int] = DEFAULT_HOST_ID):
+        """Open a raw CAN socket on ``interface``.
+
+        Args:
+            interface: CAN interface name (e.g. 'can0', 'vcan0')
+            host_id: Only receive frames addressed to this ID (None: all)
+        """
+        if not hasattr(socket, 'AF_CAN'):
+            raise OSError("SocketCAN is only available on Linux")
+        self._sock = socket.socket(socket.AF_CAN, socket.SOCK_RAW, socket.CAN_RAW)
+        try:
+            if host_id is not None:
+                self._sock.setsockopt(
+                    socket.SOL_CAN_RAW,
+                    socket.CAN_RAW_FILTER,
+                    struct.pack('=II', _CAN_EFF_FLAG | host_id, _CAN_EFF_FLAG | _CAN_RTR_FLAG | 0xFF),
+                )
+            self._sock.bind((interface,))
+        except OSError:
+            self._sock.close()
+            raise
+        self._interface = interface
+
+    @property
+    def interface(self) -> str:
+        return self._interface
+
+    def fileno(self) -> int:
+        return self._sock.fileno()
+
+    def send(self, frame: CanFrame) -> None:
+        """Send one extended frame."""
+        can_id, data = frame
+        self._sock.send(_CAN_FRAME.pack((can_id & _CAN_EFF_MASK) | _CAN_EFF_FLAG, len(data), data))
+
+    def send_batch(self, frames: Iterable[CanFrame]) -> None:
+        """Send several frames (one control tick for a group of motors)."""
+        for frame in frames:
+            self.send(frame)
+
+    def receive(self, timeout: Optional[float] = 0.0) -> Optional[CanFrame]:
+        """Receive one extended data frame.
+
+        Args:
+            timeout: Seconds to wait (0 polls, None blocks)
+
+        Returns:
+            (id, data), or None on timeout
+        """
+        self._sock.settimeout(timeout)
+        try:
+            while True:
+                raw = self._sock.recv(_CAN_FRAME.size)
+                can_id, dlc, data = _CAN_FRAME.unpack(raw)
+                if can_id & _CAN_EFF_FLAG and not can_id & (_CAN_RTR_FLAG | _CAN_ERR_FLAG):
+                    return can_id & _CAN_EFF_MASK, data[:min(dlc, 8)]
+        except (socket.timeout, BlockingIOError):
+            return None
+
+    def close(self) -> None:
+        self._sock.close()
+
+    def __enter__(self) -> 'CybergearBus':
+        return self
+
+    def __exit__(self, *args) -> None:
+        self.close()
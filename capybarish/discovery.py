@@ -0,0 +1,435 @@
+"""
+Multicast discovery of capybarish nodes.
+
+Python side of ``cpy::Discovery`` (``capybarish_discovery.h``). Instead of
+hard-coding module IPs, or waiting for each module's first feedback packet,
+a :class:`Discovery` attached to a :class:`~capybarish.pubsub.Node`
+announces the node's topics on a multicast group and listens for the
+announcements of other nodes:
+
+- each topic is advertised with its role, port, message size and a layout
+  fingerprint (:func:`fingerprint`, equal to ``messageFingerprint<T>()``)
+- a node that starts asks everyone to announce back, so peers are known
+  after one round trip
+- each UDP publisher of this node gets one remote subscriber of its topic
+  as its target, unless the fingerprints disagree. As in C++, the first
+  subscriber heard keeps the target while it goes on announcing; another
+  takes over once it has been silent for ``STALE_PERIODS`` announce
+  periods, and a new port at the target's address is followed at once
+- with ``fan_out=True`` a publisher sends to every compatible subscriber
+  instead (e.g. a host commanding many modules). This is Python only: a
+  C++ publisher has a single destination
+- targets are kept in a JSON cache file, rewritten only when one changes,
+  and applied at the next start, before any reply arrives. Only topics
+  this node publishes are cached
+
+Example Usage:
+    ```python
+    import capybarish as cpy
+    from capybarish.discovery import Discovery
+    from capybarish.generated import MotorCommand, SensorData
+
+    node = cpy.Node('server')
+    cmd_pub = node.create_publisher(MotorCommand, '/motor/command')
+    feedback = node.create_subscription(SensorData, '/motor/feedback', on_feedback)
+    feedback.bind_network(port=6666)
+
+    discovery = Discovery(node, cache_path='~/.capybarish/peers.json', fan_out=True)
+    discovery.start()  # cmd_pub reaches each module as soon as it announces
+    ```
+
+Copyright 2025 Chen Yu <chenyu@u.northwestern.edu>
+Licensed under the Apache License, Version 2.0
+"""
+
+import json
+import os
+import socket
+import struct
+import threading
+import time
+from dataclasses import dataclass, field
+from typing import Any, Dict, List, Optional, Tuple
+
+DEFAULT_GROUP = "239.255.0.99"
+DEFAULT_PORT = 7400
+
+DISCOVERY_MAGIC = b"CPYD"
+DISCOVERY_VERSION = 1
+REPLY_REQUESTED = 0x01
+
+ROLE_PUBLISHER = 1
+ROLE_SUBSCRIBER = 2
+
+STALE_PERIODS = 3  # Announce periods a target may stay silent before it is replaced
+
+_HEADER = struct.Struct("<4sBBBBI24s16s")
+_TOPIC = struct.Struct("<32sIHHB3x")
+
+
+def fnv1a32(data: bytes, value: int = 2166136261) -> int:
+    """32-bit FNV-1a, continuing from ``value``."""
+    for byte in data:
+        value = ((value ^ byte) * 16777619) & 0xFFFFFFFF
+    return value
+
+
+def fingerprint(msg_type: Any) -> int:
+    """Layout fingerprint of a generated message class.
+
+    Hashes ``"Name:"`` plus the class's struct format, as
+    ``cpy::messageFingerprint<T>()`` does from the generated FIELDS table.
+
+    Returns:
+        The fingerprint, or 0 ("unknown") for classes without ``_FORMAT``.
+    """
+    fmt = getattr(msg_type, "_FORMAT", None)
+    if not fmt:
+        return 0
+    value = fnv1a32(f"{msg_type.__name__}:{fmt.lstrip('<>=!@')}".encode())
+    return value or 1
+
+
+@dataclass
+class TopicAnnouncement:
+    """One topic of an announcement."""
+    topic: str
+    role: int
+    port: int
+    msg_size: int = 0
+    fingerprint: int = 0
+
+
+@dataclass
+class Announcement:
+    """A decoded discovery packet."""
+    node: str
+    address: str
+    node_id: int
+    topics: List[TopicAnnouncement] = field(default_factory=list)
+    reply_requested: bool = False
+
+
+def node_id(name: str, address: str) -> int:
+    """Identifier a node puts in its announcements (matches the C++ side)."""
+    return fnv1a32(address.encode(), fnv1a32(name.encode()))
+
+
+def encode_announcement(announcement: Announcement) -> bytes:
+    """Serialize an announcement (names are truncated to fit)."""
+    data = _HEADER.pack(
+        DISCOVERY_MAGIC, DISCOVERY_VERSION,
+        REPLY_REQUESTED if announcement.reply_requested else 0,
+        len(announcement.topics), 0, announcement.node_id,
+        announcement.node.encode()[:23], announcement.address.encode()[:15],
+    )
+    for topic in announcement.topics:
+        data += _TOPIC.pack(topic.topic.encode()[:31], topic.fingerprint,
+                            topic.port, topic.msg_size, topic.role)
+    return data
+
+
+def decode_announcement(data: bytes) -> Optional[Announcement]:
+    """Parse a discovery packet; None if it is not a valid one."""
+    if len(data) < _HEADER.size:
+        return None
+    magic, version, flags, count, _, nid, node, address = _HEADER.unpack_from(data)
+    if magic != DISCOVERY_MAGIC or version != DISCOVERY_VERSION:
+        return None
+    if len(data) < _HEADER.size + count * _TOPIC.size:
+        return None
+
+    def text(raw: bytes) -> str:
+        return raw.split(b"\0", 1)[0].decode("utf-8", "replace")
+
+    announcement = Announcement(text(node), text(address), nid,
+                                reply_requested=bool(flags & REPLY_REQUESTED))
+    for i in range(count):
+        topic, fp, port, size, role = _TOPIC.unpack_from(data, _HEADER.size + i * _TOPIC.size)
+        announcement.topics.append(TopicAnnouncement(text(topic), role, port, size, fp))
+    return announcement
+
+
+def local_address(group: str = DEFAULT_GROUP) -> str:
+    """IPv4 address of the interface that routes to ``group``."""
+    with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as sock:
+        try:
+            sock.connect((group, DEFAULT_PORT))  # No packet is sent
+            return sock.getsockname()[0]
+        except OSError:
+            return "127.0.0.1"
+
+
+class Discovery:
+    """Announces a Node's topics and connects its publishers to peers.
+
+    Only UDP topics take part: publishers and subscriptions on a serial
+    transport are point-to-point already.
+    """
+
+    def __init__(
+        self,
+        node: Any,
+        group: str = DEFAULT_GROUP,
+        port: int = DEFAULT_PORT,
+        announce_period: float = 2.0,
+        address: Optional[str] = None,
+        cache_path: Optional[str] = None,
+        fan_out: bool = False,
+    ):
+        """
+        Args:
+            node: The :class:`~capybarish.pubsub.Node` to advertise.
+            group: Multicast group shared by all nodes.
+            port: Discovery port.
+            announce_period: Seconds between periodic announcements.
+            address: Advertised IPv4 address (default: the routing interface's).
+            cache_path: JSON file of publisher targets, or None.
+            fan_out: Send to every compatible subscriber of a topic rather
+                than to a single target.
+        """
+        self._node = node
+        self._group = group
+        self._port = port
+        self._announce_period = announce_period
+        self._address = address or local_address(group)
+        self._cache_path = os.path.expanduser(cache_path) if cache_path else None
+        self._node_id = node_id(node.name, self._address)
+        self._fan_out = fan_out
+
+        # (topic, address) -> {"port": ..., "fingerprint": ...}; without
+        # fan-out, at most one entry per topic
+        self._endpoints: Dict[Tuple[str, str], Dict[str, int]] = {}
+        self._heard: Dict[Tuple[str, str], float] = {}  # Last announcement (monotonic)
+        self._peers: Dict[int, Tuple[str, str]] = {}
+        self._lock = threading.Lock()
+        self._sock: Optional[socket.socket] = None
+        self._thread: Optional[threading.Thread] = None
+        self._running = False
+
+        self.announce_count = 0
+        self.receive_count = 0
+        self.mismatch_count = 0
+
+    @property
+    def peers(self) -> Dict[int, Tuple[str, str]]:
+        """Node id -> (name, address) of every node heard from."""
+        with self._lock:
+            return dict(self._peers)
+
+    @property
+    def endpoints(self) -> Dict[Tuple[str, str], Dict[str, int]]:
+        """Publisher targets, keyed by (topic, address)."""
+        with self._lock:
+            return dict(self._endpoints)
+
+    def start(self) -> None:
+        """Apply cached endpoints, join the group and announce."""
+        self.load_cache()
+
+        sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM, socket.IPPROTO_UDP)
+        sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        if hasattr(socket, "SO_REUSEPORT"):
+            sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEPORT, 1)
+        sock.bind(("", self._port))
+        membership = socket.inet_aton(self._group) + socket.inet_aton("0.0.0.0")
+        sock.setsockopt(socket.IPPROTO_IP, socket.IP_ADD_MEMBERSHIP, membership)
+        sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_LOOP, 1)
+        sock.settimeout(0.1)
+        self._sock = sock
+
+        self._running = True
+        self._thread = threading.Thread(target=self._loop, daemon=True)
+        self._thread.start()
+        self.announce(request_reply=True)
+
+    def load_cache(self) -> int:
+        """Apply the cached targets; they get ``STALE_PERIODS`` to confirm.
+
+        Returns:
+            Targets applied.
+        """
+        now = time.monotonic()
+        with self._lock:
+            for (topic, address), info in self._load_cache().items():
+                if not self._fan_out and any(key[0] == topic for key in self._endpoints):
+                    continue
+                self._endpoints[(topic, address)] = info
+                self._heard[(topic, address)] = now
+                self._apply(topic, address, info)
+            return len(self._endpoints)
+
+    def stop(self) -> None:
+        """Stop listening and announcing."""
+        self._running = False
+        if self._thread:
+            self._thread.join(timeout=1.0)
+            self._thread = None
+        if self._sock:
+            self._sock.close()
+            self._sock = None
+
+    def announcement(self, request_reply: bool = False) -> Announcement:
+        """The node's current topics as an announcement."""
+        topics = []
+        for pub in self._node._publishers:
+            if pub._transport is not None:
+                continue
+            port = pub._remote_endpoints[0][1] if pub._remote_endpoints else 0
+            topics.append(TopicAnnouncement(pub.topic_name, ROLE_PUBLISHER, port,
+                                            getattr(pub.msg_type, "_SIZE", 0),
+                                            fingerprint(pub.msg_type)))
+        for sub in self._node._subscriptions:
+            if sub._transport is not None or sub._udp_socket is None:
+                continue  # Not reachable over the network
+            topics.append(TopicAnnouncement(sub.topic_name, ROLE_SUBSCRIBER,
+                                            sub._udp_socket.getsockname()[1],
+                                            getattr(sub.msg_type, "_SIZE", 0),
+                                            fingerprint(sub.msg_type)))
+        return Announcement(self._node.name, self._address, self._node_id, topics, request_reply)
+
+    def announce(self, request_reply: bool = False) -> bool:
+        """Send the node's topics to the group now."""
+        if self._sock is None:
+            return False
+        try:
+            self._sock.sendto(encode_announcement(self.announcement(request_reply)),
+                              (self._group, self._port))
+        except OSError:
+            return False
+        self.announce_count += 1
+        return True
+
+    def handle_packet(self, data: bytes) -> Optional[Announcement]:
+        """Process one received packet.
+
+        Returns:
+            The announcement if it came from another node, else None.
+        """
+        announcement = decode_announcement(data)
+        if announcement is None or announcement.node_id == self._node_id:
+            return None
+        self.receive_count += 1
+
+        changed = False
+        with self._lock:
+            if announcement.node_id not in self._peers:
+                self._node.get_logger().info(
+                    f"Discovered {announcement.node} at {announcement.address}")
+            self._peers[announcement.node_id] = (announcement.node, announcement.address)
+            for topic in announcement.topics:
+                if topic.role != ROLE_SUBSCRIBER or not announcement.address:
+                    continue
+                info = {"port": topic.port, "fingerprint": topic.fingerprint}
+                changed |= self._offer(topic.topic, announcement.address, info)
+
+        if changed:
+            self._save_cache()
+        if announcement.reply_requested:
+            self.announce()
+        return announcement
+
+    def _offer(self, topic: str, address: str, info: Dict[str, int]) -> bool:
+        """Make a subscriber a target of ``topic`` if a publisher wants it
+        and (without fan-out) the current target is the same node or has
+        gone silent.
+
+        Returns:
+            True if the targets changed (and the cache must be saved).
+        """
+        if not self._wants(topic, address, info):
+            return False
+        key = (topic, address)
+        now = time.monotonic()
+        if not self._fan_out:
+            current = next((k for k in self._endpoints if k[0] == topic), None)
+            if current is not None and current != key:
+                if now - self._heard[current] < self._announce_period * STALE_PERIODS:
+                    return False
+                self._drop(current)
+        self._heard[key] = now
+        if self._endpoints.get(key) == info:
+            return False
+        self._endpoints[key] = info
+        self._apply(topic, address, info)
+        return True
+
+    def _publishers(self, topic: str) -> List[Any]:
+        return [pub for pub in self._node._publishers
+                if pub.topic_name == topic and pub._transport is None]
+
+    def _wants(self, topic: str, address: str, info: Dict[str, int]) -> bool:
+        """Whether a UDP publisher sends ``topic`` with a compatible layout."""
+        wanted = False
+        for pub in self._publishers(topic):
+            ours = fingerprint(pub.msg_type)
+            if ours and info["fingerprint"] and ours != info["fingerprint"]:
+                self.mismatch_count += 1
+                self._node.get_logger().warn(
+                    f"{topic}: {address} expects another message layout "
+                    f"({info['fingerprint']:08x} != {ours:08x})")
+                continue
+            wanted = True
+        return wanted
+
+    def _drop(self, key: Tuple[str, str]) -> None:
+        """Stop sending ``topic`` to a target that went silent."""
+        topic, address = key
+        info = self._endpoints.pop(key)
+        self._heard.pop(key, None)
+        for pub in self._publishers(topic):
+            if (address, info["port"]) in pub._remote_endpoints:
+                pub._remote_endpoints.remove((address, info["port"]))
+
+    def _apply(self, topic: str, address: str, info: Dict[str, int]) -> None:
+        """Add the endpoint to this node's publishers of ``topic``."""
+        for pub in self._publishers(topic):
+            ours = fingerprint(pub.msg_type)
+            if ours and info["fingerprint"] and ours != info["fingerprint"]:
+                continue
+            # A subscriber that moved ports replaces its old endpoint
+            stale = [ep for ep in pub._remote_endpoints if ep[0] == address and ep[1] != info["port"]]
+            for ep in stale:
+                pub._remote_endpoints.remove(ep)
+            if (address, info["port"]) not in pub._remote_endpoints:
+                pub.add_remote_endpoint(address, info["port"])
+
+    def _loop(self) -> None:
+        next_announce = time.monotonic() + self._announce_period
+        while self._running:
+            try:
+                data, _ = self._sock.recvfrom(2048)
+                self.handle_packet(data)
+            except socket.timeout:
+                pass
+            except OSError:
+                break
+            if time.monotonic() >= next_announce:
+                self.announce()
+                next_announce += self._announce_period
+
+    def _load_cache(self) -> Dict[Tuple[str, str], Dict[str, int]]:
+        if not self._cache_path or not os.path.exists(self._cache_path):
+            return {}
+        try:
+            with open(self._cache_path) as f:
+                entries = json.load(f).get("endpoints", [])
+            return {(e["topic"], e["address"]): {"port": int(e["port"]),
+                                                 "fingerprint": int(e.get("fingerprint", 0))}
+                    for e in entries}
+        except (OSError, ValueError, KeyError, TypeError, AttributeError):
+            return {}
+
+    def _save_cache(self) -> None:
+        if not self._cache_path:
+            return
+        with self._lock:
+            entries = [{"topic": topic, "address": address, **info}
+                       for (topic, address), info in self._endpoints.items()]
+        directory = os.path.dirname(self._cache_path)
+        if directory:
+            os.makedirs(directory, exist_ok=True)
+        temp = self._cache_path + ".tmp"
+        with open(temp, "w") as f:
+            json.dump({"version": DISCOVERY_VERSION, "endpoints": entries}, f, indent=2)
+        os.replace(temp, self._cache_path)
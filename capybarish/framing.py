@@ -0,0 +1,329 @@
+"""
+Sequenced framing and forward error correction for pub/sub topics.
+
+Plain topics put the serialized message on the wire as-is. When a topic needs
+per-message metadata, each datagram is prefixed with a 12-byte frame header
+carrying a sequence number and the publisher's stream ID. This module mirrors
+``capybarish_frame.h`` on the ESP32 side byte for byte.
+
+FEC is a single XOR parity packet per group of K messages: any one lost
+message in a group is rebuilt as soon as the parity arrives, without waiting
+a round trip for a retransmission. Overhead is 1/K extra packets.
+
+Redundant (multi-path) publishing sends every frame over several paths;
+``SeqWindow`` drops the later copies in O(1) by sequence number, and
+``StreamDecoder`` combines it with FEC, keeping one window per publisher
+stream so a port can hear from several publishers.
+
+Example Usage:
+    ```python
+    from capybarish.framing import FecEncoder, StreamDecoder
+
+    encoder = FecEncoder(group_size=5)
+    for frame in encoder.encode(cmd.serialize()):
+        sock.sendto(frame, addr)
+
+    decoder = StreamDecoder()
+    for payload in decoder.decode(datagram, MotorCommand._SIZE):
+        handle(MotorCommand.deserialize(payload))
+    ```
+
+Copyright 2025 Chen Yu <chenyu@u.northwestern.edu>
+Licensed under the Apache License, Version 2.0
+"""
+
+import os
+import struct
+from collections import OrderedDict
+from dataclasses import dataclass
+from typing import List, Optional, Tuple
+
+FRAME_MAGIC = 0xCB
+FRAME_PARITY = 0x01
+MAX_FEC_GROUP = 16
+MAX_STREAMS = 8  # Publisher streams a decoder tracks at once
+
+_HEADER = struct.Struct('<BBBBII')
+HEADER_SIZE = _HEADER.size
+
+
+@dataclass
+class FrameHeader:
+    """Header prepended to framed datagrams."""
+    flags: int = 0
+    fec_k: int = 0       # FEC group size, 0 if the stream has no parity
+    fec_index: int = 0   # Position in the FEC group (K for parity)
+    seq: int = 0         # Message sequence number (group base for parity)
+    stream: int = 0      # Chosen at random by each publisher when it starts
+
+    @property
+    def is_parity(self) -> bool:
+        return bool(self.flags & FRAME_PARITY)
+
+    def pack(self) -> bytes:
+        return _HEADER.pack(FRAME_MAGIC, self.flags, self.fec_k, self.fec_index,
+                            self.seq & 0xFFFFFFFF, self.stream & 0xFFFFFFFF)
+
+    @classmethod
+    def unpack(cls, data: bytes) -> 'FrameHeader':
+        _, flags, fec_k, fec_index, seq, stream = _HEADER.unpack_from(data)
+        return cls(flags, fec_k, fec_index, seq, stream)
+
+
+def is_frame(data: bytes, payload_size: int) -> bool:
+    """Check whether a datagram is a frame carrying ``payload_size`` bytes."""
+    return len(data) == HEADER_SIZE + payload_size and data[0] == FRAME_MAGIC
+
+
+def seq_newer(a: int, b: int) -> bool:
+    """Wrap-aware "a is newer than b" for 32-bit sequence numbers."""
+    diff = (a - b) & 0xFFFFFFFF
+    return diff != 0 and diff < 0x80000000
+
+
+def _xor_into(acc: bytearray, data: bytes) -> None:
+    # int.from_bytes keeps the XOR in C instead of a per-byte Python loop
+    n = len(acc)
+    value = int.from_bytes(acc, 'little') ^ int.from_bytes(data[:n], 'little')
+    acc[:] = value.to_bytes(n, 'little')
+
+
+class SeqWindow:
+    """Sliding-window duplicate filter over sequence numbers.
+
+    Tracks the newest sequence number and a 64-bit bitmap of the ones before
+    it. A sequence number far behind the window is taken as a publisher restart.
+    One window covers one publisher's stream.
+    """
+
+    WINDOW = 64
+    RESTART_GAP = 1024
+
+    def __init__(self):
+        self._active = False
+        self._top = 0
+        self._bits = 0
+
+    def accept(self, seq: int) -> bool:
+        """Mark ``seq`` as seen; True the first time, False for duplicates/stale."""
+        if not self._active:
+            self._active, self._top, self._bits = True, seq, 1
+            return True
+
+        ahead = (seq - self._top) & 0xFFFFFFFF
+        if ahead and ahead < 0x80000000:
+            self._bits = ((self._bits << ahead) | 1) & 0xFFFFFFFFFFFFFFFF
+            self._top = seq
+            return True
+
+        behind = (self._top - seq) & 0xFFFFFFFF
+        if behind >= self.WINDOW:
+            if behind > self.RESTART_GAP:
+                self._active, self._top, self._bits = True, seq, 1
+                return True
+            return False
+
+        bit = 1 << behind
+        if self._bits & bit:
+            return False
+        self._bits |= bit
+        return True
+
+    def reset(self) -> None:
+        self._active = False
+
+    @property
+    def newest(self) -> int:
+        """Newest sequence number accepted so far."""
+        return self._top
+
+
+def random_stream_id() -> int:
+    """A fresh 32-bit stream ID for a publisher."""
+    return int.from_bytes(os.urandom(4), 'little')
+
+
+class FecEncoder:
+    """Frames payloads and emits one XOR parity frame per group."""
+
+    def __init__(self, group_size: int = 0, stream: Optional[int] = None):
+        """
+        Args:
+            group_size: Send one parity frame every ``group_size`` payloads
+                (0 or 1 = frames without parity).
+            stream: Stream ID put in every frame (None = random).
+        """
+        self._k = min(max(group_size, 0), MAX_FEC_GROUP)
+        self.stream = random_stream_id() if stream is None else stream
+        self._seq = 0
+        self._count = 0
+        self._parity: Optional[bytearray] = None
+
+    @property
+    def enabled(self) -> bool:
+        return self._k > 1
+
+    @property
+    def group_size(self) -> int:
+        return self._k
+
+    def encode(self, payload: bytes) -> List[bytes]:
+        """Frame one payload.
+
+        Returns:
+            The data frame, followed by the parity frame when the group completes.
+        """
+        if not self.enabled:
+            header = FrameHeader(seq=self._seq, stream=self.stream)
+            self._seq = (self._seq + 1) & 0xFFFFFFFF
+            return [header.pack() + payload]
+
+        if self._parity is None or len(self._parity) != len(payload):
+            self._parity = bytearray(len(payload))
+            self._count = 0
+
+        header = FrameHeader(fec_k=self._k, fec_index=self._count, seq=self._seq,
+                             stream=self.stream)
+        self._seq = (self._seq + 1) & 0xFFFFFFFF
+        frames = [header.pack() + payload]
+        _xor_into(self._parity, payload)
+        self._count += 1
+
+        if self._count == self._k:
+            parity = FrameHeader(
+                flags=FRAME_PARITY,
+                fec_k=self._k,
+                fec_index=self._k,
+                seq=(header.seq - (self._k - 1)) & 0xFFFFFFFF,
+                stream=self.stream,
+            )
+            frames.append(parity.pack() + bytes(self._parity))
+            self._parity = bytearray(len(payload))
+            self._count = 0
+        return frames
+
+
+class FecDecoder:
+    """Rebuilds a single lost message per FEC group.
+
+    Keeps one running XOR of every payload seen in the newest group. Once the
+    parity and K-1 data payloads have arrived, that XOR is the missing message.
+    Data frames from older groups are passed through without recovery;
+    duplicates across groups are left to :class:`SeqWindow`. One decoder
+    follows one publisher's stream.
+
+    Parity is sent last, so a rebuilt message is usually older than data
+    frames of its group that were already delivered.
+    """
+
+    def __init__(self):
+        self._active = False
+        self._k = 0
+        self._base = 0
+        self._mask = 0
+        self._acc = bytearray()
+        self.recovered_count = 0
+        self.recovered_seq = 0
+
+    def push(self, header: FrameHeader, payload: bytes) -> List[bytes]:
+        """Feed one frame, returning the payloads that became deliverable."""
+        k = header.fec_k
+        parity = header.is_parity
+        if k < 2 or k > MAX_FEC_GROUP or (not parity and header.fec_index >= k):
+            return [] if parity else [payload]
+
+        base = header.seq if parity else (header.seq - header.fec_index) & 0xFFFFFFFF
+        if not self._active or k != self._k or seq_newer(base, self._base):
+            self._active = True
+            self._k = k
+            self._base = base
+            self._mask = 0
+            self._acc = bytearray(len(payload))
+        elif base != self._base:
+            # Older group, already recovered or given up. Its data frames
+            # still count (reordered, e.g. by another path); SeqWindow
+            # drops the ones already delivered.
+            return [] if parity else [payload]
+
+        bit = 1 << (k if parity else header.fec_index)
+        if self._mask & bit:
+            return []  # Duplicate (or already rebuilt)
+        self._mask |= bit
+        _xor_into(self._acc, payload)
+
+        out = [] if parity else [payload]
+        missing = ~self._mask & ((1 << k) - 1)
+        if self._mask & (1 << k) and missing and not missing & (missing - 1):
+            out.append(bytes(self._acc))
+            self._mask |= missing
+            self.recovered_count += 1
+            self.recovered_seq = (self._base + missing.bit_length() - 1) & 0xFFFFFFFF
+        return out
+
+    def decode(self, data: bytes, payload_size: int) -> List[bytes]:
+        """Decode a datagram that may or may not be framed."""
+        if is_frame(data, payload_size):
+            return self.push(FrameHeader.unpack(data), data[HEADER_SIZE:])
+        if len(data) >= payload_size:
+            return [data]
+        return []
+
+
+class StreamDecoder:
+    """Decodes incoming frames: duplicate filtering, then FEC recovery.
+
+    Keeps a :class:`SeqWindow` and a :class:`FecDecoder` per stream ID, for
+    up to ``max_streams`` publishers; the one heard from least recently is
+    evicted to make room. Copies of a frame sent over different paths
+    carry the same stream ID, whichever address they arrive from.
+    """
+
+    def __init__(self, max_streams: int = MAX_STREAMS, drop_stale_recovered: bool = False):
+        """
+        Args:
+            max_streams: Publisher streams tracked at once.
+            drop_stale_recovered: Drop a message rebuilt by FEC once a newer
+                one of its stream was delivered (for latest-only streams).
+        """
+        self._max_streams = max_streams
+        self._drop_stale_recovered = drop_stale_recovered
+        self._streams: 'OrderedDict[int, Tuple[SeqWindow, FecDecoder]]' = OrderedDict()
+        self.duplicate_count = 0
+        self.recovered_count = 0
+        self.stale_recovered_count = 0
+        self.evicted_count = 0
+
+    def decode(self, data: bytes, payload_size: int) -> List[bytes]:
+        """Decode a datagram that may or may not be framed."""
+        if not is_frame(data, payload_size):
+            return [data] if len(data) >= payload_size else []
+
+        header = FrameHeader.unpack(data)
+        seen, fec = self._stream(header.stream)
+        if not header.is_parity and not seen.accept(header.seq):
+            self.duplicate_count += 1
+            return []
+
+        recovered_before = fec.recovered_count
+        out = fec.push(header, data[HEADER_SIZE:])
+        if fec.recovered_count != recovered_before:
+            stale = not seq_newer(fec.recovered_seq, seen.newest)
+            if not seen.accept(fec.recovered_seq):
+                out.pop()
+            elif stale and self._drop_stale_recovered:
+                out.pop()
+                self.stale_recovered_count += 1
+            else:
+                self.recovered_count += 1
+        return out
+
+    def _stream(self, stream: int) -> Tuple[SeqWindow, FecDecoder]:
+        state = self._streams.get(stream)
+        if state is not None:
+            self._streams.move_to_end(stream)
+            return state
+        if len(self._streams) >= self._max_streams:
+            self._streams.popitem(last=False)
+            self.evicted_count += 1
+        state = self._streams[stream] = (SeqWindow(), FecDecoder())
+        return state
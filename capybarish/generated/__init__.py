@@ -23,6 +23,7 @@ Copyright 2025 Chen Yu <chenyu@u.northwestern.edu>
 
 from .motor_control_messages import (
     MotorCommand,
+    TrajectoryChunk,
     SensorData,
     MotorData,
     IMUData,
@@ -36,9 +37,14 @@ from .motor_control_messages import (
     MESSAGE_TYPES,
     get_message_type,
 )
+from .multi_robot_messages import (
+    MocapPose,
+    Pose,
+)
 
 __all__ = [
     "MotorCommand",
+    "TrajectoryChunk",
     "SensorData",
     "MotorData",
     "IMUData",
@@ -51,4 +57,6 @@ __all__ = [
     "PolicyDebugData",
     "MESSAGE_TYPES",
     "get_message_type",
+    "MocapPose",
+    "Pose",
 ]
@@ -0,0 +1,445 @@
+/**
+ * @file Auto-generated message definitions for multi_robot
+ *
+ * Generated from: schemas/multi_robot.cpy
+ * Generated at: 2026-10-17T11:40:22.042727
+ *
+ * DO NOT EDIT - This file is auto-generated by capybarish-gen.
+ *
+ * @copyright 2025 Chen Yu
+ * @license Apache-2.0
+ */
+
+#ifndef MULTI_ROBOT_MESSAGES_HPP
+#define MULTI_ROBOT_MESSAGES_HPP
+
+#include <cstdint>
+#include <cstring>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+namespace multi_robot {
+
+// Forward declarations
+struct Position3D;
+struct Quaternion;
+struct Pose;
+struct RobotCommand;
+struct BatchCommand;
+struct RobotStatus;
+struct MocapPose;
+
+/** One primitive field in a message's flattened wire layout */
+struct FieldLayout {
+    const char* name;  ///< Dotted path for nested fields, e.g. "pose.position.x"
+    const char* type;  ///< Wire type: int8..uint64, float32, float64, bool
+    uint16_t offset;   ///< Byte offset in the serialized message
+    uint16_t count;    ///< Array length (1 for scalars)
+};
+
+/** Position in 3D space */
+#pragma pack(push, 1)
+struct Position3D {
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+
+    static constexpr size_t SIZE = 12;
+
+    static constexpr const char* NAME = "Position3D";
+    static constexpr size_t FIELD_COUNT = 3;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"x", "float32", 0, 1},
+        {"y", "float32", 4, 1},
+        {"z", "float32", 8, 1},
+    };
+
+    /**
+     * @brief Serialize struct to byte buffer
+     * @param buffer Output buffer (must be at least SIZE bytes)
+     */
+    void serialize(uint8_t* buffer) const {
+        memcpy(buffer, this, SIZE);
+    }
+
+    /**
+     * @brief Deserialize from byte buffer
+     * @param buffer Input buffer (must be at least SIZE bytes)
+     * @param len Buffer length
+     * @return true if successful
+     */
+    bool deserialize(const uint8_t* buffer, size_t len) {
+        if (len < SIZE) return false;
+        memcpy(this, buffer, SIZE);
+        return true;
+    }
+
+    /**
+     * @brief Static factory: create from byte buffer
+     * @param buffer Input buffer
+     * @param len Buffer length
+     * @return Position3D object
+     */
+    static Position3D fromBytes(const uint8_t* buffer, size_t len) {
+        Position3D obj;
+        obj.deserialize(buffer, len);
+        return obj;
+    }
+};
+#pragma pack(pop)
+static_assert(sizeof(Position3D) == 12, "Size mismatch for Position3D");
+
+/** Orientation as quaternion */
+#pragma pack(push, 1)
+struct Quaternion {
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+    float w = 0.0f;
+
+    static constexpr size_t SIZE = 16;
+
+    static constexpr const char* NAME = "Quaternion";
+    static constexpr size_t FIELD_COUNT = 4;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"x", "float32", 0, 1},
+        {"y", "float32", 4, 1},
+        {"z", "float32", 8, 1},
+        {"w", "float32", 12, 1},
+    };
+
+    /**
+     * @brief Serialize struct to byte buffer
+     * @param buffer Output buffer (must be at least SIZE bytes)
+     */
+    void serialize(uint8_t* buffer) const {
+        memcpy(buffer, this, SIZE);
+    }
+
+    /**
+     * @brief Deserialize from byte buffer
+     * @param buffer Input buffer (must be at least SIZE bytes)
+     * @param len Buffer length
+     * @return true if successful
+     */
+    bool deserialize(const uint8_t* buffer, size_t len) {
+        if (len < SIZE) return false;
+        memcpy(this, buffer, SIZE);
+        return true;
+    }
+
+    /**
+     * @brief Static factory: create from byte buffer
+     * @param buffer Input buffer
+     * @param len Buffer length
+     * @return Quaternion object
+     */
+    static Quaternion fromBytes(const uint8_t* buffer, size_t len) {
+        Quaternion obj;
+        obj.deserialize(buffer, len);
+        return obj;
+    }
+};
+#pragma pack(pop)
+static_assert(sizeof(Quaternion) == 16, "Size mismatch for Quaternion");
+
+/** Complete pose (position + orientation) */
+#pragma pack(push, 1)
+struct Pose {
+    Position3D position;
+    Quaternion orientation;
+
+    static constexpr size_t SIZE = 28;
+
+    static constexpr const char* NAME = "Pose";
+    static constexpr size_t FIELD_COUNT = 7;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"position.x", "float32", 0, 1},
+        {"position.y", "float32", 4, 1},
+        {"position.z", "float32", 8, 1},
+        {"orientation.x", "float32", 12, 1},
+        {"orientation.y", "float32", 16, 1},
+        {"orientation.z", "float32", 20, 1},
+        {"orientation.w", "float32", 24, 1},
+    };
+
+    /**
+     * @brief Serialize struct to byte buffer
+     * @param buffer Output buffer (must be at least SIZE bytes)
+     */
+    void serialize(uint8_t* buffer) const {
+        memcpy(buffer, this, SIZE);
+    }
+
+    /**
+     * @brief Deserialize from byte buffer
+     * @param buffer Input buffer (must be at least SIZE bytes)
+     * @param len Buffer length
+     * @return true if successful
+     */
+    bool deserialize(const uint8_t* buffer, size_t len) {
+        if (len < SIZE) return false;
+        memcpy(this, buffer, SIZE);
+        return true;
+    }
+
+    /**
+     * @brief Static factory: create from byte buffer
+     * @param buffer Input buffer
+     * @param len Buffer length
+     * @return Pose object
+     */
+    static Pose fromBytes(const uint8_t* buffer, size_t len) {
+        Pose obj;
+        obj.deserialize(buffer, len);
+        return obj;
+    }
+};
+#pragma pack(pop)
+static_assert(sizeof(Pose) == 28, "Size mismatch for Pose");
+
+/** Command for a single robot */
+#pragma pack(push, 1)
+struct RobotCommand {
+    int32_t robot_id = 0;  ///< Target robot ID
+    Pose target_pose;  ///< Target pose
+    float velocity = 0.0f;  ///< Max velocity
+    int32_t flags = 0;  ///< Control flags
+
+    static constexpr size_t SIZE = 40;
+
+    static constexpr const char* NAME = "RobotCommand";
+    static constexpr size_t FIELD_COUNT = 10;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"robot_id", "int32", 0, 1},
+        {"target_pose.position.x", "float32", 4, 1},
+        {"target_pose.position.y", "float32", 8, 1},
+        {"target_pose.position.z", "float32", 12, 1},
+        {"target_pose.orientation.x", "float32", 16, 1},
+        {"target_pose.orientation.y", "float32", 20, 1},
+        {"target_pose.orientation.z", "float32", 24, 1},
+        {"target_pose.orientation.w", "float32", 28, 1},
+        {"velocity", "float32", 32, 1},
+        {"flags", "int32", 36, 1},
+    };
+
+    /**
+     * @brief Serialize struct to byte buffer
+     * @param buffer Output buffer (must be at least SIZE bytes)
+     */
+    void serialize(uint8_t* buffer) const {
+        memcpy(buffer, this, SIZE);
+    }
+
+    /**
+     * @brief Deserialize from byte buffer
+     * @param buffer Input buffer (must be at least SIZE bytes)
+     * @param len Buffer length
+     * @return true if successful
+     */
+    bool deserialize(const uint8_t* buffer, size_t len) {
+        if (len < SIZE) return false;
+        memcpy(this, buffer, SIZE);
+        return true;
+    }
+
+    /**
+     * @brief Static factory: create from byte buffer
+     * @param buffer Input buffer
+     * @param len Buffer length
+     * @return RobotCommand object
+     */
+    static RobotCommand fromBytes(const uint8_t* buffer, size_t len) {
+        RobotCommand obj;
+        obj.deserialize(buffer, len);
+        return obj;
+    }
+};
+#pragma pack(pop)
+static_assert(sizeof(RobotCommand) == 40, "Size mismatch for RobotCommand");
+
+/** Batch command for multiple robots (up to 8) */
+#pragma pack(push, 1)
+struct BatchCommand {
+    int32_t count = 0;  ///< Number of active commands
+    int32_t sequence_id = 0;  ///< Sequence number for tracking
+    float targets[8];  ///< Target values for 8 robots
+    int32_t modes[8];  ///< Modes for 8 robots
+
+    static constexpr size_t SIZE = 72;
+
+    static constexpr const char* NAME = "BatchCommand";
+    static constexpr size_t FIELD_COUNT = 4;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"count", "int32", 0, 1},
+        {"sequence_id", "int32", 4, 1},
+        {"targets", "float32", 8, 8},
+        {"modes", "int32", 40, 8},
+    };
+
+    /**
+     * @brief Serialize struct to byte buffer
+     * @param buffer Output buffer (must be at least SIZE bytes)
+     */
+    void serialize(uint8_t* buffer) const {
+        memcpy(buffer, this, SIZE);
+    }
+
+    /**
+     * @brief Deserialize from byte buffer
+     * @param buffer Input buffer (must be at least SIZE bytes)
+     * @param len Buffer length
+     * @return true if successful
+     */
+    bool deserialize(const uint8_t* buffer, size_t len) {
+        if (len < SIZE) return false;
+        memcpy(this, buffer, SIZE);
+        return true;
+    }
+
+    /**
+     * @brief Static factory: create from byte buffer
+     * @param buffer Input buffer
+     * @param len Buffer length
+     * @return BatchCommand object
+     */
+    static BatchCommand fromBytes(const uint8_t* buffer, size_t len) {
+        BatchCommand obj;
+        obj.deserialize(buffer, len);
+        return obj;
+    }
+};
+#pragma pack(pop)
+static_assert(sizeof(BatchCommand) == 72, "Size mismatch for BatchCommand");
+
+/** Status from a single robot */
+#pragma pack(push, 1)
+struct RobotStatus {
+    int32_t robot_id = 0;
+    Pose current_pose;
+    float battery_level = 0.0f;  ///< Battery percentage (0-100)
+    int32_t status_flags = 0;
+    uint64_t timestamp_us = 0;  ///< Microsecond timestamp
+
+    static constexpr size_t SIZE = 48;
+
+    static constexpr const char* NAME = "RobotStatus";
+    static constexpr size_t FIELD_COUNT = 11;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"robot_id", "int32", 0, 1},
+        {"current_pose.position.x", "float32", 4, 1},
+        {"current_pose.position.y", "float32", 8, 1},
+        {"current_pose.position.z", "float32", 12, 1},
+        {"current_pose.orientation.x", "float32", 16, 1},
+        {"current_pose.orientation.y", "float32", 20, 1},
+        {"current_pose.orientation.z", "float32", 24, 1},
+        {"current_pose.orientation.w", "float32", 28, 1},
+        {"battery_level", "float32", 32, 1},
+        {"status_flags", "int32", 36, 1},
+        {"timestamp_us", "uint64", 40, 1},
+    };
+
+    /**
+     * @brief Serialize struct to byte buffer
+     * @param buffer Output buffer (must be at least SIZE bytes)
+     */
+    void serialize(uint8_t* buffer) const {
+        memcpy(buffer, this, SIZE);
+    }
+
+    /**
+     * @brief Deserialize from byte buffer
+     * @param buffer Input buffer (must be at least SIZE bytes)
+     * @param len Buffer length
+     * @return true if successful
+     */
+    bool deserialize(const uint8_t* buffer, size_t len) {
+        if (len < SIZE) return false;
+        memcpy(this, buffer, SIZE);
+        return true;
+    }
+
+    /**
+     * @brief Static factory: create from byte buffer
+     * @param buffer Input buffer
+     * @param len Buffer length
+     * @return RobotStatus object
+     */
+    static RobotStatus fromBytes(const uint8_t* buffer, size_t len) {
+        RobotStatus obj;
+        obj.deserialize(buffer, len);
+        return obj;
+    }
+};
+#pragma pack(pop)
+static_assert(sizeof(RobotStatus) == 48, "Size mismatch for RobotStatus");
+
+/** Motion-capture pose of one rigid body, stamped with the camera mid-exposure time (cpy::natnet) */
+#pragma pack(push, 1)
+struct MocapPose {
+    int32_t body_id = 0;  ///< Rigid body ID assigned in Motive
+    int32_t frame_number = 0;  ///< Mocap frame number
+    uint64_t timestamp_us = 0;  ///< Capture time (microseconds, mocap host clock)
+    Pose pose;  ///< Position (m) and orientation
+    float mean_error = 0.0f;  ///< Mean marker residual (m)
+    int32_t tracking_valid = 0;  ///< 1 if the body was tracked in this frame
+
+    static constexpr size_t SIZE = 52;
+
+    static constexpr const char* NAME = "MocapPose";
+    static constexpr size_t FIELD_COUNT = 12;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"body_id", "int32", 0, 1},
+        {"frame_number", "int32", 4, 1},
+        {"timestamp_us", "uint64", 8, 1},
+        {"pose.position.x", "float32", 16, 1},
+        {"pose.position.y", "float32", 20, 1},
+        {"pose.position.z", "float32", 24, 1},
+        {"pose.orientation.x", "float32", 28, 1},
+        {"pose.orientation.y", "float32", 32, 1},
+        {"pose.orientation.z", "float32", 36, 1},
+        {"pose.orientation.w", "float32", 40, 1},
+        {"mean_error", "float32", 44, 1},
+        {"tracking_valid", "int32", 48, 1},
+    };
+
+    /**
+     * @brief Serialize struct to byte buffer
+     * @param buffer Output buffer (must be at least SIZE bytes)
+     */
+    void serialize(uint8_t* buffer) const {
+        memcpy(buffer, this, SIZE);
+    }
+
+    /**
+     * @brief Deserialize from byte buffer
+     * @param buffer Input buffer (must be at least SIZE bytes)
+     * @param len Buffer length
+     * @return true if successful
+     */
+    bool deserialize(const uint8_t* buffer, size_t len) {
+        if (len < SIZE) return false;
+        memcpy(this, buffer, SIZE);
+        return true;
+    }
+
+    /**
+     * @brief Static factory: create from byte buffer
+     * @param buffer Input buffer
+     * @param len Buffer length
+     * @return MocapPose object
+     */
+    static MocapPose fromBytes(const uint8_t* buffer, size_t len) {
+        MocapPose obj;
+        obj.deserialize(buffer, len);
+        return obj;
+    }
+};
+#pragma pack(pop)
+static_assert(sizeof(MocapPose) == 52, "Size mismatch for MocapPose");
+
+} // namespace multi_robot
+
+#endif // MULTI_ROBOT_MESSAGES_HPP
\ No newline at end of file
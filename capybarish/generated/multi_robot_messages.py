@@ -0,0 +1,322 @@
+"""
+Auto-generated message definitions for multi_robot.
+
+Generated from: schemas/multi_robot.cpy
+Generated at: 2026-10-17T11:25:38.078776
+
+DO NOT EDIT - This file is auto-generated by capybarish-gen.
+"""
+
+import struct
+from dataclasses import dataclass, field, fields
+from typing import Any, ClassVar, Dict, List, Optional, Tuple, Type, Union
+
+
+# Helper functions for nested type serialization
+def _flatten_nested(obj: Any) -> List:
+    """Flatten a nested dataclass to a list of primitive values."""
+    values = []
+    for f in fields(obj):
+        val = getattr(obj, f.name)
+        if hasattr(val, '__dataclass_fields__'):
+            values.extend(_flatten_nested(val))
+        elif isinstance(val, list) and val and hasattr(val[0], '__dataclass_fields__'):
+            for item in val:
+                values.extend(_flatten_nested(item))
+        elif isinstance(val, list):
+            values.extend(val)
+        else:
+            values.append(val)
+    return values
+
+
+def _unflatten_nested(cls: Type, values: Tuple, start_idx: int = 0) -> Tuple[Any, int]:
+    """Reconstruct a nested dataclass from a flat tuple of values."""
+    obj = cls()
+    idx = start_idx
+    for f in fields(obj):
+        field_type = f.type
+        # Handle string type annotations
+        if isinstance(field_type, str):
+            field_type = globals().get(field_type, field_type)
+        current_val = getattr(obj, f.name)
+        # Check if it's a nested dataclass by checking default_factory
+        if f.default_factory is not type(None) and hasattr(f.default_factory, '__self__'):
+            # It's a nested type
+            nested_cls = f.default_factory.__self__.__class__
+            nested_obj, idx = _unflatten_nested(nested_cls, values, idx)
+            setattr(obj, f.name, nested_obj)
+        elif hasattr(field_type, '__dataclass_fields__'):
+            nested_obj, idx = _unflatten_nested(field_type, values, idx)
+            setattr(obj, f.name, nested_obj)
+        elif isinstance(current_val, list):
+            if current_val and hasattr(current_val[0], '__dataclass_fields__'):
+                nested_items = []
+                for item in current_val:
+                    nested_obj, idx = _unflatten_nested(item.__class__, values, idx)
+                    nested_items.append(nested_obj)
+                setattr(obj, f.name, nested_items)
+            else:
+                array_len = len(current_val)
+                setattr(obj, f.name, list(values[idx:idx + array_len]))
+                idx += array_len
+        else:
+            setattr(obj, f.name, values[idx])
+            idx += 1
+    return obj, idx
+
+
+# Position in 3D space
+@dataclass
+class Position3D:
+    """Message type: Position3D."""
+
+    _FORMAT: ClassVar[str] = 'fff'
+    _SIZE: ClassVar[int] = 12
+
+    x: float = 0.0
+    y: float = 0.0
+    z: float = 0.0
+
+    def serialize(self) -> bytes:
+        """Serialize message to bytes."""
+        return struct.pack(self._FORMAT, self.x, self.y, self.z)
+
+    @classmethod
+    def deserialize(cls, data: bytes) -> 'Position3D':
+        """Deserialize message from bytes."""
+        if len(data) < cls._SIZE:
+            raise ValueError(f"Buffer too small: {len(data)} < {cls._SIZE}")
+        values = struct.unpack(cls._FORMAT, data[:cls._SIZE])
+        obj = cls()
+        obj.x = values[0]
+        obj.y = values[1]
+        obj.z = values[2]
+        return obj
+
+    @classmethod
+    def size(cls) -> int:
+        """Get serialized size in bytes."""
+        return cls._SIZE
+
+
+# Orientation as quaternion
+@dataclass
+class Quaternion:
+    """Message type: Quaternion."""
+
+    _FORMAT: ClassVar[str] = 'ffff'
+    _SIZE: ClassVar[int] = 16
+
+    x: float = 0.0
+    y: float = 0.0
+    z: float = 0.0
+    w: float = 0.0
+
+    def serialize(self) -> bytes:
+        """Serialize message to bytes."""
+        return struct.pack(self._FORMAT, self.x, self.y, self.z, self.w)
+
+    @classmethod
+    def deserialize(cls, data: bytes) -> 'Quaternion':
+        """Deserialize message from bytes."""
+        if len(data) < cls._SIZE:
+            raise ValueError(f"Buffer too small: {len(data)} < {cls._SIZE}")
+        values = struct.unpack(cls._FORMAT, data[:cls._SIZE])
+        obj = cls()
+        obj.x = values[0]
+        obj.y = values[1]
+        obj.z = values[2]
+        obj.w = values[3]
+        return obj
+
+    @classmethod
+    def size(cls) -> int:
+        """Get serialized size in bytes."""
+        return cls._SIZE
+
+
+# Complete pose (position + orientation)
+@dataclass
+class Pose:
+    """Message type: Pose."""
+
+    _FORMAT: ClassVar[str] = 'fffffff'
+    _SIZE: ClassVar[int] = 28
+
+    position: Position3D = field(default_factory=Position3D)
+    orientation: Quaternion = field(default_factory=Quaternion)
+
+    def serialize(self) -> bytes:
+        """Serialize message to bytes."""
+        values = _flatten_nested(self)
+        return struct.pack(self._FORMAT, *values)
+
+    @classmethod
+    def deserialize(cls, data: bytes) -> 'Pose':
+        """Deserialize message from bytes."""
+        if len(data) < cls._SIZE:
+            raise ValueError(f"Buffer too small: {len(data)} < {cls._SIZE}")
+        values = struct.unpack(cls._FORMAT, data[:cls._SIZE])
+        obj, _ = _unflatten_nested(cls, values)
+        return obj
+
+    @classmethod
+    def size(cls) -> int:
+        """Get serialized size in bytes."""
+        return cls._SIZE
+
+
+# Command for a single robot
+@dataclass
+class RobotCommand:
+    """Message type: RobotCommand."""
+
+    _FORMAT: ClassVar[str] = 'iffffffffi'
+    _SIZE: ClassVar[int] = 40
+
+    robot_id: int = 0  # Target robot ID
+    target_pose: Pose = field(default_factory=Pose)  # Target pose
+    velocity: float = 0.0  # Max velocity
+    flags: int = 0  # Control flags
+
+    def serialize(self) -> bytes:
+        """Serialize message to bytes."""
+        values = _flatten_nested(self)
+        return struct.pack(self._FORMAT, *values)
+
+    @classmethod
+    def deserialize(cls, data: bytes) -> 'RobotCommand':
+        """Deserialize message from bytes."""
+        if len(data) < cls._SIZE:
+            raise ValueError(f"Buffer too small: {len(data)} < {cls._SIZE}")
+        values = struct.unpack(cls._FORMAT, data[:cls._SIZE])
+        obj, _ = _unflatten_nested(cls, values)
+        return obj
+
+    @classmethod
+    def size(cls) -> int:
+        """Get serialized size in bytes."""
+        return cls._SIZE
+
+
+# Batch command for multiple robots (up to 8)
+@dataclass
+class BatchCommand:
+    """Message type: BatchCommand."""
+
+    _FORMAT: ClassVar[str] = 'iiffffffffiiiiiiii'
+    _SIZE: ClassVar[int] = 72
+
+    count: int = 0  # Number of active commands
+    sequence_id: int = 0  # Sequence number for tracking
+    targets: List[float] = field(default_factory=lambda: [0.0] * 8)  # Target values for 8 robots
+    modes: List[int] = field(default_factory=lambda: [0] * 8)  # Modes for 8 robots
+
+    def serialize(self) -> bytes:
+        """Serialize message to bytes."""
+        return struct.pack(self._FORMAT, self.count, self.sequence_id, *self.targets, *self.modes)
+
+    @classmethod
+    def deserialize(cls, data: bytes) -> 'BatchCommand':
+        """Deserialize message from bytes."""
+        if len(data) < cls._SIZE:
+            raise ValueError(f"Buffer too small: {len(data)} < {cls._SIZE}")
+        values = struct.unpack(cls._FORMAT, data[:cls._SIZE])
+        obj = cls()
+        obj.count = values[0]
+        obj.sequence_id = values[1]
+        obj.targets = list(values[2:10])
+        obj.modes = list(values[10:18])
+        return obj
+
+    @classmethod
+    def size(cls) -> int:
+        """Get serialized size in bytes."""
+        return cls._SIZE
+
+
+# Status from a single robot
+@dataclass
+class RobotStatus:
+    """Message type: RobotStatus."""
+
+    _FORMAT: ClassVar[str] = 'iffffffffiQ'
+    _SIZE: ClassVar[int] = 48
+
+    robot_id: int = 0
+    current_pose: Pose = field(default_factory=Pose)
+    battery_level: float = 0.0  # Battery percentage (0-100)
+    status_flags: int = 0
+    timestamp_us: int = 0  # Microsecond timestamp
+
+    def serialize(self) -> bytes:
+        """Serialize message to bytes."""
+        values = _flatten_nested(self)
+        return struct.pack(self._FORMAT, *values)
+
+    @classmethod
+    def deserialize(cls, data: bytes) -> 'RobotStatus':
+        """Deserialize message from bytes."""
+        if len(data) < cls._SIZE:
+            raise ValueError(f"Buffer too small: {len(data)} < {cls._SIZE}")
+        values = struct.unpack(cls._FORMAT, data[:cls._SIZE])
+        obj, _ = _unflatten_nested(cls, values)
+        return obj
+
+    @classmethod
+    def size(cls) -> int:
+        """Get serialized size in bytes."""
+        return cls._SIZE
+
+
+# Motion-capture pose of one rigid body, stamped with the camera mid-exposure time (cpy::natnet)
+@dataclass
+class MocapPose:
+    """Message type: MocapPose."""
+
+    _FORMAT: ClassVar[str] = 'iiQffffffffi'
+    _SIZE: ClassVar[int] = 52
+
+    body_id: int = 0  # Rigid body ID assigned in Motive
+    frame_number: int = 0  # Mocap frame number
+    timestamp_us: int = 0  # Capture time (microseconds, mocap host clock)
+    pose: Pose = field(default_factory=Pose)  # Position (m) and orientation
+    mean_error: float = 0.0  # Mean marker residual (m)
+    tracking_valid: int = 0  # 1 if the body was tracked in this frame
+
+    def serialize(self) -> bytes:
+        """Serialize message to bytes."""
+        values = _flatten_nested(self)
+        return struct.pack(self._FORMAT, *values)
+
+    @classmethod
+    def deserialize(cls, data: bytes) -> 'MocapPose':
+        """Deserialize message from bytes."""
+        if len(data) < cls._SIZE:
+            raise ValueError(f"Buffer too small: {len(data)} < {cls._SIZE}")
+        values = struct.unpack(cls._FORMAT, data[:cls._SIZE])
+        obj, _ = _unflatten_nested(cls, values)
+        return obj
+
+    @classmethod
+    def size(cls) -> int:
+        """Get serialized size in bytes."""
+        return cls._SIZE
+
+
+# Message registry for dynamic lookup
+MESSAGE_TYPES: Dict[str, type] = {
+    "Position3D": Position3D,
+    "Quaternion": Quaternion,
+    "Pose": Pose,
+    "RobotCommand": RobotCommand,
+    "BatchCommand": BatchCommand,
+    "RobotStatus": RobotStatus,
+    "MocapPose": MocapPose,
+}
+
+
+def get_message_type(name: str) -> Optional[type]:
+    """Get message class by name."""
+    return MESSAGE_TYPES.get(name)
\ No newline at end of file
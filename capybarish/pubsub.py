@@ -28,6 +28,8 @@ Copyright 2025 Chen Yu <chenyu@u.northwestern.edu>
 Licensed under the Apache License, Version 2.0
 """
 
+import math
+import os
 import queue
 import socket
 import struct
@@ -35,10 +37,10 @@ import threading
 import time
 import weakref
 from abc import ABC, abstractmethod
-from collections import defaultdict
-from dataclasses import dataclass, field
+from dataclasses import dataclass, field, replace
 from enum import Enum, auto
 from typing import (
+    TYPE_CHECKING,
     Any,
     Callable,
     Dict,
@@ -52,6 +54,12 @@ from typing import (
     Union,
 )
 
+from .auth import MessageAuth, TRAILER_SIZE as AUTH_TRAILER_SIZE
+from .framing import HEADER_SIZE, FecEncoder, StreamDecoder
+
+if TYPE_CHECKING:
+    from .serial_transport import SerialTransport
+
 # Type variable for message types
 MsgT = TypeVar('MsgT')
 
@@ -78,6 +86,98 @@ class QoSDurabilityPolicy(Enum):
     TRANSIENT_LOCAL = auto()  # Keep last message for late joiners
 
 
+class TrafficClass(Enum):
+    """Traffic class (WMM access category) for a topic.
+    
+    Values are ordered from lowest to highest priority and match
+    ``cpy::TrafficClass`` in ``capybarish_pubsub.h``. Each class is written
+    into outgoing packets as a DSCP code point; WiFi drivers derive the
+    802.11 user priority from its top three bits.
+    """
+    BACKGROUND = 0   # AC_BK - bulk logs, debug dumps
+    BEST_EFFORT = 1  # AC_BE - default for all traffic
+    VIDEO = 2        # AC_VI - telemetry that must stay fresh
+    VOICE = 3        # AC_VO - control commands
+    
+    @property
+    def dscp(self) -> int:
+        """DSCP code point (VOICE uses CS6: EF would map to AC_VI)."""
+        return _TRAFFIC_CLASS_DSCP[self]
+    
+    @property
+    def tos(self) -> int:
+        """IPv4 TOS byte (DSCP << 2, ECN bits clear)."""
+        return self.dscp << 2
+    
+    @property
+    def user_priority(self) -> int:
+        """802.1d user priority, used for SO_PRIORITY on Linux."""
+        return self.dscp >> 3
+
+
+class RateLimitAction(Enum):
+    """What a publisher does when its bandwidth budget is used up."""
+    DROP = auto()   # Discard the message
+    DEFER = auto()  # Hold the latest message and send it once the budget refills
+
+
+_TRAFFIC_CLASS_DSCP = {
+    TrafficClass.BACKGROUND: 8,    # CS1  -> UP 1
+    TrafficClass.BEST_EFFORT: 0,   # CS0  -> UP 0
+    TrafficClass.VIDEO: 34,        # AF41 -> UP 4
+    TrafficClass.VOICE: 48,        # CS6  -> UP 6
+}
+
+
+def apply_traffic_class(sock: socket.socket, traffic_class: 'TrafficClass') -> bool:
+    """Mark a UDP socket's outgoing packets with a traffic class.
+    
+    Sets ``IP_TOS`` everywhere it is available and, on Linux, ``SO_PRIORITY``
+    so the local qdisc and mac80211 queue the packet in the same access
+    category before it even reaches the AP.
+    
+    Returns:
+        True if the DSCP marking was applied
+    """
+    applied = False
+    if hasattr(socket, 'IP_TOS'):
+        try:
+            sock.setsockopt(socket.IPPROTO_IP, socket.IP_TOS, traffic_class.tos)
+            applied = True
+        except OSError:
+            pass
+    if hasattr(socket, 'SO_PRIORITY'):
+        try:
+            sock.setsockopt(socket.SOL_SOCKET, socket.SO_PRIORITY, traffic_class.user_priority)
+        except OSError:
+            pass  # Priorities above 6 need CAP_NET_ADMIN; DSCP still applies
+    return applied
+
+
+def open_path_socket(
+    traffic_class: 'TrafficClass',
+    source_address: Optional[str] = None,
+    interface: Optional[str] = None,
+) -> socket.socket:
+    """Open a send socket pinned to a local address and/or interface.
+    
+    Used for redundant multi-path publishing: one socket per link.
+    """
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    try:
+        if interface is not None:
+            if not hasattr(socket, 'SO_BINDTODEVICE'):
+                raise OSError(f"Cannot bind to interface '{interface}' on this platform")
+            sock.setsockopt(socket.SOL_SOCKET, socket.SO_BINDTODEVICE, interface.encode())
+        if source_address is not None:
+            sock.bind((source_address, 0))
+        apply_traffic_class(sock, traffic_class)
+    except OSError:
+        sock.close()
+        raise
+    return sock
+
+
 @dataclass
 class QoSProfile:
     """Quality of Service profile for publishers and subscribers.
@@ -88,6 +188,26 @@ class QoSProfile:
     history: QoSHistoryPolicy = QoSHistoryPolicy.KEEP_LAST
     depth: int = 10  # Queue depth for KEEP_LAST
     durability: QoSDurabilityPolicy = QoSDurabilityPolicy.VOLATILE
+    traffic_class: TrafficClass = TrafficClass.BEST_EFFORT
+    fec_group_size: int = 0  # Send one XOR parity packet every N messages (0 = off)
+    rate_limit_bps: int = 0  # Token bucket refill rate in bytes/s (0 = unlimited)
+    burst_bytes: int = 0  # Bucket depth (0 = 100 ms of budget)
+    rate_limit_action: RateLimitAction = RateLimitAction.DROP
+    drop_stale_recovered: bool = False  # Drop a message rebuilt by FEC once a newer one was delivered
+    
+    def with_budget(
+        self,
+        bytes_per_sec: int,
+        burst: int = 0,
+        action: RateLimitAction = RateLimitAction.DROP,
+    ) -> 'QoSProfile':
+        """Copy of this profile with a hard per-topic bandwidth budget.
+        
+        Bytes are counted on the wire: every endpoint and path, frame
+        headers and parity.
+        """
+        return replace(self, rate_limit_bps=bytes_per_sec, burst_bytes=burst,
+                       rate_limit_action=action)
     
     @classmethod
     def sensor_data(cls) -> 'QoSProfile':
@@ -104,6 +224,29 @@ class QoSProfile:
         """Default QoS profile (reliable, depth 10)."""
         return cls()
     
+    @classmethod
+    def control(cls) -> 'QoSProfile':
+        """QoS profile for control commands (latest only, WMM voice class).
+        
+        A command rebuilt by FEC after a newer one arrived is dropped, so
+        the stream never steps back to an older command.
+        """
+        return cls(
+            reliability=QoSReliabilityPolicy.BEST_EFFORT,
+            history=QoSHistoryPolicy.KEEP_LAST,
+            depth=1,
+            durability=QoSDurabilityPolicy.VOLATILE,
+            traffic_class=TrafficClass.VOICE,
+            drop_stale_recovered=True,
+        )
+    
+    @classmethod
+    def lossy_control(cls, group_size: int = 5) -> 'QoSProfile':
+        """Control profile plus one FEC parity packet every ``group_size`` commands."""
+        qos = cls.control()
+        qos.fec_group_size = group_size
+        return qos
+    
     @classmethod
     def services(cls) -> 'QoSProfile':
         """QoS profile for service calls (reliable)."""
@@ -125,6 +268,81 @@ class QoSProfile:
         )
 
 
+# =============================================================================
+# Bandwidth Accounting
+# =============================================================================
+
+class RateEstimator:
+    """Exponentially decayed rate estimator (events/s or bytes/s).
+    
+    Each sample adds ``weight / tau`` and the total decays by
+    ``exp(-dt / tau)``, so a stream that stops decays to zero instead of
+    freezing at its last value. Mirrors ``cpy::RateEstimator``.
+    """
+    
+    def __init__(self, tau_sec: float = 1.0):
+        self._tau = tau_sec
+        self._rate = 0.0
+        self._last = 0.0
+    
+    def add(self, now: float, weight: float = 1.0) -> None:
+        self._rate = self.rate(now) + weight / self._tau
+        self._last = now
+    
+    def rate(self, now: float) -> float:
+        """Estimated rate per second at ``now``."""
+        if self._rate == 0.0:
+            return 0.0
+        return self._rate * math.exp(-(now - self._last) / self._tau)
+
+
+class TokenBucket:
+    """Token bucket holding up to ``burst`` bytes, refilled at ``rate``.
+    
+    Disabled (always admits) while the rate is 0. Mirrors ``cpy::TokenBucket``.
+    """
+    
+    def __init__(self, rate: float = 0.0, burst: float = 0.0, now: Optional[float] = None):
+        self.configure(rate, burst, now)
+    
+    def configure(self, rate: float, burst: float, now: Optional[float] = None) -> None:
+        self._rate = rate
+        self._burst = burst
+        self._tokens = burst
+        self._last = time.monotonic() if now is None else now
+    
+    @property
+    def enabled(self) -> bool:
+        return self._rate > 0
+    
+    def _refill(self, now: float) -> None:
+        self._tokens = min(self._burst, self._tokens + (now - self._last) * self._rate)
+        self._last = now
+    
+    def try_consume(self, now: float, amount: float) -> bool:
+        """Take ``amount`` if the bucket holds that much."""
+        if not self.enabled:
+            return True
+        self._refill(now)
+        if self._tokens < amount:
+            return False
+        self._tokens -= amount
+        return True
+    
+    def consume(self, now: float, amount: float) -> None:
+        """Take ``amount`` unconditionally (the bucket may go into debt)."""
+        if self.enabled:
+            self._refill(now)
+            self._tokens -= amount
+    
+    def wait_time(self, now: float, amount: float) -> float:
+        """Seconds until ``amount`` is available (0 if now)."""
+        if not self.enabled:
+            return 0.0
+        tokens = min(self._burst, self._tokens + (now - self._last) * self._rate)
+        return max(0.0, (amount - tokens) / self._rate)
+
+
 # =============================================================================
 # Topic Manager (Global Registry)
 # =============================================================================
@@ -350,6 +568,11 @@ class Publisher(Generic[MsgT]):
         pub = node.create_publisher(MotorCommand, '/motor/command', qos_depth=10)
         msg = MotorCommand(target=1.5, target_vel=0.0)
         pub.publish(msg)
+        
+        # Network sends capped at 20 kB/s, holding back only the latest message
+        qos = QoSProfile.sensor_data().with_budget(20000, action=RateLimitAction.DEFER)
+        telemetry = node.create_publisher(SensorData, '/motor/feedback', qos_profile=qos)
+        print(telemetry.bytes_per_sec, telemetry.throttled_count)
         ```
     """
     
@@ -359,11 +582,13 @@ class Publisher(Generic[MsgT]):
         msg_type: Type[MsgT],
         topic_name: str,
         qos: QoSProfile,
+        transport: Optional['SerialTransport'] = None,
     ):
         self._node = node
         self._msg_type = msg_type
         self._topic_name = topic_name
         self._qos = qos
+        self._transport = transport
         
         # Get or create the topic
         self._topic = TopicManager().get_or_create_topic(topic_name, msg_type, qos)
@@ -376,6 +601,21 @@ class Publisher(Generic[MsgT]):
         # Network publisher for inter-process (optional)
         self._udp_socket: Optional[socket.socket] = None
         self._remote_endpoints: List[Tuple[str, int]] = []
+        self._fec = FecEncoder(qos.fec_group_size) if qos.fec_group_size > 1 else None
+        
+        # Redundant paths: (socket, endpoint) pairs that carry every frame again
+        self._paths: List[Tuple[socket.socket, Tuple[str, int]]] = []
+        
+        # Bandwidth accounting and budget (network sends only)
+        self._byte_count = 0
+        self._throttled_count = 0
+        self._byte_rate = RateEstimator()
+        self._msg_rate = RateEstimator()
+        self._bucket = TokenBucket()
+        self._deferred: Optional[MsgT] = None
+        
+        # Per-topic authentication (see capybarish.auth)
+        self._auth: Optional[MessageAuth] = None
     
     @property
     def topic_name(self) -> str:
@@ -406,35 +646,182 @@ class Publisher(Generic[MsgT]):
         self._topic.publish(msg)
         
         # Network delivery (if configured)
-        if self._udp_socket and self._remote_endpoints:
-            self._publish_network(msg)
+        if (self._udp_socket and self._remote_endpoints) or self._paths:
+            if not self._bucket.enabled:
+                self._publish_network(msg)
+            elif self._bucket.try_consume(time.monotonic(), self._wire_cost(msg)):
+                if self._deferred is not None:
+                    self._deferred = None
+                    self._throttled_count += 1  # Superseded
+                self._publish_network(msg)
+            elif self._qos.rate_limit_action == RateLimitAction.DEFER:
+                if self._deferred is not None:
+                    self._throttled_count += 1  # Superseded
+                self._deferred = msg
+            else:
+                self._throttled_count += 1
+    
+    def flush(self) -> bool:
+        """Send the held-back message once the budget allows it.
+        
+        Called by ``Node.spin_once()``.
+        
+        Returns:
+            True if a held message was sent
+        """
+        if self._deferred is None:
+            return False
+        if not self._bucket.try_consume(time.monotonic(), self._wire_cost(self._deferred)):
+            return False
+        msg, self._deferred = self._deferred, None
+        self._publish_network(msg)
+        return True
+    
+    def time_until_flush(self) -> float:
+        """Seconds until ``flush()`` can send the held message (inf if none)."""
+        if self._deferred is None:
+            return math.inf
+        return self._bucket.wait_time(time.monotonic(), self._wire_cost(self._deferred))
+    
+    def _sends(self) -> List[Tuple[socket.socket, Tuple[str, int]]]:
+        return [(self._udp_socket, ep) for ep in self._remote_endpoints] + self._paths
+    
+    def _wire_cost(self, msg: MsgT) -> int:
+        """Bytes one message puts on the wire across every destination."""
+        size = getattr(self._msg_type, '_SIZE', None)
+        if size is None:
+            size = len(msg.serialize()) if hasattr(msg, 'serialize') else 0
+        if self._fec is not None or self._paths:
+            size += HEADER_SIZE
+        if self._auth is not None:
+            size += AUTH_TRAILER_SIZE
+        return size * len(self._sends())
+    
+    def _configure_budget(self) -> None:
+        """(Re)fill the token bucket; it always holds at least one message."""
+        if self._qos.rate_limit_bps <= 0:
+            return
+        burst = self._qos.burst_bytes or self._qos.rate_limit_bps / 10
+        size = getattr(self._msg_type, '_SIZE', 0) + HEADER_SIZE
+        if self._auth is not None:
+            size += AUTH_TRAILER_SIZE
+        self._bucket.configure(self._qos.rate_limit_bps, max(burst, size * len(self._sends())))
     
     def _publish_network(self, msg: MsgT) -> None:
         """Publish message over network."""
         if hasattr(msg, 'serialize'):
             data = msg.serialize()
-            for endpoint in self._remote_endpoints:
-                try:
-                    self._udp_socket.sendto(data, endpoint)
-                except OSError:
-                    pass  # Ignore network errors in best-effort mode
+            if self._fec is None and self._paths:
+                self._fec = FecEncoder()  # Sequence numbers for deduplication
+            frames = self._fec.encode(data) if self._fec else [data]
+            if self._auth is not None:
+                frames = [self._auth.seal(frame) for frame in frames]
+            sends = self._sends()
+            now = time.monotonic()
+            # A trailing parity frame completes an admitted group: charge, don't gate
+            for frame in frames[1:]:
+                self._bucket.consume(now, len(frame) * len(sends))
+            for frame in frames:
+                for sock, endpoint in sends:
+                    try:
+                        sock.sendto(frame, endpoint)
+                        self._byte_count += len(frame)
+                        self._byte_rate.add(now, len(frame))
+                    except OSError:
+                        pass  # Ignore network errors in best-effort mode
+            self._msg_rate.add(now)
     
     def add_remote_endpoint(self, host: str, port: int) -> None:
-        """Add a remote endpoint for network publishing."""
+        """Add a remote endpoint for network publishing.
+        
+        With a transport, ``host`` is ignored and ``port`` addresses the topic
+        on the other end of the link.
+        """
         if self._udp_socket is None:
-            self._udp_socket = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+            if self._transport is not None:
+                self._udp_socket = self._transport.open_channel()
+            else:
+                self._udp_socket = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+                apply_traffic_class(self._udp_socket, self._qos.traffic_class)
         self._remote_endpoints.append((host, port))
+        self._configure_budget()
+    
+    def set_auth(self, key: Union[str, bytes], first_seq: Optional[int] = None,
+                 sender: Optional[int] = None) -> None:
+        """Authenticate every network datagram (``capybarish_auth.h`` format).
+        
+        Args:
+            key: Shared key, 16 bytes or 32 hex digits.
+            first_seq: First sequence number; must grow across restarts
+                (default: wall-clock microseconds).
+            sender: Sender ID; another publisher of this topic on the same
+                host needs its own (default: from the MAC address).
+        """
+        self._auth = MessageAuth(key, self._topic_name, first_seq, sender)
+        self._configure_budget()
+    
+    def clear_auth(self) -> None:
+        """Send unauthenticated datagrams again."""
+        self._auth = None
+        self._configure_budget()
+    
+    def add_path(
+        self,
+        host: str,
+        port: int,
+        source_address: Optional[str] = None,
+        interface: Optional[str] = None,
+    ) -> None:
+        """Send every message over an additional network path as well.
+        
+        Each path gets its own socket, optionally pinned to a local address or
+        interface (e.g. the wired NIC next to the WiFi one). Once a path is
+        added, messages are sent as sequenced frames and subscribers keep
+        whichever copy arrives first.
+        
+        Args:
+            host: Destination address for this path
+            port: Destination port for this path
+            source_address: Local address to send from
+            interface: Network interface to send from (Linux, needs CAP_NET_RAW)
+        """
+        self._paths.append((open_path_socket(self._qos.traffic_class, source_address, interface),
+                            (host, port)))
+        self._configure_budget()
     
     def get_subscription_count(self) -> int:
         """Get number of subscribers to this topic."""
         return self._topic.subscriber_count
     
+    @property
+    def byte_count(self) -> int:
+        """Bytes put on the network (every destination, headers and parity)."""
+        return self._byte_count
+    
+    @property
+    def throttled_count(self) -> int:
+        """Messages dropped or superseded by the bandwidth budget."""
+        return self._throttled_count
+    
+    @property
+    def bytes_per_sec(self) -> float:
+        """Exponentially decayed network send rate in bytes/s (1 s time constant)."""
+        return self._byte_rate.rate(time.monotonic())
+    
+    @property
+    def messages_per_sec(self) -> float:
+        """Exponentially decayed network send rate in messages/s."""
+        return self._msg_rate.rate(time.monotonic())
+    
     def destroy(self) -> None:
         """Clean up the publisher."""
         self._topic.remove_publisher(self)
         if self._udp_socket:
             self._udp_socket.close()
             self._udp_socket = None
+        for sock, _ in self._paths:
+            sock.close()
+        self._paths.clear()
 
 
 # =============================================================================
@@ -460,12 +847,14 @@ class Subscription(Generic[MsgT]):
         topic_name: str,
         callback: Callable[[MsgT], None],
         qos: QoSProfile,
+        transport: Optional['SerialTransport'] = None,
     ):
         self._node = node
         self._msg_type = msg_type
         self._topic_name = topic_name
         self._callback = callback
         self._qos = qos
+        self._transport = transport
         
         # Message queue
         if qos.history == QoSHistoryPolicy.KEEP_ALL:
@@ -486,6 +875,11 @@ class Subscription(Generic[MsgT]):
         self._udp_socket: Optional[socket.socket] = None
         self._network_thread: Optional[threading.Thread] = None
         self._running = False
+        self._decoder = StreamDecoder(drop_stale_recovered=qos.drop_stale_recovered)
+        self._auth: Optional[MessageAuth] = None
+        self._auth_state_path: Optional[str] = None
+        self._auth_fail_count = 0
+        self._replay_count = 0
     
     @property
     def topic_name(self) -> str:
@@ -511,6 +905,7 @@ class Subscription(Generic[MsgT]):
             self._queue.put_nowait(msg)
             self._recv_count += 1
             self._last_recv_time = time.time()
+            self._node._notify()
         except queue.Full:
             self._drop_count += 1
     
@@ -565,6 +960,9 @@ class Subscription(Generic[MsgT]):
     def bind_network(self, host: str = '0.0.0.0', port: Optional[int] = None) -> None:
         """Bind to network for receiving messages from remote publishers.
         
+        With a transport, ``host`` is ignored and ``port`` selects the
+        datagrams addressed to this topic on the link.
+        
         Args:
             host: Host to bind to
             port: Port to bind to (uses topic's port if not specified)
@@ -573,9 +971,12 @@ class Subscription(Generic[MsgT]):
             return
         
         port = port or self._topic._port
-        self._udp_socket = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
-        self._udp_socket.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
-        self._udp_socket.bind((host, port))
+        if self._transport is not None:
+            self._udp_socket = self._transport.open_channel(port)
+        else:
+            self._udp_socket = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+            self._udp_socket.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+            self._udp_socket.bind((host, port))
         self._udp_socket.settimeout(0.1)
         
         self._running = True
@@ -587,18 +988,75 @@ class Subscription(Generic[MsgT]):
         while self._running:
             try:
                 data, addr = self._udp_socket.recvfrom(4096)
-                if hasattr(self._msg_type, 'deserialize'):
-                    msg = self._msg_type.deserialize(data)
-                    self._enqueue(msg)
+                self._receive_datagram(data)
             except socket.timeout:
                 continue
             except Exception:
                 continue
     
+    def _receive_datagram(self, data: bytes) -> None:
+        """Authenticate, deframe and queue one datagram."""
+        if self._auth is not None:
+            payload, authentic = self._auth.accept(data)
+            if not authentic:
+                self._auth_fail_count += 1
+                return
+            if payload is None:
+                self._replay_count += 1  # Replayed, or a later copy from another path
+                return
+            if self._auth_state_path and self._auth.guard.checkpoint_due:
+                self._auth.guard.save(self._auth_state_path)
+            data = payload
+        if hasattr(self._msg_type, 'deserialize'):
+            # Framed datagrams (FEC, multi-path) may yield zero, one or two messages
+            size = getattr(self._msg_type, '_SIZE', None)
+            payloads = self._decoder.decode(data, size) if size else [data]
+            for payload in payloads:
+                self._enqueue(self._msg_type.deserialize(payload))
+    
+    def set_auth(self, key: Union[str, bytes], state_path: Optional[str] = None) -> None:
+        """Accept only datagrams sealed with ``key`` (see ``capybarish.auth``).
+        
+        Args:
+            key: Shared key, 16 bytes or 32 hex digits.
+            state_path: JSON file for replay checkpoints, so a restart
+                does not accept a recorded stream (None = keep none).
+        """
+        self._auth = MessageAuth(key, self._topic_name)
+        self._auth_state_path = os.path.expanduser(state_path) if state_path else None
+        if self._auth_state_path:
+            self._auth.guard.load(self._auth_state_path)
+    
+    def clear_auth(self) -> None:
+        """Accept unauthenticated datagrams again."""
+        self._auth = None
+    
+    @property
+    def auth_fail_count(self) -> int:
+        """Get number of datagrams dropped for a missing or wrong tag (or
+        from a sender beyond ``MAX_SENDERS``)."""
+        return self._auth_fail_count
+    
     def get_publisher_count(self) -> int:
         """Get number of publishers to this topic."""
         return self._topic.publisher_count
     
+    @property
+    def recovered_count(self) -> int:
+        """Get number of messages rebuilt by forward error correction."""
+        return self._decoder.recovered_count
+    
+    @property
+    def stale_recovered_count(self) -> int:
+        """Get number of rebuilt messages dropped because a newer one had
+        already been delivered (``QoSProfile.drop_stale_recovered``)."""
+        return self._decoder.stale_recovered_count
+    
+    @property
+    def duplicate_count(self) -> int:
+        """Get number of redundant copies (and replayed datagrams) dropped."""
+        return self._decoder.duplicate_count + self._replay_count
+    
     @property
     def pending_count(self) -> int:
         """Get number of pending messages in queue."""
@@ -636,10 +1094,12 @@ class Timer:
         node: 'Node',
         period_sec: float,
         callback: Callable[[], None],
+        traffic_class: TrafficClass = TrafficClass.BEST_EFFORT,
     ):
         self._node = node
         self._period = period_sec
         self._callback = callback
+        self._traffic_class = traffic_class
         
         self._last_call = time.time()
         self._call_count = 0
@@ -650,11 +1110,22 @@ class Timer:
         """Get timer period in seconds."""
         return self._period
     
+    @property
+    def traffic_class(self) -> TrafficClass:
+        """Get the traffic class of what this timer publishes."""
+        return self._traffic_class
+    
     @property
     def is_ready(self) -> bool:
         """Check if timer is ready to fire."""
         return self._active and (time.time() - self._last_call) >= self._period
     
+    def time_until_ready(self) -> float:
+        """Seconds until the timer is next due (0 if due now, inf if cancelled)."""
+        if not self._active:
+            return math.inf
+        return max(0.0, self._last_call + self._period - time.time())
+    
     def fire(self) -> None:
         """Fire the timer callback."""
         if self._active:
@@ -692,18 +1163,29 @@ class Node:
         pub = node.create_publisher(MotorCommand, '/motor/command')
         sub = node.create_subscription(SensorData, '/motor/feedback', my_callback)
         timer = node.create_timer(0.01, control_loop)  # 100 Hz
+        
+        # Same topics over a USB-tethered module instead of UDP
+        usb_node = Node('bench', transport=SerialTransport('/dev/ttyACM0'))
         ```
     """
     
-    def __init__(self, name: str, *, namespace: str = ''):
+    def __init__(
+        self,
+        name: str,
+        *,
+        namespace: str = '',
+        transport: Optional['SerialTransport'] = None,
+    ):
         """Create a new node.
         
         Args:
             name: Node name (must be unique)
             namespace: Optional namespace prefix for topics
+            transport: Carry network topics over this transport instead of UDP
         """
         self._name = name
         self._namespace = namespace
+        self._transport = transport
         self._full_name = f"{namespace}/{name}" if namespace else name
         
         self._publishers: List[Publisher] = []
@@ -711,6 +1193,7 @@ class Node:
         self._timers: List[Timer] = []
         
         self._lock = threading.Lock()
+        self._wake = threading.Event()  # Set whenever a subscription queues a message
         self._context = TopicManager()
         self._context.register_node(self)
         
@@ -759,7 +1242,7 @@ class Node:
         # Apply namespace
         full_topic = self._resolve_topic_name(topic)
         
-        pub = Publisher(self, msg_type, full_topic, qos_profile)
+        pub = Publisher(self, msg_type, full_topic, qos_profile, self._transport)
         with self._lock:
             self._publishers.append(pub)
         
@@ -792,7 +1275,7 @@ class Node:
         # Apply namespace
         full_topic = self._resolve_topic_name(topic)
         
-        sub = Subscription(self, msg_type, full_topic, callback, qos_profile)
+        sub = Subscription(self, msg_type, full_topic, callback, qos_profile, self._transport)
         with self._lock:
             self._subscriptions.append(sub)
         
@@ -803,19 +1286,26 @@ class Node:
         self,
         period_sec: float,
         callback: Callable[[], None],
+        traffic_class: TrafficClass = TrafficClass.BEST_EFFORT,
     ) -> Timer:
         """Create a periodic timer.
         
+        Timers are kept ordered by traffic class, so when several are due in
+        the same spin the one driving control publishes sends first.
+        
         Args:
             period_sec: Timer period in seconds
             callback: Function to call when timer fires
+            traffic_class: Class of the traffic this timer publishes
             
         Returns:
             Timer instance
         """
-        timer = Timer(self, period_sec, callback)
+        timer = Timer(self, period_sec, callback, traffic_class)
         with self._lock:
             self._timers.append(timer)
+            # Stable sort keeps creation order within a class
+            self._timers.sort(key=lambda t: t.traffic_class.value, reverse=True)
         
         self._logger.debug(f"Created timer: period={period_sec}s")
         return timer
@@ -856,8 +1346,56 @@ class Node:
                 timer.fire()
                 count += 1
         
+        # Send messages held back by a bandwidth budget, unless a timer
+        # above just replaced them with a newer one
+        with self._lock:
+            pubs = list(self._publishers)
+        
+        for pub in pubs:
+            pub.flush()
+        
         return count
     
+    def spin_until(self, deadline: float) -> int:
+        """Process callbacks until a deadline, sleeping while idle.
+        
+        Between passes the calling thread blocks until a subscription queues
+        a message or the next timer is due, whichever comes first, instead
+        of polling.
+        
+        Args:
+            deadline: Absolute time in ``time.monotonic()`` seconds
+            
+        Returns:
+            Number of callbacks executed
+        """
+        count = 0
+        while True:
+            # Clear before draining so a message queued mid-pass ends the wait
+            self._wake.clear()
+            count += self.spin_once()
+            
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                return count
+            
+            with self._lock:
+                timers = list(self._timers)
+                pubs = list(self._publishers)
+            timeout = min([remaining]
+                          + [t.time_until_ready() for t in timers]
+                          + [p.time_until_flush() for p in pubs])
+            if timeout > 0:
+                self._wake.wait(timeout)
+    
+    def spin_for(self, duration_sec: float) -> int:
+        """Process callbacks for ``duration_sec``, sleeping while idle."""
+        return self.spin_until(time.monotonic() + duration_sec)
+    
+    def _notify(self) -> None:
+        """Wake a thread blocked in spin_until()."""
+        self._wake.set()
+    
     def destroy(self) -> None:
         """Destroy the node and clean up resources."""
         with self._lock:
@@ -1149,6 +1687,7 @@ class Rate:
 # Commonly used QoS profiles
 qos_profile_sensor_data = QoSProfile.sensor_data()
 qos_profile_default = QoSProfile.default()
+qos_profile_control = QoSProfile.control()
 qos_profile_services = QoSProfile.services()
 qos_profile_parameters = QoSProfile.parameters()
 
@@ -1216,6 +1755,9 @@ class NetworkServer(Generic[MsgT]):
         send_port: int,
         callback: Optional[Callable[[MsgT, str], None]] = None,
         timeout_sec: float = 2.0,
+        traffic_class: TrafficClass = TrafficClass.BEST_EFFORT,
+        fec_group_size: int = 0,
+        transport: Optional['SerialTransport'] = None,
     ):
         """Create a network server.
         
@@ -1226,6 +1768,10 @@ class NetworkServer(Generic[MsgT]):
             send_port: Port to send replies to
             callback: Callback(msg, sender_ip) when message received
             timeout_sec: Time after which a client is considered inactive
+            traffic_class: Traffic class for replies (e.g. VOICE for commands)
+            fec_group_size: Send one FEC parity packet every N replies per device
+            transport: Talk to a tethered device over this transport instead of
+                UDP; the device address is then the transport name
         """
         self._recv_type = recv_type
         self._send_type = send_type
@@ -1235,15 +1781,30 @@ class NetworkServer(Generic[MsgT]):
         self._timeout_sec = timeout_sec
         
         # Socket for receiving and sending
-        self._socket = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
-        self._socket.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
-        self._socket.bind(("0.0.0.0", recv_port))
+        if transport is not None:
+            self._socket = transport.open_channel(recv_port)
+        else:
+            self._socket = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+            self._socket.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+            self._socket.bind(("0.0.0.0", recv_port))
+            apply_traffic_class(self._socket, traffic_class)
         self._socket.setblocking(False)
         
         # Discovered devices
         self._devices: Dict[str, RemoteDevice] = {}
         self._devices_lock = threading.Lock()
         
+        # Forward error correction state: one outgoing stream per device;
+        # incoming frames carry their publisher's stream ID, so one decoder
+        # serves every device (and every path a device sends over)
+        self._fec_group_size = fec_group_size
+        self._fec_encoders: Dict[str, FecEncoder] = {}
+        self._decoder = StreamDecoder()
+        
+        # Extra send sockets for redundant multi-path replies
+        self._traffic_class = traffic_class
+        self._path_sockets: List[socket.socket] = []
+        
         # Statistics
         self._total_recv = 0
         self._total_send = 0
@@ -1280,33 +1841,36 @@ class NetworkServer(Generic[MsgT]):
                 if hasattr(self._recv_type, '_SIZE'):
                     if len(data) < self._recv_type._SIZE:
                         continue
-                
-                # Deserialize
-                if hasattr(self._recv_type, 'deserialize'):
-                    msg = self._recv_type.deserialize(data)
+                    payloads = self._decoder.decode(data, self._recv_type._SIZE)
                 else:
-                    continue
-                
-                # Update device info
-                now = time.time()
-                with self._devices_lock:
-                    if sender_ip not in self._devices:
-                        self._devices[sender_ip] = RemoteDevice(
-                            address=sender_ip,
-                            port=addr[1],
-                            last_seen=now,
-                        )
-                    dev = self._devices[sender_ip]
-                    dev.last_seen = now
-                    dev.recv_count += 1
-                    dev.last_message = msg
+                    payloads = [data]
                 
-                self._total_recv += 1
-                count += 1
+                if not hasattr(self._recv_type, 'deserialize'):
+                    continue
                 
-                # Call user callback
-                if self._callback:
-                    self._callback(msg, sender_ip)
+                for payload in payloads:
+                    msg = self._recv_type.deserialize(payload)
+                    
+                    # Update device info
+                    now = time.time()
+                    with self._devices_lock:
+                        if sender_ip not in self._devices:
+                            self._devices[sender_ip] = RemoteDevice(
+                                address=sender_ip,
+                                port=addr[1],
+                                last_seen=now,
+                            )
+                        dev = self._devices[sender_ip]
+                        dev.last_seen = now
+                        dev.recv_count += 1
+                        dev.last_message = msg
+                    
+                    self._total_recv += 1
+                    count += 1
+                    
+                    # Call user callback
+                    if self._callback:
+                        self._callback(msg, sender_ip)
                     
             except BlockingIOError:
                 break  # No more data
@@ -1328,7 +1892,20 @@ class NetworkServer(Generic[MsgT]):
         try:
             if hasattr(msg, 'serialize'):
                 data = msg.serialize()
-                self._socket.sendto(data, (address, self._send_port))
+                if self._fec_group_size > 1 or self._path_sockets:
+                    encoder = self._fec_encoders.get(address)
+                    if encoder is None:
+                        encoder = FecEncoder(self._fec_group_size)
+                        self._fec_encoders[address] = encoder
+                    for frame in encoder.encode(data):
+                        self._socket.sendto(frame, (address, self._send_port))
+                        for sock in self._path_sockets:
+                            try:
+                                sock.sendto(frame, (address, self._send_port))
+                            except OSError:
+                                pass  # The primary path still carried it
+                else:
+                    self._socket.sendto(data, (address, self._send_port))
                 
                 with self._devices_lock:
                     if address in self._devices:
@@ -1357,9 +1934,30 @@ class NetworkServer(Generic[MsgT]):
                 count += 1
         return count
     
+    def add_path(
+        self,
+        source_address: Optional[str] = None,
+        interface: Optional[str] = None,
+    ) -> None:
+        """Send every reply over an additional local link as well.
+        
+        Replies become sequenced frames; devices keep whichever copy arrives
+        first. Incoming duplicates from devices are dropped per sender.
+        
+        Args:
+            source_address: Local address of the extra link
+            interface: Network interface of the extra link (Linux)
+        """
+        self._path_sockets.append(
+            open_path_socket(self._traffic_class, source_address, interface)
+        )
+    
     def close(self) -> None:
         """Close the server socket."""
         self._socket.close()
+        for sock in self._path_sockets:
+            sock.close()
+        self._path_sockets.clear()
     
     def __enter__(self):
         return self
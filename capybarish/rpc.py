@@ -0,0 +1,327 @@
+"""
+Request/response services, compatible with ``cpy::Service`` and
+``cpy::Client`` (``capybarish_pubsub.h``).
+
+Control-plane operations ("read a motor parameter", "calibrate and
+report") get their own port instead of flags in the command stream. Every
+datagram starts with a 12-byte header::
+
+    u8 magic (0xCC) | u8 kind | u8 status | u8 reserved |
+    u32 correlation id | u16 reply port | u16 payload size   (little-endian)
+
+A request carries the request message; a response with status OK carries
+the response message, any other response is the header alone. Responses
+go back to the address and port the request came from. Nothing is
+retransmitted: a call that gets no response before its timeout fails.
+
+Example Usage:
+    ```python
+    from capybarish.rpc import RpcStatus, ServiceClient
+
+    get_param = ServiceClient(ParamRequest, ParamValue, module_ip, 6670)
+    value = get_param.call(ParamRequest(index=KP), timeout=0.02)
+    if value is None:
+        print("no answer:", get_param.last_status)
+    ```
+
+Copyright 2025 Chen Yu <chenyu@u.northwestern.edu>
+Licensed under the Apache License, Version 2.0
+"""
+
+import os
+import select
+import socket
+import struct
+import threading
+import time
+from enum import IntEnum
+from typing import Any, Callable, Dict, NamedTuple, Optional, Tuple
+
+RPC_MAGIC = 0xCC
+RPC_REQUEST = 1
+RPC_RESPONSE = 2
+
+HEADER = struct.Struct("<BBBBIHH")
+HEADER_SIZE = HEADER.size
+
+
+class RpcStatus(IntEnum):
+    """Outcome of a service call (``cpy::RpcStatus``)."""
+
+    OK = 0
+    REJECTED = 1       # The handler refused the request
+    BAD_REQUEST = 2    # The request does not have the service's request type
+    TIMEOUT = 3        # No response before the deadline (set by the client)
+    CANCELLED = 4      # Given up by the caller (set by the client)
+
+
+class RpcMessage(NamedTuple):
+    """A decoded request or response datagram."""
+
+    kind: int
+    status: int
+    id: int
+    reply_port: int
+    payload: bytes
+
+
+def encode(kind: int, id: int, payload: bytes = b"", status: int = RpcStatus.OK,
+           reply_port: int = 0) -> bytes:
+    """Build a request or response datagram."""
+    return HEADER.pack(RPC_MAGIC, kind, int(status), 0, id, reply_port, len(payload)) + payload
+
+
+def decode(data: bytes) -> Optional[RpcMessage]:
+    """Parse a datagram, or None if it is not a well-formed service datagram."""
+    if len(data) < HEADER_SIZE:
+        return None
+    magic, kind, status, _, id, reply_port, size = HEADER.unpack_from(data)
+    if magic != RPC_MAGIC or len(data) != HEADER_SIZE + size:
+        return None
+    return RpcMessage(kind, status, id, reply_port, data[HEADER_SIZE:])
+
+
+class ServiceClient:
+    """Calls a service, matching responses to requests by correlation ID.
+
+    Only datagrams from the service's address and port count as
+    responses; anything else is dropped (:attr:`drop_count`). Correlation
+    IDs start at a random value, so a response meant for an earlier run
+    of the client is not taken for one of this run's calls.
+
+    At most ``max_pending`` calls can be outstanding. :meth:`send` and
+    :meth:`take` poll without blocking; :meth:`call` blocks until the
+    response or the timeout.
+    """
+
+    def __init__(
+        self,
+        request_type: Any,
+        response_type: Any,
+        address: str,
+        port: int,
+        local_port: int = 0,
+        max_pending: int = 4,
+    ):
+        """
+        Args:
+            request_type: Generated request message class.
+            response_type: Generated response message class.
+            address: Address of the node running the service.
+            port: Service port.
+            local_port: Port for responses (0 = any).
+            max_pending: Calls that can be outstanding at once.
+        """
+        self._request_type = request_type
+        self._response_type = response_type
+        self._server = (socket.gethostbyname(address), port)
+        self._max_pending = max_pending
+        self._next_id = int.from_bytes(os.urandom(4), "little") or 1
+
+        # id -> [deadline (monotonic, None = never), status or None, response, sent at]
+        self._pending: Dict[int, list] = {}
+
+        self._sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self._sock.bind(("", local_port))
+        self._sock.setblocking(False)
+
+        self.last_status: Optional[RpcStatus] = None
+        self.last_round_trip = 0.0
+        self.busy_count = 0
+        self.timeout_count = 0
+        self.late_count = 0
+        self.drop_count = 0
+
+    @property
+    def local_port(self) -> int:
+        return self._sock.getsockname()[1]
+
+    @property
+    def pending_count(self) -> int:
+        """Calls waiting for a response."""
+        return sum(1 for entry in self._pending.values() if entry[1] is None)
+
+    def send(self, request: Any, timeout: Optional[float] = 0.1) -> int:
+        """Send a request.
+
+        Args:
+            request: Request message.
+            timeout: Seconds to wait for the response (None = never).
+
+        Returns:
+            The call's correlation ID, 0 if ``max_pending`` calls are
+            already outstanding.
+        """
+        if len(self._pending) >= self._max_pending:
+            self.busy_count += 1
+            return 0
+        id = self._next_id
+        self._next_id = (self._next_id + 1) & 0xFFFFFFFF or 1
+        now = time.monotonic()
+        self._sock.sendto(encode(RPC_REQUEST, id, request.serialize(), reply_port=self.local_port),
+                          self._server)
+        self._pending[id] = [None if timeout is None else now + timeout, None, None, now]
+        return id
+
+    def poll(self) -> int:
+        """Collect pending responses and expire deadlines.
+
+        Returns:
+            Number of calls finished.
+        """
+        finished = 0
+        while True:
+            try:
+                data, sender = self._sock.recvfrom(HEADER_SIZE + self._response_type._SIZE + 1)
+            except (BlockingIOError, InterruptedError):
+                break
+            msg = decode(data)
+            if msg is None or msg.kind != RPC_RESPONSE or sender[:2] != self._server:
+                self.drop_count += 1
+                continue
+            entry = self._pending.get(msg.id)
+            if entry is None or entry[1] is not None:
+                self.late_count += 1
+                continue
+            try:
+                status = RpcStatus(msg.status)
+            except ValueError:
+                continue
+            if status == RpcStatus.OK:
+                if len(msg.payload) != self._response_type._SIZE:
+                    continue
+                entry[2] = self._response_type.deserialize(msg.payload)
+            entry[1] = status
+            self.last_round_trip = time.monotonic() - entry[3]
+            finished += 1
+
+        now = time.monotonic()
+        for entry in self._pending.values():
+            if entry[1] is None and entry[0] is not None and now >= entry[0]:
+                entry[1] = RpcStatus.TIMEOUT
+                self.timeout_count += 1
+                finished += 1
+        return finished
+
+    def take(self, id: int) -> Optional[Tuple[RpcStatus, Any]]:
+        """Take the outcome of a finished call, freeing its slot.
+
+        Returns:
+            (status, response or None), or None while the call is pending
+            (or if ``id`` is unknown).
+        """
+        self.poll()
+        entry = self._pending.get(id)
+        if entry is None or entry[1] is None:
+            return None
+        del self._pending[id]
+        self.last_status = entry[1]
+        return entry[1], entry[2]
+
+    def cancel(self, id: int) -> bool:
+        """Give up on a call; a late response is dropped."""
+        return self._pending.pop(id, None) is not None
+
+    def call(self, request: Any, timeout: float = 0.1) -> Optional[Any]:
+        """Send a request and wait for the response.
+
+        Returns:
+            The response, or None on timeout, rejection or a full table
+            (see :attr:`last_status`).
+        """
+        id = self.send(request, timeout)
+        if id == 0:
+            self.last_status = None
+            return None
+        while True:
+            result = self.take(id)
+            if result is not None:
+                status, response = result
+                return response if status == RpcStatus.OK else None
+            left = self._pending[id][0] - time.monotonic()
+            select.select([self._sock], [], [], max(left, 0.0))
+
+    def close(self) -> None:
+        self._sock.close()
+
+
+class Service:
+    """Answers requests on a port (the Python side of ``cpy::Service``).
+
+    The handler returns the response, or None to reject the request.
+    """
+
+    def __init__(
+        self,
+        request_type: Any,
+        response_type: Any,
+        handler: Callable[[Any], Optional[Any]],
+        port: int,
+        address: str = "",
+    ):
+        self._request_type = request_type
+        self._response_type = response_type
+        self._handler = handler
+        self._sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self._sock.bind((address, port))
+        self._sock.settimeout(0.1)
+        self._thread: Optional[threading.Thread] = None
+        self._running = False
+
+        self.call_count = 0
+        self.reject_count = 0
+        self.bad_request_count = 0
+
+    @property
+    def port(self) -> int:
+        return self._sock.getsockname()[1]
+
+    def handle_datagram(self, data: bytes) -> Optional[bytes]:
+        """Answer one datagram.
+
+        Returns:
+            The response datagram, or None if ``data`` is not a request.
+        """
+        msg = decode(data)
+        if msg is None or msg.kind != RPC_REQUEST or msg.id == 0:
+            return None
+        self.call_count += 1
+        if len(msg.payload) != self._request_type._SIZE:
+            self.bad_request_count += 1
+            return encode(RPC_RESPONSE, msg.id, status=RpcStatus.BAD_REQUEST, reply_port=self.port)
+        response = self._handler(self._request_type.deserialize(msg.payload))
+        if response is None:
+            self.reject_count += 1
+            return encode(RPC_RESPONSE, msg.id, status=RpcStatus.REJECTED, reply_port=self.port)
+        return encode(RPC_RESPONSE, msg.id, response.serialize(), reply_port=self.port)
+
+    def spin_once(self) -> bool:
+        """Wait up to 0.1 s for a request and answer it."""
+        try:
+            data, sender = self._sock.recvfrom(HEADER_SIZE + self._request_type._SIZE + 1)
+        except socket.timeout:
+            return False
+        reply = self.handle_datagram(data)
+        if reply is not None:
+            self._sock.sendto(reply, sender)
+        return reply is not None
+
+    def start(self) -> None:
+        """Answer requests on a background thread."""
+        self._running = True
+        self._thread = threading.Thread(target=self._loop, daemon=True)
+        self._thread.start()
+
+    def stop(self) -> None:
+        self._running = False
+        if self._thread:
+            self._thread.join(timeout=1.0)
+            self._thread = None
+        self._sock.close()
+
+    def _loop(self) -> None:
+        while self._running:
+            try:
+                self.spin_once()
+            except OSError:
+                break
@@ -0,0 +1,373 @@
+"""
+Serial / USB-CDC transport for pub/sub topics.
+
+Carries the same datagrams as the UDP path over a serial line, so modules
+tethered over USB keep their message code. This module mirrors
+``capybarish_serial.h`` on the ESP32 side byte for byte: each datagram is
+sent as
+
+    0x00 COBS(port:u16 | datagram | crc16:u16) 0x00
+
+with little-endian fields and CRC-16/CCITT-FALSE over port and datagram.
+The port plays the role of the UDP port, so several topics share one line.
+
+``SerialTransport`` configures the line with termios (raw mode, no flow
+control) and hands out socket-like channels, one per port, which the
+pub/sub classes use in place of UDP sockets. It works against a
+pseudo-terminal (``open_pty``) for testing without hardware.
+
+Example Usage:
+    ```python
+    import capybarish as cpy
+    from capybarish.serial_transport import SerialTransport
+
+    usb = SerialTransport('/dev/ttyACM0', baudrate=921600)
+    node = cpy.Node('bench', transport=usb)  # Every topic now goes over USB
+    ```
+
+Copyright 2025 Chen Yu <chenyu@u.northwestern.edu>
+Licensed under the Apache License, Version 2.0
+"""
+
+import binascii
+import os
+import queue
+import select
+import socket
+import struct
+import threading
+import time
+from typing import Dict, List, Optional, Tuple, Union
+
+try:
+    import termios
+    import tty
+except ImportError:  # Windows
+    termios = None
+    tty = None
+
+_PORT = struct.Struct('<H')
+_CRC = struct.Struct('<H')
+
+
+# =============================================================================
+# COBS and CRC
+# =============================================================================
+
+def cobs_encode(data: bytes) -> bytes:
+    """COBS-encode ``data`` (no delimiter)."""
+    out = bytearray()
+    block = bytearray()
+    for byte in data:
+        if byte == 0:
+            out.append(len(block) + 1)
+            out += block
+            block.clear()
+        else:
+            block.append(byte)
+            if len(block) == 254:
+                out.append(255)
+                out += block
+                block.clear()
+    out.append(len(block) + 1)
+    out += block
+    return bytes(out)
+
+
+def cobs_decode(data: bytes) -> bytes:
+    """Decode one COBS packet (no delimiter).
+
+    Raises:
+        ValueError: If the packet is malformed
+    """
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        i += 1
+        end = i + code - 1
+        if code == 0 or end > len(data) or 0 in data[i:end]:
+            raise ValueError("Malformed COBS packet")
+        out += data[i:end]
+        i = end
+        if code != 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def crc16(data: bytes) -> int:
+    """CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)."""
+    return binascii.crc_hqx(data, 0xFFFF)
+
+
+def encode_packet(port: int, datagram: bytes) -> bytes:
+    """Frame one datagram for the serial line, delimiters included."""
+    raw = _PORT.pack(port) + datagram
+    return b'\x00' + cobs_encode(raw + _CRC.pack(crc16(raw))) + b'\x00'
+
+
+class PacketDecoder:
+    """Splits a serial byte stream into (port, datagram) pairs."""
+
+    def __init__(self, max_datagram: int = 512):
+        self._max_encoded = max_datagram + 4 + (max_datagram + 4) // 254 + 1
+        self._buffer = bytearray()
+        self._discard = False
+        self.crc_errors = 0
+        self.framing_errors = 0
+
+    def feed(self, data: bytes) -> List[Tuple[int, bytes]]:
+        """Consume received bytes, returning every complete datagram."""
+        packets = []
+        for chunk_end, chunk in enumerate(data.split(b'\x00')):
+            if chunk_end > 0:
+                self._finish(packets)
+            if len(self._buffer) + len(chunk) > self._max_encoded:
+                self._discard = True  # Oversized: skip to the next delimiter
+                self._buffer.clear()
+            elif not self._discard:
+                self._buffer += chunk
+        return packets
+
+    def _finish(self, packets: List[Tuple[int, bytes]]) -> None:
+        if self._discard:
+            self.framing_errors += 1
+        elif self._buffer:
+            try:
+                raw = cobs_decode(bytes(self._buffer))
+            except ValueError:
+                raw = b''
+            if len(raw) < 4:
+                self.framing_errors += 1
+            elif crc16(raw[:-2]) != _CRC.unpack_from(raw, len(raw) - 2)[0]:
+                self.crc_errors += 1
+            else:
+                packets.append((_PORT.unpack_from(raw)[0], raw[2:-2]))
+        self._buffer.clear()
+        self._discard = False
+
+
+# =============================================================================
+# termios helpers
+# =============================================================================
+
+def configure_line(fd: int, baudrate: int) -> None:
+    """Put a tty in raw 8N1 mode at ``baudrate`` without flow control.
+
+    USB-CDC devices ignore the baud rate, but it must still be valid.
+    """
+    if termios is None:
+        raise OSError("Serial transport needs termios (POSIX)")
+    speed = getattr(termios, f'B{baudrate}', None)
+    if speed is None:
+        raise ValueError(f"Unsupported baud rate: {baudrate}")
+
+    tty.setraw(fd)
+    attrs = termios.tcgetattr(fd)
+    attrs[2] |= termios.CLOCAL | termios.CREAD
+    attrs[2] &= ~getattr(termios, 'CRTSCTS', 0)
+    attrs[4] = attrs[5] = speed
+    attrs[6][termios.VMIN] = 0
+    attrs[6][termios.VTIME] = 0
+    termios.tcsetattr(fd, termios.TCSANOW, attrs)
+
+
+def open_pty() -> Tuple[int, str]:
+    """Open a pseudo-terminal pair for testing.
+
+    Returns:
+        (master_fd, slave_path): pass the master fd to one SerialTransport
+        and the slave path to another (or to a device simulator).
+    """
+    master, slave = os.openpty()
+    path = os.ttyname(slave)
+    os.close(slave)
+    return master, path
+
+
+# =============================================================================
+# Serial Transport
+# =============================================================================
+
+class SerialChannel:
+    """Socket-like endpoint for one port of a SerialTransport.
+
+    Implements the subset of ``socket.socket`` the pub/sub classes use, so a
+    channel can stand in for a UDP socket. ``recvfrom`` reports the
+    transport name and this channel's port as the address.
+    """
+
+    def __init__(self, transport: 'SerialTransport', port: Optional[int], depth: int = 256):
+        self._transport = transport
+        self._port = port
+        self._queue: queue.Queue = queue.Queue(maxsize=depth)
+        self._timeout: Optional[float] = None
+        self.dropped = 0
+
+    @property
+    def port(self) -> Optional[int]:
+        return self._port
+
+    def _put(self, datagram: bytes) -> None:
+        try:
+            self._queue.put_nowait(datagram)
+        except queue.Full:
+            self.dropped += 1
+
+    def sendto(self, data: bytes, address: Tuple[str, int]) -> int:
+        """Send to ``address[1]`` on the other end (the host part is ignored)."""
+        self._transport.send(address[1], data)
+        return len(data)
+
+    def recvfrom(self, bufsize: int) -> Tuple[bytes, Tuple[str, int]]:
+        try:
+            if self._timeout == 0.0:
+                data = self._queue.get_nowait()
+            else:
+                data = self._queue.get(timeout=self._timeout)
+        except queue.Empty:
+            if self._timeout == 0.0:
+                raise BlockingIOError("No datagram pending") from None
+            raise socket.timeout("timed out") from None
+        return data[:bufsize], (self._transport.name, self._port)
+
+    def settimeout(self, timeout: Optional[float]) -> None:
+        self._timeout = timeout
+
+    def setblocking(self, flag: bool) -> None:
+        self._timeout = None if flag else 0.0
+
+    def setsockopt(self, *args) -> None:
+        raise OSError("Socket options do not apply to a serial channel")
+
+    def getsockname(self) -> Tuple[str, Optional[int]]:
+        return self._transport.name, self._port
+
+    def close(self) -> None:
+        self._transport._release(self)
+
+
+class SerialTransport:
+    """Datagram transport over a serial line (USB-CDC, UART, pty).
+
+    A background thread reads the line and dispatches datagrams to the
+    channel opened for their port; datagrams for other ports are counted
+    in ``unrouted``.
+    """
+
+    def __init__(
+        self,
+        device: Union[str, int],
+        baudrate: int = 921600,
+        max_datagram: int = 512,
+    ):
+        """Open a serial device.
+
+        Args:
+            device: Device path (e.g. '/dev/ttyACM0') or an open tty fd
+            baudrate: Line rate for real UARTs
+            max_datagram: Largest datagram carried (bytes)
+        """
+        if isinstance(device, int):
+            self._fd = device
+            self._name = f"fd{device}"
+        else:
+            self._fd = os.open(device, os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK)
+            self._name = device
+        try:
+            configure_line(self._fd, baudrate)
+            os.set_blocking(self._fd, False)
+        except Exception:
+            if not isinstance(device, int):
+                os.close(self._fd)
+            raise
+
+        self._max_datagram = max_datagram
+        self._decoder = PacketDecoder(max_datagram)
+        self._channels: Dict[int, SerialChannel] = {}
+        self._lock = threading.Lock()
+        self._write_lock = threading.Lock()
+        self.unrouted = 0
+
+        self._running = True
+        self._reader = threading.Thread(target=self._read_loop, daemon=True)
+        self._reader.start()
+
+    @property
+    def name(self) -> str:
+        """Device name, used as the peer address of received datagrams."""
+        return self._name
+
+    @property
+    def crc_errors(self) -> int:
+        return self._decoder.crc_errors
+
+    @property
+    def framing_errors(self) -> int:
+        return self._decoder.framing_errors
+
+    def fileno(self) -> int:
+        return self._fd
+
+    def open_channel(self, port: Optional[int] = None) -> SerialChannel:
+        """Open the socket-like endpoint for ``port`` (None: send only)."""
+        channel = SerialChannel(self, port)
+        if port is not None:
+            with self._lock:
+                if port in self._channels:
+                    raise OSError(f"Port {port} is already open on {self._name}")
+                self._channels[port] = channel
+        return channel
+
+    def send(self, port: int, datagram: bytes) -> None:
+        """Send one datagram to ``port`` on the other end."""
+        if len(datagram) > self._max_datagram:
+            raise ValueError(f"Datagram too large: {len(datagram)} > {self._max_datagram}")
+        packet = memoryview(encode_packet(port, datagram))
+        with self._write_lock:
+            while packet:
+                try:
+                    packet = packet[os.write(self._fd, packet):]
+                except BlockingIOError:
+                    select.select([], [self._fd], [], 0.1)
+
+    def close(self) -> None:
+        """Stop the reader and close the device."""
+        if not self._running:
+            return
+        self._running = False
+        self._reader.join(timeout=1.0)
+        os.close(self._fd)
+
+    def _release(self, channel: SerialChannel) -> None:
+        with self._lock:
+            if self._channels.get(channel.port) is channel:
+                del self._channels[channel.port]
+
+    def _read_loop(self) -> None:
+        while self._running:
+            try:
+                ready, _, _ = select.select([self._fd], [], [], 0.1)
+                if not ready:
+                    continue
+                data = os.read(self._fd, 4096)
+            except (BlockingIOError, InterruptedError):
+                continue
+            except OSError:
+                # pty peer closed (EIO) or device unplugged; poll again
+                time.sleep(0.05)
+                continue
+
+            for port, datagram in self._decoder.feed(data):
+                with self._lock:
+                    channel = self._channels.get(port)
+                if channel is None:
+                    self.unrouted += 1
+                else:
+                    channel._put(datagram)
+
+    def __enter__(self) -> 'SerialTransport':
+        return self
+
+    def __exit__(self, *args) -> None:
+        self.close()
@@ -0,0 +1,286 @@
+"""
+Convert on-device Node traces to Chrome/Perfetto trace JSON.
+
+``cpy::TraceRecorder::dump()`` (``capybarish_trace.h``) writes a compact
+binary trace: a table of entities (the node, its publishers, subscriptions,
+timers and coroutines) followed by 10-byte events. This module parses that
+blob and emits the Trace Event Format understood by ui.perfetto.dev and
+chrome://tracing:
+
+- one process per dump, named after its node
+- one track per entity, with a slice for every callback
+- instant events for packet arrivals and publishes
+- a counter track of lateness per timer
+- "idle" slices on the node track while it sleeps
+
+A dump is usually captured from the serial port together with log text, so
+the parser looks for the ``CPYTRACE`` magic instead of expecting it at
+offset 0. Several dumps (from one capture or several boards) become
+separate processes in the same trace.
+
+Example Usage:
+    ```python
+    from capybarish.trace import parse_traces, to_chrome_json
+
+    with open("capture.bin", "rb") as f:
+        traces = parse_traces(f.read())
+    with open("trace.json", "w") as f:
+        json.dump(to_chrome_json(traces), f)
+    ```
+
+or from the command line::
+
+    capybarish trace capture.bin -o trace.json
+
+Copyright 2025 Chen Yu <chenyu@u.northwestern.edu>
+Licensed under the Apache License, Version 2.0
+"""
+
+import argparse
+import json
+import struct
+import sys
+from dataclasses import dataclass, field
+from typing import Any, Dict, List, Optional, Tuple
+
+TRACE_MAGIC = b"CPYTRACE"
+FORMAT_VERSION = 1
+
+# TraceEventType
+CALLBACK_BEGIN = 1
+CALLBACK_END = 2
+PACKET = 3
+PUBLISH = 4
+TIMER_LATENESS = 5
+IDLE_BEGIN = 6
+IDLE_END = 7
+
+# TraceEntityKind
+KIND_NODE = 0
+KIND_SUBSCRIPTION = 1
+KIND_PUBLISHER = 2
+KIND_TIMER = 3
+KIND_COROUTINES = 4
+KIND_SERVICE = 5
+KIND_CLIENT = 6
+
+KIND_NAMES = {
+    KIND_NODE: "node",
+    KIND_SUBSCRIPTION: "sub",
+    KIND_PUBLISHER: "pub",
+    KIND_TIMER: "timer",
+    KIND_COROUTINES: "coro",
+    KIND_SERVICE: "srv",
+    KIND_CLIENT: "client",
+}
+
+_HEADER = struct.Struct("<8sHHII")
+_EVENT = struct.Struct("<IIBB")
+
+
+@dataclass
+class TraceEntity:
+    """A track registered with ``TraceRecorder::addEntity()``."""
+    kind: int
+    name: str
+
+
+@dataclass
+class TraceEvent:
+    """One event; ``time_us`` is unwrapped to 64 bits."""
+    time_us: int
+    arg: int
+    type: int
+    entity: int
+
+
+@dataclass
+class Trace:
+    """One dump of a TraceRecorder."""
+    entities: List[TraceEntity] = field(default_factory=list)
+    events: List[TraceEvent] = field(default_factory=list)
+    dropped: int = 0
+
+    @property
+    def node_name(self) -> str:
+        for entity in self.entities:
+            if entity.kind == KIND_NODE:
+                return entity.name
+        return "node"
+
+
+def parse_trace(data: bytes, offset: int = 0) -> Tuple[Trace, int]:
+    """Parse the dump starting at ``offset``.
+
+    Returns:
+        The trace and the offset just past it.
+
+    Raises:
+        ValueError: If there is no valid dump at ``offset`` or it is cut short.
+    """
+    if len(data) - offset < _HEADER.size:
+        raise ValueError("truncated trace header")
+    magic, version, n_entities, n_events, dropped = _HEADER.unpack_from(data, offset)
+    if magic != TRACE_MAGIC:
+        raise ValueError("not a capybarish trace")
+    if version != FORMAT_VERSION:
+        raise ValueError(f"unsupported trace version {version}")
+    pos = offset + _HEADER.size
+
+    trace = Trace(dropped=dropped)
+    for _ in range(n_entities):
+        if pos + 2 > len(data):
+            raise ValueError("truncated entity table")
+        kind, length = data[pos], data[pos + 1]
+        name = data[pos + 2:pos + 2 + length]
+        if len(name) != length:
+            raise ValueError("truncated entity table")
+        trace.entities.append(TraceEntity(kind, name.decode("utf-8", "replace")))
+        pos += 2 + length
+
+    end = pos + n_events * _EVENT.size
+    if end > len(data):
+        raise ValueError("truncated event list")
+
+    # Timestamps are micros() and wrap every ~71.6 minutes
+    high = 0
+    last = None
+    for time_us, arg, kind, entity in _EVENT.iter_unpack(data[pos:end]):
+        if last is not None and time_us < last and last - time_us > 0x80000000:
+            high += 1 << 32
+        last = time_us
+        trace.events.append(TraceEvent(high + time_us, arg, kind, entity))
+    return trace, end
+
+
+def parse_traces(data: bytes) -> List[Trace]:
+    """Find and parse every dump in ``data``, skipping anything between them."""
+    traces = []
+    pos = data.find(TRACE_MAGIC)
+    while pos >= 0:
+        try:
+            trace, end = parse_trace(data, pos)
+        except ValueError:
+            end = pos + len(TRACE_MAGIC)
+        else:
+            traces.append(trace)
+        pos = data.find(TRACE_MAGIC, end)
+    return traces
+
+
+def to_chrome_json(traces: List[Trace], relative: bool = True) -> Dict[str, Any]:
+    """Convert traces to the Chrome Trace Event Format.
+
+    Args:
+        traces: Parsed dumps; each becomes a process (pid 1, 2, ...).
+        relative: Start each trace at time 0 instead of at its raw nowUs().
+
+    Returns:
+        A dict ready for ``json.dump``.
+    """
+    out: List[Dict[str, Any]] = []
+    for pid, trace in enumerate(traces, start=1):
+        out.append({"ph": "M", "pid": pid, "name": "process_name",
+                    "args": {"name": trace.node_name}})
+        if trace.dropped:
+            out.append({"ph": "M", "pid": pid, "name": "process_labels",
+                        "args": {"labels": f"{trace.dropped} older events dropped"}})
+        for index, entity in enumerate(trace.entities):
+            label = entity.name if entity.kind in (KIND_NODE, KIND_COROUTINES) \
+                else f"{KIND_NAMES.get(entity.kind, '?')} {entity.name}"
+            out.append({"ph": "M", "pid": pid, "tid": index + 1, "name": "thread_name",
+                        "args": {"name": label}})
+            out.append({"ph": "M", "pid": pid, "tid": index + 1, "name": "thread_sort_index",
+                        "args": {"sort_index": index}})
+
+        origin = trace.events[0].time_us if relative and trace.events else 0
+        # Events from before the ring wrapped may have lost their BEGIN
+        open_slices: Dict[int, int] = {}
+        for event in trace.events:
+            if event.entity >= len(trace.entities):
+                continue
+            entity = trace.entities[event.entity]
+            base = {"pid": pid, "tid": event.entity + 1, "ts": event.time_us - origin}
+
+            if event.type == CALLBACK_BEGIN:
+                open_slices[event.entity] = open_slices.get(event.entity, 0) + 1
+                out.append({**base, "ph": "B", "name": entity.name, "cat": "callback"})
+            elif event.type == CALLBACK_END:
+                if open_slices.get(event.entity, 0) > 0:
+                    open_slices[event.entity] -= 1
+                    out.append({**base, "ph": "E", "name": entity.name, "cat": "callback"})
+            elif event.type == IDLE_BEGIN:
+                open_slices[event.entity] = open_slices.get(event.entity, 0) + 1
+                out.append({**base, "ph": "B", "name": "idle", "cat": "idle",
+                            "args": {"budget_us": event.arg}})
+            elif event.type == IDLE_END:
+                if open_slices.get(event.entity, 0) > 0:
+                    open_slices[event.entity] -= 1
+                    out.append({**base, "ph": "E", "name": "idle", "cat": "idle"})
+            elif event.type == PACKET:
+                out.append({**base, "ph": "i", "s": "t", "name": "packet", "cat": "net",
+                            "args": {"bytes": event.arg}})
+            elif event.type == PUBLISH:
+                out.append({**base, "ph": "i", "s": "t", "name": "publish", "cat": "net",
+                            "args": {"bytes": event.arg}})
+            elif event.type == TIMER_LATENESS:
+                out.append({"pid": pid, "ts": base["ts"], "ph": "C",
+                            "name": f"{entity.name} lateness", "args": {"us": event.arg}})
+
+    return {"traceEvents": out, "displayTimeUnit": "ms"}
+
+
+def create_parser() -> argparse.ArgumentParser:
+    parser = argparse.ArgumentParser(
+        prog="capybarish trace",
+        description="Convert capybarish Node trace dumps to Chrome/Perfetto JSON",
+    )
+    add_arguments(parser)
+    return parser
+
+
+def add_arguments(parser: argparse.ArgumentParser) -> None:
+    parser.add_argument(
+        "inputs",
+        nargs="+",
+        help="Binary dumps or serial captures containing them",
+    )
+    parser.add_argument(
+        "--output", "-o",
+        help="Output JSON file (default: stdout)",
+    )
+    parser.add_argument(
+        "--absolute",
+        action="store_true",
+        help="Keep device timestamps instead of starting each trace at 0",
+    )
+
+
+def run(args: argparse.Namespace) -> int:
+    traces: List[Trace] = []
+    for path in args.inputs:
+        with open(path, "rb") as f:
+            found = parse_traces(f.read())
+        if not found:
+            print(f"No trace found in {path}", file=sys.stderr)
+        traces.extend(found)
+    if not traces:
+        return 1
+
+    document = to_chrome_json(traces, relative=not args.absolute)
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(document, f)
+        n_events = sum(len(t.events) for t in traces)
+        print(f"Wrote {len(traces)} trace(s), {n_events} events to {args.output}")
+    else:
+        json.dump(document, sys.stdout)
+    return 0
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    return run(create_parser().parse_args(argv))
+
+
+if __name__ == "__main__":
+    sys.exit(main())
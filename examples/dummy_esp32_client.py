@@ -27,6 +27,9 @@ Usage:
     # Custom server address (if server is on another machine)
     python dummy_esp32_client.py --module-id 1 --server-ip 192.168.1.100
 
+    # Fleet-scale load (100+ modules at up to kHz rates): use the native
+    # generator in swarm_loadgen.cpp, which runs all modules in one thread
+
 Requirements:
     - Server (basic_usage_pubsub.py) should be running
     - On Linux, binding to 127.0.0.x IPs works out of the box
@@ -0,0 +1,587 @@
+/**
+ * @file swarm_loadgen.cpp
+ * @brief Native load generator simulating a fleet of ESP32 modules
+ *
+ * The C++ counterpart of dummy_esp32_client.py for stress tests. N virtual
+ * modules run in one process and one thread: each publishes SensorData to
+ * the server and consumes MotorCommand with the same motor dynamics as the
+ * Python client. A single scheduler (timerfd + epoll, 1 ns timer slack)
+ * staggers the modules evenly over the period, so 100 modules at 1 kHz are
+ * one send every 10 us rather than 100-packet bursts.
+ *
+ * Each module gets its own address, the way the server tells devices
+ * apart:
+ *
+ * - ip mode (default): module i binds 127.0.0.(i+1):command-port, like
+ *   dummy_esp32_client.py. Works with basic_usage_pubsub.py unchanged.
+ * - port mode: module i binds base-ip:(command-port + i), for servers that
+ *   reply to the sender's address.
+ *
+ * Latency: MotorCommand.timestamp is the server's clock (seconds since it
+ * started), so each arrival is compared against it after removing the
+ * clock offset. The offset is the smallest (arrival - timestamp) seen over
+ * the warm-up, so the figures are delay above the fastest delivery in the
+ * run, per module. The server's float32 timestamp limits resolution to
+ * ~8 us after two minutes of server uptime.
+ *
+ * Linux only. Build and run from the repository root:
+ * @code
+ * g++ -O2 -std=c++20 -I capybarish/generated examples/swarm_loadgen.cpp -o swarm_loadgen
+ * ./swarm_loadgen --modules 100 --rate 1000 --duration 30
+ * ./swarm_loadgen --modules 300 --mode port --server-ip 192.168.1.100 --csv fleet.csv
+ * @endcode
+ *
+ * Loopback sockets drop under overload like a real network would; raise
+ * net.core.rmem_max/rmem_default on the server side before blaming it.
+ *
+ * @author Chen Yu <chenyu@u.northwestern.edu>
+ * @copyright 2025 Chen Yu
+ * @license Apache-2.0
+ */
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "motor_control_messages.hpp"
+
+using motor_control::MotorCommand;
+using motor_control::SensorData;
+
+// =============================================================================
+// Configuration
+// =============================================================================
+
+constexpr float MOTOR_TIME_CONSTANT = 0.1f;  // Seconds
+constexpr float MOTOR_MAX_VELOCITY = 10.0f;  // rad/s
+constexpr float MOTOR_NOISE_STD = 0.001f;    // rad
+
+struct Options {
+    int modules = 100;
+    double rateHz = 1000.0;
+    double durationS = 10.0;
+    double warmupS = 1.0;
+    double reportS = 1.0;
+    std::string serverIp = "127.0.0.1";
+    uint16_t serverPort = 6666;
+    uint16_t commandPort = 6667;
+    bool portMode = false;
+    std::string baseIp = "127.0.0.1";
+    std::string csvPath;
+};
+
+static volatile sig_atomic_t g_running = 1;
+
+static void onSignal(int) { g_running = 0; }
+
+static int64_t nowNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// =============================================================================
+// Latency Histogram
+// =============================================================================
+
+/**
+ * @brief Log-linear histogram of microsecond values (~6% resolution)
+ *
+ * 16 linear buckets per power of two, exact below 16 us, up to ~2^32 us.
+ */
+class Histogram {
+public:
+    void add(uint32_t us) {
+        _buckets[_index(us)]++;
+        _count++;
+        _sum += us;
+        _max = std::max(_max, us);
+    }
+
+    void merge(const Histogram& other) {
+        for (size_t i = 0; i < BUCKETS; i++) _buckets[i] += other._buckets[i];
+        _count += other._count;
+        _sum += other._sum;
+        _max = std::max(_max, other._max);
+    }
+
+    void clear() { *this = Histogram(); }
+
+    /**
+     * @return Upper bound of the bucket holding quantile @p q (0..1)
+     */
+    uint32_t percentile(double q) const {
+        if (_count == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(std::ceil(q * _count));
+        if (rank == 0) rank = 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; i++) {
+            seen += _buckets[i];
+            if (seen >= rank) return std::min(_upper(i), _max);
+        }
+        return _max;
+    }
+
+    uint64_t count() const { return _count; }
+    uint32_t max() const { return _max; }
+    double mean() const { return _count ? static_cast<double>(_sum) / _count : 0.0; }
+
+private:
+    static constexpr int SUB_BITS = 4;
+    static constexpr size_t SUB = 1 << SUB_BITS;
+    static constexpr size_t BUCKETS = SUB * (33 - SUB_BITS);
+
+    static size_t _index(uint32_t v) {
+        if (v < SUB) return v;
+        int msb = 31 - __builtin_clz(v);
+        int shift = msb - SUB_BITS;
+        return (shift + 1) * SUB + ((v >> shift) & (SUB - 1));
+    }
+
+    static uint32_t _upper(size_t i) {
+        if (i < SUB) return static_cast<uint32_t>(i);
+        size_t shift = i / SUB - 1;
+        uint64_t base = (SUB + i % SUB) << shift;
+        return static_cast<uint32_t>(std::min<uint64_t>(base + (1ull << shift) - 1, UINT32_MAX));
+    }
+
+    uint32_t _buckets[BUCKETS] = {};
+    uint64_t _count = 0;
+    uint64_t _sum = 0;
+    uint32_t _max = 0;
+};
+
+// =============================================================================
+// Virtual Module
+// =============================================================================
+
+/**
+ * @brief Motor dynamics of dummy_esp32_client.MotorState
+ */
+struct MotorState {
+    float position = 0.0f;
+    float velocity = 0.0f;
+    float torque = 0.0f;
+    float target = 0.0f;
+    float targetVel = 0.0f;
+    float kp = 10.0f;
+    float kd = 0.5f;
+    bool enabled = false;
+
+    void update(float dt) {
+        if (!enabled) {
+            velocity *= 0.9f;
+            position += velocity * dt;
+            torque = 0.0f;
+            return;
+        }
+
+        torque = kp * (target - position) + kd * (targetVel - velocity);
+        velocity += torque * 10.0f * dt;  // Simplified inertia
+        velocity = std::clamp(velocity, -MOTOR_MAX_VELOCITY, MOTOR_MAX_VELOCITY);
+        position += velocity * dt;
+
+        float alpha = dt / (dt + MOTOR_TIME_CONSTANT);
+        velocity = (1 - alpha) * velocity + alpha * targetVel;
+    }
+};
+
+struct Module {
+    int id = 0;
+    int fd = -1;
+    sockaddr_in local = {};
+    MotorState motor;
+    float lastCommandTimestamp = 0.0f;
+    int64_t lastSendNs = 0;
+
+    uint64_t sent = 0;
+    uint64_t sendErrors = 0;
+    uint64_t received = 0;
+    uint64_t malformed = 0;
+    Histogram latency;   // Whole run after warm-up
+    Histogram interval;  // Current report interval
+
+    std::string address() const {
+        char ip[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &local.sin_addr, ip, sizeof(ip));
+        return std::string(ip) + ":" + std::to_string(ntohs(local.sin_port));
+    }
+};
+
+/**
+ * @brief Open module @p id's socket, used for both feedback and commands
+ */
+static bool openModule(Module& m, int id, const Options& opt) {
+    m.id = id;
+    m.local.sin_family = AF_INET;
+    if (opt.portMode) {
+        inet_pton(AF_INET, opt.baseIp.c_str(), &m.local.sin_addr);
+        m.local.sin_port = htons(static_cast<uint16_t>(opt.commandPort + id));
+    } else {
+        // 127.0.0.1, 127.0.0.2, ... carrying into the third octet past .254
+        uint32_t host = (127u << 24) + 1 + (id / 254) * 256 + (id % 254);
+        m.local.sin_addr.s_addr = htonl(host);
+        m.local.sin_port = htons(opt.commandPort);
+    }
+
+    m.fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m.fd < 0) {
+        fprintf(stderr, "[Module %d] socket: %s\n", id, strerror(errno));
+        return false;
+    }
+    int one = 1;
+    setsockopt(m.fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(m.fd, reinterpret_cast<sockaddr*>(&m.local), sizeof(m.local)) != 0) {
+        fprintf(stderr, "[Module %d] bind %s: %s\n", id, m.address().c_str(), strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+// =============================================================================
+// Load Generator
+// =============================================================================
+
+class SwarmLoadGen {
+public:
+    explicit SwarmLoadGen(const Options& opt) : _opt(opt), _modules(opt.modules), _rng(12345) {}
+
+    ~SwarmLoadGen() {
+        for (auto& m : _modules) {
+            if (m.fd >= 0) close(m.fd);
+        }
+        if (_timerFd >= 0) close(_timerFd);
+        if (_epollFd >= 0) close(_epollFd);
+    }
+
+    bool init() {
+        _server.sin_family = AF_INET;
+        _server.sin_port = htons(_opt.serverPort);
+        if (inet_pton(AF_INET, _opt.serverIp.c_str(), &_server.sin_addr) != 1) {
+            fprintf(stderr, "Bad server IP %s\n", _opt.serverIp.c_str());
+            return false;
+        }
+
+        _epollFd = epoll_create1(EPOLL_CLOEXEC);
+        _timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (_epollFd < 0 || _timerFd < 0) {
+            perror("epoll/timerfd");
+            return false;
+        }
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.u32 = TIMER_TAG;
+        epoll_ctl(_epollFd, EPOLL_CTL_ADD, _timerFd, &ev);
+
+        for (int i = 0; i < _opt.modules; i++) {
+            if (!openModule(_modules[i], i, _opt)) return false;
+            ev.data.u32 = static_cast<uint32_t>(i);
+            epoll_ctl(_epollFd, EPOLL_CTL_ADD, _modules[i].fd, &ev);
+        }
+
+        // Default slack lets the kernel fire timers up to 50 us late
+        prctl(PR_SET_TIMERSLACK, 1UL);
+        return true;
+    }
+
+    void run() {
+        const int64_t slotNs = static_cast<int64_t>(1e9 / (_opt.rateHz * _opt.modules));
+        const int64_t startNs = nowNs();
+        const int64_t endNs = startNs + static_cast<int64_t>(_opt.durationS * 1e9);
+        _warmupEndNs = startNs + static_cast<int64_t>(_opt.warmupS * 1e9);
+        int64_t nextReportNs = startNs + static_cast<int64_t>(_opt.reportS * 1e9);
+        uint64_t slot = 0;
+
+        printf("%d modules x %.0f Hz -> %s:%u (%s mode), one send every %.2f us\n", _opt.modules,
+               _opt.rateHz, _opt.serverIp.c_str(), _opt.serverPort, _opt.portMode ? "port" : "ip",
+               slotNs / 1000.0);
+
+        epoll_event events[64];
+        while (g_running) {
+            int64_t now = nowNs();
+            if (now >= endNs) break;
+
+            // Every slot that is due, oldest first; late slots run back to back
+            int64_t dueNs = startNs + static_cast<int64_t>(slot) * slotNs;
+            while (dueNs <= now) {
+                _lag.add(static_cast<uint32_t>((now - dueNs) / 1000));
+                _sendFeedback(_modules[slot % _opt.modules], now);
+                slot++;
+                dueNs = startNs + static_cast<int64_t>(slot) * slotNs;
+                now = nowNs();
+            }
+
+            if (now >= nextReportNs) {
+                _report(now - startNs);
+                nextReportNs += static_cast<int64_t>(_opt.reportS * 1e9);
+            }
+
+            itimerspec its = {};
+            its.it_value.tv_sec = dueNs / 1000000000;
+            its.it_value.tv_nsec = dueNs % 1000000000;
+            timerfd_settime(_timerFd, TFD_TIMER_ABSTIME, &its, nullptr);
+
+            int n = epoll_wait(_epollFd, events, 64, 100);
+            for (int i = 0; i < n; i++) {
+                if (events[i].data.u32 == TIMER_TAG) {
+                    uint64_t expirations;
+                    while (read(_timerFd, &expirations, sizeof(expirations)) > 0) {
+                    }
+                } else {
+                    _receiveCommands(_modules[events[i].data.u32]);
+                }
+            }
+        }
+
+        _summary((nowNs() - startNs) / 1e9);
+    }
+
+private:
+    static constexpr uint32_t TIMER_TAG = UINT32_MAX;
+
+    void _sendFeedback(Module& m, int64_t now) {
+        float dt = m.lastSendNs ? (now - m.lastSendNs) / 1e9f : static_cast<float>(1.0 / _opt.rateHz);
+        m.lastSendNs = now;
+        m.motor.update(dt);
+
+        SensorData msg{};
+        msg.module_id = m.id;
+        msg.receive_dt = static_cast<int32_t>(dt * 1e6f);
+        msg.timestamp = static_cast<int32_t>(now / 1000);
+        msg.switch_off = m.motor.enabled ? 0 : 1;
+        msg.last_rcv_timestamp = m.lastCommandTimestamp;
+        msg.motor.pos = m.motor.position + _noise(_rng);
+        msg.motor.large_pos = m.motor.position;
+        msg.motor.vel = m.motor.velocity;
+        msg.motor.torque = m.motor.torque;
+        msg.motor.voltage = 24.0f;
+        msg.motor.current = std::fabs(m.motor.torque) * 0.1f;
+        msg.motor.temperature = 45;
+        msg.motor.motor_mode = m.motor.enabled ? 2 : 0;
+        msg.goal_distance = 0.233f;
+
+        uint8_t buffer[SensorData::SIZE];
+        msg.serialize(buffer);
+        ssize_t n = sendto(m.fd, buffer, sizeof(buffer), 0, reinterpret_cast<const sockaddr*>(&_server),
+                           sizeof(_server));
+        if (n == static_cast<ssize_t>(sizeof(buffer))) {
+            m.sent++;
+        } else {
+            m.sendErrors++;
+        }
+    }
+
+    void _receiveCommands(Module& m) {
+        uint8_t buffer[1500];
+        while (true) {
+            ssize_t n = recv(m.fd, buffer, sizeof(buffer), 0);
+            if (n < 0) return;  // EAGAIN: drained
+            int64_t arrivalNs = nowNs();
+            if (static_cast<size_t>(n) < MotorCommand::SIZE) {
+                m.malformed++;
+                continue;
+            }
+
+            MotorCommand cmd;
+            cmd.deserialize(buffer, static_cast<size_t>(n));
+            m.motor.target = cmd.target;
+            m.motor.targetVel = cmd.target_vel;
+            m.motor.kp = cmd.kp;
+            m.motor.kd = cmd.kd;
+            m.motor.enabled = cmd.switch_ == 1;
+            m.lastCommandTimestamp = cmd.timestamp;
+            m.received++;
+
+            _recordLatency(m, arrivalNs, cmd.timestamp);
+        }
+    }
+
+    /**
+     * @brief Delay of a command relative to the server's clock, less the
+     *        smallest offset seen (see file comment)
+     */
+    void _recordLatency(Module& m, int64_t arrivalNs, float serverSeconds) {
+        int64_t rawUs = arrivalNs / 1000 - static_cast<int64_t>(static_cast<double>(serverSeconds) * 1e6);
+        if (arrivalNs < _warmupEndNs || !_haveOffset) {
+            _offsetUs = _haveOffset ? std::min(_offsetUs, rawUs) : rawUs;
+            _haveOffset = true;
+            if (arrivalNs < _warmupEndNs) return;
+        }
+        if (rawUs < _offsetUs) {
+            _rebaselined++;
+            _offsetUs = rawUs;
+        }
+        auto us = static_cast<uint32_t>(std::min<int64_t>(rawUs - _offsetUs, UINT32_MAX));
+        m.latency.add(us);
+        m.interval.add(us);
+    }
+
+    void _report(int64_t elapsedNs) {
+        uint64_t sent = 0, received = 0;
+        Histogram interval;
+        for (auto& m : _modules) {
+            sent += m.sent;
+            received += m.received;
+            interval.merge(m.interval);
+            m.interval.clear();
+        }
+        double seconds = elapsedNs / 1e9;
+        printf("[%6.1fs] sent %8.0f/s  recv %8.0f/s  lag p99 %5u us max %6u us  "
+               "latency p50 %5u p99 %6u max %6u us\n",
+               seconds, (sent - _lastSent) / _opt.reportS, (received - _lastReceived) / _opt.reportS,
+               _lag.percentile(0.99), _lag.max(), interval.percentile(0.5), interval.percentile(0.99),
+               interval.max());
+        _lastSent = sent;
+        _lastReceived = received;
+        _lag.clear();
+    }
+
+    void _summary(double seconds) {
+        FILE* csv = nullptr;
+        if (!_opt.csvPath.empty()) {
+            csv = fopen(_opt.csvPath.c_str(), "w");
+            if (!csv) perror(_opt.csvPath.c_str());
+        }
+        if (csv) fprintf(csv, "module_id,address,sent,send_errors,received,malformed,p50_us,p99_us,max_us,mean_us\n");
+
+        printf("\n%-6s %-22s %10s %10s %8s %8s %8s %10s\n", "module", "address", "sent", "received",
+               "p50 us", "p99 us", "max us", "send errs");
+        Histogram all;
+        uint64_t sent = 0, received = 0, errors = 0, silent = 0;
+        for (const auto& m : _modules) {
+            all.merge(m.latency);
+            sent += m.sent;
+            received += m.received;
+            errors += m.sendErrors;
+            if (m.received == 0) silent++;
+            printf("%-6d %-22s %10llu %10llu %8u %8u %8u %10llu\n", m.id, m.address().c_str(),
+                   static_cast<unsigned long long>(m.sent), static_cast<unsigned long long>(m.received),
+                   m.latency.percentile(0.5), m.latency.percentile(0.99), m.latency.max(),
+                   static_cast<unsigned long long>(m.sendErrors));
+            if (csv) {
+                fprintf(csv, "%d,%s,%llu,%llu,%llu,%llu,%u,%u,%u,%.1f\n", m.id, m.address().c_str(),
+                        static_cast<unsigned long long>(m.sent), static_cast<unsigned long long>(m.sendErrors),
+                        static_cast<unsigned long long>(m.received), static_cast<unsigned long long>(m.malformed),
+                        m.latency.percentile(0.5), m.latency.percentile(0.99), m.latency.max(), m.latency.mean());
+            }
+        }
+        if (csv) fclose(csv);
+
+        printf("\nTotal over %.1f s: sent %llu (%.0f/s, %llu errors), received %llu (%.0f/s), "
+               "%llu modules got no commands\n",
+               seconds, static_cast<unsigned long long>(sent), sent / seconds,
+               static_cast<unsigned long long>(errors), static_cast<unsigned long long>(received),
+               received / seconds, static_cast<unsigned long long>(silent));
+        printf("Latency above fastest delivery: p50 %u us, p99 %u us, p99.9 %u us, max %u us "
+               "(%llu samples, offset re-based %llu times after warm-up)\n",
+               all.percentile(0.5), all.percentile(0.99), all.percentile(0.999), all.max(),
+               static_cast<unsigned long long>(all.count()), static_cast<unsigned long long>(_rebaselined));
+    }
+
+    Options _opt;
+    std::vector<Module> _modules;
+    sockaddr_in _server = {};
+    int _epollFd = -1;
+    int _timerFd = -1;
+
+    std::mt19937 _rng;
+    std::normal_distribution<float> _noise{0.0f, MOTOR_NOISE_STD};
+
+    Histogram _lag;  // Scheduler lateness, current report interval
+    int64_t _warmupEndNs = 0;
+    int64_t _offsetUs = 0;
+    bool _haveOffset = false;
+    uint64_t _rebaselined = 0;
+    uint64_t _lastSent = 0;
+    uint64_t _lastReceived = 0;
+};
+
+// =============================================================================
+// Entry Point
+// =============================================================================
+
+static void usage(const char* argv0) {
+    printf("Usage: %s [options]\n"
+           "  --modules N          Virtual modules (default 100)\n"
+           "  --rate HZ            Feedback rate per module (default 1000)\n"
+           "  --duration S         Run time in seconds (default 10)\n"
+           "  --warmup S           Seconds used to find the clock offset (default 1)\n"
+           "  --report S           Progress interval in seconds (default 1)\n"
+           "  --server-ip IP       Server address (default 127.0.0.1)\n"
+           "  --server-port PORT   Port the server listens on (default 6666)\n"
+           "  --command-port PORT  Port modules listen on (default 6667)\n"
+           "  --mode ip|port       One loopback IP or one port per module (default ip)\n"
+           "  --base-ip IP         Local address in port mode (default 127.0.0.1)\n"
+           "  --csv PATH           Write per-module results as CSV\n",
+           argv0);
+}
+
+static bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") return false;
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return false;
+        }
+        const char* value = argv[++i];
+        if (arg == "--modules") opt.modules = atoi(value);
+        else if (arg == "--rate") opt.rateHz = atof(value);
+        else if (arg == "--duration") opt.durationS = atof(value);
+        else if (arg == "--warmup") opt.warmupS = atof(value);
+        else if (arg == "--report") opt.reportS = atof(value);
+        else if (arg == "--server-ip") opt.serverIp = value;
+        else if (arg == "--server-port") opt.serverPort = static_cast<uint16_t>(atoi(value));
+        else if (arg == "--command-port") opt.commandPort = static_cast<uint16_t>(atoi(value));
+        else if (arg == "--mode") opt.portMode = strcmp(value, "port") == 0;
+        else if (arg == "--base-ip") opt.baseIp = value;
+        else if (arg == "--csv") opt.csvPath = value;
+        else {
+            fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return false;
+        }
+    }
+    if (opt.modules < 1 || opt.rateHz <= 0 || opt.reportS <= 0) {
+        fprintf(stderr, "--modules, --rate and --report must be positive\n");
+        return false;
+    }
+    if (opt.portMode && opt.commandPort + opt.modules > 65536) {
+        fprintf(stderr, "Port range %u+%d overflows\n", opt.commandPort, opt.modules);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    SwarmLoadGen gen(opt);
+    if (!gen.init()) return 1;
+    gen.run();
+    return 0;
+}
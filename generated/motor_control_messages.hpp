@@ -2,7 +2,7 @@
  * @file Auto-generated message definitions for motor_control
  *
  * Generated from: Capybarish/schemas/motor_control.cpy
- * Generated at: 2026-03-08T19:28:15.479389
+ * Generated at: 2026-10-17T11:40:21.849894
  *
  * DO NOT EDIT - This file is auto-generated by capybarish-gen.
  *
@@ -24,6 +24,7 @@ namespace motor_control {
 
 // Forward declarations
 struct MotorCommand;
+struct TrajectoryChunk;
 struct IMUOrientation;
 struct IMUQuaternion;
 struct IMUOmega;
@@ -32,8 +33,17 @@ struct IMUData;
 struct MotorData;
 struct ErrorData;
 struct UWBDistances;
+struct PolicyDebugData;
 struct SensorData;
 
+/** One primitive field in a message's flattened wire layout */
+struct FieldLayout {
+    const char* name;  ///< Dotted path for nested fields, e.g. "pose.position.x"
+    const char* type;  ///< Wire type: int8..uint64, float32, float64, bool
+    uint16_t offset;   ///< Byte offset in the serialized message
+    uint16_t count;    ///< Array length (1 for scalars)
+};
+
 /** Motor command sent from server to robot module */
 #pragma pack(push, 1)
 struct MotorCommand {
@@ -54,6 +64,25 @@ struct MotorCommand {
 
     static constexpr size_t SIZE = 84;
 
+    static constexpr const char* NAME = "MotorCommand";
+    static constexpr size_t FIELD_COUNT = 14;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"target", "float32", 0, 1},
+        {"target_vel", "float32", 4, 1},
+        {"kp", "float32", 8, 1},
+        {"kd", "float32", 12, 1},
+        {"enable_filter", "int32", 16, 1},
+        {"switch_", "int32", 20, 1},
+        {"calibrate", "int32", 24, 1},
+        {"restart", "int32", 28, 1},
+        {"timestamp", "float32", 32, 1},
+        {"control_mode", "int32", 36, 1},
+        {"joint_offset", "float32", 40, 1},
+        {"policy_hash", "int32", 44, 1},
+        {"joint_id", "int32", 48, 1},
+        {"command_context", "float32", 52, 8},
+    };
+
     /**
      * @brief Serialize struct to byte buffer
      * @param buffer Output buffer (must be at least SIZE bytes)
@@ -89,6 +118,70 @@ struct MotorCommand {
 #pragma pack(pop)
 static_assert(sizeof(MotorCommand) == 84, "Size mismatch for MotorCommand");
 
+/** Short horizon of timestamped setpoints, interpolated on the module (cpy::TrajectoryBuffer) */
+#pragma pack(push, 1)
+struct TrajectoryChunk {
+    int32_t joint_id = 0;  ///< Target joint (0-based); -1 = broadcast/all
+    int32_t seq = 0;  ///< Chunk sequence number
+    float timestamp = 0.0f;  ///< Sender time of the chunk (seconds, same clock as MotorCommand)
+    int32_t count = 0;  ///< Number of valid points (0-8)
+    float t[8];  ///< Point times relative to timestamp (seconds, increasing)
+    float target[8];  ///< Target position at each point (radians)
+    float target_vel[8];  ///< Target velocity at each point (rad/s)
+    float kp = 0.0f;  ///< Proportional gain
+    float kd = 0.0f;  ///< Derivative gain
+
+    static constexpr size_t SIZE = 120;
+
+    static constexpr const char* NAME = "TrajectoryChunk";
+    static constexpr size_t FIELD_COUNT = 9;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"joint_id", "int32", 0, 1},
+        {"seq", "int32", 4, 1},
+        {"timestamp", "float32", 8, 1},
+        {"count", "int32", 12, 1},
+        {"t", "float32", 16, 8},
+        {"target", "float32", 48, 8},
+        {"target_vel", "float32", 80, 8},
+        {"kp", "float32", 112, 1},
+        {"kd", "float32", 116, 1},
+    };
+
+    /**
+     * @brief Serialize struct to byte buffer
+     * @param buffer Output buffer (must be at least SIZE bytes)
+     */
+    void serialize(uint8_t* buffer) const {
+        memcpy(buffer, this, SIZE);
+    }
+
+    /**
+     * @brief Deserialize from byte buffer
+     * @param buffer Input buffer (must be at least SIZE bytes)
+     * @param len Buffer length
+     * @return true if successful
+     */
+    bool deserialize(const uint8_t* buffer, size_t len) {
+        if (len < SIZE) return false;
+        memcpy(this, buffer, SIZE);
+        return true;
+    }
+
+    /**
+     * @brief Static factory: create from byte buffer
+     * @param buffer Input buffer
+     * @param len Buffer length
+     * @return TrajectoryChunk object
+     */
+    static TrajectoryChunk fromBytes(const uint8_t* buffer, size_t len) {
+        TrajectoryChunk obj;
+        obj.deserialize(buffer, len);
+        return obj;
+    }
+};
+#pragma pack(pop)
+static_assert(sizeof(TrajectoryChunk) == 120, "Size mismatch for TrajectoryChunk");
+
 /** IMU orientation (Euler angles in radians) */
 #pragma pack(push, 1)
 struct IMUOrientation {
@@ -98,6 +191,14 @@ struct IMUOrientation {
 
     static constexpr size_t SIZE = 12;
 
+    static constexpr const char* NAME = "IMUOrientation";
+    static constexpr size_t FIELD_COUNT = 3;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"x", "float32", 0, 1},
+        {"y", "float32", 4, 1},
+        {"z", "float32", 8, 1},
+    };
+
     /**
      * @brief Serialize struct to byte buffer
      * @param buffer Output buffer (must be at least SIZE bytes)
@@ -143,6 +244,15 @@ struct IMUQuaternion {
 
     static constexpr size_t SIZE = 16;
 
+    static constexpr const char* NAME = "IMUQuaternion";
+    static constexpr size_t FIELD_COUNT = 4;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"x", "float32", 0, 1},
+        {"y", "float32", 4, 1},
+        {"z", "float32", 8, 1},
+        {"w", "float32", 12, 1},
+    };
+
     /**
      * @brief Serialize struct to byte buffer
      * @param buffer Output buffer (must be at least SIZE bytes)
@@ -187,6 +297,14 @@ struct IMUOmega {
 
     static constexpr size_t SIZE = 12;
 
+    static constexpr const char* NAME = "IMUOmega";
+    static constexpr size_t FIELD_COUNT = 3;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"x", "float32", 0, 1},
+        {"y", "float32", 4, 1},
+        {"z", "float32", 8, 1},
+    };
+
     /**
      * @brief Serialize struct to byte buffer
      * @param buffer Output buffer (must be at least SIZE bytes)
@@ -231,6 +349,14 @@ struct IMUAcceleration {
 
     static constexpr size_t SIZE = 12;
 
+    static constexpr const char* NAME = "IMUAcceleration";
+    static constexpr size_t FIELD_COUNT = 3;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"x", "float32", 0, 1},
+        {"y", "float32", 4, 1},
+        {"z", "float32", 8, 1},
+    };
+
     /**
      * @brief Serialize struct to byte buffer
      * @param buffer Output buffer (must be at least SIZE bytes)
@@ -276,6 +402,24 @@ struct IMUData {
 
     static constexpr size_t SIZE = 52;
 
+    static constexpr const char* NAME = "IMUData";
+    static constexpr size_t FIELD_COUNT = 13;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"orientation.x", "float32", 0, 1},
+        {"orientation.y", "float32", 4, 1},
+        {"orientation.z", "float32", 8, 1},
+        {"quaternion.x", "float32", 12, 1},
+        {"quaternion.y", "float32", 16, 1},
+        {"quaternion.z", "float32", 20, 1},
+        {"quaternion.w", "float32", 24, 1},
+        {"omega.x", "float32", 28, 1},
+        {"omega.y", "float32", 32, 1},
+        {"omega.z", "float32", 36, 1},
+        {"acceleration.x", "float32", 40, 1},
+        {"acceleration.y", "float32", 44, 1},
+        {"acceleration.z", "float32", 48, 1},
+    };
+
     /**
      * @brief Serialize struct to byte buffer
      * @param buffer Output buffer (must be at least SIZE bytes)
@@ -327,6 +471,21 @@ struct MotorData {
 
     static constexpr size_t SIZE = 40;
 
+    static constexpr const char* NAME = "MotorData";
+    static constexpr size_t FIELD_COUNT = 10;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"pos", "float32", 0, 1},
+        {"large_pos", "float32", 4, 1},
+        {"vel", "float32", 8, 1},
+        {"torque", "float32", 12, 1},
+        {"voltage", "float32", 16, 1},
+        {"current", "float32", 20, 1},
+        {"temperature", "int32", 24, 1},
+        {"motor_error", "int32", 28, 1},
+        {"motor_mode", "int32", 32, 1},
+        {"driver_error", "int32", 36, 1},
+    };
+
     /**
      * @brief Serialize struct to byte buffer
      * @param buffer Output buffer (must be at least SIZE bytes)
@@ -370,6 +529,13 @@ struct ErrorData {
 
     static constexpr size_t SIZE = 8;
 
+    static constexpr const char* NAME = "ErrorData";
+    static constexpr size_t FIELD_COUNT = 2;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"reset_reason0", "int32", 0, 1},
+        {"reset_reason1", "int32", 4, 1},
+    };
+
     /**
      * @brief Serialize struct to byte buffer
      * @param buffer Output buffer (must be at least SIZE bytes)
@@ -415,6 +581,15 @@ struct UWBDistances {
 
     static constexpr size_t SIZE = 16;
 
+    static constexpr const char* NAME = "UWBDistances";
+    static constexpr size_t FIELD_COUNT = 4;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"d0", "float32", 0, 1},
+        {"d1", "float32", 4, 1},
+        {"d2", "float32", 8, 1},
+        {"d3", "float32", 12, 1},
+    };
+
     /**
      * @brief Serialize struct to byte buffer
      * @param buffer Output buffer (must be at least SIZE bytes)
@@ -450,6 +625,70 @@ struct UWBDistances {
 #pragma pack(pop)
 static_assert(sizeof(UWBDistances) == 16, "Size mismatch for UWBDistances");
 
+/** input/output used on the module. */
+#pragma pack(push, 1)
+struct PolicyDebugData {
+    int32_t valid = 0;  ///< 1 when onboard-model debug data is populated
+    int32_t seq = 0;  ///< Monotonic sequence number for model ticks
+    float nn_action = 0.0f;  ///< Raw onboard-model action in [-0.8, 0.8]
+    float motor_target = 0.0f;  ///< Final motor target after adding joint_offset
+    float joint_offset = 0.0f;  ///< Joint offset applied on the ESP32
+    float dof_pos = 0.0f;  ///< Filtered joint position used by the onboard model
+    float dof_vel = 0.0f;  ///< Filtered joint velocity used by the onboard model
+    float command_context[8];  ///< Latest command context used by the onboard model
+    float local_obs[40];  ///< Full onboard-model observation history (current deploy config)
+
+    static constexpr size_t SIZE = 220;
+
+    static constexpr const char* NAME = "PolicyDebugData";
+    static constexpr size_t FIELD_COUNT = 9;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"valid", "int32", 0, 1},
+        {"seq", "int32", 4, 1},
+        {"nn_action", "float32", 8, 1},
+        {"motor_target", "float32", 12, 1},
+        {"joint_offset", "float32", 16, 1},
+        {"dof_pos", "float32", 20, 1},
+        {"dof_vel", "float32", 24, 1},
+        {"command_context", "float32", 28, 8},
+        {"local_obs", "float32", 60, 40},
+    };
+
+    /**
+     * @brief Serialize struct to byte buffer
+     * @param buffer Output buffer (must be at least SIZE bytes)
+     */
+    void serialize(uint8_t* buffer) const {
+        memcpy(buffer, this, SIZE);
+    }
+
+    /**
+     * @brief Deserialize from byte buffer
+     * @param buffer Input buffer (must be at least SIZE bytes)
+     * @param len Buffer length
+     * @return true if successful
+     */
+    bool deserialize(const uint8_t* buffer, size_t len) {
+        if (len < SIZE) return false;
+        memcpy(this, buffer, SIZE);
+        return true;
+    }
+
+    /**
+     * @brief Static factory: create from byte buffer
+     * @param buffer Input buffer
+     * @param len Buffer length
+     * @return PolicyDebugData object
+     */
+    static PolicyDebugData fromBytes(const uint8_t* buffer, size_t len) {
+        PolicyDebugData obj;
+        obj.deserialize(buffer, len);
+        return obj;
+    }
+};
+#pragma pack(pop)
+static_assert(sizeof(PolicyDebugData) == 220, "Size mismatch for PolicyDebugData");
+
 /** Complete sensor data from robot module */
 #pragma pack(push, 1)
 struct SensorData {
@@ -467,8 +706,62 @@ struct SensorData {
     int32_t policy_error = 0;  ///< Runtime policy error code (0=OK, nonzero=fault)
     float goal_distance = 0.0f;  ///< Distance to goal (meters)
     UWBDistances uwb;  ///< UWB distance measurements
-
-    static constexpr size_t SIZE = 156;
+    PolicyDebugData policy_debug;  ///< Optional onboard-model debug snapshot
+
+    static constexpr size_t SIZE = 376;
+
+    static constexpr const char* NAME = "SensorData";
+    static constexpr size_t FIELD_COUNT = 48;
+    static constexpr FieldLayout FIELDS[FIELD_COUNT] = {
+        {"module_id", "int32", 0, 1},
+        {"receive_dt", "int32", 4, 1},
+        {"timestamp", "int32", 8, 1},
+        {"switch_off", "int32", 12, 1},
+        {"last_rcv_timestamp", "float32", 16, 1},
+        {"info", "int32", 20, 1},
+        {"motor.pos", "float32", 24, 1},
+        {"motor.large_pos", "float32", 28, 1},
+        {"motor.vel", "float32", 32, 1},
+        {"motor.torque", "float32", 36, 1},
+        {"motor.voltage", "float32", 40, 1},
+        {"motor.current", "float32", 44, 1},
+        {"motor.temperature", "int32", 48, 1},
+        {"motor.motor_error", "int32", 52, 1},
+        {"motor.motor_mode", "int32", 56, 1},
+        {"motor.driver_error", "int32", 60, 1},
+        {"imu.orientation.x", "float32", 64, 1},
+        {"imu.orientation.y", "float32", 68, 1},
+        {"imu.orientation.z", "float32", 72, 1},
+        {"imu.quaternion.x", "float32", 76, 1},
+        {"imu.quaternion.y", "float32", 80, 1},
+        {"imu.quaternion.z", "float32", 84, 1},
+        {"imu.quaternion.w", "float32", 88, 1},
+        {"imu.omega.x", "float32", 92, 1},
+        {"imu.omega.y", "float32", 96, 1},
+        {"imu.omega.z", "float32", 100, 1},
+        {"imu.acceleration.x", "float32", 104, 1},
+        {"imu.acceleration.y", "float32", 108, 1},
+        {"imu.acceleration.z", "float32", 112, 1},
+        {"error.reset_reason0", "int32", 116, 1},
+        {"error.reset_reason1", "int32", 120, 1},
+        {"policy_hash", "int32", 124, 1},
+        {"policy_status", "int32", 128, 1},
+        {"policy_error", "int32", 132, 1},
+        {"goal_distance", "float32", 136, 1},
+        {"uwb.d0", "float32", 140, 1},
+        {"uwb.d1", "float32", 144, 1},
+        {"uwb.d2", "float32", 148, 1},
+        {"uwb.d3", "float32", 152, 1},
+        {"policy_debug.valid", "int32", 156, 1},
+        {"policy_debug.seq", "int32", 160, 1},
+        {"policy_debug.nn_action", "float32", 164, 1},
+        {"policy_debug.motor_target", "float32", 168, 1},
+        {"policy_debug.joint_offset", "float32", 172, 1},
+        {"policy_debug.dof_pos", "float32", 176, 1},
+        {"policy_debug.dof_vel", "float32", 180, 1},
+        {"policy_debug.command_context", "float32", 184, 8},
+        {"policy_debug.local_obs", "float32", 216, 40},
+    };
 
     /**
      * @brief Serialize struct to byte buffer
@@ -503,8 +796,8 @@ struct SensorData {
     }
 };
 #pragma pack(pop)
-static_assert(sizeof(SensorData) == 156, "Size mismatch for SensorData");
+static_assert(sizeof(SensorData) == 376, "Size mismatch for SensorData");
 
 } // namespace motor_control
 
-#endif // MOTOR_CONTROL_MESSAGES_HPP
+#endif // MOTOR_CONTROL_MESSAGES_HPP
\ No newline at end of file
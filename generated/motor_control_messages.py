@@ -110,6 +110,52 @@ class MotorCommand:
         return cls._SIZE
 
 
+# Short horizon of timestamped setpoints, interpolated on the module (cpy::TrajectoryBuffer)
+@dataclass
+class TrajectoryChunk:
+    """Message type: TrajectoryChunk."""
+
+    _FORMAT: ClassVar[str] = 'iififfffffffffffffffffffffffff'
+    _SIZE: ClassVar[int] = 120
+
+    joint_id: int = 0  # Target joint (0-based); -1 = broadcast/all
+    seq: int = 0  # Chunk sequence number
+    timestamp: float = 0.0  # Sender time of the chunk (seconds, same clock as MotorCommand)
+    count: int = 0  # Number of valid points (0-8)
+    t: List[float] = field(default_factory=lambda: [0.0] * 8)  # Point times relative to timestamp (seconds, increasing)
+    target: List[float] = field(default_factory=lambda: [0.0] * 8)  # Target position at each point (radians)
+    target_vel: List[float] = field(default_factory=lambda: [0.0] * 8)  # Target velocity at each point (rad/s)
+    kp: float = 0.0  # Proportional gain
+    kd: float = 0.0  # Derivative gain
+
+    def serialize(self) -> bytes:
+        """Serialize message to bytes."""
+        return struct.pack(self._FORMAT, self.joint_id, self.seq, self.timestamp, self.count, *self.t, *self.target, *self.target_vel, self.kp, self.kd)
+
+    @classmethod
+    def deserialize(cls, data: bytes) -> 'TrajectoryChunk':
+        """Deserialize message from bytes."""
+        if len(data) < cls._SIZE:
+            raise ValueError(f"Buffer too small: {len(data)} < {cls._SIZE}")
+        values = struct.unpack(cls._FORMAT, data[:cls._SIZE])
+        obj = cls()
+        obj.joint_id = values[0]
+        obj.seq = values[1]
+        obj.timestamp = values[2]
+        obj.count = values[3]
+        obj.t = list(values[4:12])
+        obj.target = list(values[12:20])
+        obj.target_vel = list(values[20:28])
+        obj.kp = values[28]
+        obj.kd = values[29]
+        return obj
+
+    @classmethod
+    def size(cls) -> int:
+        """Get serialized size in bytes."""
+        return cls._SIZE
+
+
 # IMU orientation (Euler angles in radians)
 @dataclass
 class IMUOrientation:
@@ -443,6 +489,7 @@ class SensorData:
 # Message registry for dynamic lookup
 MESSAGE_TYPES: Dict[str, type] = {
     "MotorCommand": MotorCommand,
+    "TrajectoryChunk": TrajectoryChunk,
     "IMUOrientation": IMUOrientation,
     "IMUQuaternion": IMUQuaternion,
     "IMUOmega": IMUOmega,
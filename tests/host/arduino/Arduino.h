@@ -0,0 +1,104 @@
+/**
+ * @file Arduino.h
+ * @brief Just enough of the Arduino core to run the library on a POSIX host
+ *
+ * Host tests build the headers in arduino/src as ESP32 code (define
+ * HOST_ESP8266 for the ESP8266 branches). Sockets are the host's own, the
+ * clock is steady_clock, Serial output is discarded.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+using std::max;
+using std::min;
+
+unsigned long micros();
+unsigned long millis();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+class String {
+public:
+    String() {}
+    String(const char* text) : _text(text) {}
+    const char* c_str() const { return _text.c_str(); }
+
+private:
+    std::string _text;
+};
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t byte) = 0;
+    virtual size_t write(const uint8_t* data, size_t len) {
+        for (size_t i = 0; i < len; i++) write(data[i]);
+        return len;
+    }
+    template<typename T> size_t print(const T&) { return 0; }
+    template<typename T> size_t println(const T&) { return 0; }
+    size_t println() { return 0; }
+    size_t printf(const char*, ...) { return 0; }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() { return -1; }
+    virtual size_t readBytes(uint8_t*, size_t) { return 0; }
+    void flush() {}
+};
+
+class HardwareSerial : public Stream {
+public:
+    using Print::write;
+    size_t write(uint8_t) override { return 1; }
+    int available() override { return 0; }
+    int read() override { return -1; }
+    void begin(unsigned long) {}
+    int availableForWrite() { return 128; }
+    void setRxBufferSize(size_t) {}
+};
+
+extern HardwareSerial Serial;
+
+class IPAddress {
+public:
+    IPAddress() {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+        : _address(a | (b << 8) | (c << 16) | (static_cast<uint32_t>(d) << 24)) {}
+    IPAddress(uint32_t address) : _address(address) {}
+    bool fromString(const char* text);
+    operator uint32_t() const { return _address; }
+    String toString() const;
+
+private:
+    uint32_t _address = 0;
+};
+
+uint32_t esp_random();
+
+class EspClass {
+public:
+    uint32_t getFreeHeap() { return 0; }
+    uint64_t getEfuseMac() { return 0x0000AABBCCDDEEFFull; }
+    uint32_t random() { return esp_random(); }
+};
+
+extern EspClass ESP;
+
+#ifdef HOST_ESP8266
+#define ESP8266 1
+#else
+#define ESP32 1
+#endif
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// NVS stand-in that stores nothing
+class Preferences {
+public:
+    bool begin(const char*, bool = false) { return true; }
+    void end() {}
+    bool isKey(const char*) { return false; }
+    size_t getBytes(const char*, void*, size_t) { return 0; }
+    size_t putBytes(const char*, const void*, size_t len) { return len; }
+    uint32_t getUInt(const char*, uint32_t fallback = 0) { return fallback; }
+    size_t putUInt(const char*, uint32_t) { return 4; }
+};
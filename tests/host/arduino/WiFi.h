@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Arduino.h"
+
+#define WL_CONNECTED 3
+
+class WiFiClass {
+public:
+    int status() { return WL_CONNECTED; }
+    void begin(const char*, const char*) {}
+    void disconnect(bool = false) {}
+    void setSleep(bool) {}
+    void setAutoReconnect(bool) {}
+    IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+    String macAddress() { return String("AA:BB:CC:DD:EE:FF"); }
+    void macAddress(uint8_t* mac) {
+        const uint8_t address[6] = {0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF};
+        memcpy(mac, address, sizeof(address));
+    }
+};
+
+extern WiFiClass WiFi;
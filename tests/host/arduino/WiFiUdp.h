@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Arduino.h"
+
+// The ESP8266 branches use WiFiUDP; on the host it never delivers anything
+class WiFiUDP {
+public:
+    int begin(uint16_t) { return 1; }
+    int beginMulticast(IPAddress, uint16_t) { return 1; }
+    int parsePacket() { return 0; }
+    int available() { return 0; }
+    int read() { return -1; }
+    int read(uint8_t*, size_t) { return 0; }
+    int beginPacket(const char*, uint16_t) { return 1; }
+    int beginPacket(IPAddress, uint16_t) { return 1; }
+    size_t write(const uint8_t*, size_t len) { return len; }
+    int endPacket() { return 1; }
+    void stop() {}
+    IPAddress remoteIP() { return IPAddress(); }
+    uint16_t remotePort() { return 0; }
+};
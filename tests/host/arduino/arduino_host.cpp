@@ -0,0 +1,49 @@
+/**
+ * @file arduino_host.cpp
+ * @brief Definitions behind Arduino.h for host tests
+ */
+
+#include "Arduino.h"
+#include "WiFi.h"
+
+#include <arpa/inet.h>
+
+#include <chrono>
+#include <random>
+#include <thread>
+
+HardwareSerial Serial;
+EspClass ESP;
+WiFiClass WiFi;
+
+static const auto start = std::chrono::steady_clock::now();
+
+unsigned long micros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+unsigned long millis() { return micros() / 1000; }
+
+void delay(unsigned long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+void delayMicroseconds(unsigned int us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+
+uint32_t esp_random() {
+    static thread_local std::mt19937 rng(std::random_device{}());
+    return rng();
+}
+
+bool IPAddress::fromString(const char* text) {
+    in_addr address;
+    if (inet_pton(AF_INET, text, &address) != 1) return false;
+    _address = address.s_addr;
+    return true;
+}
+
+String IPAddress::toString() const {
+    char text[INET_ADDRSTRLEN];
+    in_addr address{_address};
+    inet_ntop(AF_INET, &address, text, sizeof(text));
+    return String(text);
+}
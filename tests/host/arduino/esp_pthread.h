@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+
+#define portNUM_PROCESSORS 2
+
+struct esp_pthread_cfg_t {
+    int pin_to_core = -1;
+    size_t stack_size = 4096;
+};
+
+inline esp_pthread_cfg_t esp_pthread_get_default_config() { return {}; }
+inline int esp_pthread_set_cfg(const esp_pthread_cfg_t*) { return 0; }
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <netinet/in.h>
+
+typedef struct {
+    uint32_t addr;
+} ip4_addr_t;
+
+inline int igmp_joingroup(const ip4_addr_t*, const ip4_addr_t*) { return 0; }
@@ -0,0 +1,23 @@
+/**
+ * @file host_test.h
+ * @brief Minimal checks for host tests (see tests/test_host.py)
+ */
+
+#pragma once
+
+#include <cstdio>
+
+inline int& hostTestFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(cond)                                                          \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            hostTestFailures()++;                                            \
+        }                                                                    \
+    } while (0)
+
+#define HOST_TEST_RESULT() (hostTestFailures() == 0 ? 0 : 1)
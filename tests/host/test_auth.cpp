@@ -0,0 +1,49 @@
+/**
+ * @file test_auth.cpp
+ * @brief The ESP8266 derives its default sender ID from the MAC address
+ */
+
+#define HOST_ESP8266
+
+#include "capybarish_sim.h"
+#include "motor_control_messages.hpp"
+#include "host_test.h"
+
+using namespace motor_control;
+
+static void senderId() {
+    // AA:BB:CC:DD:EE:FF as the ESP32's getEfuseMac() would hold it
+    const uint64_t mac = 0xFFEEDDCCBBAAull;
+    CHECK(cpy::authSenderId() == static_cast<uint32_t>(mac ^ (mac >> 32)));
+}
+
+// The default sender ID goes on the wire and the subscriber accepts it
+static void authenticated() {
+    cpy::AuthKey key;
+    CHECK(cpy::parseAuthKey("000102030405060708090a0b0c0d0e0f", key));
+
+    cpy::Simulation sim;
+    cpy::Node module("module", "", sim.createTransport("module"));
+    cpy::Node server("server", "", sim.createTransport("server"));
+    uint32_t got = 0;
+    auto* sub = module.createSubscription<MotorCommand>("/motor/command",
+                                                        [&](const MotorCommand&) { got++; }, 6666);
+    sub->setAuth(key);
+    auto* pub = server.createPublisher<MotorCommand>("/motor/command", "", 6666);
+    pub->setAuth(key, 1ull << 32);
+    sim.addNode(&module);
+    sim.addNode(&server);
+
+    for (int i = 0; i < 3; i++) {
+        pub->publish(MotorCommand{});
+        sim.runFor(1000);
+    }
+    CHECK(got == 3);
+    CHECK(sub->getAuthFailCount() == 0);
+}
+
+int main() {
+    senderId();
+    authenticated();
+    return HOST_TEST_RESULT();
+}
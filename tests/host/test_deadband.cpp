@@ -0,0 +1,136 @@
+/**
+ * @file test_deadband.cpp
+ * @brief Publish-on-change: deadbands, heartbeat and the reference message
+ */
+
+#include "capybarish_sim.h"
+#include "motor_control_messages.hpp"
+#include "host_test.h"
+
+#include <cmath>
+
+using namespace motor_control;
+
+struct Plain {
+    float a;
+    int b;
+};
+
+// A module streaming at 1 kHz to a server, idle then moving
+static void deadbands() {
+    cpy::Simulation sim({.latencyUs = 100});
+    cpy::Node module("module", "", sim.createTransport("module"));
+    cpy::Node server("server", "", sim.createTransport("server"));
+    uint32_t got = 0;
+    server.createSubscription<SensorData>("/feedback", [&](const SensorData&) { got++; }, 6666);
+    auto* pub = module.createPublisher<SensorData>("/feedback", "", 6666);
+
+    CHECK(pub->setDeadband("motor.pos", 0.001));
+    CHECK(pub->setDeadband("uwb.d0", 0.0));
+    CHECK(!pub->setDeadband("motor.nope", 1));
+    CHECK(!pub->setDeadband("motor", 1));  // A struct, not a field
+    pub->setHeartbeat(100000);
+
+    SensorData d{};
+    bool moving = false;
+    float pos = 0;
+    module.createTimer(0.001f, [&] {
+        pos += moving ? 0.002f : 0.0000001f;
+        d.motor.pos = pos;
+        d.timestamp = static_cast<int32_t>(cpy::nowUs());
+        pub->publish(d);
+    });
+    sim.addNode(&module);
+    sim.addNode(&server);
+
+    sim.runFor(1000000);  // Drift under the deadband: heartbeats only
+    CHECK(got >= 10 && got <= 12);
+
+    uint32_t before = got;
+    moving = true;
+    sim.runFor(100000);
+    CHECK(got - before >= 99);
+
+    moving = false;
+    sim.runFor(500);
+    before = got;
+    d.uwb.d0 = 1;  // Deadband 0: any change of the field
+    sim.runFor(50000);
+    CHECK(got - before == 1);
+
+    uint32_t count = pub->getPublishCount();
+    d.motor.pos = NAN;  // A NaN is a change once, then equal to itself
+    pub->publish(d);
+    pub->publish(d);
+    CHECK(pub->getPublishCount() - count == 1);
+    d.motor.pos = pos;
+    pub->publish(d);
+    CHECK(pub->getPublishCount() - count == 2);
+
+    pub->clearDeadbands();
+    before = got;
+    sim.runFor(10000);
+    CHECK(got - before >= 9);
+}
+
+// setHeartbeat(0) does not turn the mode on; setPublishOnChange() does
+static void anyChange() {
+    cpy::Simulation sim;
+    cpy::Publisher<Plain> pub("/plain", "", 7000, 0, cpy::QoSProfile::defaultProfile(), false,
+                              sim.createTransport("plain"));
+    pub.init();
+    CHECK(!pub.setDeadband("a", 1));  // No generated field table
+
+    Plain p = {1, 2};
+    pub.setHeartbeat(0);
+    pub.publish(p);
+    pub.publish(p);
+    CHECK(pub.getPublishCount() == 2 && pub.getSuppressedCount() == 0);
+
+    pub.setPublishOnChange();
+    pub.publish(p);
+    pub.publish(p);
+    p.b = 3;
+    pub.publish(p);
+    CHECK(pub.getPublishCount() == 4 && pub.getSuppressedCount() == 1);
+
+    pub.setHeartbeat(0);  // Still on change
+    pub.publish(p);
+    CHECK(pub.getPublishCount() == 4 && pub.getSuppressedCount() == 2);
+}
+
+// A change dropped by the bandwidth budget is sent once the budget allows,
+// and a held (DEFER) one is the new reference
+static void budget(cpy::RateLimitAction action) {
+    cpy::Simulation sim;
+    const uint32_t size = SensorData::SIZE;
+    auto qos = cpy::QoSProfile::sensorData().withBudget(size, size, action);
+    cpy::Publisher<SensorData> pub("/feedback", "", 6666, 0, qos, false, sim.createTransport("module"));
+    pub.init();
+    CHECK(pub.setDeadband("motor.pos", 0.001));
+
+    SensorData d{};
+    CHECK(pub.publish(d));  // Uses up the burst
+    d.motor.pos = 1;
+    bool accepted = pub.publish(d);
+    CHECK(pub.getPublishCount() == 1);
+
+    sim.runFor(2000000);  // Budget back
+    if (action == cpy::RateLimitAction::DROP) {
+        CHECK(!accepted && pub.getThrottledCount() == 1);
+        CHECK(pub.publish(d));  // Not taken for already sent
+        CHECK(pub.getPublishCount() == 2 && pub.getSuppressedCount() == 0);
+    } else {
+        CHECK(accepted && pub.flush());
+        CHECK(pub.publish(d));  // Same as the held message
+        CHECK(pub.getPublishCount() == 2 && pub.getSuppressedCount() == 1);
+    }
+}
+
+int main() {
+    deadbands();
+    anyChange();
+    budget(cpy::RateLimitAction::DROP);
+    budget(cpy::RateLimitAction::DEFER);
+    return HOST_TEST_RESULT();
+}
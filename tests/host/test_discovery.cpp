@@ -0,0 +1,53 @@
+/**
+ * @file test_discovery.cpp
+ * @brief Discovery announces the WiFi address on the ESP8266 too
+ */
+
+#define HOST_ESP8266
+
+#include "capybarish_sim.h"
+#include "capybarish_discovery.h"
+#include "motor_control_messages.hpp"
+#include "host_test.h"
+
+using namespace motor_control;
+
+// The robot leaves its address to WiFi.localIP(); its announcements must
+// carry it, or peers would not target it
+static void localAddress() {
+    cpy::Simulation sim({.latencyUs = 500});
+    cpy::Node robot("robot", "", sim.createTransport("robot"));
+    cpy::Node listener("listener", "", sim.createTransport("listener"));
+    robot.createSubscription<MotorCommand>("/motor/command", [](const MotorCommand&) {}, 6667);
+
+    char announced[sizeof(cpy::DiscoveryHeader::address) + 1] = {};
+    listener.createGenericSubscription("/cpy/discovery", nullptr, [&](const uint8_t* data, size_t len) {
+        cpy::DiscoveryHeader header;
+        if (len < sizeof(header)) return;
+        memcpy(&header, data, sizeof(header));
+        memcpy(announced, header.address, sizeof(header.address));
+    }, 7400);
+
+    cpy::Discovery discovery(robot);
+    sim.addNode(&robot);
+    sim.addNode(&listener);
+    CHECK(discovery.begin());
+    sim.runFor(10000);
+    CHECK(strcmp(announced, "127.0.0.1") == 0);
+}
+
+// Nothing to announce: begin() fails instead of sending empty addresses
+static void noAddress() {
+    cpy::Simulation sim;
+    cpy::Node node("node", "", sim.createTransport("node"));
+    cpy::DiscoveryConfig config;
+    config.address = "0.0.0.0";
+    cpy::Discovery discovery(node, config);
+    CHECK(!discovery.begin());
+}
+
+int main() {
+    localAddress();
+    noAddress();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,215 @@
+/**
+ * @file test_executor.cpp
+ * @brief Work-stealing deque, callback group ordering, poller wakeups,
+ *        client deadlines and coroutines on an executor
+ */
+
+#include "capybarish_coro.h"
+#include "capybarish_executor.h"
+#include "motor_control_messages.hpp"
+#include "host_test.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace motor_control;
+
+static void busyUs(uint32_t us) {
+    const uint32_t start = micros();
+    while (micros() - start < us) {}
+}
+
+// One owner pushing and popping, three thieves; every item is taken once
+static void deque() {
+    constexpr int ITEMS = 100000;
+    cpy::WorkStealingDeque<int> deque;
+    deque.reserve(1024);
+    std::vector<int> items(ITEMS);
+    std::atomic<long> sum{0};
+    std::atomic<bool> done{false};
+
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < 3; t++) {
+        thieves.emplace_back([&] {
+            while (!done || !deque.empty()) {
+                if (int* item = deque.steal()) sum += *item;
+            }
+        });
+    }
+    long expected = 0;
+    for (int i = 0; i < ITEMS; i++) {
+        items[i] = i;
+        expected += i;
+        while (!deque.push(&items[i])) {
+            if (int* item = deque.pop()) sum += *item;
+        }
+        if (i % 3 == 0) {
+            if (int* item = deque.pop()) sum += *item;
+        }
+    }
+    while (int* item = deque.pop()) sum += *item;
+    done = true;
+    for (auto& thief : thieves) thief.join();
+    CHECK(sum == expected);
+}
+
+// N subscriptions over loopback: nothing lost, each in order, and only a
+// reentrant group lets callbacks overlap
+static void groups(cpy::CallbackGroupType type) {
+    constexpr int SUBS = 8;
+    constexpr int MESSAGES = 100;
+    constexpr uint16_t PORT = 17340;
+
+    cpy::Node node("gateway");
+    std::atomic<int> received{0}, inside{0}, overlap{0}, outOfOrder{0};
+    int last[SUBS];
+    for (int i = 0; i < SUBS; i++) {
+        last[i] = -1;
+        node.createSubscription<MotorCommand>("/cmd", [&, i](const MotorCommand& cmd) {
+            int now = ++inside;
+            int peak = overlap;
+            while (now > peak && !overlap.compare_exchange_weak(peak, now)) {}
+            if (cmd.joint_id != last[i] + 1) outOfOrder++;
+            last[i] = cmd.joint_id;
+            std::this_thread::sleep_for(std::chrono::microseconds(300));
+            --inside;
+            ++received;
+        }, PORT + i, cpy::QoSProfile::defaultProfile());
+    }
+
+    cpy::Executor exec({.threads = 4});
+    exec.add(node, exec.createCallbackGroup(type));
+    exec.start();
+
+    std::vector<std::unique_ptr<cpy::Publisher<MotorCommand>>> pubs;
+    for (int i = 0; i < SUBS; i++) {
+        pubs.push_back(std::make_unique<cpy::Publisher<MotorCommand>>("/cmd", "127.0.0.1", PORT + i));
+        pubs.back()->init();
+    }
+    for (int m = 0; m < MESSAGES; m++) {
+        for (auto& pub : pubs) {
+            MotorCommand cmd{};
+            cmd.joint_id = m;
+            pub->publish(cmd);
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(2500));
+    }
+    const uint32_t start = millis();
+    while (received < SUBS * MESSAGES && millis() - start < 10000) delay(1);
+    exec.stop();
+
+    CHECK(received == SUBS * MESSAGES);
+    CHECK(outOfOrder == 0);
+    if (type == cpy::CallbackGroupType::MUTUALLY_EXCLUSIVE) {
+        CHECK(overlap == 1);
+    } else {
+        CHECK(overlap > 1);
+    }
+}
+
+// A long callback outlasts the idle workers' naps, so another worker is
+// the poller, blocked in select() on the idle subscription only. The next
+// datagram lands while the callback runs; when it ends the poller must be
+// woken to pick it up rather than sit out MAX_POLL_US.
+static void wakeup() {
+    constexpr int MESSAGES = 20;
+    constexpr uint16_t PORT = 17360;
+    constexpr uint32_t BUSY_US = 12000;  // Longer than MAX_POLL_US
+
+    cpy::Node node("busy");
+    std::atomic<uint32_t> endUs{0};
+    std::atomic<int> started{0};
+    std::vector<uint32_t> latency;
+    node.createSubscription<MotorCommand>("/cmd", [&](const MotorCommand&) {
+        if (started > 0) latency.push_back(micros() - endUs);
+        ++started;
+        busyUs(BUSY_US);
+        endUs = micros();
+    }, PORT, cpy::QoSProfile::control());
+    node.createSubscription<MotorCommand>("/idle", [](const MotorCommand&) {}, PORT + 1);
+
+    cpy::Executor exec({.threads = 2});
+    exec.add(node);
+    exec.start();
+
+    cpy::Publisher<MotorCommand> pub("/cmd", "127.0.0.1", PORT);
+    pub.init();
+    for (int i = 0; i < MESSAGES; i++) {
+        while (started < i) std::this_thread::yield();
+        if (i > 0) busyUs(BUSY_US / 2);
+        pub.publish(MotorCommand{});
+    }
+    const uint32_t start = millis();
+    while (started < MESSAGES && millis() - start < 5000) delay(1);
+    exec.stop();
+
+    CHECK(latency.size() == MESSAGES - 1);
+    std::sort(latency.begin(), latency.end());
+    uint32_t median = latency.empty() ? UINT32_MAX : latency[latency.size() / 2];
+    std::printf("median latency %u us\n", median);
+    CHECK(median < 500);  // A blind poll waits milliseconds
+}
+
+// A call to a server that never answers times out on the executor too:
+// the client is polled for its socket and its deadline
+static void clientDeadline() {
+    constexpr uint16_t PORT = 17370;
+    constexpr uint32_t TIMEOUT_US = 20000;
+
+    cpy::Node node("caller");
+    std::atomic<int> status{-1};
+    std::atomic<uint32_t> doneUs{0};
+    auto* client = node.createClient<MotorCommand, SensorData>("/get", "127.0.0.1", PORT, PORT + 1,
+        [&](uint32_t, cpy::RpcStatus s, const SensorData&) {
+            doneUs = micros();
+            status = static_cast<int>(s);
+        });
+    const uint32_t sentUs = micros();
+    CHECK(client->send(MotorCommand{}, TIMEOUT_US) != 0);
+
+    cpy::Executor exec({.threads = 2});
+    exec.add(node);
+    exec.start();
+    const uint32_t start = millis();
+    while (status < 0 && millis() - start < 1000) delay(1);
+    exec.stop();
+
+    CHECK(status == static_cast<int>(cpy::RpcStatus::TIMEOUT));
+    CHECK(doneUs - sentUs >= TIMEOUT_US && doneUs - sentUs < TIMEOUT_US + 5000);
+}
+
+static cpy::Task nap(cpy::Node& node, bool* woke) {
+    co_await node.sleepFor(1000000);
+    *woke = true;
+}
+
+// Coroutines are resumed by spinOnce() only: a node with a parked one is
+// refused, and one added afterwards does not hang
+static void coroutines() {
+    cpy::Node parked("parked");
+    bool woke = false;
+    nap(parked, &woke);
+    CHECK(parked.getWaitCount() == 1);
+    cpy::Executor refusing({.threads = 1});
+    CHECK(!refusing.add(parked));
+
+    cpy::Node node("run");
+    cpy::Executor exec({.threads = 1});
+    CHECK(exec.add(node));
+    CHECK(nap(node, &woke).valid());
+    CHECK(woke);  // Right away, not parked
+    CHECK(node.getWaitCount() == 0);
+}
+
+int main() {
+    deque();
+    groups(cpy::CallbackGroupType::MUTUALLY_EXCLUSIVE);
+    groups(cpy::CallbackGroupType::REENTRANT);
+    wakeup();
+    clientDeadline();
+    coroutines();
+    return HOST_TEST_RESULT();
+}
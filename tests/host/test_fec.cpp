@@ -0,0 +1,102 @@
+/**
+ * @file test_fec.cpp
+ * @brief FEC recovery with two publishers on one subscription
+ */
+
+#include "capybarish_pubsub.h"
+#include "motor_control_messages.hpp"
+#include "host_test.h"
+
+#include <deque>
+#include <vector>
+
+using namespace motor_control;
+
+// In-memory transport that loses the datagrams it is told to
+class LossyTransport : public cpy::Transport {
+public:
+    bool send(uint16_t, const uint8_t* data, size_t len) override {
+        if (loseNext) {
+            loseNext = false;
+            return true;
+        }
+        _queue.emplace_back(data, data + len);
+        return true;
+    }
+
+    size_t receive(uint16_t, uint8_t* buffer, size_t capacity) override {
+        if (_queue.empty()) return 0;
+        size_t len = min(capacity, _queue.front().size());
+        memcpy(buffer, _queue.front().data(), len);
+        _queue.pop_front();
+        return len;
+    }
+
+    const char* name() const override { return "lossy"; }
+
+    bool loseNext = false;
+
+private:
+    std::deque<std::vector<uint8_t>> _queue;
+};
+
+static void publish(cpy::Publisher<MotorCommand>& pub, int joint, float target) {
+    MotorCommand msg{};
+    msg.joint_id = joint;
+    msg.target = target;
+    pub.publish(msg);
+}
+
+// Two publishers, the first of every group of 3 lost from each
+static void twoPublishers() {
+    LossyTransport net;
+    std::vector<float> received[2];
+    cpy::Subscription<MotorCommand> sub("/cmd", [&](const MotorCommand& msg) { received[msg.joint_id].push_back(msg.target); },
+                                        7000, cpy::QoSProfile::defaultProfile(), &net);
+    cpy::Publisher<MotorCommand> a("/cmd", "", 7000, 0, cpy::QoSProfile::lossyControl(3), false, &net);
+    cpy::Publisher<MotorCommand> b("/cmd", "", 7000, 0, cpy::QoSProfile::lossyControl(3), false, &net);
+    sub.init();
+    a.init();
+    b.init();
+
+    for (int i = 0; i < 6; i++) publish(b, 1, -1);  // b's sequence numbers run ahead
+    while (sub.spinOnce()) {}
+    received[1].clear();
+
+    for (int i = 0; i < 9; i++) {
+        net.loseNext = i % 3 == 0;
+        publish(a, 0, i);
+        net.loseNext = i % 3 == 2;
+        publish(b, 1, i);
+        while (sub.spinOnce()) {}
+    }
+    CHECK(received[0].size() == 9);
+    CHECK(received[1].size() == 9);
+    CHECK(sub.getRecoveredCount() == 6);
+}
+
+// A rebuilt command older than one already delivered
+static void staleRecovery(cpy::QoSProfile qos, size_t expected) {
+    LossyTransport net;
+    std::vector<float> received;
+    cpy::Subscription<MotorCommand> sub("/cmd", [&](const MotorCommand& msg) { received.push_back(msg.target); },
+                                        7000, qos, &net);
+    cpy::Publisher<MotorCommand> pub("/cmd", "", 7000, 0, cpy::QoSProfile::lossyControl(3), false, &net);
+    sub.init();
+    pub.init();
+
+    for (int i = 0; i < 6; i++) {
+        net.loseNext = i == 1 || i == 5;  // Middle of group 0, last of group 1
+        publish(pub, 0, i);
+        while (sub.spinOnce()) {}
+    }
+    CHECK(received.size() == expected);
+    CHECK(received.back() == 5);
+}
+
+int main() {
+    twoPublishers();
+    staleRecovery(cpy::QoSProfile::defaultProfile(), 6);
+    staleRecovery(cpy::QoSProfile::lossyControl(3), 5);
+    return HOST_TEST_RESULT();
+}
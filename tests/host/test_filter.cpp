@@ -0,0 +1,116 @@
+/**
+ * @file test_filter.cpp
+ * @brief ContentFilter parsing, evaluation and use on a subscription
+ */
+
+#include "capybarish_pubsub.h"
+#include "motor_control_messages.hpp"
+#include "multi_robot_messages.hpp"
+#include "host_test.h"
+
+using namespace motor_control;
+
+static bool matches(const cpy::ContentFilter& filter, const MotorCommand& cmd) {
+    uint8_t buffer[MotorCommand::SIZE];
+    cmd.serialize(buffer);
+    return filter.match(buffer, sizeof(buffer));
+}
+
+static void expressions() {
+    cpy::ContentFilter filter;
+    CHECK(filter.addField<&MotorCommand::joint_id>("joint_id"));
+    CHECK(filter.addField<&MotorCommand::target>("target"));
+    CHECK(filter.addField<&MotorCommand::command_context>("ctx"));
+    CHECK(filter.addField<&MotorCommand::switch_>("switch"));
+
+    MotorCommand cmd{};
+    CHECK(matches(filter, cmd));  // Empty filter
+
+    CHECK(filter.compile("joint_id == 3 || joint_id == -1"));
+    cmd.joint_id = 3;
+    CHECK(matches(filter, cmd));
+    cmd.joint_id = -1;
+    CHECK(matches(filter, cmd));
+    cmd.joint_id = 2;
+    CHECK(!matches(filter, cmd));
+
+    CHECK(filter.compile("joint_id in {1, 2, 5} && !(target > 0.5)"));
+    cmd.target = 0.5f;
+    CHECK(matches(filter, cmd));
+    cmd.target = 0.6f;
+    CHECK(!matches(filter, cmd));
+    cmd.joint_id = 3;
+    cmd.target = 0;
+    CHECK(!matches(filter, cmd));
+
+    // && binds tighter than ||
+    CHECK(filter.compile("joint_id not in {1,2} && ctx[7] <= -1.5 || switch == true"));
+    cmd.command_context[7] = -2;
+    CHECK(matches(filter, cmd));
+    cmd.command_context[7] = 0;
+    CHECK(!matches(filter, cmd));
+    cmd.switch_ = 1;
+    CHECK(matches(filter, cmd));
+
+    // A failed compile reports why and keeps the previous program
+    const char* invalid[] = {"joint_id == 1.5", "nope == 1", "ctx > 0", "ctx[8] > 0", "joint_id = 1",
+                             "(joint_id == 1", "joint_id == 1 extra", "", "joint_id in {1,"};
+    for (const char* expr : invalid) {
+        CHECK(!filter.compile(expr));
+        CHECK(filter.lastError()[0] != '\0');
+    }
+    CHECK(matches(filter, cmd));
+
+    uint8_t truncated[10] = {};
+    CHECK(!filter.match(truncated, sizeof(truncated)));
+}
+
+static void wideFields() {
+    cpy::ContentFilter filter;
+    CHECK(filter.addField<&multi_robot::MocapPose::body_id>("body_id"));
+    CHECK(filter.addField<&multi_robot::MocapPose::timestamp_us>("t"));
+    CHECK(filter.compile("body_id >= 2 && t > 1000000000000"));
+
+    multi_robot::MocapPose pose{};
+    pose.body_id = 2;
+    pose.timestamp_us = 1000000000001ull;
+    uint8_t buffer[sizeof(pose)];
+    memcpy(buffer, &pose, sizeof(pose));
+    CHECK(filter.match(buffer, sizeof(buffer)));
+    pose.timestamp_us = 1000000000000ull;
+    memcpy(buffer, &pose, sizeof(pose));
+    CHECK(!filter.match(buffer, sizeof(buffer)));
+}
+
+static void subscription() {
+    cpy::Node node("filter");
+    int received = 0;
+    auto* sub = node.createSubscription<MotorCommand>("/cmd", [&](const MotorCommand& cmd) {
+        CHECK(cmd.joint_id == 3 || cmd.joint_id == -1);
+        received++;
+    }, 17330);
+
+    cpy::ContentFilter mine;
+    mine.addField<&MotorCommand::joint_id>("joint_id");
+    CHECK(mine.compile("joint_id == 3 || joint_id == -1"));
+    sub->setFilter(&mine);
+
+    cpy::Publisher<MotorCommand> pub("/cmd", "127.0.0.1", 17330);
+    pub.init();
+    for (int joint = -1; joint < 8; joint++) {
+        MotorCommand cmd{};
+        cmd.joint_id = joint;
+        pub.publish(cmd);
+    }
+    node.spinFor(20000);
+    CHECK(received == 2);
+    CHECK(sub->getFilteredCount() == 7);
+    CHECK(sub->getReceiveCount() == 2);
+}
+
+int main() {
+    expressions();
+    wideFields();
+    subscription();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,92 @@
+/**
+ * @file test_serial.cpp
+ * @brief SerialTransport shared by publishers and subscriptions on several threads
+ */
+
+#include "capybarish_serial.h"
+#include "host_test.h"
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Stream whose writes come back as reads, thread-safe like a UART driver
+class LoopbackStream : public Stream {
+public:
+    using Print::write;
+
+    size_t write(uint8_t byte) override { return write(&byte, 1); }
+
+    size_t write(const uint8_t* data, size_t len) override {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _bytes.insert(_bytes.end(), data, data + len);
+        return len;
+    }
+
+    int available() override {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return static_cast<int>(_bytes.size());
+    }
+
+    int read() override {
+        uint8_t byte;
+        return readBytes(&byte, 1) == 1 ? byte : -1;
+    }
+
+    size_t readBytes(uint8_t* data, size_t len) override {
+        std::lock_guard<std::mutex> lock(_mutex);
+        size_t n = min(len, _bytes.size());
+        std::copy(_bytes.begin(), _bytes.begin() + n, data);
+        _bytes.erase(_bytes.begin(), _bytes.begin() + n);
+        return n;
+    }
+
+private:
+    std::mutex _mutex;
+    std::deque<uint8_t> _bytes;
+};
+
+static constexpr int THREADS = 4;
+static constexpr int MESSAGES = 2000;
+
+int main() {
+    LoopbackStream stream;
+    cpy::SerialTransport<64, 64> link(stream);
+    std::atomic<int> received[THREADS] = {};
+    std::atomic<int> corrupt{0};
+    std::atomic<bool> sending{true};
+
+    // One publisher and one subscription per port, each on its own thread
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++) {
+        threads.emplace_back([&, t] {
+            uint8_t msg[32];
+            for (int i = 0; i < MESSAGES; i++) {
+                memset(msg, t * 16 + i % 16, sizeof(msg));
+                while (!link.send(7000 + t, msg, sizeof(msg))) {}
+            }
+        });
+        threads.emplace_back([&, t] {
+            uint8_t msg[64];
+            while (sending || link.pending() > 0 || stream.available() > 0) {
+                size_t len = link.receive(7000 + t, msg, sizeof(msg));
+                if (len == 0) continue;
+                if (len != 32 || msg[0] / 16 != t || memcmp(msg, msg + 1, 31) != 0) corrupt++;
+                received[t]++;
+            }
+        });
+    }
+    for (int t = 0; t < THREADS; t++) threads[2 * t].join();
+    sending = false;
+    for (int t = 0; t < THREADS; t++) threads[2 * t + 1].join();
+
+    CHECK(corrupt == 0);
+    CHECK(link.getCrcErrors() == 0);
+    CHECK(link.getFramingErrors() == 0);
+    int total = 0;
+    for (int t = 0; t < THREADS; t++) total += received[t];
+    CHECK(total + static_cast<int>(link.getOverflowCount()) == THREADS * MESSAGES);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,56 @@
+/**
+ * @file test_shared.cpp
+ * @brief Seqlock reads against a racing writer, spinning and not
+ */
+
+#include "capybarish_shared.h"
+#include "motor_control_messages.hpp"
+#include "host_test.h"
+
+#include <atomic>
+#include <thread>
+
+using namespace motor_control;
+
+static bool consistent(const SensorData& d) {
+    return d.motor.pos == d.motor.vel && d.motor.pos == d.timestamp;
+}
+
+// Every field equals the write counter, so a torn copy shows up
+static void racing(bool spin) {
+    constexpr uint32_t WRITES = 200000;
+    cpy::Seqlock<SensorData> lock;
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        SensorData d{};
+        for (uint32_t i = 1; i <= WRITES; i++) {
+            d.motor.pos = d.motor.vel = static_cast<float>(i);
+            d.timestamp = static_cast<int32_t>(i);
+            lock.write(d);
+        }
+        done = true;
+    });
+
+    uint32_t seen = 0;
+    int32_t last = 0;
+    SensorData d;
+    while (!done) {
+        bool newer = spin ? lock.readIfNewer(d, seen) : lock.tryReadIfNewer(d, seen);
+        if (!newer) continue;
+        CHECK(consistent(d));
+        CHECK(d.timestamp > last);
+        last = d.timestamp;
+    }
+    writer.join();
+
+    if (lock.tryReadIfNewer(d, seen)) last = d.timestamp;
+    CHECK(last == static_cast<int32_t>(WRITES) && seen == WRITES);
+    CHECK(!lock.tryReadIfNewer(d, seen));
+    CHECK(!lock.readIfNewer(d, seen));
+}
+
+int main() {
+    racing(true);
+    racing(false);
+    return HOST_TEST_RESULT();
+}
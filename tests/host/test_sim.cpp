@@ -0,0 +1,126 @@
+/**
+ * @file test_sim.cpp
+ * @brief Seeded simulations repeat exactly, with and without loss and jitter
+ */
+
+#include "capybarish_sim.h"
+#include "capybarish_coro.h"
+#include "motor_control_messages.hpp"
+#include "host_test.h"
+
+#include <memory>
+#include <vector>
+
+using namespace motor_control;
+
+struct Counters {
+    uint64_t steps, spins, callbacks;
+    uint64_t sent, delivered, lost, overflow;
+    uint64_t feedback, commands;
+    uint64_t trace;  // Order and virtual time of every feedback message
+
+    bool operator==(const Counters&) const = default;
+};
+
+struct Module {
+    cpy::Node node;
+    uint64_t commands = 0;
+
+    Module(int id, cpy::Transport* transport) : node("module", "", transport) {
+        auto* pub = node.createPublisher<SensorData>("/feedback", "", 6666);
+        node.createSubscription<MotorCommand>("/cmd", [this](const MotorCommand&) { commands++; }, 6667);
+        node.createTimer(0.001f, [pub, id] {
+            SensorData d{};
+            d.module_id = id;
+            d.timestamp = static_cast<int32_t>(cpy::nowUs());
+            pub->publish(d);
+        });
+    }
+};
+
+// A server commanding N modules at 50 Hz, fed back at 1 kHz, for 2 s
+static Counters run(const cpy::SimLinkConfig& link, uint64_t seed) {
+    constexpr int MODULES = 20;
+    cpy::Simulation sim(link, seed);
+    Counters c = {};
+    c.trace = 1469598103934665603ull;
+
+    cpy::Node server("server", "", sim.createTransport("server"));
+    server.createSubscription<SensorData>("/feedback", [&](const SensorData& d) {
+        c.feedback++;
+        c.trace = (c.trace ^ d.module_id ^ (uint64_t(cpy::nowUs()) << 20)) * 1099511628211ull;
+    }, 6666, cpy::QoSProfile::defaultProfile());
+    auto* cmd = server.createPublisher<MotorCommand>("/cmd", "", 6667);
+    server.createTimer(0.02f, [cmd] { cmd->publish(MotorCommand{}); });
+    sim.addNode(&server);
+
+    std::vector<std::unique_ptr<Module>> modules;
+    for (int i = 0; i < MODULES; i++) {
+        modules.push_back(std::make_unique<Module>(i, sim.createTransport("module")));
+        sim.addNode(&modules.back()->node);
+    }
+
+    c.callbacks = sim.runFor(2000000);
+    c.steps = sim.getStepCount();
+    c.spins = sim.getSpinCount();
+    c.sent = sim.network().getSentCount();
+    c.delivered = sim.network().getDeliveredCount();
+    c.lost = sim.network().getLostCount();
+    c.overflow = sim.network().getOverflowCount();
+    for (const auto& m : modules) c.commands += m->commands;
+    return c;
+}
+
+static void clean() {
+    cpy::SimLinkConfig link;
+    Counters a = run(link, 7);
+    Counters b = run(link, 7);
+    CHECK(a == b);
+    CHECK(a.lost == 0 && a.overflow == 0);
+    // 100 commands and 2000 feedback messages each; the last are in flight
+    CHECK(a.commands == 20 * 99);
+    CHECK(a.feedback == 20 * 1999);
+    CHECK(a.delivered == a.feedback + a.commands);
+}
+
+static void lossy() {
+    cpy::SimLinkConfig link = {.latencyUs = 300, .jitterUs = 200, .lossRate = 0.05f, .queueDepth = 256};
+    Counters a = run(link, 7);
+    Counters b = run(link, 7);
+    Counters other = run(link, 8);
+    CHECK(a == b);
+    CHECK(a.lost > 0);
+    CHECK(a.feedback < 20 * 2000);
+    CHECK(a.lost != other.lost || a.trace != other.trace);
+    std::printf("lossy: steps=%llu sent=%llu lost=%llu feedback=%llu\n",
+                static_cast<unsigned long long>(a.steps), static_cast<unsigned long long>(a.sent),
+                static_cast<unsigned long long>(a.lost), static_cast<unsigned long long>(a.feedback));
+}
+
+static cpy::Task sleeper(cpy::Node& node, uint64_t* wokeUs) {
+    co_await node.sleepFor(2500);
+    wokeUs[0] = cpy::nowUs();
+    co_await node.sleepFor(1000000);
+    wokeUs[1] = cpy::nowUs();
+}
+
+// Coroutines sleep in virtual time, and the clock is released afterwards
+static void virtualTime() {
+    {
+        cpy::Simulation sim;
+        cpy::Node node("sleeper", "", sim.createTransport("sleeper"));
+        sim.addNode(&node);
+        uint64_t woke[2] = {0, 0};
+        sleeper(node, woke);
+        sim.runFor(2000000);
+        CHECK(woke[0] == 2500 && woke[1] == 1002500);
+    }
+    CHECK(cpy::activeClock() == nullptr);
+}
+
+int main() {
+    clean();
+    lossy();
+    virtualTime();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,54 @@
+/**
+ * @file test_spin.cpp
+ * @brief Node::spinFor() wakes on arrival even between sub-millisecond timers
+ */
+
+#include "capybarish_pubsub.h"
+#include "motor_control_messages.hpp"
+#include "host_test.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace motor_control;
+
+static constexpr uint16_t PORT = 17320;
+static constexpr int SAMPLES = 60;
+
+int main() {
+    cpy::Node node("spin");
+    std::atomic<uint32_t> sentUs{0};
+    std::vector<uint32_t> latency;
+    node.createSubscription<MotorCommand>("/cmd", [&](const MotorCommand&) {
+        latency.push_back(micros() - sentUs);
+    }, PORT, cpy::QoSProfile::control());
+
+    // Every sleep is shorter than a millisecond
+    uint32_t ticks = 0;
+    node.createTimer(0.0007f, [&] { ticks++; });
+
+    std::atomic<bool> done{false};
+    std::thread sender([&] {
+        cpy::Publisher<MotorCommand> pub("/cmd", "127.0.0.1", PORT);
+        pub.init();
+        for (int i = 0; i < SAMPLES; i++) {
+            delayMicroseconds(2000 + 97 * (i % 7));  // Land anywhere between two ticks
+            sentUs = micros();
+            pub.publish(MotorCommand{});
+        }
+        delay(5);
+        done = true;
+    });
+    while (!done) node.spinFor(10000);
+    sender.join();
+
+    CHECK(latency.size() == SAMPLES);
+    CHECK(ticks > 100);
+    std::sort(latency.begin(), latency.end());
+    uint32_t median = latency.empty() ? UINT32_MAX : latency[latency.size() / 2];
+    std::printf("median latency %u us\n", median);
+    CHECK(median < 200);  // Polling between ticks would average about 350 us
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,70 @@
+/**
+ * @file test_streams.cpp
+ * @brief Framed topics with several publishers on one subscription port
+ */
+
+#include "capybarish_pubsub.h"
+#include "motor_control_messages.hpp"
+#include "host_test.h"
+
+using namespace motor_control;
+
+static constexpr uint16_t PORT = 17310;
+
+// Take everything that arrives until the port has been quiet for 20 ms
+static void drain(cpy::Subscription<SensorData>& sub) {
+    uint32_t quietSince = micros();
+    while (micros() - quietSince < 20000) {
+        if (sub.spinOnce()) quietSince = micros();
+    }
+}
+
+// Every message goes out twice, so the frames carry sequence numbers
+static cpy::Publisher<SensorData>* redundantPublisher() {
+    auto* pub = new cpy::Publisher<SensorData>("/fb", "127.0.0.1", PORT);
+    pub->init();
+    pub->addPath("127.0.0.1", PORT);
+    return pub;
+}
+
+static void publish(cpy::Publisher<SensorData>* pub, int module) {
+    SensorData msg{};
+    msg.module_id = module;
+    pub->publish(msg);
+}
+
+int main() {
+    uint32_t received[3] = {};
+    cpy::Subscription<SensorData> sub("/fb", [&](const SensorData& msg) { received[msg.module_id]++; }, PORT);
+    CHECK(sub.init());
+
+    // Module 1 has been running for a while before module 2 starts
+    auto* first = redundantPublisher();
+    for (int i = 0; i < 300; i++) {
+        publish(first, 1);
+        if (i % 10 == 0) drain(sub);  // Stay well inside the socket buffer
+    }
+    drain(sub);
+
+    auto* second = redundantPublisher();
+    for (int i = 0; i < 50; i++) {
+        publish(first, 1);
+        publish(second, 2);
+        if (i % 10 == 0) drain(sub);
+    }
+    drain(sub);
+    CHECK(received[1] == 350);
+    CHECK(received[2] == 50);
+    CHECK(sub.getDuplicateCount() == 400);
+
+    // Module 2 restarts: its sequence numbers begin at 0 again
+    delete second;
+    second = redundantPublisher();
+    for (int i = 0; i < 10; i++) publish(second, 2);
+    drain(sub);
+    CHECK(received[2] == 60);
+
+    delete first;
+    delete second;
+    return HOST_TEST_RESULT();
+}
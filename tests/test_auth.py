@@ -0,0 +1,209 @@
+"""
+Tests for the auth module.
+
+Checks SipHash against the reference vectors, the sealed datagram layout
+against bytes produced by cpy::MessageAuth (capybarish_auth.h), and the
+replay window.
+"""
+
+import struct
+
+import pytest
+
+from capybarish.auth import (
+    CHECKPOINT_INTERVAL,
+    MAX_SENDERS,
+    TRAILER_SIZE,
+    MessageAuth,
+    ReplayGuard,
+    ReplayResult,
+    ReplayWindow,
+    parse_key,
+    siphash24,
+)
+from capybarish.generated.motor_control_messages import MotorCommand
+from capybarish.pubsub import Node, TopicManager
+
+KEY = "000102030405060708090a0b0c0d0e0f"
+
+
+@pytest.fixture(autouse=True)
+def reset_topic_manager():
+    """Give every test a fresh topic/node registry."""
+    TopicManager.reset()
+    yield
+    TopicManager.reset()
+
+
+class TestSipHash:
+    """Test the MAC primitive."""
+
+    def test_reference_vectors(self):
+        k0, k1 = struct.unpack("<QQ", parse_key(KEY))
+        assert siphash24(k0, k1, b"") == 0x726FDB47DD0E0E31
+        assert siphash24(k0, k1, bytes(range(15))) == 0xA129CA6149BE45E5
+
+    def test_key_parsing(self):
+        assert parse_key(KEY) == bytes(range(16))
+        with pytest.raises(ValueError):
+            parse_key("0011")
+
+
+class TestMessageAuth:
+    """Test sealing, opening and replay protection."""
+
+    def test_matches_cpp(self):
+        # cpy::MessageAuth::seal("hello capybara", sender 0x01020304, seq 0x0000000500000001)
+        auth = MessageAuth(KEY, "/motor/command", first_seq=0x0000000500000001, sender=0x01020304)
+        assert auth.seal(b"hello capybara").hex() == (
+            "68656c6c6f2063617079626172610403020101000000050000007f909d4b8d8a64ae")
+
+    def test_roundtrip_and_sequence(self):
+        tx = MessageAuth(KEY, "/motor/command", first_seq=7, sender=3)
+        rx = MessageAuth(KEY, "/motor/command")
+        sealed = tx.seal(b"payload")
+        assert len(sealed) == len(b"payload") + TRAILER_SIZE
+        assert rx.open(sealed) == (b"payload", 3, 7)
+        assert rx.open(tx.seal(b"payload"))[2] == 8
+
+    def test_forgery_is_rejected(self):
+        tx = MessageAuth(KEY, "/motor/command")
+        rx = MessageAuth(KEY, "/motor/command")
+        sealed = bytearray(tx.seal(b"payload"))
+        sealed[0] ^= 1
+        assert rx.accept(bytes(sealed)) == (None, False)
+        assert rx.accept(b"short") == (None, False)
+
+    def test_topic_binds_the_key(self):
+        sealed = MessageAuth(KEY, "/motor/other").seal(b"payload")
+        assert MessageAuth(KEY, "/motor/command").open(sealed) is None
+
+    def test_replay_is_rejected(self):
+        tx = MessageAuth(KEY, "/motor/command", first_seq=100)
+        rx = MessageAuth(KEY, "/motor/command")
+        first = tx.seal(b"a")
+        assert rx.accept(first) == (b"a", True)
+        assert rx.accept(first) == (None, True)
+
+    def test_senders_have_their_own_windows(self):
+        rx = MessageAuth(KEY, "/motor/command")
+        late = MessageAuth(KEY, "/motor/command", first_seq=5 << 32, sender=1)
+        early = MessageAuth(KEY, "/motor/command", first_seq=1, sender=2)
+        assert rx.accept(late.seal(b"a")) == (b"a", True)
+        assert rx.accept(early.seal(b"b")) == (b"b", True)
+
+        # Changing the sender breaks the tag
+        sealed = bytearray(early.seal(b"c"))
+        sealed[1] ^= 1
+        assert rx.accept(bytes(sealed)) == (None, False)
+
+    def test_default_sequence_grows_across_restarts(self):
+        before = MessageAuth(KEY, "/t").seq
+        assert MessageAuth(KEY, "/t").seq >= before > 1 << 50
+
+
+class TestReplayWindow:
+    """Test the 64-bit anti-replay window."""
+
+    def test_reordering_within_window(self):
+        window = ReplayWindow()
+        assert window.accept(1000)
+        assert window.accept(990)
+        assert not window.accept(990)
+        assert window.accept(1100)
+        assert window.accept(1099)
+        assert not window.accept(1000)  # Fell out of the window
+
+    def test_never_moves_back(self):
+        window = ReplayWindow()
+        assert window.accept(5 << 32)
+        assert not window.accept(0)
+        window.reset()
+        assert window.accept(0)
+
+
+class TestReplayGuard:
+    """Test per-sender windows and checkpoints (cpy::ReplayGuard)."""
+
+    def test_checkpoints_survive_restart(self, tmp_path):
+        guard = ReplayGuard()
+        assert guard.accept(7, 100) == ReplayResult.ACCEPTED and guard.checkpoint_due
+        assert guard.checkpoints() == {7: 100} and not guard.checkpoint_due
+        for seq in range(101, 100 + CHECKPOINT_INTERVAL):
+            guard.accept(7, seq)
+        assert not guard.checkpoint_due
+        guard.accept(7, 100 + CHECKPOINT_INTERVAL)
+        assert guard.checkpoint_due
+        guard.save(str(tmp_path / "replay.json"))
+
+        restarted = ReplayGuard()
+        assert restarted.load(str(tmp_path / "replay.json"))
+        assert restarted.accept(7, 150) == ReplayResult.REPLAYED
+        assert restarted.accept(7, 100 + CHECKPOINT_INTERVAL) == ReplayResult.REPLAYED
+        assert restarted.accept(7, 101 + CHECKPOINT_INTERVAL) == ReplayResult.ACCEPTED
+        assert not ReplayGuard().load(str(tmp_path / "missing.json"))
+
+    def test_sender_table_is_bounded(self):
+        guard = ReplayGuard()
+        guard.restore({99: 1000})
+        for sender in range(1, MAX_SENDERS):
+            assert guard.accept(sender, 5) == ReplayResult.ACCEPTED
+        # The restored sender has not been heard from, so it makes way
+        assert guard.accept(50, 5) == ReplayResult.ACCEPTED
+        assert guard.accept(51, 5) == ReplayResult.TOO_MANY_SENDERS
+
+
+class TestPubSubAuth:
+    """Test authentication on network topics."""
+
+    def test_subscription_filters_datagrams(self):
+        node = Node("module")
+        sub = node.create_subscription(MotorCommand, "/motor/command", lambda msg: None)
+        sub.set_auth(KEY)
+        tx = MessageAuth(KEY, "/motor/command", first_seq=1)
+        payload = MotorCommand(target=1.5).serialize()
+
+        sealed = tx.seal(payload)
+        sub._receive_datagram(sealed)
+        sub._receive_datagram(sealed)                   # Replay
+        sub._receive_datagram(payload)                  # Unauthenticated
+        sub._receive_datagram(MessageAuth("ff" * 16, "/motor/command").seal(payload))
+        assert sub.take(timeout=0).target == pytest.approx(1.5)
+        assert sub.take(timeout=0) is None
+        assert sub.auth_fail_count == 2
+        assert sub.duplicate_count == 1
+        node.destroy()
+
+    def test_subscription_restores_checkpoints(self, tmp_path):
+        state = str(tmp_path / "replay.json")
+        tx = MessageAuth(KEY, "/motor/command", first_seq=1)
+        recorded = [tx.seal(MotorCommand(target=i).serialize()) for i in range(3)]
+
+        node = Node("module")
+        sub = node.create_subscription(MotorCommand, "/motor/command", lambda msg: None)
+        sub.set_auth(KEY, state_path=state)
+        sub._receive_datagram(recorded[0])
+        node.destroy()
+
+        # After a restart the recording is refused up to the checkpoint
+        TopicManager.reset()
+        node = Node("module")
+        sub = node.create_subscription(MotorCommand, "/motor/command", lambda msg: None)
+        sub.set_auth(KEY, state_path=state)
+        sub._receive_datagram(recorded[0])
+        assert sub.take(timeout=0) is None and sub.duplicate_count == 1
+        sub._receive_datagram(recorded[1])
+        assert sub.take(timeout=0).target == pytest.approx(1.0)
+        node.destroy()
+
+    def test_publisher_seals_and_budgets_trailer(self):
+        node = Node("server")
+        pub = node.create_publisher(MotorCommand, "/motor/command")
+        pub.add_remote_endpoint("127.0.0.1", 9)
+        plain = pub._wire_cost(MotorCommand())
+        pub.set_auth(KEY, first_seq=42)
+        assert pub._wire_cost(MotorCommand()) == plain + TRAILER_SIZE
+        pub.publish(MotorCommand())
+        assert pub.byte_count == MotorCommand._SIZE + TRAILER_SIZE
+        assert pub._auth.seq == 43
+        node.destroy()
@@ -0,0 +1,116 @@
+"""
+Tests for the Cybergear CAN codec and SocketCAN bus.
+
+The codec vectors are shared with the ESP32 library (capybarish_cybergear.h).
+Bus tests need a virtual CAN interface and are skipped without one:
+
+    sudo modprobe vcan
+    sudo ip link add dev vcan0 type vcan && sudo ip link set up vcan0
+"""
+
+import math
+import os
+import socket
+import struct
+
+import pytest
+
+from capybarish.devices import cybergear as cg
+from capybarish.generated import MotorData
+
+
+def _vcan_available() -> bool:
+    return hasattr(socket, 'AF_CAN') and os.path.exists('/sys/class/net/vcan0')
+
+
+def _feedback_frame(motor_id, pos, vel, torque, temp_c, faults=0, mode=2, host=cg.DEFAULT_HOST_ID):
+    area2 = (mode << 14) | (faults << 8) | motor_id
+    data = struct.pack(
+        '>4H',
+        cg._to_uint16(pos, cg.P_MIN, cg.P_MAX),
+        cg._to_uint16(vel, cg.V_MIN, cg.V_MAX),
+        cg._to_uint16(torque, cg.T_MIN, cg.T_MAX),
+        int(temp_c * 10),
+    )
+    return cg.make_id(cg.TYPE_FEEDBACK, area2, host), data
+
+
+class TestCodec:
+    """Test frame encoding and feedback parsing."""
+
+    def test_motion_reference_vector(self):
+        can_id, data = cg.encode_motion(0x7F, pos=0.0, vel=0.0, kp=500.0, kd=0.0, torque=0.0)
+        assert can_id == 0x0180007F
+        assert data == bytes.fromhex('8000 8000 ffff 0000')
+
+    def test_motion_clamps_and_rejects_nan(self):
+        _, data = cg.encode_motion(1, pos=100.0, vel=-100.0, kp=float('nan'), kd=9.0)
+        assert data == bytes.fromhex('ffff 0000 0000 ffff')
+
+    def test_batch_matches_single_frames(self):
+        cmds = [(0.5, 1.0, 20.0, 0.5, 0.1), (-0.5, -1.0, 30.0, 1.0, -0.2)]
+        assert cg.encode_motion_batch([1, 2], cmds) == [
+            cg.encode_motion(1, *cmds[0]),
+            cg.encode_motion(2, *cmds[1]),
+        ]
+
+    def test_param_frames(self):
+        can_id, data = cg.encode_param_write(3, cg.PARAM_LIMIT_TORQUE, 6.0)
+        assert cg.frame_type(can_id) == cg.TYPE_PARAM_WRITE
+        assert can_id & 0xFF == 3 and cg.source_id(can_id) == cg.DEFAULT_HOST_ID
+        assert data == struct.pack('<HHf', 0x700B, 0, 6.0)
+
+        _, data = cg.encode_param_write(3, cg.PARAM_RUN_MODE, cg.MODE_SPEED)
+        assert data == bytes([0x05, 0x70, 0, 0, 2, 0, 0, 0])
+
+        _, data = cg.encode_stop(3, clear_fault=True)
+        assert data[0] == 1
+
+    def test_feedback_roundtrip_into_motor_data(self):
+        motor = MotorData()
+        can_id, data = _feedback_frame(5, pos=1.25, vel=-3.0, torque=2.5, temp_c=41.7, faults=0b000101)
+
+        assert cg.apply_feedback(can_id, data, motor)
+        assert motor.pos == pytest.approx(1.25, abs=4 * math.pi / 32768)
+        assert motor.large_pos == motor.pos
+        assert motor.vel == pytest.approx(-3.0, abs=1e-3)
+        assert motor.torque == pytest.approx(2.5, abs=1e-3)
+        assert motor.temperature == 41
+        assert motor.motor_mode == 2
+        assert cg.CybergearErrorDecoder().decode_motor_error(motor.motor_error) == "UV,OT"
+
+    def test_short_feedback_frame_leaves_motor_data(self):
+        motor = MotorData(pos=1.5, temperature=40)
+        can_id, data = _feedback_frame(5, pos=0.0, vel=0.0, torque=0.0, temp_c=0.0, faults=0)
+        assert not cg.apply_feedback(can_id, data[:6], motor)
+        assert (motor.pos, motor.temperature) == (1.5, 40)
+
+    def test_param_and_fault_frames_fill_motor_data(self):
+        motor = MotorData()
+        vbus = (cg.make_id(cg.TYPE_PARAM_READ, 5, cg.DEFAULT_HOST_ID),
+                struct.pack('<HHf', cg.PARAM_VBUS, 0, 24.0))
+        fault = (cg.make_id(cg.TYPE_FAULT, 5, cg.DEFAULT_HOST_ID), struct.pack('<II', 0x10001, 1))
+        other = (cg.make_id(cg.TYPE_PARAM_READ, 5, cg.DEFAULT_HOST_ID),
+                 struct.pack('<HHf', cg.PARAM_LOC_KP, 0, 30.0))
+
+        assert cg.apply_feedback(*vbus, motor)
+        assert cg.apply_feedback(*fault, motor)
+        assert not cg.apply_feedback(*other, motor)
+        assert motor.voltage == 24.0
+        assert cg.CybergearErrorDecoder().decode_driver_error(motor.driver_error) == "MotOT,PhA_OC,TmpWrn"
+
+
+@pytest.mark.skipif(not _vcan_available(), reason="vcan0 not configured")
+class TestVcanBus:
+    """Test CybergearBus on a virtual CAN interface."""
+
+    def test_host_and_simulated_motor_exchange_frames(self):
+        with cg.CybergearBus('vcan0') as host, cg.CybergearBus('vcan0', host_id=7) as motor:
+            host.send_batch(cg.encode_motion_batch([7, 8], [(1.0, 0.0, 10.0, 0.5, 0.0)] * 2))
+            can_id, data = motor.receive(timeout=1.0)
+            assert (can_id, data) == cg.encode_motion(7, 1.0, 0.0, 10.0, 0.5, 0.0)
+            assert motor.receive(timeout=0.05) is None  # Frame for motor 8 filtered out
+
+            motor.send(_feedback_frame(7, pos=0.5, vel=0.0, torque=0.0, temp_c=30.0))
+            reply = host.receive(timeout=1.0)
+            assert cg.parse_feedback(*reply).motor_id == 7
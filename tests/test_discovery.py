@@ -0,0 +1,190 @@
+"""
+Tests for the discovery module.
+
+Announcements are fed to Discovery.handle_packet() directly, so no
+multicast traffic is needed. Fingerprints are checked against the values
+cpy::messageFingerprint<T>() computes for the generated C++ types.
+"""
+
+import json
+import struct
+
+import pytest
+
+from capybarish.discovery import (
+    ROLE_PUBLISHER,
+    ROLE_SUBSCRIBER,
+    STALE_PERIODS,
+    Announcement,
+    Discovery,
+    TopicAnnouncement,
+    decode_announcement,
+    encode_announcement,
+    fingerprint,
+    node_id,
+)
+from capybarish.generated.motor_control_messages import MotorCommand, SensorData
+from capybarish.pubsub import Node, TopicManager
+
+
+@pytest.fixture(autouse=True)
+def reset_topic_manager():
+    """Give every test a fresh topic/node registry."""
+    TopicManager.reset()
+    yield
+    TopicManager.reset()
+
+
+def _module_announcement(address="10.0.0.7", port=6667, fp=None, reply=False):
+    return Announcement("motor_module", address, node_id("motor_module", address), [
+        TopicAnnouncement("/motor/command", ROLE_SUBSCRIBER, port, MotorCommand._SIZE,
+                          fingerprint(MotorCommand) if fp is None else fp),
+        TopicAnnouncement("/motor/feedback", ROLE_PUBLISHER, 6666, SensorData._SIZE,
+                          fingerprint(SensorData)),
+    ], reply_requested=reply)
+
+
+class TestWireFormat:
+    """Test the announcement encoding shared with capybarish_discovery.h."""
+
+    def test_record_sizes_match_cpp(self):
+        assert struct.calcsize("<4sBBBBI24s16s") == 52
+        assert struct.calcsize("<32sIHHB3x") == 44
+
+    def test_roundtrip(self):
+        announcement = _module_announcement(reply=True)
+        data = encode_announcement(announcement)
+        assert len(data) == 52 + 2 * 44
+        assert decode_announcement(data) == announcement
+
+    def test_rejects_garbage_and_truncation(self):
+        data = encode_announcement(_module_announcement())
+        assert decode_announcement(b"CPYTRACE" + data) is None
+        assert decode_announcement(data[:-1]) is None
+
+    def test_fingerprints_match_cpp(self):
+        # printf("%08x", cpy::messageFingerprint<SensorData>()) etc.
+        assert fingerprint(SensorData) == 0x52A8A419
+        assert fingerprint(MotorCommand) == 0xDF663F46
+        assert fingerprint(object) == 0
+
+
+class TestDiscovery:
+    """Test peer handling and publisher wiring."""
+
+    def _server(self, tmp_path=None, **kwargs):
+        node = Node("server")
+        pub = node.create_publisher(MotorCommand, "/motor/command")
+        cache = str(tmp_path / "peers.json") if tmp_path else None
+        return node, pub, Discovery(node, address="10.0.0.1", cache_path=cache, **kwargs)
+
+    def test_subscriber_becomes_endpoint(self):
+        node, pub, discovery = self._server()
+        assert discovery.handle_packet(encode_announcement(_module_announcement())) is not None
+        assert pub._remote_endpoints == [("10.0.0.7", 6667)]
+        assert discovery.peers[node_id("motor_module", "10.0.0.7")] == ("motor_module", "10.0.0.7")
+
+        # Periodic re-announcements change nothing
+        discovery.handle_packet(encode_announcement(_module_announcement()))
+        assert pub._remote_endpoints == [("10.0.0.7", 6667)]
+        node.destroy()
+
+    def test_port_change_replaces_endpoint(self):
+        node, pub, discovery = self._server()
+        discovery.handle_packet(encode_announcement(_module_announcement()))
+        discovery.handle_packet(encode_announcement(_module_announcement(port=7000)))
+        assert pub._remote_endpoints == [("10.0.0.7", 7000)]
+        node.destroy()
+
+    def test_single_target_is_sticky(self, monkeypatch):
+        clock = [100.0]
+        monkeypatch.setattr("capybarish.discovery.time.monotonic", lambda: clock[0])
+        node, pub, discovery = self._server()
+        discovery.handle_packet(encode_announcement(_module_announcement("10.0.0.7")))
+        for _ in range(3):
+            discovery.handle_packet(encode_announcement(_module_announcement("10.0.0.8")))
+            clock[0] += 1.0
+            discovery.handle_packet(encode_announcement(_module_announcement("10.0.0.7")))
+        assert pub._remote_endpoints == [("10.0.0.7", 6667)]
+        assert list(discovery.endpoints) == [("/motor/command", "10.0.0.7")]
+
+        # Silent for STALE_PERIODS announce periods: the next subscriber takes over
+        clock[0] += 2.0 * STALE_PERIODS
+        discovery.handle_packet(encode_announcement(_module_announcement("10.0.0.8")))
+        assert pub._remote_endpoints == [("10.0.0.8", 6667)]
+        assert list(discovery.endpoints) == [("/motor/command", "10.0.0.8")]
+        node.destroy()
+
+    def test_fan_out_reaches_every_subscriber(self):
+        node, pub, discovery = self._server(fan_out=True)
+        for address in ("10.0.0.7", "10.0.0.8"):
+            discovery.handle_packet(encode_announcement(_module_announcement(address)))
+        assert pub._remote_endpoints == [("10.0.0.7", 6667), ("10.0.0.8", 6667)]
+        node.destroy()
+
+    def test_only_published_topics_are_cached(self, tmp_path, monkeypatch):
+        node, pub, discovery = self._server(tmp_path)
+        saves = []
+        monkeypatch.setattr(discovery, "_save_cache", lambda: saves.append(1))
+        other = Announcement("logger", "10.0.0.9", node_id("logger", "10.0.0.9"), [
+            TopicAnnouncement("/motor/feedback", ROLE_SUBSCRIBER, 6666, SensorData._SIZE,
+                              fingerprint(SensorData))])
+        discovery.handle_packet(encode_announcement(other))
+        assert discovery.endpoints == {} and saves == []
+
+        # Re-announcements and competing subscribers are not written again
+        for _ in range(3):
+            discovery.handle_packet(encode_announcement(_module_announcement("10.0.0.7")))
+            discovery.handle_packet(encode_announcement(_module_announcement("10.0.0.8")))
+        assert saves == [1]
+        discovery.handle_packet(encode_announcement(_module_announcement("10.0.0.7", port=7000)))
+        assert saves == [1, 1]
+        node.destroy()
+
+    def test_fingerprint_mismatch_is_refused(self):
+        node, pub, discovery = self._server()
+        discovery.handle_packet(encode_announcement(_module_announcement(fp=0x1234)))
+        assert pub._remote_endpoints == []
+        assert discovery.mismatch_count == 1
+
+        # Unknown layouts (0) are accepted
+        discovery.handle_packet(encode_announcement(_module_announcement("10.0.0.8", fp=0)))
+        assert pub._remote_endpoints == [("10.0.0.8", 6667)]
+        node.destroy()
+
+    def test_own_announcements_are_ignored(self):
+        node, pub, discovery = self._server()
+        own = discovery.announcement()
+        own.topics.append(TopicAnnouncement("/motor/command", ROLE_SUBSCRIBER, 1, 0, 0))
+        assert discovery.handle_packet(encode_announcement(own)) is None
+        assert pub._remote_endpoints == []
+        node.destroy()
+
+    def test_announcement_lists_topics(self):
+        node, _, discovery = self._server()
+        announcement = discovery.announcement(request_reply=True)
+        assert announcement.reply_requested
+        assert announcement.address == "10.0.0.1"
+        assert [(t.topic, t.role, t.fingerprint) for t in announcement.topics] == [
+            ("/motor/command", ROLE_PUBLISHER, fingerprint(MotorCommand))]
+        node.destroy()
+
+    def test_cache_survives_restart(self, tmp_path):
+        node, _, discovery = self._server(tmp_path)
+        discovery.handle_packet(encode_announcement(_module_announcement()))
+        node.destroy()
+        saved = json.loads((tmp_path / "peers.json").read_text())
+        assert saved["endpoints"][0]["address"] == "10.0.0.7"
+
+        # Applied at start, before any announcement is heard
+        TopicManager.reset()
+        node, pub, discovery = self._server(tmp_path)
+        assert discovery.load_cache() == 1
+        assert pub._remote_endpoints == [("10.0.0.7", 6667)]
+        node.destroy()
+
+    def test_corrupt_cache_is_ignored(self, tmp_path):
+        (tmp_path / "peers.json").write_text("{not json")
+        node, _, discovery = self._server(tmp_path)
+        assert discovery._load_cache() == {}
+        node.destroy()
@@ -0,0 +1,264 @@
+"""
+Tests for the framing module.
+
+These tests verify the frame header wire format and XOR forward error
+correction shared with the ESP32 library (capybarish_frame.h).
+"""
+
+import struct
+
+import pytest
+
+from capybarish.framing import (
+    FRAME_MAGIC,
+    HEADER_SIZE,
+    MAX_STREAMS,
+    FecDecoder,
+    FecEncoder,
+    FrameHeader,
+    SeqWindow,
+    StreamDecoder,
+    is_frame,
+    seq_newer,
+)
+
+
+def _payload(i: int, size: int = 12) -> bytes:
+    return struct.pack('<I', i) * (size // 4)
+
+
+class TestFrameHeader:
+    """Test the 8-byte frame header."""
+
+    def test_wire_layout_matches_cpp(self):
+        """Header is magic, flags, K, index, then little-endian u32 seq and stream."""
+        data = FrameHeader(flags=1, fec_k=5, fec_index=5, seq=0x01020304, stream=0xA0B0C0D0).pack()
+        assert data == bytes([FRAME_MAGIC, 1, 5, 5, 0x04, 0x03, 0x02, 0x01, 0xD0, 0xC0, 0xB0, 0xA0])
+        assert HEADER_SIZE == 12
+
+    def test_roundtrip(self):
+        header = FrameHeader(fec_k=4, fec_index=2, seq=123456, stream=99)
+        assert FrameHeader.unpack(header.pack()) == header
+
+    def test_is_frame_requires_exact_size_and_magic(self):
+        frame = FrameHeader().pack() + _payload(1)
+        assert is_frame(frame, 12)
+        assert not is_frame(frame, 8)
+        assert not is_frame(b'\x00' + frame[1:], 12)
+
+    def test_seq_newer_wraps(self):
+        assert seq_newer(1, 0)
+        assert seq_newer(0, 0xFFFFFFFF)
+        assert not seq_newer(5, 5)
+        assert not seq_newer(0xFFFFFFFF, 0)
+
+
+class TestFec:
+    """Test XOR parity encoding and single-loss recovery."""
+
+    def test_encoder_emits_parity_every_k(self):
+        encoder = FecEncoder(group_size=4)
+        counts = [len(encoder.encode(_payload(i))) for i in range(8)]
+        assert counts == [1, 1, 1, 2, 1, 1, 1, 2]
+
+    def test_disabled_encoder_still_frames(self):
+        encoder = FecEncoder()
+        frames = encoder.encode(_payload(7))
+        assert len(frames) == 1
+        assert FrameHeader.unpack(frames[0]).fec_k == 0
+
+    @pytest.mark.parametrize("lost_index", [0, 1, 2, 3])
+    def test_recovers_any_single_loss(self, lost_index):
+        encoder = FecEncoder(group_size=4)
+        decoder = FecDecoder()
+        delivered = []
+        for i in range(4):
+            frames = encoder.encode(_payload(i))
+            if i == lost_index:
+                frames = frames[1:]  # Drop the data frame, keep parity if any
+            for frame in frames:
+                delivered.extend(decoder.decode(frame, 12))
+
+        assert sorted(delivered) == sorted(_payload(i) for i in range(4))
+        assert decoder.recovered_count == 1
+
+    def test_two_losses_are_not_recovered(self):
+        encoder = FecEncoder(group_size=4)
+        decoder = FecDecoder()
+        delivered = []
+        for i in range(4):
+            frames = encoder.encode(_payload(i))
+            if i in (0, 1):
+                frames = frames[1:]
+            for frame in frames:
+                delivered.extend(decoder.decode(frame, 12))
+
+        assert len(delivered) == 2
+        assert decoder.recovered_count == 0
+
+    def test_duplicates_and_stale_groups(self):
+        encoder = FecEncoder(group_size=2)
+        decoder = FecDecoder()
+        first = encoder.encode(_payload(0))
+        assert decoder.decode(first[0], 12) == [_payload(0)]
+        assert decoder.decode(first[0], 12) == []
+
+        frames = []
+        for i in (1, 2):
+            frames += encoder.encode(_payload(i))
+        for frame in frames:
+            decoder.decode(frame, 12)
+        # Group 0 is finished: old data passes through (SeqWindow drops
+        # copies), old parity is dropped
+        assert decoder.decode(first[0], 12) == [_payload(0)]
+        assert decoder.decode(frames[1], 12) == []
+
+    @pytest.mark.parametrize("order", [[0, 1, 2, 4, 3], [4, 0, 1, 2, 3], [0, 4, 1, 5, 2, 3]])
+    def test_reordering_across_groups_loses_nothing(self, order):
+        encoder = FecEncoder(group_size=4)
+        data = []
+        for i in range(max(order) + 1):
+            data.append(encoder.encode(_payload(i))[0])  # Data frames only
+        decoder = StreamDecoder()
+        delivered = []
+        for i in order:
+            delivered.extend(decoder.decode(data[i], 12))
+        assert sorted(delivered) == sorted(_payload(i) for i in order)
+
+    def test_plain_datagrams_pass_through(self):
+        decoder = FecDecoder()
+        assert decoder.decode(_payload(3), 12) == [_payload(3)]
+        assert decoder.decode(b'\x01\x02', 12) == []
+
+
+class TestRedundantPaths:
+    """Test duplicate filtering for multi-path streams."""
+
+    def test_seq_window_drops_duplicates(self):
+        window = SeqWindow()
+        assert window.accept(10)
+        assert not window.accept(10)
+        assert window.accept(12)
+        assert window.accept(11)
+        assert not window.accept(11)
+
+    def test_seq_window_drops_stale_and_detects_restart(self):
+        window = SeqWindow()
+        window.accept(100)
+        assert not window.accept(30)  # Behind the 64-entry window
+        window.accept(5000)
+        assert window.accept(0)  # Far behind: publisher restarted
+        assert not window.accept(0)
+
+    def test_seq_window_wraps(self):
+        window = SeqWindow()
+        assert window.accept(0xFFFFFFFE)
+        assert window.accept(1)
+        assert window.accept(0xFFFFFFFF)
+        assert not window.accept(0xFFFFFFFE)
+
+    def test_stream_decoder_keeps_first_copy(self):
+        encoder = FecEncoder()
+        decoder = StreamDecoder()
+        delivered = []
+        for i in range(10):
+            (frame,) = encoder.encode(_payload(i))
+            delivered.extend(decoder.decode(frame, 12))  # Path A
+            delivered.extend(decoder.decode(frame, 12))  # Path B
+        assert delivered == [_payload(i) for i in range(10)]
+        assert decoder.duplicate_count == 10
+
+    def test_recovered_message_is_not_delivered_twice(self):
+        encoder = FecEncoder(group_size=3)
+        decoder = StreamDecoder()
+        frames = [encoder.encode(_payload(i)) for i in range(3)]
+        delivered = []
+        # Path A loses message 1; FEC rebuilds it
+        for group in (frames[0], frames[2]):
+            for frame in group:
+                delivered.extend(decoder.decode(frame, 12))
+        # Path B's copy of message 1 arrives late
+        delivered.extend(decoder.decode(frames[1][0], 12))
+        assert sorted(delivered) == sorted(_payload(i) for i in range(3))
+
+
+class TestStreams:
+    """Test duplicate filtering with several publishers on one port."""
+
+    def test_publishers_far_apart_are_all_delivered(self):
+        # One publisher has been running much longer than the other
+        old, new = FecEncoder(stream=1), FecEncoder(stream=2)
+        for _ in range(500):
+            old.encode(_payload(0))
+        decoder = StreamDecoder()
+        delivered = 0
+        for i in range(100):
+            for encoder in (old, new):
+                delivered += len(decoder.decode(encoder.encode(_payload(i))[0], 12))
+        assert delivered == 200
+        assert decoder.duplicate_count == 0
+
+    def test_restarted_publisher_gets_a_fresh_window(self):
+        decoder = StreamDecoder()
+        first = FecEncoder()
+        for i in range(200):
+            decoder.decode(first.encode(_payload(i))[0], 12)
+        restarted = FecEncoder()  # Sequence numbers start at 0 again
+        assert restarted.stream != first.stream
+        assert decoder.decode(restarted.encode(_payload(0))[0], 12) == [_payload(0)]
+
+    def test_copies_dedup_per_stream(self):
+        a, b = FecEncoder(stream=10), FecEncoder(stream=20)
+        decoder = StreamDecoder()
+        frames = [a.encode(_payload(0))[0], b.encode(_payload(1))[0]]
+        for frame in frames + frames:  # Second round: copies from another path
+            decoder.decode(frame, 12)
+        assert decoder.duplicate_count == 2
+
+    def test_least_recent_stream_is_evicted(self):
+        decoder = StreamDecoder()
+        encoders = [FecEncoder(stream=i) for i in range(MAX_STREAMS + 1)]
+        first = encoders[0].encode(_payload(0))[0]
+        decoder.decode(first, 12)
+        for encoder in encoders[1:]:
+            decoder.decode(encoder.encode(_payload(0))[0], 12)
+        assert decoder.evicted_count == 1
+        # Stream 0 was forgotten, so its old frame passes again
+        assert decoder.decode(first, 12) == [_payload(0)]
+
+    def test_fec_groups_from_two_publishers_do_not_collide(self):
+        a, b = FecEncoder(group_size=3, stream=1), FecEncoder(group_size=3, stream=2)
+        for _ in range(9):
+            b.encode(_payload(0))  # Sequence numbers of the two streams differ
+        decoder = StreamDecoder()
+        delivered = []
+        for i in range(6):
+            frames_a, frames_b = a.encode(_payload(i)), b.encode(_payload(100 + i))
+            if i % 3 == 0:
+                frames_a = frames_a[1:]  # First of every group lost
+            for frame in frames_a + frames_b:
+                delivered.extend(decoder.decode(frame, 12))
+        assert decoder.recovered_count == 2
+        assert sorted(delivered) == sorted([_payload(i) for i in range(6)]
+                                           + [_payload(100 + i) for i in range(6)])
+
+    def test_stale_recovered_message_is_dropped_on_request(self):
+        def run(drop):
+            encoder = FecEncoder(group_size=3)
+            decoder = StreamDecoder(drop_stale_recovered=drop)
+            delivered = []
+            for i in range(6):
+                frames = encoder.encode(_payload(i))
+                if i in (1, 5):
+                    frames = frames[1:]  # Middle of group 0, last of group 1
+                for frame in frames:
+                    delivered.extend(decoder.decode(frame, 12))
+            return decoder, delivered
+
+        decoder, delivered = run(drop=False)
+        assert delivered == [_payload(i) for i in (0, 2, 1, 3, 4, 5)]
+
+        # Message 1 comes back after 2; message 5 is still the newest
+        decoder, delivered = run(drop=True)
+        assert delivered == [_payload(i) for i in (0, 2, 3, 4, 5)]
+        assert (decoder.recovered_count, decoder.stale_recovered_count) == (1, 1)
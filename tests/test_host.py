@@ -0,0 +1,38 @@
+"""
+Host tests for the C++ library (arduino/src).
+
+Each tests/host/test_*.cpp is built against the Arduino stand-in in
+tests/host/arduino, with real POSIX sockets and clocks, and must exit 0.
+Skipped when no C++20 compiler is available.
+"""
+
+import os
+import shutil
+import subprocess
+from pathlib import Path
+
+import pytest
+
+ROOT = Path(__file__).resolve().parent.parent
+HOST = ROOT / "tests" / "host"
+CXX = os.environ.get("CXX") or shutil.which("g++") or shutil.which("clang++")
+
+SOURCES = sorted(HOST.glob("test_*.cpp"))
+
+
+@pytest.mark.skipif(CXX is None, reason="no C++ compiler")
+@pytest.mark.parametrize("source", SOURCES, ids=[source.stem for source in SOURCES])
+def test_host(source, tmp_path):
+    binary = tmp_path / source.stem
+    build = subprocess.run(
+        [CXX, "-std=gnu++20", "-O1", "-g", "-Wall", "-Wno-unused-parameter",
+         "-I", str(HOST), "-I", str(HOST / "arduino"),
+         "-I", str(ROOT / "arduino" / "src"), "-I", str(ROOT / "capybarish" / "generated"),
+         str(source), str(HOST / "arduino" / "arduino_host.cpp"),
+         "-o", str(binary), "-lpthread"],
+        capture_output=True, text=True,
+    )
+    assert build.returncode == 0, build.stderr[-4000:]
+
+    run = subprocess.run([str(binary)], capture_output=True, text=True, timeout=120)
+    assert run.returncode == 0, run.stdout[-4000:] + run.stderr[-4000:]
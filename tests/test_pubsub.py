@@ -0,0 +1,244 @@
+"""
+Tests for the pubsub module.
+
+These tests verify QoS handling, publisher/subscriber wiring, and the
+network-facing helpers of the ROS2-like pub/sub API.
+"""
+
+import socket
+import sys
+import threading
+import time
+
+import pytest
+
+from capybarish.pubsub import (
+    Node,
+    QoSProfile,
+    RateEstimator,
+    RateLimitAction,
+    TokenBucket,
+    TopicManager,
+    TrafficClass,
+    apply_traffic_class,
+)
+
+
+@pytest.fixture(autouse=True)
+def reset_topic_manager():
+    """Give every test a fresh topic/node registry."""
+    TopicManager.reset()
+    yield
+    TopicManager.reset()
+
+
+class TestTrafficClass:
+    """Test per-topic traffic classes and DSCP marking."""
+
+    def test_dscp_maps_to_expected_access_category(self):
+        """The top three DSCP bits select the WMM user priority."""
+        assert TrafficClass.BACKGROUND.user_priority in (1, 2)
+        assert TrafficClass.BEST_EFFORT.user_priority in (0, 3)
+        assert TrafficClass.VIDEO.user_priority in (4, 5)
+        assert TrafficClass.VOICE.user_priority in (6, 7)
+
+    def test_tos_is_dscp_shifted(self):
+        """TOS byte carries DSCP in its upper six bits."""
+        for cls in TrafficClass:
+            assert cls.tos == cls.dscp << 2
+
+    def test_control_profile_uses_voice(self):
+        """The control preset keeps only the latest command in AC_VO."""
+        qos = QoSProfile.control()
+        assert qos.traffic_class == TrafficClass.VOICE
+        assert qos.depth == 1
+        assert QoSProfile().traffic_class == TrafficClass.BEST_EFFORT
+
+    @pytest.mark.unix_only
+    @pytest.mark.skipif(sys.platform == "win32", reason="IP_TOS is ignored on Windows")
+    def test_apply_traffic_class_sets_tos(self):
+        """Marking a socket is visible through getsockopt."""
+        sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        try:
+            assert apply_traffic_class(sock, TrafficClass.VIDEO)
+            tos = sock.getsockopt(socket.IPPROTO_IP, socket.IP_TOS)
+            assert tos == TrafficClass.VIDEO.tos
+        finally:
+            sock.close()
+
+    def test_publisher_socket_is_marked(self):
+        """Network publishers apply the class of their QoS profile."""
+        node = Node("tc_pub")
+        pub = node.create_publisher(int, "/cmd", qos_profile=QoSProfile.control())
+        pub.add_remote_endpoint("127.0.0.1", 9)
+        if hasattr(socket, "IP_TOS") and sys.platform != "win32":
+            tos = pub._udp_socket.getsockopt(socket.IPPROTO_IP, socket.IP_TOS)
+            assert tos == TrafficClass.VOICE.tos
+        node.destroy()
+
+    def test_timers_ordered_by_class(self):
+        """Higher-class timers fire first within the same spin."""
+        node = Node("tc_timers")
+        fired = []
+        node.create_timer(0.0, lambda: fired.append("telemetry"))
+        node.create_timer(0.0, lambda: fired.append("log"), TrafficClass.BACKGROUND)
+        node.create_timer(0.0, lambda: fired.append("control"), TrafficClass.VOICE)
+
+        node.spin_once()
+
+        assert fired == ["control", "telemetry", "log"]
+        node.destroy()
+
+
+class TestRedundantPublishing:
+    """Test multi-path publishing over loopback."""
+
+    def test_subscriber_receives_each_message_once(self):
+        from capybarish.generated import MotorCommand
+
+        node = Node("multipath")
+        received = []
+        sub = node.create_subscription(MotorCommand, "/mp/cmd", received.append)
+        probe = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        probe.bind(("127.0.0.1", 0))
+        port = probe.getsockname()[1]
+        probe.close()
+        sub.bind_network("127.0.0.1", port)
+
+        pub = node.create_publisher(MotorCommand, "/mp/cmd_out")
+        pub.add_remote_endpoint("127.0.0.1", port)
+        pub.add_path("127.0.0.1", port, source_address="127.0.0.1")
+        for i in range(5):
+            pub.publish(MotorCommand(target=float(i)))
+
+        deadline = time.time() + 2.0
+        while sub.duplicate_count < 5 and time.time() < deadline:
+            time.sleep(0.01)
+        node.spin_once()
+
+        assert [msg.target for msg in received] == [0.0, 1.0, 2.0, 3.0, 4.0]
+        assert sub.duplicate_count == 5
+        node.destroy()
+
+
+class TestSpinUntil:
+    """Test the blocking spin that sleeps until data or a timer is due."""
+
+    def test_wakes_on_message(self):
+        """A message published from another thread is handled promptly."""
+        node = Node("spin_wake")
+        received = []
+        node.create_subscription(int, "/wake", lambda msg: received.append(time.monotonic()))
+        pub = node.create_publisher(int, "/wake")
+
+        sent = []
+        def publish_later():
+            time.sleep(0.05)
+            sent.append(time.monotonic())
+            pub.publish(1)
+        sender = threading.Thread(target=publish_later)
+        sender.start()
+
+        start = time.monotonic()
+        count = node.spin_until(start + 0.3)
+        sender.join()
+
+        assert count == 1
+        assert received[0] - sent[0] < 0.02
+        assert time.monotonic() - start >= 0.3
+        node.destroy()
+
+    def test_fires_timers_while_idle(self):
+        """Timers still fire on schedule when no messages arrive."""
+        node = Node("spin_timers")
+        fired = []
+        node.create_timer(0.02, lambda: fired.append(time.monotonic()))
+
+        count = node.spin_for(0.11)
+
+        assert count == len(fired)
+        assert 4 <= len(fired) <= 6
+        node.destroy()
+
+
+def _loopback_receiver():
+    """Bound, non-blocking UDP socket on an ephemeral loopback port."""
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind(("127.0.0.1", 0))
+    sock.setblocking(False)
+    return sock
+
+
+def _drain(sock):
+    datagrams = []
+    while True:
+        try:
+            datagrams.append(sock.recv(4096))
+        except BlockingIOError:
+            return datagrams
+
+
+class TestBandwidthBudget:
+    """Test per-topic rate estimation and token-bucket limiting."""
+
+    def test_estimator_tracks_steady_rate(self):
+        """A steady stream reads its true rate and decays once it stops."""
+        est = RateEstimator(tau_sec=1.0)
+        for i in range(500):
+            est.add(i * 0.01, 8)  # 100 msg/s of 8 bytes
+        assert est.rate(4.99) == pytest.approx(800, rel=0.08)
+        assert est.rate(9.99) < 10
+
+    def test_bucket_admits_burst_then_rate(self):
+        """The bucket passes its depth at once, then refills at the rate."""
+        bucket = TokenBucket(rate=100, burst=50, now=0.0)
+        assert sum(bucket.try_consume(0.0, 10) for _ in range(10)) == 5
+        assert bucket.wait_time(0.0, 10) == pytest.approx(0.1)
+        assert bucket.try_consume(0.1, 10)
+
+    def test_drop_over_budget(self):
+        """Messages over budget never reach the network."""
+        from capybarish.generated import MotorCommand
+
+        rx = _loopback_receiver()
+        node = Node("bw_drop")
+        size = MotorCommand._SIZE
+        qos = QoSProfile().with_budget(size * 10, burst=size * 3)
+        pub = node.create_publisher(MotorCommand, "/bw/drop", qos_profile=qos)
+        pub.add_remote_endpoint(*rx.getsockname())
+
+        for i in range(10):
+            pub.publish(MotorCommand(target=float(i)))
+        time.sleep(0.05)
+
+        assert len(_drain(rx)) == 3
+        assert pub.throttled_count == 7
+        assert pub.byte_count == size * 3
+        assert pub.bytes_per_sec > 0
+        rx.close()
+        node.destroy()
+
+    def test_defer_sends_latest_after_refill(self):
+        """With DEFER only the newest held message goes out, once tokens refill."""
+        from capybarish.generated import MotorCommand
+
+        rx = _loopback_receiver()
+        node = Node("bw_defer")
+        size = MotorCommand._SIZE
+        qos = QoSProfile().with_budget(size * 20, burst=size, action=RateLimitAction.DEFER)
+        pub = node.create_publisher(MotorCommand, "/bw/defer", qos_profile=qos)
+        pub.add_remote_endpoint(*rx.getsockname())
+
+        for i in range(3):
+            pub.publish(MotorCommand(target=float(i)))
+        assert pub.throttled_count == 1
+        assert 0 < pub.time_until_flush() <= 0.05
+
+        node.spin_for(0.1)
+        time.sleep(0.02)
+
+        targets = [MotorCommand.deserialize(d).target for d in _drain(rx)]
+        assert targets == [0.0, 2.0]
+        assert pub.time_until_flush() == float("inf")
+        rx.close()
+        node.destroy()
@@ -0,0 +1,162 @@
+"""
+Tests for the rpc module.
+
+Checks the header layout against bytes produced by cpy::RpcHeader
+(capybarish_pubsub.h), then runs calls over loopback UDP.
+"""
+
+import socket
+
+import pytest
+
+from capybarish.generated.motor_control_messages import MotorCommand, SensorData
+from capybarish.rpc import (
+    HEADER_SIZE,
+    RPC_REQUEST,
+    RPC_RESPONSE,
+    RpcStatus,
+    Service,
+    ServiceClient,
+    decode,
+    encode,
+)
+
+
+def _read_sensor(cmd):
+    """Answer with module_id = 10 * joint_id; reject negative joints."""
+    if cmd.joint_id < 0:
+        return None
+    return SensorData(module_id=cmd.joint_id * 10)
+
+
+@pytest.fixture
+def service():
+    service = Service(MotorCommand, SensorData, _read_sensor, 0, "127.0.0.1")
+    service.start()
+    yield service
+    service.stop()
+
+
+@pytest.fixture
+def client(service):
+    client = ServiceClient(MotorCommand, SensorData, "127.0.0.1", service.port, max_pending=2)
+    yield client
+    client.close()
+
+
+class TestWireFormat:
+    """Test the header shared with capybarish_pubsub.h."""
+
+    def test_matches_cpp(self):
+        # RpcHeader{kind RESPONSE, status REJECTED, id 0x11223344, replyPort 7001}
+        data = encode(RPC_RESPONSE, 0x11223344, status=RpcStatus.REJECTED, reply_port=7001)
+        assert HEADER_SIZE == 12
+        assert data.hex() == "cc02010044332211591b0000"
+
+    def test_roundtrip_and_garbage(self):
+        data = encode(RPC_REQUEST, 7, b"abc", reply_port=9)
+        assert decode(data) == (RPC_REQUEST, RpcStatus.OK, 7, 9, b"abc")
+        assert decode(data[:-1]) is None
+        assert decode(b"\xcb" + data[1:]) is None
+        assert decode(b"short") is None
+
+
+class TestService:
+    """Test request handling without sockets."""
+
+    def test_handle_datagram(self):
+        service = Service(MotorCommand, SensorData, _read_sensor, 0, "127.0.0.1")
+        ok = decode(service.handle_datagram(encode(RPC_REQUEST, 5, MotorCommand(joint_id=2).serialize())))
+        assert (ok.kind, ok.status, ok.id) == (RPC_RESPONSE, RpcStatus.OK, 5)
+        assert SensorData.deserialize(ok.payload).module_id == 20
+
+        rejected = decode(service.handle_datagram(encode(RPC_REQUEST, 6, MotorCommand(joint_id=-1).serialize())))
+        assert (rejected.status, rejected.payload) == (RpcStatus.REJECTED, b"")
+
+        bad = decode(service.handle_datagram(encode(RPC_REQUEST, 7, b"xyz")))
+        assert bad.status == RpcStatus.BAD_REQUEST
+        assert service.handle_datagram(encode(RPC_RESPONSE, 8)) is None
+        assert (service.call_count, service.reject_count, service.bad_request_count) == (3, 1, 1)
+        service.stop()
+
+
+class TestClient:
+    """Test calls over loopback UDP."""
+
+    def test_call(self, client):
+        assert client.call(MotorCommand(joint_id=3), timeout=1.0).module_id == 30
+        assert client.last_status == RpcStatus.OK
+        assert client.call(MotorCommand(joint_id=-1), timeout=1.0) is None
+        assert client.last_status == RpcStatus.REJECTED
+        assert client.pending_count == 0
+
+    def test_pending_table_is_bounded(self, client):
+        first = client.send(MotorCommand(joint_id=1), timeout=1.0)
+        second = client.send(MotorCommand(joint_id=2), timeout=1.0)
+        assert first and second and first != second
+        assert client.send(MotorCommand(joint_id=3)) == 0
+        assert client.busy_count == 1
+
+        # Responses are matched by ID, whatever order they are taken in
+        results = {}
+        while len(results) < 2:
+            for id in (second, first):
+                result = client.take(id)
+                if result is not None:
+                    results[id] = result
+        assert results[second][1].module_id == 20
+        assert results[first][1].module_id == 10
+
+    def test_timeout_and_late_response(self):
+        silent = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        silent.bind(("127.0.0.1", 0))
+        client = ServiceClient(MotorCommand, SensorData, "127.0.0.1", silent.getsockname()[1])
+        assert client.call(MotorCommand(), timeout=0.02) is None
+        assert client.last_status == RpcStatus.TIMEOUT
+        assert client.timeout_count == 1
+
+        # The request arrived; answering it now is too late
+        data, sender = silent.recvfrom(1024)
+        request = decode(data)
+        assert request.reply_port == client.local_port
+        silent.sendto(encode(RPC_RESPONSE, request.id, SensorData().serialize()), sender)
+        id = client.send(MotorCommand(), timeout=0.05)
+        while client.take(id) is None:
+            pass
+        assert client.late_count == 1
+        client.close()
+        silent.close()
+
+    def test_response_from_another_socket_is_dropped(self):
+        server = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        server.bind(("127.0.0.1", 0))
+        spoofer = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        client = ServiceClient(MotorCommand, SensorData, "127.0.0.1", server.getsockname()[1])
+        id = client.send(MotorCommand(), timeout=1.0)
+
+        # Right ID, wrong source port: not the server's response
+        spoofer.sendto(encode(RPC_RESPONSE, id, SensorData(module_id=66).serialize()),
+                       ("127.0.0.1", client.local_port))
+        data, sender = server.recvfrom(1024)
+        server.sendto(encode(RPC_RESPONSE, decode(data).id, SensorData(module_id=7).serialize()), sender)
+        while (result := client.take(id)) is None:
+            pass
+        assert result[1].module_id == 7
+        assert client.drop_count == 1
+        client.close()
+        spoofer.close()
+        server.close()
+
+    def test_ids_start_at_random(self):
+        ids = set()
+        for _ in range(4):
+            client = ServiceClient(MotorCommand, SensorData, "127.0.0.1", 9)
+            ids.add(client.send(MotorCommand(), timeout=None))
+            client.close()
+        assert len(ids) > 1
+
+    def test_cancel(self, client):
+        id = client.send(MotorCommand(), timeout=None)
+        assert client.cancel(id)
+        assert not client.cancel(id)
+        assert client.pending_count == 0
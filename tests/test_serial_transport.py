@@ -0,0 +1,138 @@
+"""
+Tests for the serial transport.
+
+These tests verify COBS/CRC framing shared with the ESP32 library
+(capybarish_serial.h) and run the termios transport over a pseudo-terminal.
+"""
+
+import sys
+import time
+
+import pytest
+
+from capybarish.serial_transport import (
+    PacketDecoder,
+    cobs_decode,
+    cobs_encode,
+    crc16,
+    encode_packet,
+)
+
+pytestmark = pytest.mark.skipif(sys.platform == "win32", reason="termios is POSIX only")
+
+
+def _wait_for(predicate, timeout=2.0):
+    deadline = time.time() + timeout
+    while not predicate() and time.time() < deadline:
+        time.sleep(0.01)
+    return predicate()
+
+
+class TestFraming:
+    """Test COBS encoding, CRC and stream resynchronisation."""
+
+    @pytest.mark.parametrize("data", [
+        b"",
+        b"\x00",
+        b"\x11\x22\x00\x33",
+        bytes(range(1, 255)),
+        bytes(range(256)) * 3,
+    ])
+    def test_cobs_roundtrip_has_no_zeros(self, data):
+        encoded = cobs_encode(data)
+        assert 0 not in encoded
+        assert cobs_decode(encoded) == data
+
+    def test_cobs_reference_vectors(self):
+        assert cobs_encode(b"\x11\x22\x00\x33") == b"\x03\x11\x22\x02\x33"
+        assert cobs_encode(b"\x00\x00") == b"\x01\x01\x01"
+
+    def test_crc_matches_ccitt_false(self):
+        assert crc16(b"123456789") == 0x29B1
+
+    def test_decoder_splits_stream(self):
+        decoder = PacketDecoder()
+        stream = encode_packet(6666, b"abc") + encode_packet(6667, b"\x00\x01")
+        # Feed one byte at a time, as a slow UART would deliver it
+        packets = []
+        for i in range(len(stream)):
+            packets += decoder.feed(stream[i:i + 1])
+        assert packets == [(6666, b"abc"), (6667, b"\x00\x01")]
+
+    def test_log_text_and_corruption_are_discarded(self):
+        decoder = PacketDecoder()
+        bad = bytearray(encode_packet(1, b"hello"))
+        bad[3] ^= 0x40
+        stream = b"[Node] Created: module\r\n" + bytes(bad) + encode_packet(2, b"ok")
+        assert decoder.feed(stream) == [(2, b"ok")]
+        assert decoder.crc_errors + decoder.framing_errors == 2
+
+    def test_oversized_packet_is_skipped(self):
+        decoder = PacketDecoder(max_datagram=8)
+        stream = encode_packet(1, b"x" * 64) + encode_packet(1, b"y")
+        assert decoder.feed(stream) == [(1, b"y")]
+        assert decoder.framing_errors == 1
+
+
+@pytest.mark.unix_only
+class TestPtyTransport:
+    """Test SerialTransport end to end over a pseudo-terminal."""
+
+    @pytest.fixture
+    def link(self):
+        from capybarish.serial_transport import SerialTransport, open_pty
+
+        master, path = open_pty()
+        host = SerialTransport(path)
+        device = SerialTransport(master)
+        yield host, device
+        host.close()
+        device.close()
+
+    def test_channels_demultiplex_by_port(self, link):
+        host, device = link
+        cmd = device.open_channel(6667)
+        other = device.open_channel(7000)
+        tx = host.open_channel()
+
+        tx.sendto(b"to-cmd", ("ignored", 6667))
+        tx.sendto(b"to-other", ("ignored", 7000))
+        tx.sendto(b"nobody", ("ignored", 1234))
+
+        cmd.settimeout(1.0)
+        other.settimeout(1.0)
+        assert cmd.recvfrom(64) == (b"to-cmd", (device.name, 6667))
+        assert other.recvfrom(64)[0] == b"to-other"
+        assert _wait_for(lambda: host.unrouted + device.unrouted == 1)
+
+    def test_nonblocking_channel_raises_when_empty(self, link):
+        _, device = link
+        channel = device.open_channel(6667)
+        channel.setblocking(False)
+        with pytest.raises(BlockingIOError):
+            channel.recvfrom(64)
+
+    def test_pubsub_over_transport(self, link):
+        from capybarish.generated import MotorCommand
+        from capybarish.pubsub import Node, TopicManager
+
+        host, device = link
+        TopicManager.reset()
+        host_node = Node("bench", transport=host)
+        device_node = Node("module", transport=device)
+
+        received = []
+        sub = device_node.create_subscription(MotorCommand, "/cmd", received.append)
+        sub.bind_network(port=6667)
+        pub = host_node.create_publisher(MotorCommand, "/cmd_out")
+        pub.add_remote_endpoint("module", 6667)
+
+        for i in range(3):
+            pub.publish(MotorCommand(target=float(i), kp=10.0))
+        assert _wait_for(lambda: sub.pending_count == 3)
+        device_node.spin_once()
+
+        assert [msg.target for msg in received] == [0.0, 1.0, 2.0]
+        host_node.destroy()
+        device_node.destroy()
+        TopicManager.reset()
@@ -0,0 +1,157 @@
+"""
+Tests for the trace module.
+
+These tests build dumps in the binary layout written by
+cpy::TraceRecorder::dump() (capybarish_trace.h) and check the parser and
+the Chrome/Perfetto JSON produced from them.
+"""
+
+import json
+import struct
+
+import pytest
+
+from capybarish.trace import (
+    CALLBACK_BEGIN,
+    CALLBACK_END,
+    IDLE_BEGIN,
+    IDLE_END,
+    KIND_CLIENT,
+    KIND_NODE,
+    KIND_SERVICE,
+    KIND_SUBSCRIPTION,
+    KIND_TIMER,
+    PACKET,
+    PUBLISH,
+    TIMER_LATENESS,
+    main,
+    parse_trace,
+    parse_traces,
+    to_chrome_json,
+)
+
+
+def _dump(entities, events, dropped=0) -> bytes:
+    data = b"CPYTRACE" + struct.pack("<HHII", 1, len(entities), len(events), dropped)
+    for kind, name in entities:
+        raw = name.encode()
+        data += bytes([kind, len(raw)]) + raw
+    for time_us, arg, kind, entity in events:
+        data += struct.pack("<IIBB", time_us, arg, kind, entity)
+    return data
+
+
+ENTITIES = [(KIND_NODE, "robot"), (KIND_SUBSCRIPTION, "/cmd"), (KIND_TIMER, "timer 100.0 Hz")]
+EVENTS = [
+    (1000, 84, PACKET, 1),
+    (1010, 0, CALLBACK_BEGIN, 1),
+    (1050, 0, CALLBACK_END, 1),
+    (1100, 250, TIMER_LATENESS, 2),
+    (1100, 0, CALLBACK_BEGIN, 2),
+    (1120, 376, PUBLISH, 0),
+    (1200, 0, CALLBACK_END, 2),
+    (1200, 8800, IDLE_BEGIN, 0),
+    (9000, 0, IDLE_END, 0),
+]
+
+
+class TestParse:
+    """Test the binary dump parser."""
+
+    def test_event_record_is_ten_bytes(self):
+        assert struct.calcsize("<IIBB") == 10
+
+    def test_roundtrip(self):
+        trace, end = parse_trace(_dump(ENTITIES, EVENTS, dropped=3))
+        assert [e.name for e in trace.entities] == ["robot", "/cmd", "timer 100.0 Hz"]
+        assert trace.node_name == "robot"
+        assert trace.dropped == 3
+        assert len(trace.events) == len(EVENTS)
+        assert trace.events[0].arg == 84 and trace.events[0].type == PACKET
+        assert end == len(_dump(ENTITIES, EVENTS))
+
+    def test_finds_dumps_in_serial_log(self):
+        capture = (b"[Node] Created: robot\n" + _dump(ENTITIES, EVENTS) +
+                   b"\nnoise CPYTRACE garbage\n" + _dump(ENTITIES[:1], EVENTS[-2:]))
+        traces = parse_traces(capture)
+        assert len(traces) == 2
+        assert len(traces[1].events) == 2
+
+    def test_truncated_dump_is_skipped(self):
+        data = _dump(ENTITIES, EVENTS)
+        assert parse_traces(data[:-5]) == []
+        with pytest.raises(ValueError):
+            parse_trace(data[:-5])
+
+    def test_timestamps_unwrap(self):
+        events = [(0xFFFFFF00, 0, PUBLISH, 0), (0x00000100, 0, PUBLISH, 0)]
+        trace, _ = parse_trace(_dump(ENTITIES, events))
+        assert trace.events[1].time_us - trace.events[0].time_us == 0x200
+
+
+class TestChromeJson:
+    """Test conversion to the Trace Event Format."""
+
+    def _events(self, data=None, **kwargs):
+        doc = to_chrome_json(parse_traces(data or _dump(ENTITIES, EVENTS)), **kwargs)
+        json.dumps(doc)  # Must serialize
+        return [e for e in doc["traceEvents"] if e["ph"] != "M"]
+
+    def test_callbacks_become_slices(self):
+        events = self._events()
+        slices = [(e["ph"], e["tid"], e["ts"]) for e in events if e["ph"] in "BE"]
+        assert ("B", 2, 10) in slices and ("E", 2, 50) in slices
+        assert ("B", 3, 100) in slices and ("E", 3, 200) in slices
+
+    def test_instants_and_counters(self):
+        events = self._events()
+        packet = next(e for e in events if e["name"] == "packet")
+        assert packet["ph"] == "i" and packet["args"]["bytes"] == 84
+        counter = next(e for e in events if e["ph"] == "C")
+        assert counter["name"] == "timer 100.0 Hz lateness"
+        assert counter["args"]["us"] == 250
+
+    def test_idle_slice_on_node_track(self):
+        idle = [e for e in self._events() if e["name"] == "idle"]
+        assert [(e["ph"], e["tid"], e["ts"]) for e in idle] == [("B", 1, 200), ("E", 1, 8000)]
+
+    def test_absolute_timestamps(self):
+        events = self._events(relative=False)
+        assert min(e["ts"] for e in events) == 1000
+
+    def test_end_without_begin_is_dropped(self):
+        # The ring overwrote the BEGIN of the first callback
+        data = _dump(ENTITIES, [(50, 0, CALLBACK_END, 1), (60, 0, CALLBACK_BEGIN, 1),
+                                (70, 0, CALLBACK_END, 1)])
+        phases = [e["ph"] for e in self._events(data)]
+        assert phases == ["B", "E"]
+
+    def test_processes_and_track_names(self):
+        doc = to_chrome_json(parse_traces(_dump(ENTITIES, EVENTS) * 2))
+        names = {(e["pid"], e.get("tid"), e["args"]["name"])
+                 for e in doc["traceEvents"] if e["name"] in ("process_name", "thread_name")}
+        assert (1, None, "robot") in names and (2, None, "robot") in names
+        assert (1, 2, "sub /cmd") in names
+
+    def test_service_and_client_tracks(self):
+        entities = ENTITIES + [(KIND_SERVICE, "/get_param"), (KIND_CLIENT, "/set_param")]
+        doc = to_chrome_json(parse_traces(_dump(entities, EVENTS)))
+        names = {e["args"]["name"] for e in doc["traceEvents"] if e["name"] == "thread_name"}
+        assert "srv /get_param" in names and "client /set_param" in names
+
+
+class TestCommandLine:
+    """Test the trace converter entry point."""
+
+    def test_writes_json(self, tmp_path):
+        src = tmp_path / "capture.bin"
+        src.write_bytes(b"log\n" + _dump(ENTITIES, EVENTS))
+        dst = tmp_path / "trace.json"
+        assert main([str(src), "-o", str(dst)]) == 0
+        doc = json.loads(dst.read_text())
+        assert any(e["ph"] == "C" for e in doc["traceEvents"])
+
+    def test_no_trace_fails(self, tmp_path):
+        src = tmp_path / "empty.bin"
+        src.write_bytes(b"just a log\n")
+        assert main([str(src)]) == 1